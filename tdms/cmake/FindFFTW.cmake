@@ -10,6 +10,9 @@
 #   FFTW_FOUND                  ... true if fftw is found on the system
 #   FFTW_LIBRARIES              ... full paths to all found fftw libraries
 #   FFTW_INCLUDE_DIRS           ... fftw include directory paths
+#   FFTW_THREADS_LIB            ... the threaded fftw library, if found, in
+#                                   which case FFTW::Double defines
+#                                   TDMS_FFTW_THREADS
 #
 # The following variables will be checked by the function
 #   FFTW_USE_STATIC_LIBS        ... if true, only static libraries are found,
@@ -46,6 +49,14 @@ if(FFTW_ROOT)
             NO_DEFAULT_PATH
     )
 
+    find_library(
+            FFTW_THREADS_LIB
+            NAMES "fftw3_threads" libfftw3_threads-3
+            PATHS ${FFTW_ROOT}
+            PATH_SUFFIXES "lib" "lib64"
+            NO_DEFAULT_PATH
+    )
+
     find_path(FFTW_INCLUDE_DIRS
             NAMES "fftw3.h"
             PATHS ${FFTW_ROOT}
@@ -59,6 +70,12 @@ else()
             PATHS ${PKG_FFTW_LIBRARY_DIRS} ${LIB_INSTALL_DIR}
     )
 
+    find_library(
+            FFTW_THREADS_LIB
+            NAMES "fftw3_threads"
+            PATHS ${PKG_FFTW_LIBRARY_DIRS} ${LIB_INSTALL_DIR}
+    )
+
     find_path(FFTW_INCLUDE_DIRS
             NAMES "fftw3.h"
             PATHS ${PKG_FFTW_INCLUDE_DIRS} ${INCLUDE_INSTALL_DIR}
@@ -79,6 +96,18 @@ set_target_properties(FFTW::Double
         INTERFACE_LINK_LIBRARIES "${FFTW_DOUBLE_LIB}"
         )
 
+# the threaded library is optional: without it, every transform is executed by
+# a single thread
+if (FFTW_THREADS_LIB)
+    message(STATUS "Found the threaded FFTW library: ${FFTW_THREADS_LIB}")
+    set(FFTW_LIBRARIES ${FFTW_THREADS_LIB} ${FFTW_LIBRARIES})
+    set_target_properties(FFTW::Double
+            PROPERTIES INTERFACE_LINK_LIBRARIES
+            "${FFTW_THREADS_LIB};${FFTW_DOUBLE_LIB}"
+            INTERFACE_COMPILE_DEFINITIONS TDMS_FFTW_THREADS
+            )
+endif()
+
 set( CMAKE_FIND_LIBRARY_SUFFIXES ${CMAKE_FIND_LIBRARY_SUFFIXES_SAV} )
 
 include(FindPackageHandleStandardArgs)
@@ -92,4 +121,5 @@ mark_as_advanced(
         FFTW_INCLUDE_DIRS
         FFTW_LIBRARIES
         FFTW_DOUBLE_LIB
+        FFTW_THREADS_LIB
 )
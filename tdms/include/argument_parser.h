@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "globals.h"
+#include "solver_options.h"
 
 /**
  * @brief Wraps a vector of string CL arguments with some helpful functionality.
@@ -38,6 +39,15 @@ public:
    */
   bool have_flag(std::string const &flag) const;
 
+  /**
+   * @brief Searches the arguments for a flag of the form flag=value
+   *
+   * @param flag to search for, without the =
+   * @return std::string the value of the flag, or an empty string if the flag
+   * is not present
+   */
+  std::string flag_value(std::string const &flag) const;
+
   /**
    * @brief Return true if the user has requested the output file we written in
    * compressed format.
@@ -49,6 +59,31 @@ public:
    */
   bool compressed_output() const;
 
+  /**
+   * @brief The execution options of the solver requested on the command line.
+   * @details Cache blocking is toggled by the -b, --cache-blocking options,
+   * and the number of timesteps in each of its tiles, and the width of its
+   * slabs, by the --tile-steps=<steps> and --slab-width=<cells> options, the
+   * fused update engine by the -f, --fused-updates options, and the
+   * accumulation of the phasors in its sweeps by the --fused-phasors option,
+   * the storage of the field arrays by the --huge-pages, --pad-rows, and
+   * --unsplit-interior options, the FFT library by the --fft-backend=<library>
+   * option, the planning of the PSTD transforms by the
+   * --fftw-planning=<rigour> and --fftw-wisdom=<file> options, and the hybrid
+   * PSTD/FDTD solver by the --hybrid-pstd and --hybrid-overlap=<cells>
+   * options, and the tracking of the active region of pulsed simulations by
+   * the --active-region and --active-region-threshold=<fraction> options,
+   * and the early termination of pulsed simulations by the
+   * --energy-decay=<fraction> option, and the convergence check of
+   * steady-state simulations by the --convergence-on=<phasors> and
+   * --convergence-stride=<cells> options, and the extraction of the volume
+   * phasors at every extraction frequency by the --volume-spectrum option,
+   * and the evaluation of the probes with compiled stencils by the
+   * --compiled-probes option, and the distribution of the grid over MPI
+   * processes by the --distributed option.
+   */
+  SolverOptions solver_options() const;
+
   /**
    * @brief Have we been provided with a grid filename?
    *
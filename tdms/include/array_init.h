@@ -9,12 +9,12 @@
 #include "mat_io.h"
 
 /**
- * Initialise the grid tensors/arrays, including the electric and magnetic split
- * fields and the materials array.
+ * Initialise the grid arrays: the materials array, and the dimensions of the
+ * electric and magnetic split fields, which are not allocated.
  * @param ptr Pointer to the matlab struct
  * @param E_s Electric split field
  * @param H_s Magnetic split field
- * @param materials Materials array
+ * @param materials Materials of the cells, indexed (i, j, k)
  */
 void init_grid_arrays(const mxArray *ptr, SplitField &E_s, SplitField &H_s,
-                      uint8_t ***&materials);
+                      Tensor3D<uint8_t> &materials);
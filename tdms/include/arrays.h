@@ -5,12 +5,14 @@
 #pragma once
 
 #include <complex>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include <fftw3.h>
 
+#include "fft_backend.h"
 #include "globals.h"
 #include "matlabio.h"
 #include "utils.h"
@@ -102,10 +104,17 @@ struct FrequencyVectors {
 class DetectorSensitivityArrays {
 public:
   fftw_complex *v = nullptr;          // Flat fftw vector
-  fftw_plan plan = nullptr;           // fftw plan for the setup
+  std::unique_ptr<ComplexFFT2D> plan; // 2D FFT of v, in place
   std::complex<double> **cm = nullptr;// Column major matrix
 
-  void initialise(int n_rows, int n_cols);
+  /**
+   * @brief Allocate the arrays, and plan the transform of v with an FFT
+   * library (FFTW, if none is given)
+   */
+  void initialise(int n_rows, int n_cols, const FFTBackend &fft);
+  void initialise(int n_rows, int n_cols) {
+    initialise(n_rows, n_cols, FFTWBackend());
+  }
 
   ~DetectorSensitivityArrays();
 };
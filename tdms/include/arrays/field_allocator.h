@@ -0,0 +1,107 @@
+/**
+ * @file field_allocator.h
+ * @brief Allocator for the large arrays (the split fields, and the per-cell
+ * arrays of the main loop) that are updated in parallel at every timestep.
+ */
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/*! Alignment, in bytes, of the field arrays (one cache line, and one AVX-512
+ * register) */
+constexpr std::size_t FIELD_ALIGNMENT = 64;
+/*! Size, in bytes, of a transparent huge page. Arrays at least this large are
+ * aligned to it, so that they can be backed by huge pages. */
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/**
+ * @brief Process-wide options for the storage of the field arrays.
+ *
+ * These take effect when an array is next allocated, so should be set before
+ * the input file is read.
+ */
+struct FieldStorage {
+  /*! Request transparent huge pages for the field arrays (Linux only) */
+  inline static bool huge_pages = false;
+  /*! Pad the fastest-varying dimension of the split fields so that each row
+   * starts on a FIELD_ALIGNMENT boundary */
+  inline static bool pad_rows = false;
+};
+
+/**
+ * @brief Allocator of aligned storage whose elements are left untouched on
+ * construction.
+ *
+ * Default-inserted elements are default-initialised, which leaves arithmetic
+ * types uninitialised. The pages of the storage are therefore not touched
+ * until the owner of the storage first writes to them, which it should do
+ * from the threads that will update them, so that (under the first-touch
+ * policy of Linux) each page is placed on the NUMA node of the thread that
+ * uses it. Tensor3D does this in allocate().
+ *
+ * @tparam T The type of the elements
+ */
+template<typename T>
+class FieldAllocator {
+private:
+  /*! The alignment of an allocation of the given number of bytes */
+  static std::size_t alignment_of(std::size_t bytes) {
+    return bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : FIELD_ALIGNMENT;
+  }
+
+public:
+  using value_type = T;
+
+  FieldAllocator() noexcept = default;
+  template<typename U>
+  FieldAllocator(const FieldAllocator<U> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    std::size_t bytes = n * sizeof(T);
+    void *p = ::operator new(bytes, std::align_val_t(alignment_of(bytes)));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (FieldStorage::huge_pages && bytes >= HUGE_PAGE_SIZE) {
+      // Advisory only, so failure (e.g. THP being disabled) is harmless
+      madvise(p, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return static_cast<T *>(p);
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    ::operator delete(p, std::align_val_t(alignment_of(n * sizeof(T))));
+  }
+
+  /** @brief Default-initialise, rather than value-initialise, the element */
+  template<typename U>
+  void construct(U *p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+    ::new ((void *) p) U;
+  }
+  template<typename U, typename... Args>
+  void construct(U *p, Args &&...args) {
+    ::new ((void *) p) U(std::forward<Args>(args)...);
+  }
+
+  template<typename U>
+  bool operator==(const FieldAllocator<U> &) const noexcept {
+    return true;
+  }
+  template<typename U>
+  bool operator!=(const FieldAllocator<U> &) const noexcept {
+    return false;
+  }
+};
+
+/*! Whether storage from the Allocator is left untouched on construction, and
+ * so should be first written in parallel */
+template<typename Allocator>
+struct defers_first_touch : std::false_type {};
+template<typename T>
+struct defers_first_touch<FieldAllocator<T>> : std::true_type {};
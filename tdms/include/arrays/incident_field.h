@@ -18,5 +18,7 @@ public:
   Tensor3D<double> x;
   Tensor3D<double> y;
 
+  /** @brief An incident field with neither component present */
+  IncidentField() = default;
   explicit IncidentField(const mxArray *ptr);
 };
@@ -5,8 +5,12 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 #include <vector>
 
+#include "arrays/field_allocator.h"
 #include "cell_coordinate.h"
 
 /**
@@ -19,27 +23,48 @@
  *
  * This is consistent with the way hdf5 files store array-like data, see
  * https://support.hdfgroup.org/HDF5/doc1.6/UG/12_Dataspaces.html.
+ *
+ * Loops over a tensor should therefore run over k innermost, and be shared
+ * between threads over i, as allocate() first touches the storage, so that
+ * they walk the storage contiguously. Buffers in the (MATLAB) order in which
+ * i varies fastest are transposed once, by initialise().
+ *
+ * If layer padding is enabled, each row of n_layers elements is padded so that
+ * it occupies a whole number of FIELD_ALIGNMENT-byte blocks, and n_layers is
+ * replaced by layer_stride() in the strides above.
+ *
+ * A tensor may store only a box of the (i, j, k) indices, see
+ * allocate(const CellBox &), whose elements keep their indices: (i, j, k) is
+ * then offset by the first index of the box, origin(), in the strides above.
  * @tparam T Numerical datatype
+ * @tparam Allocator Allocator of the strided vector. With a FieldAllocator,
+ * the elements are first touched in parallel, see allocate().
  */
-template<typename T>
+template<typename T, typename Allocator = std::allocator<T>>
 class Tensor3D {
-private:
+protected:
   /** @brief Convert a 3D (i,j,k) index to the corresponding index in the
    * strided storage. */
   int to_global_index(int i, int j, int k) const {
-    return i * n_layers_ * n_cols_ + j * n_layers_ + k;
+    return (i - origin_.i) * layer_stride_ * n_cols_ +
+           (j - origin_.j) * layer_stride_ + (k - origin_.k);
   }
   int to_global_index(const ijk &index_3d) const {
     return to_global_index(index_3d.i, index_3d.j, index_3d.k);
   }
 
-protected:
   int n_layers_ = 0;
   int n_cols_ = 0;
   int n_rows_ = 0;
+  /*! Distance between the starts of consecutive rows of layers */
+  int layer_stride_ = 0;
+  /*! Whether to pad the rows of layers at the next allocation */
+  bool pad_layers_ = false;
+  /*! The (i, j, k) index of the first stored element */
+  ijk origin_;
 
   /*! Strided vector that will store the array data */
-  std::vector<T> data_;
+  std::vector<T, Allocator> data_;
 
   /*! The total number of elements, according to the dimension values currently
    * set. */
@@ -81,9 +106,37 @@ public:
    */
   bool has_elements() const { return total_elements() != 0; }
 
+  int get_n_layers() const { return n_layers_; }
+  int get_n_cols() const { return n_cols_; }
+  int get_n_rows() const { return n_rows_; }
+
+  /** @brief The (i, j, k) index of the first stored element, which is
+   * (0, 0, 0) unless the tensor stores a box of indices only */
+  const ijk &origin() const { return origin_; }
+  /** @brief The box of (i, j, k) indices whose elements are stored */
+  CellBox stored_cells() const {
+    return {origin_,
+            {origin_.i + n_rows_, origin_.j + n_cols_, origin_.k + n_layers_}};
+  }
+
+  /** @brief Distance, in elements, between the (i, j, 0) and (i, j + 1, 0)-th
+   * elements. Equal to the number of layers unless the rows are padded. */
+  int layer_stride() const { return layer_stride_; }
+
+  /**
+   * @brief Whether to pad the rows of layers to a multiple of FIELD_ALIGNMENT
+   * bytes. Takes effect at the next allocation.
+   */
+  void set_layer_padding(bool pad) { pad_layers_ = pad; }
+
   /**
    * @brief Allocate memory for this tensor given the dimensions passed.
    *
+   * With a FieldAllocator, the elements are zeroed by a parallel loop over the
+   * rows (the slowest-varying dimension) with a static schedule, matching the
+   * partitioning of the update loops, so that each page of the storage is
+   * placed on the NUMA node of the thread that will update it.
+   *
    * @param n_layers,n_cols,n_rows Number of layers, columns, and rows to
    * assign.
    */
@@ -91,13 +144,69 @@ public:
     n_layers_ = n_layers;
     n_cols_ = n_cols;
     n_rows_ = n_rows;
-    data_.resize(total_elements());
+    origin_ = {0, 0, 0};
+    layer_stride_ = n_layers;
+    if (pad_layers_) {
+      int block = (int) std::max<std::size_t>(1, FIELD_ALIGNMENT / sizeof(T));
+      layer_stride_ = (n_layers + block - 1) / block * block;
+    }
+    int n_stored = n_rows_ * n_cols_ * layer_stride_;
+
+    if constexpr (defers_first_touch<Allocator>::value) {
+      // fresh, untouched, storage
+      data_ = std::vector<T, Allocator>(n_stored);
+      T *data = data_.data();
+      std::ptrdiff_t plane = (std::ptrdiff_t) n_cols_ * layer_stride_;
+#pragma omp parallel for schedule(static)
+      for (int i = 0; i < n_rows_; i++) {
+        std::fill_n(data + i * plane, plane, T());
+      }
+    } else {
+      data_.resize(n_stored);
+    }
+  }
+
+  /**
+   * @brief Allocate memory for the elements of a box of (i, j, k) indices
+   * only, which keep their indices: element (i, j, k) may be accessed for
+   * (i, j, k) in cells.
+   */
+  void allocate(const CellBox &cells) {
+    allocate(cells.upper.k - cells.lower.k, cells.upper.j - cells.lower.j,
+             cells.upper.i - cells.lower.i);
+    origin_ = cells.lower;
+  }
+
+  /**
+   * @brief Keep the elements of the stored indices that are in a box, and
+   * release the storage of the rest.
+   *
+   * The kept elements are copied to storage of their own, which is first
+   * touched as allocate() does.
+   *
+   * @param cells The indices whose elements to keep
+   */
+  void restrict_to(const CellBox &cells) {
+    if (!has_elements()) { return; }
+    CellBox box = cells.intersection(stored_cells());
+    Tensor3D restricted;
+    restricted.set_layer_padding(pad_layers_);
+    restricted.allocate(box);
+    int n_k = box.upper.k - box.lower.k;
+#pragma omp parallel for schedule(static)
+    for (int i = box.lower.i; i < box.upper.i; i++) {
+      for (int j = box.lower.j; j < box.upper.j; j++) {
+        const T *row = &operator()(i, j, box.lower.k);
+        std::copy(row, row + n_k, &restricted(i, j, box.lower.k));
+      }
+    }
+    *this = std::move(restricted);
   }
 
   /**
    * @brief Initialise this tensor from a 3D-buffer of matching size.
    * @details Data values are copied so that membership over this->data() is
-   * preserved.
+   * preserved, and are converted to T if the buffer is of another type.
    * @param buffer 3D buffer to read from
    * @param n_layers,n_cols,n_rows "Shape" of the read buffer to assign to this
    * tensor.
@@ -106,14 +215,15 @@ public:
    * assumed to have the dimensions in reverse order,
    * [n_rows][n_cols][n_layers].
    */
-  void initialise(T ***buffer, int n_layers, int n_cols, int n_rows,
+  template<typename U>
+  void initialise(U ***buffer, int n_layers, int n_cols, int n_rows,
                   bool buffer_leads_n_layers = false) {
     allocate(n_layers, n_cols, n_rows);
     if (buffer_leads_n_layers) {
       for (int k = 0; k < n_layers_; k++) {
         for (int j = 0; j < n_cols_; j++) {
           for (int i = 0; i < n_rows_; i++) {
-            operator()(i, j, k) = buffer[k][j][i];
+            operator()(i, j, k) = static_cast<T>(buffer[k][j][i]);
           }
         }
       }
@@ -121,7 +231,7 @@ public:
       for (int k = 0; k < n_layers_; k++) {
         for (int j = 0; j < n_cols_; j++) {
           for (int i = 0; i < n_rows_; i++) {
-            operator()(i, j, k) = buffer[i][j][k];
+            operator()(i, j, k) = static_cast<T>(buffer[i][j][k]);
           }
         }
       }
@@ -144,9 +254,10 @@ public:
    * loops.
    */
   double frobenius() const {
-    T norm_val = 0;
+    double norm_val = 0.;
     for (const T &element_value : data_) {
-      norm_val += std::abs(element_value) * std::abs(element_value);
+      double abs_value = std::abs(element_value);
+      norm_val += abs_value * abs_value;
     }
     return std::sqrt(norm_val);
   }
@@ -41,3 +41,50 @@ struct ijk {
 
 typedef ijk CellCoordinate;//!< Index-coordinates (i,j,k) of a Yee cell
 typedef ijk IJKDimensions; //!< Holds array dimensions (I_tot, J_tot, K_tot)
+
+/**
+ * @brief A box of Yee cells, [lower.i, upper.i) x [lower.j, upper.j) x
+ * [lower.k, upper.k).
+ */
+struct CellBox {
+  ijk lower,//!< First cell of the box in each direction
+          upper;//!< One past the last cell of the box in each direction
+
+  /** @brief Whether the box contains no cells */
+  bool empty() const {
+    return upper.i <= lower.i || upper.j <= lower.j || upper.k <= lower.k;
+  }
+
+  /** @brief Whether (i, j) is in the projection of the box onto the ij-plane */
+  bool contains(int i, int j) const {
+    return i >= lower.i && i < upper.i && j >= lower.j && j < upper.j;
+  }
+  /** @brief Whether cell (i, j, k) is in the box */
+  bool contains(int i, int j, int k) const {
+    return contains(i, j) && k >= lower.k && k < upper.k;
+  }
+
+  /** @brief The cells that are in both this box and other */
+  CellBox intersection(const CellBox &other) const {
+    return {{std::max(lower.i, other.lower.i), std::max(lower.j, other.lower.j),
+             std::max(lower.k, other.lower.k)},
+            {std::min(upper.i, other.upper.i), std::min(upper.j, other.upper.j),
+             std::min(upper.k, other.upper.k)}};
+  }
+  /** @brief The smallest box that contains both this box and other */
+  CellBox enclosing(const CellBox &other) const {
+    if (empty()) { return other; }
+    if (other.empty()) { return *this; }
+    return {{std::min(lower.i, other.lower.i), std::min(lower.j, other.lower.j),
+             std::min(lower.k, other.lower.k)},
+            {std::max(upper.i, other.upper.i), std::max(upper.j, other.upper.j),
+             std::max(upper.k, other.upper.k)}};
+  }
+
+  /** @brief Number of cells in the box */
+  long long n_cells() const {
+    if (empty()) { return 0; }
+    return (long long) (upper.i - lower.i) * (upper.j - lower.j) *
+           (upper.k - lower.k);
+  }
+};
@@ -0,0 +1,68 @@
+/**
+ * @file distributed_fdtd.h
+ * @brief The halo exchanges of the FDTD update of a grid of Yee cells that is
+ * distributed over MPI processes in blocks.
+ */
+#pragma once
+
+#include <vector>
+
+#include <mpi.h>
+
+#include "cell_coordinate.h"
+#include "field.h"
+#include "globals.h"
+
+/**
+ * @brief The exchange of the faces of the split fields between the blocks of
+ * a grid of Yee cells distributed over a P1 x P2 grid of MPI processes, in
+ * blocks of whole rows (along k).
+ *
+ * Each process stores the cells [lower.i, upper.i) x [lower.j, upper.j) x
+ * [0, K_tot] of its block, and a halo of one cell on each side in i and j
+ * where it has a neighbour, at their indices in the whole grid (see
+ * SplitField::restrict_to). The E-field update reads the H field at i - 1 and
+ * j - 1, and the H-field update the E field at i + 1 and j + 1, so before each
+ * update one face of the other field is exchanged in each direction (and no
+ * corners). The exchange is non-blocking: the rows that do not read the halo
+ * are updated while it is in flight, and the rows next to it once it has
+ * arrived.
+ */
+class DistributedFDTD {
+private:
+  MPI_Comm cart_;//< The Cartesian communicator of the processes (not owned)
+  //! Neighbouring processes below and above in i and j (MPI_PROC_NULL at the
+  //! edges of the grid)
+  int low_i_, high_i_, low_j_, high_j_;
+  CellBox block_;//< The cells updated by this process
+
+  //! Buffers of the faces sent and received in the exchange in progress
+  std::vector<field_t> send_i_, send_j_, receive_i_, receive_j_;
+  MPI_Request requests_[4];
+
+public:
+  /**
+   * @brief The exchanges of a process of a Cartesian communicator
+   *
+   * @param cart A communicator with a 2D Cartesian topology, whose dimensions
+   * 0 and 1 split the grid in i and j. Must outlive the exchange.
+   * @param block The cells of this process
+   */
+  DistributedFDTD(MPI_Comm cart, const CellBox &block);
+
+  /** @brief The cells updated by this process */
+  const CellBox &block() const { return block_; }
+
+  /**
+   * @brief Start sending a face of field to the neighbours on one side, and
+   * receiving the face on the other side into the halo
+   *
+   * @param field The field that is exchanged
+   * @param upwards Whether the highest owned face is sent to the neighbours
+   * above (and the low halo received from below), or the lowest owned face to
+   * the neighbours below (and the high halo received from above)
+   */
+  void start_exchange(SplitField &field, bool upwards);
+  /** @brief Wait for the exchange started by start_exchange to complete */
+  void finish_exchange(SplitField &field, bool upwards);
+};
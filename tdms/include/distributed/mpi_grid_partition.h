@@ -0,0 +1,61 @@
+/**
+ * @file mpi_grid_partition.h
+ * @brief The partition of the grid of a process of an MPI run, in which the
+ * cells are distributed over the processes in blocks of whole rows (along k).
+ */
+#pragma once
+
+#include <memory>
+
+#include <mpi.h>
+
+#include "distributed/distributed_fdtd.h"
+#include "distributed/pencil_decomposition.h"
+#include "grid_partition.h"
+
+/**
+ * @brief The cells of a grid distributed over a P1 x P2 grid of MPI
+ * processes, and the reductions and halo exchanges between them.
+ *
+ * Each process owns the cells of its Z pencil of the PencilDecomposition of
+ * the grid: [lower.i, upper.i) x [lower.j, upper.j) x [0, K_tot]. The rows are
+ * whole, so are updated by the same (vectorised) kernels as the undistributed
+ * grid, and the lines along z of the PSTD derivatives need no transpose.
+ */
+class MPIGridPartition : public GridPartition {
+private:
+  PencilDecomposition decomposition_;
+  int rank_ = 0, n_processes_ = 1;
+  std::unique_ptr<DistributedFDTD> exchange_;//< Of the FDTD halos
+
+public:
+  /**
+   * @brief Distribute a grid over the processes of a communicator
+   *
+   * @param IJK_tot The number of Yee cells of the grid in each direction
+   * @param comm The communicator, whose processes all construct the partition
+   */
+  MPIGridPartition(const IJKDimensions &IJK_tot, MPI_Comm comm);
+
+  int n_processes() const override { return n_processes_; }
+  bool is_root() const override { return rank_ == 0; }
+
+  void sum(double *values, int n) const override;
+  void maximum(double *values, int n) const override;
+  void broadcast_from_root(std::string &value) const override;
+  CellBox owned_by(int process) const override;
+  std::vector<double>
+  gather_to_root(const std::vector<double> &values) const override;
+  std::vector<int>
+  gather_to_all(const std::vector<int> &values) const override;
+
+  void start_exchange(SplitField &field, bool upwards) override;
+  void finish_exchange(SplitField &field, bool upwards) override;
+
+  /** @brief A PencilDerivative, which refers to this partition, so must not
+   * outlive it */
+  std::unique_ptr<DistributedDerivative>
+  make_derivative(AxialDirection direction, double delta,
+                  std::shared_ptr<const BatchedRealFFT> transform)
+          const override;
+};
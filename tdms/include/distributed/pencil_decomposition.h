@@ -0,0 +1,81 @@
+/**
+ * @file pencil_decomposition.h
+ * @brief Distribution of a grid of samples over MPI ranks in pencils, and the
+ * transposes between pencils of different directions.
+ */
+#pragma once
+
+#include <vector>
+
+#include <mpi.h>
+
+#include "cell_coordinate.h"
+#include "globals.h"
+
+/**
+ * @brief A 2D (pencil) decomposition of a grid of samples over a P1 x P2 grid
+ * of MPI ranks.
+ *
+ * In a pencil along a direction, every rank holds all the samples of a block
+ * of lines in that direction:
+ * - Z pencils: i is split over P1, and j over P2,
+ * - Y pencils: i is split over P1, and k over P2,
+ * - X pencils: j is split over P1, and k over P2.
+ * Each rank stores its block as Tensor3D does, in (i, j, k) order with k
+ * contiguous.
+ *
+ * Transposing between Z and Y pencils exchanges samples between the ranks
+ * with the same p1, and between Y and X pencils between the ranks with the
+ * same p2, so each transpose is an MPI_Alltoallv among sqrt(P) ranks rather
+ * than all of them.
+ */
+class PencilDecomposition {
+private:
+  IJKDimensions n_samples_;//< Number of samples of the whole grid
+  int dims_[2] = {1, 1};   //< P1 and P2
+  int coords_[2] = {0, 0}; //< p1 and p2 of this rank
+  MPI_Comm cart_ = MPI_COMM_NULL;
+  //! The ranks with the same p1 as this one (ordered by p2), and with the
+  //! same p2 (ordered by p1)
+  MPI_Comm same_p1_ = MPI_COMM_NULL, same_p2_ = MPI_COMM_NULL;
+
+public:
+  /**
+   * @brief Decompose a grid over the ranks of a communicator
+   *
+   * @param n_samples The number of samples of the grid in each direction
+   * @param comm The communicator, whose ranks all construct the decomposition
+   */
+  PencilDecomposition(const IJKDimensions &n_samples, MPI_Comm comm);
+  PencilDecomposition(const PencilDecomposition &) = delete;
+  PencilDecomposition &operator=(const PencilDecomposition &) = delete;
+  ~PencilDecomposition();
+
+  /** @brief The number of samples of the whole grid in each direction */
+  const IJKDimensions &n_samples() const { return n_samples_; }
+  /** @brief The number of ranks in each direction of the grid of ranks */
+  int n_ranks(int dimension) const { return dims_[dimension]; }
+  /** @brief The communicator of the P1 x P2 grid of ranks, whose dimensions
+   * 0 and 1 are those of p1 and p2 */
+  MPI_Comm communicator() const { return cart_; }
+
+  /** @brief The samples held by the rank (p1, p2) in a pencil along direction
+   */
+  CellBox pencil(AxialDirection direction, int p1, int p2) const;
+  /** @brief The samples held by this rank in a pencil along direction */
+  CellBox pencil(AxialDirection direction) const {
+    return pencil(direction, coords_[0], coords_[1]);
+  }
+
+  /**
+   * @brief Redistribute the samples held in pencils along one direction into
+   * pencils along another. Must be called by every rank.
+   *
+   * @param in The samples of this rank in pencils along from
+   * @param from,to The directions of the pencils: Z and Y, or Y and X
+   * @param out Resized to, and overwritten by, the samples of this rank in
+   * pencils along to
+   */
+  void transpose(const std::vector<double> &in, AxialDirection from,
+                 std::vector<double> &out, AxialDirection to) const;
+};
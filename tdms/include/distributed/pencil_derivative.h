@@ -0,0 +1,89 @@
+/**
+ * @file pencil_derivative.h
+ * @brief PSTD derivatives of a grid of samples that is distributed over MPI
+ * ranks in pencils.
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "distributed/pencil_decomposition.h"
+#include "grid_partition.h"
+#include "numerical_derivative.h"
+
+/**
+ * @brief The derivative-shift operator of BatchedDerivative along one
+ * direction of a grid that is distributed over MPI ranks in Z pencils.
+ *
+ * The lines along z are whole on every rank, and are differentiated in place.
+ * The samples are transposed into Y (or Y, then X) pencils to differentiate
+ * the lines along y (or x), and the derivative is transposed back.
+ *
+ * The lines of the transform may be shorter than those of the grid, as the
+ * E-field derivatives of a simulation are of I_tot (etc) of the I_tot + 1
+ * samples of a line: the samples beyond the transform are then not read.
+ */
+class PencilDerivative : public DistributedDerivative {
+private:
+  const PencilDecomposition &decomposition_;
+  AxialDirection direction_;
+  BatchedDerivative derivative_;
+  //! The samples, and their derivative, in the pencils of the transposes
+  std::vector<double> y_pencil_, x_pencil_, derivative_pencil_;
+
+  /**
+   * @brief Differentiate the lines of a block that holds whole lines along
+   * direction_, in (i, j, k) order. Must be called by every thread of the
+   * team, whose barrier publishes out.
+   */
+  void differentiate_block(const std::vector<double> &in, const CellBox &block,
+                           std::vector<double> &out, int begin, int end,
+                           const std::function<bool(int, int, int, double *)>
+                                   &blend);
+
+public:
+  /**
+   * @brief Create the operator, which differentiates with a transform that may
+   * be shared with other derivatives
+   *
+   * @param decomposition The distribution of the grid over the ranks, which
+   * must outlive the operator
+   * @param direction The direction of the derivative
+   * @param delta The fraction of the spatial step to shift by
+   * @param transform The transform, whose length is at most the number of
+   * samples of the grid along direction
+   */
+  PencilDerivative(const PencilDecomposition &decomposition,
+                   AxialDirection direction, double delta,
+                   std::shared_ptr<const BatchedRealFFT> transform);
+  /**
+   * @brief Create the operator, with FFTW plans of the length of the lines of
+   * the grid
+   */
+  PencilDerivative(const PencilDecomposition &decomposition,
+                   AxialDirection direction, double delta);
+
+  /**
+   * @brief Differentiate the samples x, begin <= x < end, of every line.
+   * @copydetails DistributedDerivative::differentiate
+   *
+   * The samples and derivative are those of the Z pencil of this rank.
+   */
+  void differentiate(const std::vector<double> &samples,
+                     std::vector<double> &derivative, int begin, int end,
+                     const std::function<bool(int, int, int, double *)> &blend)
+          override;
+
+  /**
+   * @brief Differentiate every sample of every line spectrally. Must be called
+   * by every thread of the team (or from outside of a parallel region) on
+   * every rank.
+   *
+   * @param in The samples of this rank, in Z pencils
+   * @param out Resized to, and overwritten by, the derivative of the samples
+   * of this rank, in Z pencils
+   */
+  void differentiate(const std::vector<double> &in, std::vector<double> &out);
+};
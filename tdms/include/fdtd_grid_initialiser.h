@@ -5,7 +5,6 @@
 #pragma once
 
 #include <string>
-#include <vector>
 
 #include "mat_io.h"
 
@@ -16,8 +15,7 @@ class fdtdGridInitialiser {
 
 private:
   const mxArray *pointer = nullptr;          //< Pointer to the array
-  const char *mat_filename = nullptr;        //< Filename of the MATLAB file
-  std::vector<mwSize> dimensions = {0, 0, 0};//< The dimensions of the array
+  const char *mat_filename = nullptr;//< Filename of the MATLAB file
 
   /**
    * @brief Get a value from a integer attribute of the FDTD grid defined in a
@@ -32,16 +30,15 @@ public:
   /** @brief Construct a new fdtd Grid Initialiser object */
   fdtdGridInitialiser() {}
   /**
-   * @brief Construct a new fdtd Grid Initialiser object
+   * @brief Construct a new fdtd Grid Initialiser object, which removes the
+   * I_tot, J_tot, and K_tot attributes from the FDTD grid.
+   *
+   * The grid is left with its materials. The split fields, which start at
+   * zero, are not added to it: they are allocated where, and how, they are
+   * stored (see SimulationManager).
    *
    * @param fdtd_pointer pointer to the FDTD grid
    * @param mat_filename the filename of the MATLAB file
    */
   fdtdGridInitialiser(const mxArray *fdtd_pointer, const char *mat_filename);
-
-  /**
-   * @brief Set an FDTD grid attribute to a tensor full of zeros
-   * @param name of the attribute
-   */
-  void add_tensor(const std::string &name);
 };
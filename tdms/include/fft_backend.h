@@ -0,0 +1,170 @@
+/**
+ * @file fft_backend.h
+ * @brief The FFT library behind the PSTD derivatives and the detector
+ * transforms, behind an interface so that it can be replaced.
+ *
+ * FFTWBackend is the default. BuiltinFFTBackend has no dependencies, for
+ * platforms on which FFTW is unavailable or unsuitable, at the cost of speed.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <fftw3.h>
+
+#include "solver_options.h"
+
+/**
+ * @brief Real-to-complex and complex-to-real transforms of a batch of
+ * interleaved real lines of the same length: sample x of line b is at
+ * x * batch_size + b, and likewise mode m of the transform of line b.
+ *
+ * The transforms are unnormalised, as FFTW's, so that a forward then a
+ * backward transform multiplies a line by N. Only the N / 2 + 1 modes of
+ * non-negative frequency are stored. A transform may be executed by several
+ * threads at once, on buffers of their own.
+ */
+class BatchedRealFFT {
+public:
+  const int N;         //< Number of samples in each line
+  const int batch_size;//< Number of lines in a batch
+
+  BatchedRealFFT(int N, int batch_size) : N(N), batch_size(batch_size) {}
+  virtual ~BatchedRealFFT() = default;
+
+  /**
+   * @brief Transform the first n_lines lines of a batch
+   *
+   * @param lines The batch of lines, N * batch_size samples
+   * @param modes The transforms of the lines, (N / 2 + 1) * batch_size
+   * @param n_lines The number of lines transformed, at most batch_size
+   */
+  virtual void forward(double *lines, fftw_complex *modes,
+                       int n_lines) const = 0;
+  /**
+   * @brief Transform the modes of the first n_lines lines of a batch back to
+   * the lines. The modes may be overwritten.
+   */
+  virtual void backward(fftw_complex *modes, double *lines,
+                        int n_lines) const = 0;
+};
+
+/**
+ * @brief The in-place forward transform of an n_0 by n_1 array of complex
+ * numbers, stored in row-major order (element (a, b) at a * n_1 + b).
+ */
+class ComplexFFT2D {
+public:
+  virtual ~ComplexFFT2D() = default;
+
+  /** @brief Transform the array that the transform was planned for */
+  virtual void forward() = 0;
+};
+
+/**
+ * @brief Plans the transforms of a simulation with an FFT library.
+ *
+ * The transforms own their plans, so they may outlive the backend.
+ */
+class FFTBackend {
+public:
+  virtual ~FFTBackend() = default;
+
+  /** @brief The name of the library, for the log */
+  virtual std::string name() const = 0;
+
+  /** @brief Plan the transforms of batches of lines of N samples */
+  virtual std::shared_ptr<const BatchedRealFFT>
+  plan_batched_real(int N, int batch_size) const = 0;
+
+  /**
+   * @brief Plan the forward transform of an array of n_0 by n_1 complex
+   * numbers, in place. Planning may overwrite the array.
+   */
+  virtual std::unique_ptr<ComplexFFT2D>
+  plan_complex_2d(int n_0, int n_1, fftw_complex *data) const = 0;
+
+  /**
+   * @brief Import the plans found by an earlier run from a file, if the
+   * library supports it
+   *
+   * @return true if the plans were imported, false otherwise
+   */
+  virtual bool import_wisdom(const std::string &) const { return false; }
+  /**
+   * @brief Export the plans found so far to a file, if the library supports
+   * it
+   *
+   * @return true if the plans were exported, false otherwise
+   */
+  virtual bool export_wisdom(const std::string &) const { return false; }
+  /**
+   * @brief Import the plans of a string from export_wisdom_to_string(), if the
+   * library supports it
+   *
+   * @return true if the plans were imported, false otherwise
+   */
+  virtual bool import_wisdom_from_string(const std::string &) const {
+    return false;
+  }
+  /**
+   * @brief The plans found so far, as a string, if the library supports it
+   *
+   * @return The plans, or an empty string
+   */
+  virtual std::string export_wisdom_to_string() const { return ""; }
+};
+
+/**
+ * @brief Transforms planned by FFTW, with the planner rigour of the options.
+ *
+ * If TDMS is linked to the threaded FFTW library (TDMS_FFTW_THREADS), the 2D
+ * transforms, which are executed by a single thread of the main loop, are
+ * split between n_threads threads by FFTW itself.
+ */
+class FFTWBackend : public FFTBackend {
+private:
+  unsigned rigour_;//< The FFTW planner flag
+  int n_threads_;  //< Threads of the 2D transforms
+
+public:
+  explicit FFTWBackend(FFTPlanning planning = FFTPlanning::Measure,
+                       int n_threads = 1);
+
+  std::string name() const override { return "FFTW"; }
+  std::shared_ptr<const BatchedRealFFT>
+  plan_batched_real(int N, int batch_size) const override;
+  std::unique_ptr<ComplexFFT2D>
+  plan_complex_2d(int n_0, int n_1, fftw_complex *data) const override;
+  bool import_wisdom(const std::string &file) const override;
+  bool export_wisdom(const std::string &file) const override;
+  bool import_wisdom_from_string(const std::string &wisdom) const override;
+  std::string export_wisdom_to_string() const override;
+};
+
+/**
+ * @brief Transforms computed by TDMS itself: radix-2 transforms for lengths
+ * that are powers of two, and Bluestein's algorithm (a convolution computed by
+ * radix-2 transforms) for any other length.
+ */
+class BuiltinFFTBackend : public FFTBackend {
+public:
+  std::string name() const override { return "builtin"; }
+  std::shared_ptr<const BatchedRealFFT>
+  plan_batched_real(int N, int batch_size) const override;
+  std::unique_ptr<ComplexFFT2D>
+  plan_complex_2d(int n_0, int n_1, fftw_complex *data) const override;
+};
+
+/**
+ * @brief Create the backend of an FFT library
+ *
+ * @param library The library
+ * @param planning The rigour of the planner, if the library has one
+ * @param n_threads The number of threads that the library may use for a
+ * single transform, if it can
+ */
+std::unique_ptr<FFTBackend> make_fft_backend(FFTLibrary library,
+                                             FFTPlanning planning,
+                                             int n_threads);
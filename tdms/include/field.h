@@ -5,9 +5,9 @@
 #pragma once
 
 #include <complex>
+#include <vector>
 
 #include "arrays.h"
-#include "arrays/eh_vec.h"
 #include "arrays/tensor3d.h"
 #include "cell_coordinate.h"
 #include "dimensions.h"
@@ -56,25 +56,134 @@ public:
   };
 };
 
-class SplitFieldComponent : public Tensor3D<double> {
-public:
-  int n_threads = 1;// Number of threads this component was chunked with
-  fftw_plan *plan_f = nullptr;// Forward fftw plan
-  fftw_plan *plan_b = nullptr;// Backward fftw plan
+/**
+ * @brief One of the split components of a SplitField.
+ *
+ * The component is normally stored over the whole grid, or over the box of
+ * cells that a process of a distributed grid updates (see restrict_to). A
+ * component of the whole grid can instead be stored only outside an interior
+ * box of cells (see store_pml_only), in which case the box is omitted from the
+ * storage, and the component must be accessed through at() and value() rather
+ * than the subscript operators.
+ */
+class SplitFieldComponent : public Tensor3D<field_t, FieldAllocator<field_t>> {
+private:
+  /*! Where row (i, j) of a PML-only component starts in pml_data_, and the
+   * number of cells omitted from it (0 if the row is not in the omitted box) */
+  struct PmlRow {
+    std::ptrdiff_t start = 0;
+    int n_omitted = 0;
+  };
 
+  /*! Cells omitted from a PML-only component */
+  CellBox omitted_;
+  /*! Rows of a PML-only component, indexed by i * n_cols + j */
+  std::vector<PmlRow> rows_;
+  /*! Values of a PML-only component, row by row */
+  std::vector<field_t, FieldAllocator<field_t>> pml_data_;
+
+  /**
+   * @brief Lay out the rows of the component around an omitted box of cells,
+   * and allocate, without touching, the storage of the cells outside it.
+   *
+   * @param interior The cells to omit
+   * @return Whether any cells of the component are omitted. If not, the
+   * component is left unchanged.
+   */
+  bool lay_out_pml_rows(const CellBox &interior);
+
+  /** @brief Index into pml_data_ of stored cell (i, j, k) */
+  std::ptrdiff_t pml_index(int i, int j, int k) const {
+    const PmlRow &row = rows_[i * n_cols_ + j];
+    return row.start + ((row.n_omitted && k >= omitted_.upper.k)
+                                ? k - row.n_omitted
+                                : k);
+  }
+
+public:
   void initialise_from_matlab(double ***tensor, Dimensions &dims);
 
+  /** @brief Whether the component is stored outside the omitted box only */
+  bool is_pml_only() const { return !rows_.empty(); }
+
+  /** @brief Whether cell (i, j, k) of the component is stored */
+  bool stores(int i, int j, int k) const {
+    if (!is_pml_only()) { return stored_cells().contains(i, j, k); }
+    return !omitted_.contains(i, j, k);
+  }
+
+  /**
+   * @brief The element at a stored cell (i, j, k), whether or not the
+   * component is PML-only.
+   */
+  field_t &at(int i, int j, int k) {
+    if (!is_pml_only()) { return operator()(i, j, k); }
+    return pml_data_[pml_index(i, j, k)];
+  }
+  field_t &at(const CellCoordinate &cell) { return at(cell.i, cell.j, cell.k); }
+
+  /** @brief The value at cell (i, j, k), which is zero if it is not stored */
+  field_t value(int i, int j, int k) const {
+    if (!is_pml_only()) { return operator()(i, j, k); }
+    if (omitted_.contains(i, j, k)) { return 0; }
+    return pml_data_[pml_index(i, j, k)];
+  }
+
+  /**
+   * @brief The index of cell (i, j, k) in stored_values(), or -1 if the cell
+   * is not stored.
+   */
+  std::ptrdiff_t stored_index(int i, int j, int k) const {
+    if (!is_pml_only()) { return to_global_index(i, j, k); }
+    if (omitted_.contains(i, j, k)) { return -1; }
+    return pml_index(i, j, k);
+  }
+
+  /**
+   * @brief The stored values of the component, those of every cell or, if it
+   * is PML-only, those of the cells outside the omitted box.
+   */
+  const field_t *stored_values() const {
+    return is_pml_only() ? pml_data_.data() : data_.data();
+  }
+
+  /**
+   * @brief Discard the values of the component in the interior box, and store
+   * the rest compactly.
+   *
+   * The rows of the grid (along k) that pass through the interior keep only
+   * their cells before and after it; all other rows are kept whole.
+   *
+   * @param interior The cells to omit
+   */
+  void store_pml_only(const CellBox &interior);
+
   /**
-   * Initialise a vector of 1d discrete Fourier transform plans
-   * @param n_threads Number of threads that will be used
-   * @param size Length of the vector
-   * @param eh_vec TODO: what is this?
+   * @brief Allocate the component over (n_layers, n_cols, n_rows) cells, of
+   * which only those outside an interior box are stored, and set them to zero.
+   *
+   * The layout is that of store_pml_only, but the storage of the whole grid is
+   * never allocated.
+   *
+   * @param n_layers,n_cols,n_rows The number of cells along k, j, and i
+   * @param interior The cells to omit
    */
-  void initialise_fftw_plan(int n_threads, int size, EHVec &eh_vec);
+  void allocate_pml_only(int n_layers, int n_cols, int n_rows,
+                         const CellBox &interior);
 
-  ~SplitFieldComponent();
+  /** @brief Set all the stored values of the component to zero */
+  void zero();
+};
+
+/*! A cell of a grid, and the weight of its value in an interpolation */
+struct StencilPoint {
+  CellCoordinate cell;
+  double weight;
 };
 
+/*! The cells, and their weights, whose weighted sum is an interpolated value */
+using InterpolationStencil = std::vector<StencilPoint>;
+
 /**
  * @brief A split field defined over a grid.
  *
@@ -82,9 +191,28 @@ public:
  * phase factor
  */
 class SplitField : public Grid {
+private:
+  /*! The cells in which the field is stored unsplit, see unsplit_interior */
+  CellBox unsplit_;
+
 protected:
   virtual int delta_n() = 0;// TODO: no idea what this is or why it's needed
 
+  /**
+   * @brief The stencil of the best interpolation scheme along an axis, from
+   * the cells either side of cell to its centre
+   */
+  InterpolationStencil stencil_along(AxialDirection axis,
+                                     const CellCoordinate &cell) const;
+
+  /**
+   * @brief The stencil that applies stencil a then stencil b, which are along
+   * different axes, to interpolate to the centre of cell
+   */
+  static InterpolationStencil combine(const InterpolationStencil &a,
+                                      const InterpolationStencil &b,
+                                      const CellCoordinate &cell);
+
 public:
   /*! Magnitude of the xy component at each grid point (i,j,k) */
   SplitFieldComponent xy;
@@ -115,6 +243,11 @@ public:
    * this split field
    */
   void allocate();
+  /**
+   * @brief Allocate the components over a box of cells only, which keep their
+   * indices in the grid
+   */
+  void allocate(const CellBox &cells);
 
   /**
    * Set all the values of all components of the field to zero
@@ -130,11 +263,21 @@ public:
   }
 
   /**
-   * Initialise the fftw plans for all components
-   * @param n_threads Number of threads to split over
-   * @param eh_vec // TODO
+   * @brief Keep the values of the field in a box of cells, and release the
+   * storage of the rest of the grid.
+   *
+   * A process of a distributed grid keeps the cells that it updates, and the
+   * halo of cells of its neighbours that the updates read. Components that
+   * have not been allocated are left unallocated. The field must not be
+   * stored unsplit in an interior.
+   *
+   * @param cells The cells to keep
    */
-  void initialise_fftw_plan(int n_threads, EHVec &eh_vec);
+  void restrict_to(const CellBox &cells);
+
+  /** @brief The cells whose values are stored: every cell of the grid unless
+   * the field was allocated over, or restricted to, a box of cells */
+  CellBox stored_cells() const;
 
   /**
    * @brief Fetches the largest absolute value of the field.
@@ -146,6 +289,85 @@ public:
    * @return double Largest (by absolute value) field value
    */
   double largest_field_value();
+  /** @brief The largest absolute value of the field in a box of cells
+   * @copydetails largest_field_value() */
+  double largest_field_value(const CellBox &cells);
+
+  /**
+   * @brief Store the field unsplit in an interior box of cells.
+   *
+   * In the interior, the xy, yx, and zx components hold the whole of the x, y,
+   * and z field (the values of the xz, yz, and zy components are added to
+   * them), and the xz, yz, and zy components are only stored outside the
+   * interior. Components that have not been allocated are left unallocated.
+   *
+   * @param interior The cells in which to store the field unsplit
+   */
+  void unsplit_interior(const CellBox &interior);
+
+  /**
+   * @brief Allocate the field to be stored unsplit in an interior box of
+   * cells, and set it to zero.
+   *
+   * The xy, yx, and zx components are allocated over the whole grid, and the
+   * xz, yz, and zy components outside the interior only, as unsplit_interior
+   * leaves them, without their storage of the whole grid ever being allocated.
+   *
+   * @param interior The cells in which to store the field unsplit
+   */
+  void allocate_unsplit(const CellBox &interior);
+
+  /** @brief Whether the field is stored unsplit in an interior box */
+  bool has_unsplit_interior() const { return !unsplit_.empty(); }
+
+  /** @brief The cells in which the field is stored unsplit */
+  const CellBox &unsplit_cells() const { return unsplit_; }
+
+  /** @brief The x-directed field, xy + xz, at cell (i, j, k) */
+  field_t x(int i, int j, int k) const {
+    return xy(i, j, k) + xz.value(i, j, k);
+  }
+  /** @brief The y-directed field, yx + yz, at cell (i, j, k) */
+  field_t y(int i, int j, int k) const {
+    return yx(i, j, k) + yz.value(i, j, k);
+  }
+  /** @brief The z-directed field, zx + zy, at cell (i, j, k) */
+  field_t z(int i, int j, int k) const {
+    return zx(i, j, k) + zy.value(i, j, k);
+  }
+  field_t x(const CellCoordinate &cell) const {
+    return x(cell.i, cell.j, cell.k);
+  }
+  field_t y(const CellCoordinate &cell) const {
+    return y(cell.i, cell.j, cell.k);
+  }
+  field_t z(const CellCoordinate &cell) const {
+    return z(cell.i, cell.j, cell.k);
+  }
+
+  /**
+   * @brief The element of the field to which a contribution to a split
+   * component at a cell should be added.
+   *
+   * This is the element of the component itself, unless the component is not
+   * stored at the cell because the field is unsplit there. Then it is the
+   * element of the component that holds the whole of the field in that
+   * direction.
+   *
+   * @param component One of the split components of this field
+   * @param cell The cell to which the contribution is made
+   */
+  field_t &element(SplitFieldComponent &component, const CellCoordinate &cell);
+
+  /**
+   * @brief The stencil of interpolate_to_centre_of: the cells whose
+   * (unsplit) values in direction d, weighted, sum to the interpolated value
+   *
+   * @param d Field component to interpolate
+   * @param cell Index (i,j,k) of the Yee cell to interpolate to the centre of
+   */
+  virtual InterpolationStencil interpolation_stencil(AxialDirection d,
+                                                     CellCoordinate cell) = 0;
 
   /**
    * @brief Interpolates a SplitField component to the centre of a Yee cell
@@ -158,6 +380,9 @@ public:
                                           CellCoordinate cell) = 0;
 };
 
+/*! One of the split components of a SplitField, e.g. &SplitField::xy */
+using SplitComponent = SplitFieldComponent SplitField::*;
+
 class ElectricSplitField : public SplitField {
 protected:
   int delta_n() override {
@@ -183,6 +408,9 @@ public:
    */
   double interpolate_to_centre_of(AxialDirection d,
                                   CellCoordinate cell) override;
+
+  InterpolationStencil interpolation_stencil(AxialDirection d,
+                                             CellCoordinate cell) override;
 };
 
 class MagneticSplitField : public SplitField {
@@ -210,6 +438,9 @@ public:
    */
   double interpolate_to_centre_of(AxialDirection d,
                                   CellCoordinate cell) override;
+
+  InterpolationStencil interpolation_stencil(AxialDirection d,
+                                             CellCoordinate cell) override;
 };
 
 class CurrentDensitySplitField : public SplitField {
@@ -230,6 +461,11 @@ public:
                                   CellCoordinate cell) override {
     return 0.;
   };
+
+  InterpolationStencil interpolation_stencil(AxialDirection /*d*/,
+                                             CellCoordinate /*cell*/) override {
+    return {};
+  }
 };
 
 /**
@@ -238,6 +474,10 @@ public:
  */
 class Field : public Grid {
 public:
+  /*! Number of k-layers in a tile of the cells visited when the phasors are
+   * set (set_phasors) or accumulated (PhasorAccumulator::flush) */
+  static const int PHASOR_TILE = 16;
+
   double ft = 0.;// TODO: an explanation of what this is
 
   std::complex<double> angular_norm = 0.;
@@ -303,8 +543,18 @@ public:
    * @param omega Angular frequency
    * @param dt Timestep
    * @param Nt Number of timesteps in a sinusoidal period
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the cells between them.
    */
   void set_phasors(SplitField &F, int n, double omega, double dt, int Nt);
+  /**
+   * @brief Set the phasors of the cells of the field that are also in cells,
+   * as set_phasors does for every cell: a process of a distributed grid sets
+   * those of the cells that it owns.
+   */
+  void set_phasors(SplitField &F, int n, double omega, double dt, int Nt,
+                   const CellBox &cells);
 
   // TODO: Docstring
   /**
@@ -391,6 +641,12 @@ public:
    */
   void set_values_from(Field &other);
 
+  /**
+   * @brief Exchange the values of this field with those of another, equally
+   * sized field, by exchanging their arrays rather than copying them
+   */
+  void swap_values(Field &other);
+
   /**
    * @brief Computes the maximum pointwise absolute difference of the other
    * field to this one, divided by the largest absolute value of this field's
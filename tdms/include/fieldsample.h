@@ -6,6 +6,7 @@
 
 #include "arrays.h"
 #include "field.h"
+#include "probe_stencils.h"
 #include "simulation_parameters.h"
 
 class FieldSample {
@@ -13,6 +14,16 @@ class FieldSample {
 private:
   double ****tensor = nullptr;
 
+  /*! Probes of Ex, Ey, and Ez at each location, in that order and with i
+   * varying fastest, if they have been compiled */
+  ProbeStencils probes;
+
+  /** @brief The cell of the location (it, jt, kt) */
+  CellCoordinate cell_of(int it, int jt, int kt,
+                         const PerfectlyMatchedLayer &pml) const {
+    return {i[it] + pml.Dxl - 1, j[jt] + pml.Dyl - 1, k[kt] + pml.Dzl - 1};
+  }
+
 public:
   mxArray *mx;//!< Matlab array
 
@@ -42,6 +53,20 @@ public:
 
   inline double ***operator[](int value) const { return tensor[value]; };
 
+  /**
+   * @brief Compile the stencils of the field at the locations, which extract
+   * then uses in place of interpolating the field at each location in turn
+   *
+   * @param E_split The electric (split) field, whose storage is final
+   * @param pml A description of the perfectly matched layer being used in this
+   * simulation
+   * @param partition The partition of the grid over the processes, or nullptr
+   * if the grid is not distributed
+   */
+  void compile_probes(ElectricSplitField &E_split,
+                      const PerfectlyMatchedLayer &pml,
+                      const GridPartition *partition = nullptr);
+
   /**
    * @brief Extract the (Electric) field values at the vertices
    *
@@ -50,6 +75,9 @@ public:
    * simulation
    * @param n_simulation_timesteps The (total) number of timesteps in this
    * simulation
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the vertices between them.
    */
   void extract(ElectricSplitField &E_split, PerfectlyMatchedLayer &pml,
                int n_simulation_timesteps);
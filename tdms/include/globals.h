@@ -35,6 +35,16 @@ typedef std::complex<double> *CArray_1d;
 typedef CArray_1d *CArray_2d;
 typedef CArray_2d *CArray_3d;
 
+/*! Scalar type of the split fields and of the auxiliary fields of the main
+ * loop. Single precision if TDMS was built with SINGLE_PRECISION_FIELDS=ON;
+ * quantities accumulated from the fields (such as the phasors) are always
+ * double precision. */
+#ifdef TDMS_SINGLE_PRECISION_FIELDS
+typedef float field_t;
+#else
+typedef double field_t;
+#endif
+
 typedef struct PlanarInterface// Structure definition for a planar six-face
                               // interface
 {
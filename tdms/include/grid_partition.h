@@ -0,0 +1,169 @@
+/**
+ * @file grid_partition.h
+ * @brief The share of the Yee cells of the grid that this process updates,
+ * behind an interface so that a simulation runs unchanged whether or not the
+ * grid is distributed over several (MPI) processes.
+ *
+ * GridPartition is the partition of a single process, which owns every cell.
+ * MPIGridPartition (in distributed/, built with TDMS_MPI) distributes the
+ * cells over the processes of an MPI run.
+ */
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cell_coordinate.h"
+#include "fft_backend.h"
+#include "field.h"
+#include "globals.h"
+
+/**
+ * @brief A PSTD derivative-shift operator (as BatchedDerivative) along one
+ * direction of a grid whose cells are distributed over processes.
+ */
+class DistributedDerivative {
+public:
+  virtual ~DistributedDerivative() = default;
+
+  /**
+   * @brief Differentiate the lines of the grid along the direction of the
+   * operator. Must be called by every thread of the team (or from outside of
+   * a parallel region) on every process.
+   *
+   * @param samples The samples of the cells that this process owns, in
+   * (i, j, k) order
+   * @param derivative Overwritten by the derivative at the owned cells, in the
+   * same order, of the samples x with begin <= x < end of each line. Must
+   * already be the size of samples.
+   * @param begin,end The range of samples of each line that are differentiated
+   * @param blend Callable (a, b, N, weight) returning whether the line through
+   * (a, b) blends the spectral derivative with a finite difference, as
+   * BatchedDerivative::differentiate_lines: (j, k) for lines along x, (i, k)
+   * along y, and (i, j) along z
+   */
+  virtual void
+  differentiate(const std::vector<double> &samples,
+                std::vector<double> &derivative, int begin, int end,
+                const std::function<bool(int, int, int, double *)> &blend) = 0;
+};
+
+/**
+ * @brief The cells of the grid that this process owns, and the communication
+ * between the processes that own the rest.
+ *
+ * Each process stores only the cells that it owns, with a halo of the cells
+ * of its neighbours that its updates read (see with_halo()): the FDTD updates
+ * read one cell beyond the block, which start_exchange() and
+ * finish_exchange() fill in every timestep, and the lines of the PSTD
+ * derivatives are transposed between the processes, so need no halo. The
+ * outputs are gathered onto the root process only once the time loop is done.
+ *
+ * The collective methods must be called by every process, and on each by one
+ * thread only (the master thread of a team): the processes communicate from
+ * the thread that initialised MPI. They have no effect on a single process.
+ */
+class GridPartition {
+protected:
+  CellBox grid_; //< Every cell of the grid
+  CellBox owned_;//< The cells that this process owns
+
+public:
+  /** @brief The partition of a single process, which owns every cell of the
+   * grid of (I_tot + 1) x (J_tot + 1) x (K_tot + 1) cells */
+  explicit GridPartition(const IJKDimensions &IJK_tot);
+  virtual ~GridPartition() = default;
+
+  /** @brief The number of processes that the grid is distributed over */
+  virtual int n_processes() const { return 1; }
+  /** @brief Whether this is the process that writes the outputs */
+  virtual bool is_root() const { return true; }
+  /** @brief Whether the grid is distributed over more than one process */
+  bool is_distributed() const { return n_processes() > 1; }
+
+  /** @brief Every cell of the grid */
+  const CellBox &grid() const { return grid_; }
+  /** @brief The cells that this process owns */
+  const CellBox &owned() const { return owned_; }
+
+  /** @brief Replace each of n values by its sum over the processes.
+   * Collective. */
+  virtual void sum(double * /*values*/, int /*n*/) const {}
+  /** @brief Replace each of n values by its maximum over the processes.
+   * Collective. */
+  virtual void maximum(double * /*values*/, int /*n*/) const {}
+  /** @brief Replace value by that of the root process. Collective. */
+  virtual void broadcast_from_root(std::string & /*value*/) const {}
+  /** @brief The cells that process (from 0 to n_processes() - 1) owns */
+  virtual CellBox owned_by(int /*process*/) const { return owned_; }
+  /** @brief The owned cells, and the cells within width of them in i and j
+   * that are in the grid */
+  CellBox with_halo(int width) const;
+
+  /**
+   * @brief The values of every process, one after the other in the order of
+   * the processes. Collective.
+   *
+   * @return The values on the root process, and nothing on the others
+   */
+  virtual std::vector<double>
+  gather_to_root(const std::vector<double> &values) const {
+    return values;
+  }
+  /**
+   * @brief The values of every process, one after the other in the order of
+   * the processes, on every process. Collective.
+   *
+   * For the few values that describe the grid, such as the positions of its
+   * material interfaces, rather than the fields.
+   */
+  virtual std::vector<int> gather_to_all(const std::vector<int> &values) const {
+    return values;
+  }
+
+  /**
+   * @brief Start sending the face of the owned cells of field that the
+   * neighbours read to them, and receiving theirs into its halo. Collective.
+   *
+   * The E-field update reads the H field at i - 1 and j - 1, and the H-field
+   * update the E field at i + 1 and j + 1, so only one face is exchanged in
+   * each direction, and no corners. The cells that do not read the halo may be
+   * updated until finish_exchange().
+   *
+   * @param field The field, stored over with_halo(1)
+   * @param upwards Whether the highest owned face is sent to the neighbours
+   * above (and the low halo received from below), as for the H field, or the
+   * lowest owned face to the neighbours below, as for the E field
+   */
+  virtual void start_exchange(SplitField & /*field*/, bool /*upwards*/) {}
+  /** @brief Wait for the exchange started by start_exchange(field, upwards),
+   * and copy the received face into the halo of field. Collective. */
+  virtual void finish_exchange(SplitField & /*field*/, bool /*upwards*/) {}
+
+  /**
+   * @brief The derivative-shift operator of the distributed grid along a
+   * direction, or nullptr if the grid is not distributed
+   *
+   * @param direction The direction of the derivative
+   * @param delta The fraction of the spatial step to shift by
+   * @param transform The transform, which sets the length of the lines
+   */
+  virtual std::unique_ptr<DistributedDerivative>
+  make_derivative(AxialDirection /*direction*/, double /*delta*/,
+                  std::shared_ptr<const BatchedRealFFT> /*transform*/) const {
+    return nullptr;
+  }
+};
+
+/**
+ * @brief The partition of the grid of this process
+ *
+ * @param distributed Whether to distribute the grid over the processes of the
+ * MPI run (--distributed), which requires a build with TDMS_MPI
+ * @param IJK_tot The number of Yee cells of the grid in each direction
+ */
+std::unique_ptr<GridPartition>
+make_grid_partition(bool distributed, const IJKDimensions &IJK_tot);
@@ -2,6 +2,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "hdf5_io/hdf5_base.h"
 #include "hdf5_io/hdf5_dimension.h"
@@ -48,6 +49,38 @@ public:
     spdlog::trace("Read successful.");
   }
 
+  /**
+   * @brief Reads a block of a named dataset, rather than the whole of it.
+   *
+   * The block is read in the order of the dataset, whose last index varies
+   * fastest. (Arrays that MATLAB writes are stored with their dimensions
+   * reversed, so their first index then varies fastest, as in MATLAB.)
+   *
+   * @param dataset_name The name of the dataset to be read
+   * @param offset The first index of the block along each dimension
+   * @param count The extent of the block along each dimension
+   * @param data A pointer to an array of the size of the block
+   */
+  template<typename T>
+  void read_block(const std::string &dataset_name,
+                  const std::vector<hsize_t> &offset,
+                  const std::vector<hsize_t> &count, T *data) const {
+    spdlog::debug("Reading a block of {} from file: {}", dataset_name,
+                  filename_);
+
+    H5::DataSet dataset = file_->openDataSet(dataset_name);
+    H5::DataSpace file_space = dataset.getSpace();
+    if (file_space.getSimpleExtentNdims() != (int) count.size() ||
+        offset.size() != count.size()) {
+      throw std::runtime_error("Cannot read a block of " +
+                               std::to_string(count.size()) +
+                               " dimensions from " + dataset_name);
+    }
+    file_space.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
+    H5::DataSpace memory_space((int) count.size(), count.data());
+    dataset.read(data, dataset.getDataType(), memory_space, file_space);
+  }
+
   /**
    * @brief Reads the data from the dataset at the location (under file root)
    * provided.
@@ -16,7 +16,7 @@ class InputMatrices {
 private:
   // Pointers to arrays in C++ that will be populated by the MATLAB matrices
   // (default to nullptrs)
-  const mxArray *matrix_pointers[NMATRICES];
+  const mxArray *matrix_pointers[NMATRICES] = {};
 
   /**
    * @brief Assigns pointers to the matrices in an input file, based on those we
@@ -43,6 +43,9 @@ public:
    * middle-child between full removal of MATLAB and the slow removal of class
    * dependencies */
   std::string input_filename;
+  /*! Name of the file that holds fdtdgrid: the gridfile, if one was supplied,
+   * or the input file */
+  std::string grid_filename;
 
   InputMatrices() = default;
 
@@ -108,14 +111,20 @@ public:
    * the matrices
    *
    * @param mat_filename The MATLAB filename
+   * @param read_grid Whether to load fdtdgrid. If not, its pointer is null, and
+   * the materials of the grid are read later, a block at a time (see
+   * IndependentObjectsFromInfile::read_materials), so that no process of a
+   * distributed grid loads the whole of it.
    */
-  void set_from_input_file(const char *mat_filename);
+  void set_from_input_file(const char *mat_filename, bool read_grid = true);
   /**
    * @brief Open the input mat file, load the matrices, and setup pointers to
    * the matrices
    *
    * @param mat_filename The MATLAB filename
    * @param gridfile The additional gridfile
+   * @param read_grid Whether to load fdtdgrid from the gridfile
    */
-  void set_from_input_file(const char *mat_filename, const char *gridfile);
+  void set_from_input_file(const char *mat_filename, const char *gridfile,
+                           bool read_grid = true);
 };
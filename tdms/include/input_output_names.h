@@ -10,9 +10,9 @@
 
 #define NMATRICES 48//< number of input matrices
 #define NOUTMATRICES_WRITE                                                     \
-  23//< number of output matrices to be written to output file
+  29//< number of output matrices to be written to output file
 #define NOUTMATRICES_WRITE_ALL                                                 \
-  25//< number of output matrices to be written to output file
+  31//< number of output matrices to be written to output file
 #define NOUTMATRICES_PASSED                                                    \
   31//< number of output matrices passed by mexFunction
 
@@ -128,19 +128,23 @@ const std::vector<std::string> matrixnames_input_with_grid = {
 const std::vector<std::string> matrixnames_gridfile = {
         "fdtdgrid"};//< Matrices we expect to obtain from a separate gridfile
 const std::vector<std::string> outputmatrices_all = {
-        "Ex_out",     "Ey_out",      "Ez_out",   "Hx_out",
-        "Hy_out",     "Hz_out",      "x_out",    "y_out",
-        "z_out",      "Ex_i",        "Ey_i",     "Ez_i",
-        "Hx_i",       "Hy_i",        "Hz_i",     "x_i",
-        "y_i",        "z_i",         "vertices", "camplitudes",
-        "facets",     "maxresfield", "Id",       "fieldsample",
-        "campssample"};//< All output matrices we might want to write
+        "Ex_out",      "Ey_out",      "Ez_out",      "Hx_out",
+        "Hy_out",      "Hz_out",      "x_out",       "y_out",
+        "z_out",       "Ex_i",        "Ey_i",        "Ez_i",
+        "Hx_i",        "Hy_i",        "Hz_i",        "x_i",
+        "y_i",         "z_i",         "vertices",    "camplitudes",
+        "facets",      "maxresfield", "Id",          "fieldsample",
+        "campssample", "Ex_spectrum", "Ey_spectrum", "Ez_spectrum",
+        "Hx_spectrum", "Hy_spectrum", "Hz_spectrum"};//< All output matrices we
+                                                     // might want to write
 const std::vector<std::string> outputmatrices = {
-        "Ex_out", "Ey_out",      "Ez_out",     "Hx_out",      "Hy_out",
-        "Hz_out", "x_out",       "y_out",      "z_out",       "Ex_i",
-        "Ey_i",   "Ez_i",        "Hx_i",       "Hy_i",        "Hz_i",
-        "x_i",    "y_i",         "z_i",        "camplitudes", "maxresfield",
-        "Id",     "fieldsample", "campssample"};//< Output matrices we want to
-                                                // write in a compressed (-m)
-                                                // output
+        "Ex_out",      "Ey_out",      "Ez_out",      "Hx_out",
+        "Hy_out",      "Hz_out",      "x_out",       "y_out",
+        "z_out",       "Ex_i",        "Ey_i",        "Ez_i",
+        "Hx_i",        "Hy_i",        "Hz_i",        "x_i",
+        "y_i",         "z_i",         "camplitudes", "maxresfield",
+        "Id",          "fieldsample", "campssample", "Ex_spectrum",
+        "Ey_spectrum", "Ez_spectrum", "Hx_spectrum", "Hy_spectrum",
+        "Hz_spectrum"};//< Output matrices we want to write in a compressed
+                       // (-m) output
 }// namespace tdms_matrix_names
@@ -101,6 +101,14 @@ public:
    */
   int num_nonzero_coeffs() const;
 
+  /**
+   * @brief The coefficient of datapoint v[index] in the interpolation scheme
+   *
+   * @param index Index of the datapoint, between 0 and 7
+   * @return double The coefficient, scheme_coeffs[index]
+   */
+  double coefficient(int index) const { return scheme_coeffs[index]; }
+
   /**
    * @brief Executes the interpolation scheme on the data provided
    *
@@ -6,7 +6,14 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include <fftw3.h>
+#include <omp.h>
+
+#include "fft_backend.h"
 
 /**
  * @brief Multiply two arrays of complex numbers element-wise.
@@ -35,6 +42,20 @@ void complex_mult_vec(fftw_complex *a, fftw_complex *b, fftw_complex *c,
  */
 void init_diff_shift_op(double delta, fftw_complex *Dk, int N);
 
+/**
+ * @brief Initialise the coefficients of the derivative-shift operator for real
+ * data.
+ *
+ * The operator is Hermitian, so only the coefficients of the N/2 + 1
+ * non-negative frequencies that a real-to-complex FFT produces are needed.
+ * These are the first N/2 + 1 coefficients of init_diff_shift_op.
+ *
+ * @param[in] delta The fraction of the spatial step.
+ * @param[out] Dk Buffer to write the N/2 + 1 coefficients to.
+ * @param[in] N The number of samples that are differentiated.
+ */
+void init_diff_shift_op_r2c(double delta, fftw_complex *Dk, int N);
+
 /**
  * @brief Calculate the first derivative of a sampled function.
  * @note in_pb_pf must be the buffer which is the input for both plans pf and
@@ -51,3 +72,172 @@ void init_diff_shift_op(double delta, fftw_complex *Dk, int N);
  */
 void first_derivative(fftw_complex *in_pb_pf, fftw_complex *out_pb_pf,
                       fftw_complex *Dk, int N, fftw_plan pf, fftw_plan pb);
+
+/**
+ * @brief The derivative-shift operator of first_derivative, applied to batches
+ * of real lines of the same length.
+ *
+ * Since the lines are real, the forward and backward transforms are
+ * real-to-complex and complex-to-real, which need half the work and memory of
+ * the complex transforms of first_derivative. Each thread transforms
+ * batch_size lines at a time, by a BatchedRealFFT of any FFTBackend, from a
+ * buffer of its own in which the lines are interleaved: sample x of line b is
+ * at x * batch_size + b. The lines of a batch are consecutive in the innermost
+ * index of the grid, so that the samples are read from (and the derivatives
+ * written to) the field arrays in the order in which they are stored,
+ * whichever direction the lines run in.
+ */
+class BatchedDerivative {
+private:
+  int N_ = 0;         //< Number of samples in each line
+  int n_modes_ = 0;   //< Number of coefficients of the transform of a line
+  int batch_size_ = 0;//< Number of lines transformed together
+  //! Whether the finite difference that replaces the derivative of a line is
+  //! forward (sample x + 1 less sample x), or backward (sample x less x - 1),
+  //! from the sign of the shift
+  bool forward_difference_ = false;
+  //! Coefficients of the non-negative frequencies, including the
+  //! normalisation
+  fftw_complex *Dk_ = nullptr;
+  std::shared_ptr<const BatchedRealFFT> transform_;
+  std::vector<double *> lines_;      //< The lines of each thread
+  std::vector<fftw_complex *> modes_;//< Their transforms
+  //! Whether each line of the batch of each thread blends the spectral
+  //! derivative with the finite difference
+  std::vector<std::vector<char>> blended_;
+  //! The weights of the spectral derivative at each sample of the blended
+  //! lines of the batch of each thread, N_ for each line
+  std::vector<std::vector<double>> weights_;
+
+  void release();
+
+  /** @brief Differentiate the first n_lines lines in the buffer of a thread */
+  void differentiate(int thread, int n_lines);
+
+public:
+  BatchedDerivative() = default;
+  BatchedDerivative(const BatchedDerivative &) = delete;
+  BatchedDerivative &operator=(const BatchedDerivative &) = delete;
+  ~BatchedDerivative() { release(); }
+
+  /**
+   * @brief Create the buffers that differentiate lines, by a transform that
+   * may be shared with other derivatives of the same length
+   *
+   * @param delta The fraction of the spatial step to shift by
+   * @param n_threads The number of threads that will differentiate lines
+   * @param transform The transform, which sets the length of the lines and the
+   * number of lines in a batch
+   */
+  void initialise(double delta, int n_threads,
+                  std::shared_ptr<const BatchedRealFFT> transform);
+  /**
+   * @brief Create the FFTW plans and buffers that differentiate lines of N
+   * samples
+   *
+   * @param N The number of samples in each line
+   * @param delta The fraction of the spatial step to shift by
+   * @param n_threads The number of threads that will differentiate lines
+   * @param batch_size The number of lines transformed together
+   */
+  void initialise(int N, double delta, int n_threads, int batch_size = 16) {
+    initialise(delta, n_threads,
+               FFTWBackend().plan_batched_real(N, batch_size));
+  }
+
+  /** @brief The number of samples in each line */
+  int length() const { return N_; }
+
+  /**
+   * @brief Differentiate a grid of n_outer by n_inner lines, batch_size lines
+   * at a time. Must be called from within a parallel region, as the batches
+   * are shared between the threads.
+   *
+   * The derivative is with respect to the sample index, which is the real part
+   * of the output of first_derivative divided by N, so that it replaces the
+   * difference between neighbouring samples of a finite-difference update.
+   *
+   * @param n_outer,n_inner Number of lines in each direction of the grid
+   * @param begin,end The range of samples of each line that are updated
+   * @param sample Callable (outer, inner, x) returning sample x of a line
+   * @param update Callable (outer, inner, x, derivative), which consumes the
+   * derivative at sample x of a line
+   */
+  template<typename Sample, typename Update>
+  void differentiate_lines(int n_outer, int n_inner, int begin, int end,
+                           Sample sample, Update update) {
+    differentiate_lines(n_outer, n_inner, begin, end, sample, update,
+                        [](int, int, int, double *) { return false; });
+  }
+
+  /**
+   * @brief Differentiate a grid of lines as differentiate_lines above, but
+   * blend the derivative of the lines that blend selects with the difference
+   * between neighbouring samples, as in an FDTD update.
+   *
+   * The derivative at sample x of a blended line is
+   *
+   *   weight[x] * spectral + (1 - weight[x]) * difference,
+   *
+   * so that segments of the line (of weight 0) are differentiated by finite
+   * differences only, and are coupled to the rest of it (of weight 1) through
+   * the samples of intermediate weight between them. The difference is
+   * backward for a negative shift, and forward for a positive one, so begin
+   * must be at least 1 (end at most N - 1) for the E-field (H-field)
+   * derivatives. A batch of lines whose weights are all 0 is not transformed
+   * at all.
+   *
+   * @param blend Callable (outer, inner, N, weight) returning whether a line
+   * is blended, which if so writes the weight of the spectral derivative at
+   * each of its N samples to weight
+   */
+  template<typename Sample, typename Update, typename Blend>
+  void differentiate_lines(int n_outer, int n_inner, int begin, int end,
+                           Sample sample, Update update, Blend blend) {
+    if (N_ < 1) { return; }
+    int thread = omp_get_thread_num();
+    int n_blocks = (n_inner + batch_size_ - 1) / batch_size_;
+    int ahead = forward_difference_ ? 1 : 0, behind = 1 - ahead;
+
+#pragma omp for schedule(static)
+    for (int batch = 0; batch < n_outer * n_blocks; batch++) {
+      int outer = batch / n_blocks;
+      int first = (batch % n_blocks) * batch_size_;
+      int n_lines = std::min(batch_size_, n_inner - first);
+      double *samples = lines_[thread];
+
+      std::vector<char> &blended = blended_[thread];
+      double *weights = weights_[thread].data();
+      bool any_spectral = false;
+      for (int b = 0; b < n_lines; b++) {
+        double *weight = weights + (std::size_t) b * N_;
+        blended[b] = blend(outer, first + b, N_, weight);
+        any_spectral = any_spectral || !blended[b] ||
+                       *std::max_element(weight, weight + N_) > 0.;
+      }
+      if (any_spectral) {
+        for (int x = 0; x < N_; x++) {
+          for (int b = 0; b < n_lines; b++) {
+            samples[x * batch_size_ + b] = sample(outer, first + b, x);
+          }
+        }
+        differentiate(thread, n_lines);
+      }
+      for (int x = begin; x < end; x++) {
+        for (int b = 0; b < n_lines; b++) {
+          double derivative = samples[x * batch_size_ + b];
+          double weight = blended[b] ? weights[(std::size_t) b * N_ + x] : 1.;
+          if (weight < 1.) {
+            double difference = sample(outer, first + b, x + ahead) -
+                                sample(outer, first + b, x - behind);
+            derivative = weight > 0.
+                                 ? weight * derivative +
+                                           (1. - weight) * difference
+                                 : difference;
+          }
+          update(outer, first + b, x, derivative);
+        }
+      }
+    }
+  }
+};
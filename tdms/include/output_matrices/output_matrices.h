@@ -11,6 +11,7 @@
 #include "field.h"
 #include "fieldsample.h"
 #include "grid_labels.h"
+#include "grid_partition.h"
 #include "input_flags.h"
 #include "matrix.h"
 #include "output_matrices/id_variables.h"
@@ -18,6 +19,7 @@
 #include "simulation_parameters.h"
 #include "surface_phasors.h"
 #include "vertex_phasors.h"
+#include "volume_spectrum.h"
 
 /**
  * @brief Handles the data that is written to the output file, and the
@@ -43,6 +45,13 @@ private:
 
   IJKDimensions n_Yee_cells;//< Number of Yee cells in each axial direction for
                             // the simulation (dictated by E_s split-field)
+  CellBox volume_cells;//< The cells of the volume phasors of the whole grid
+
+  /** @brief Set the extraction range of E and H to cells */
+  void set_EH_cells(const CellBox &cells);
+  /** @brief Create the MATLAB arrays of E and H over their extraction range,
+   * and zero them */
+  void create_EH_arrays();
 
   /**
    * @brief Computes the field values at the centre of the Yee cells, and the
@@ -96,11 +105,24 @@ public:
    * @param input_grid_labels The grid labels obtained from the input file
    * @param interpolation_method The interpolation method to be used when
    * computing the field values
+   * @param partition The partition of the grid over the processes, or nullptr
+   * for every cell. E and H are extracted over the cells that this process
+   * owns only.
    */
   void
   setup_EH_and_gridlabels(const SimulationParameters &params,
                           const GridLabels &input_grid_labels,
-                          tdms_flags::InterpolationMethod interpolation_method);
+                          tdms_flags::InterpolationMethod interpolation_method,
+                          const GridPartition *partition = nullptr);
+  /**
+   * @brief Gather the phasors of E and H, and the volume spectrum, that each
+   * process of a distributed grid has extracted at the cells that it owns
+   * into those of the whole volume, on the root process. Collective.
+   *
+   * @param partition The partition of the grid, whose owned cells E and H
+   * were set up with
+   */
+  void gather_volume_phasors(const GridPartition &partition);
   /**
    * @brief Get the dimensions of the electric (and magnetic) field.
    *
@@ -140,6 +162,25 @@ public:
    */
   void setup_vertex_phasors(const mxArray *vp_ptr, int n_frequencies);
 
+  VolumeSpectrum volume_spectrum;//< Volume phasors at every extraction
+                                 // frequency, if requested
+
+  /**
+   * @brief Setup the extraction of the volume phasors at every extraction
+   * frequency. Must be called after setup_EH_and_gridlabels.
+   *
+   * @param params The simulation parameters for this run
+   * @param frequencies The frequencies to extract the phasors at
+   */
+  void setup_volume_spectrum(const SimulationParameters &params,
+                             const std::vector<double> &frequencies);
+  /**
+   * @brief Create MATLAB memory for the volume spectrum outputs, and copy the
+   * phasors into it. The outputs are not written unless the volume spectrum
+   * was extracted.
+   */
+  void assign_volume_spectrum_outputs();
+
   FieldSample fieldsample;//< E,H split-field values sampled at user-specified
                           // locations and frequencies
 
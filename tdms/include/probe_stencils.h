@@ -0,0 +1,128 @@
+/**
+ * @file probe_stencils.h
+ * @brief Contains a class that evaluates a split field at a fixed set of
+ * probes, using interpolation stencils that are compiled once.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "cell_coordinate.h"
+#include "field.h"
+#include "grid_partition.h"
+
+/**
+ * @brief The values of a split field at a set of probes: the unsplit field in
+ * one direction, interpolated to the centre of a cell or at the cell itself.
+ *
+ * The probes of the surface, vertex, and field-sample extractions never move,
+ * so rather than choosing an interpolation scheme and gathering its data for
+ * each probe at every timestep, the stencil of each probe is compiled into a
+ * sparse row of (stored value, weight) terms when it is added. Evaluating
+ * every probe is then a sparse matrix-vector product with the stored values
+ * of the split components. The terms of each probe are split between the two
+ * components whose sum is the field (eg xy and xz), and sorted by their
+ * position in storage.
+ *
+ * The terms index the storage of the components, so the probes must be added
+ * once that storage is final (after SplitField::unsplit_interior).
+ *
+ * When the grid is distributed, each process keeps the terms of the cells that
+ * it owns, and the values of the probes are summed over the processes.
+ */
+class ProbeStencils {
+private:
+  /*! A stored value of a split component, and its weight in a probe */
+  struct Term {
+    std::ptrdiff_t index;
+    double weight;
+  };
+
+  std::vector<int> direction_;//< Direction (0, 1, 2 for x, y, z) of each probe
+  //! Terms of probe p in the xy, yx, or zx component are those of
+  //! whole_[whole_start_[p]] to whole_[whole_start_[p + 1]] (excluded)
+  std::vector<Term> whole_;
+  std::vector<std::size_t> whole_start_ = {0};
+  //! Terms of probe p in the xz, yz, or zy component, indexed as whole_ is
+  std::vector<Term> part_;
+  std::vector<std::size_t> part_start_ = {0};
+  std::vector<double> values_;//< Value of each probe at the last evaluation
+  //! The partition of the grid whose owned cells are kept, or nullptr
+  const GridPartition *partition_ = nullptr;
+
+  /** @brief Add a probe of the field F in direction d with the stencil */
+  int add(SplitField &F, AxialDirection d,
+          const InterpolationStencil &stencil);
+
+public:
+  /**
+   * @brief Add a probe of the field in direction d interpolated to the centre
+   * of a cell, as SplitField::interpolate_to_centre_of does
+   * @return int The index of the probe
+   */
+  int add_interpolated(SplitField &F, AxialDirection d,
+                       const CellCoordinate &cell) {
+    return add(F, d, F.interpolation_stencil(d, cell));
+  }
+
+  /**
+   * @brief Add a probe of the field in direction d at a cell, without
+   * interpolation
+   * @return int The index of the probe
+   */
+  int add_value(SplitField &F, AxialDirection d, const CellCoordinate &cell) {
+    return add(F, d, {{cell, 1.}});
+  }
+
+  /**
+   * @brief Add a probe whose value is always zero, for a component that is
+   * not computed
+   * @return int The index of the probe
+   */
+  int add_zero(SplitField &F) { return add(F, AxialDirection::X, {}); }
+
+  /** @brief Number of probes */
+  int n_probes() const { return (int) direction_.size(); }
+
+  /** @brief Whether there are no probes */
+  bool empty() const { return direction_.empty(); }
+
+  /** @brief Remove every probe */
+  void clear();
+
+  /**
+   * @brief Keep only the terms of the cells that this process owns, of the
+   * probes added from now on, and sum the probes over the processes when
+   * they are evaluated
+   *
+   * @param partition The partition of the grid, which must outlive the
+   * probes, or nullptr to keep every term
+   */
+  void distribute(const GridPartition *partition) { partition_ = partition; }
+
+  /**
+   * @brief Evaluate every probe, with the current values of the field F to
+   * which the probes were added
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the probes between them (on every process, if the probes are
+   * distributed).
+   */
+  void evaluate(const SplitField &F);
+
+  /** @brief The value of a probe at the last evaluation */
+  double value(int probe) const { return values_[probe]; }
+};
+
+/**
+ * @brief Add probes of Ex, Ey, Ez and Hx, Hy, Hz interpolated to the centre of
+ * a cell, in that order, as they are interpolated in a simulation of the given
+ * dimension.
+ *
+ * Components that are not interpolated in the dimension have probes that are
+ * always zero.
+ */
+void add_centre_probes(ProbeStencils &E_probes, ProbeStencils &H_probes,
+                       ElectricSplitField &E, MagneticSplitField &H,
+                       Dimension dimension, const CellCoordinate &cell);
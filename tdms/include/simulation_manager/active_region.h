@@ -0,0 +1,81 @@
+/**
+ * @file active_region.h
+ * @brief Tracking of the box of cells that the fields of a pulsed simulation
+ * can have reached, so that the update loops can skip the rest of the grid.
+ */
+#pragma once
+
+#include "cell_coordinate.h"
+#include "field.h"
+
+/**
+ * @brief The box of Yee cells outside which the fields are (still) zero.
+ *
+ * In a pulsed simulation the fields start at zero, apart from those of any
+ * initial field supplied with the grid, and the pulse enters through the
+ * source planes. The E update of a cell reads the H field of its own cell and
+ * of the cells before it, and the H update the E field of its own cell and of
+ * the cells after it, so over one timestep the non-zero fields spread by at
+ * most one cell in each direction. Growing the box by a cell before each
+ * timestep, and updating only the cells inside it, therefore gives the same
+ * fields as updating the whole grid.
+ *
+ * Optionally, the box can be shrunk back to the cells whose fields are above
+ * a threshold, once the pulse has passed through part of the grid. The fields
+ * left outside the box are then no longer updated, which is an approximation.
+ *
+ * Until track is called, the box is the whole grid.
+ */
+class ActiveRegion {
+private:
+  CellBox grid_;        //< Every cell of the grid
+  CellBox box_;         //< The cells that are updated
+  CellBox sources_;     //< The cells into which the source injects fields
+  bool tracking_ = false;//< Whether box_ can be smaller than grid_
+  //! The largest component, and the cells above the threshold, found by the
+  //! team of threads that shrink the box
+  double largest_ = 0.;
+  CellBox above_;
+
+  /** @brief The box grown by margin cells on each side, within the grid */
+  CellBox grown(const CellBox &box, int margin) const;
+
+public:
+  /*! Number of timesteps between the checks of whether the box can shrink */
+  static const int SHRINK_INTERVAL = 32;
+
+  /** @brief Set the grid of (I_tot + 1) x (J_tot + 1) x (K_tot + 1) cells */
+  void set_grid(const IJKDimensions &IJK_tot);
+
+  /**
+   * @brief Start tracking the region from the initial fields
+   *
+   * @param sources The cells that the source terms update
+   * @param E,H The initial fields, whose non-zero cells are active
+   */
+  void track(const CellBox &sources, const SplitField &E, const SplitField &H);
+
+  /** @brief Whether the box is being tracked, and so may not be the grid */
+  bool is_tracking() const { return tracking_; }
+
+  /**
+   * @brief Grow the box by the distance that the fields can travel in one
+   * timestep. Called before the fields are advanced.
+   */
+  void advance();
+
+  /**
+   * @brief Shrink the box to the cells at which a component of E or H exceeds
+   * threshold times the largest component, grown by a cell, together with the
+   * source cells. Never grows the box.
+   *
+   * Shares the cells between the threads of the calling team, so must be
+   * called by every thread of the team, or outside of a parallel region.
+   */
+  void shrink(const SplitField &E, const SplitField &H, double threshold);
+
+  /** @brief The cells to update in this timestep */
+  const CellBox &box() const { return box_; }
+  /** @brief Every cell of the grid */
+  const CellBox &grid() const { return grid_; }
+};
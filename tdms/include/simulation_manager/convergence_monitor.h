@@ -0,0 +1,90 @@
+/**
+ * @file convergence_monitor.h
+ * @brief The check of whether the phasors of a steady-state simulation have
+ * converged, made at the end of each period of the source.
+ */
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "field.h"
+#include "grid_partition.h"
+#include "solver_options.h"
+#include "surface_phasors.h"
+
+/**
+ * @brief Compares the phasors extracted over a period of the source with those
+ * of the previous period, and starts the next period.
+ *
+ * The phasors of the previous period are kept in a second field, whose arrays
+ * are exchanged with those of the phasors when a period ends, rather than
+ * copied. The comparison is made on the volume phasors, at every
+ * stride-th cell in each direction, or on the surface phasors. When the grid
+ * is distributed, the largest values are those over every process.
+ *
+ * The methods that take fields share the cells between the threads of the
+ * calling team, so must be called by every thread of the team, or outside of
+ * a parallel region.
+ */
+class ConvergenceMonitor {
+private:
+  ElectricField &previous_;//< The phasors of the previous period
+  ConvergenceSet set_;     //< The phasors that are compared
+  int stride_;             //< The distance between the cells compared
+  //! The partition of the grid over the processes, or nullptr
+  const GridPartition *partition_;
+  //! Whether previous_ holds the arrays of the phasors that it is compared to
+  bool swapped_ = false;
+  //! The surface phasors of the previous period
+  std::vector<std::complex<double>> previous_surface_;
+
+  // The largest phasor, and difference between the phasors, of all threads
+  double max_abs_ = 0., max_abs_diff_ = 0.;
+
+  /** @brief Compare the surface phasors with those of the previous period */
+  void compare_surface(const SurfacePhasors &surface);
+
+public:
+  /**
+   * @param previous The field that holds the phasors of the previous period,
+   * of the same size as the phasors compared to it
+   * @param set The phasors that are compared
+   * @param stride The distance between the cells at which the volume phasors
+   * are compared
+   * @param partition The partition of the grid over the processes, which must
+   * outlive the monitor, or nullptr if the grid is not distributed
+   */
+  explicit ConvergenceMonitor(ElectricField &previous,
+                              ConvergenceSet set = ConvergenceSet::Volume,
+                              int stride = 1,
+                              const GridPartition *partition = nullptr);
+
+  /**
+   * @brief The largest change in the phasors over the last period, relative
+   * to the largest phasor, as Field::normalised_difference
+   *
+   * @param E The volume phasors of the period that has just ended
+   * @param surface The surface phasors of the period that has just ended
+   * @return The change, which is the same on every thread (and process)
+   */
+  double difference(ElectricField &E, const SurfacePhasors &surface);
+
+  /**
+   * @brief Keep the phasors of the period that has just ended as those of the
+   * previous period, and zero E and H for the next period
+   */
+  void start_next_period(ElectricField &E, MagneticField &H);
+
+  /**
+   * @brief Set the phasors E to those of the previous period, which are the
+   * last complete ones if the simulation ends before converging. Serial.
+   */
+  void restore_previous(ElectricField &E);
+
+  /**
+   * @brief Give E back its own arrays, holding its current phasors, should
+   * they have been exchanged. Serial, and called once the main loop is over.
+   */
+  void release(ElectricField &E);
+};
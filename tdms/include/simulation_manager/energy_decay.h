@@ -0,0 +1,89 @@
+/**
+ * @file energy_decay.h
+ * @brief Monitoring of the decay of the field energy of a pulsed simulation,
+ * so that the main loop can stop once the pulse has left the grid.
+ */
+#pragma once
+
+#include <vector>
+
+#include "arrays/incident_field.h"
+#include "field.h"
+#include "grid_partition.h"
+
+/**
+ * @brief The electromagnetic energy of the fields, relative to its largest
+ * value so far.
+ *
+ * The energy is the sum over the Yee cells of epsilon_0 |E|^2 + mu_0 |H|^2,
+ * with the free-space permittivity and permeability: the cells of a scatterer
+ * are weighted as free space, which is enough to tell when the fields have
+ * decayed. When the grid is distributed, each process sums its own cells, and
+ * the energy is summed over the processes.
+ */
+class EnergyDecay {
+private:
+  double threshold_;//< Fraction of the peak below which the energy has decayed
+  //! The partition of the grid whose owned cells are summed, or nullptr to
+  //! sum every cell
+  const GridPartition *partition_;
+  double energy_ = 0.;//< The energy at the last measurement
+  double peak_ = 0.;  //< The largest energy measured
+  /*! The largest power of the incident field over the time slices from each
+   * time slice onwards, or empty if there is no incident field */
+  std::vector<double> remaining_incident_;
+  double incident_peak_ = 0.;//< The largest power of any incident time slice
+
+public:
+  /*! Number of timesteps between the measurements of the energy */
+  static const int CHECK_INTERVAL = 16;
+
+  /**
+   * @param threshold The fraction of the peak energy, or 0 to never decay
+   * @param partition The partition of the grid over the processes, which must
+   * outlive the monitor, or nullptr if the grid is not distributed
+   */
+  explicit EnergyDecay(double threshold = 0.,
+                       const GridPartition *partition = nullptr)
+      : threshold_(threshold), partition_(partition) {}
+
+  /** @brief Whether the energy is monitored at all */
+  bool is_enabled() const { return threshold_ > 0.; }
+
+  /**
+   * @brief Measure the energy of the fields
+   *
+   * Shares the cells between the threads of the calling team, so must be
+   * called by every thread of the team, or outside of a parallel region (on
+   * every process, if the grid is distributed).
+   */
+  void measure(const SplitField &E, const SplitField &H);
+
+  /** @brief The energy at the last measurement */
+  double energy() const { return energy_; }
+  /** @brief The largest energy measured */
+  double peak() const { return peak_; }
+
+  /** @brief Whether the energy has fallen below the threshold of its peak */
+  bool has_decayed() const {
+    return is_enabled() && peak_ > 0. && energy_ <= threshold_ * peak_;
+  }
+
+  /**
+   * @brief Also monitor the broadband incident field, which is injected on
+   * every timestep of a pulsed simulation, independently of its envelope.
+   *
+   * The power of a time slice of the incident field is the sum of the squares
+   * of its x and y components over the source plane.
+   *
+   * @param Ei The incident field, whose components are indexed (i, j, tind)
+   */
+  void set_incident_field(const IncidentField &Ei);
+
+  /**
+   * @brief Whether every time slice of the incident field from timestep tind
+   * onwards has power below the threshold of the peak power of the incident
+   * field. True if there is no incident field.
+   */
+  bool incident_field_has_decayed(int tind) const;
+};
@@ -13,7 +13,11 @@
 #include "arrays.h"
 #include "field.h"
 #include "matrix.h"
+#include "simulation_manager/active_region.h"
 #include "simulation_manager/objects_from_infile.h"
+#include "simulation_manager/phasor_accumulator.h"
+#include "simulation_manager/sparse_currents.h"
+#include "simulation_manager/update_coefficients.h"
 
 /**
  * @brief Handles the setup of variables that will be scoped to the main
@@ -30,8 +34,8 @@ private:
   mxArray *E_copy_MATLAB_data[3] = {nullptr};
 
   /**
-   * @brief Determine the dispersive properties and setup the corresponding
-   * arrays
+   * @brief Determine the dispersive and conductive properties of the medium.
+   * The corresponding arrays are allocated by allocate_currents.
    *
    * @param data The objects and data obtained from the input file
    */
@@ -40,17 +44,15 @@ private:
    * @brief Determine if we have a dispersive medium by searching for non-zero
    * attenuation constants in gamma.
    *
-   * @param materials
-   * @param IJK_tot Number of Yee cells in each axial direction
+   * @param max_material The largest material of the cells of the grid
    * @param attenuation_constants Material attenuation constants
    * @param dt Simulation timestep
    * @param non_zero_tol Tolerance for an attenuation constant being "non-zero"
    * @return true, we have a dispersive medium
    * @return false, we do not have a dispersive medium
    */
-  bool is_dispersive_medium(uint8_t ***materials, const IJKDimensions &IJK_tot,
-                            double *attenuation_constants, double dt,
-                            double non_zero_tol = 1e-15);
+  bool is_dispersive_medium(int max_material, double *attenuation_constants,
+                            double dt, double non_zero_tol = 1e-15);
 
   /**
    * @brief Performs an optimisation step in a 2D simulation (J_tot==0) when we
@@ -114,11 +116,18 @@ public:
 
   ElectricField E_at_previous_iteration;//< Stores the phasors at the previous
                                         // iteration, to check for convergence
+  /*! The volume phasors of E and H accumulated by the update kernels, when
+   * they are not extracted by a sweep of their own */
+  PhasorAccumulator E_phasors, H_phasors;
 
   ElectricSplitField E_nm1;
   CurrentDensitySplitField J_c;//< The per-cell ( current density or
                                // conductivity ? ) of the material
   CurrentDensitySplitField J_s, J_nm1;
+  /*! The auxiliary fields E_nm1, J_c, J_s, and J_nm1, when they are stored only
+   * in the cells that need them (in which case the split fields above are left
+   * unallocated) */
+  SparseCurrents currents;
 
   bool is_conductive,
           is_dispersive;//< Whether the materials are dispersive / conductive
@@ -134,7 +143,47 @@ public:
   int n_non_pml_cells_in_K;//< Number of non-pml cells in the K-direction (K_tot
                            //- Dxl - Dxu)
 
-  LoopVariables(const ObjectsFromInfile &data, IJKDimensions E_field_dims);
+  UpdateCoefficientPlan coefficients;//< Per-cell coefficients of the E and H
+                                     // update equations
+  ActiveRegion active_region;//< The cells that the update loops advance
+
+  LoopVariables(const ObjectsFromInfile &data, IJKDimensions E_field_dims,
+                const FFTBackend &fft);
+
+  /**
+   * @brief Allocate (and zero) the auxiliary fields of the dispersive and
+   * conductive update terms, if the medium requires them.
+   *
+   * If sparse storage is allowed, and would use less memory, the fields are
+   * stored in currents, only in the cells whose coefficients include the
+   * terms. Otherwise they are stored over the cells that data.E_s stores in
+   * E_nm1, J_c, J_s, and J_nm1. Must be called after the storage of data.E_s
+   * is final.
+   *
+   * @param data The objects and data obtained from the input file
+   * @param allow_sparse Whether the update loops of the simulation support
+   * sparse storage (FDTD only)
+   * @param cells The cells that the update loops advance
+   * @param require_sparse Whether the update loops support sparse storage
+   * only, as those of a distributed grid do
+   */
+  void allocate_currents(const ObjectsFromInfile &data, bool allow_sparse,
+                         const CellBox &cells, bool require_sparse = false);
+
+  /**
+   * @brief Add to the conductive current density of a split component at a
+   * cell. Has no effect if the current density does not enter the update of
+   * the component at the cell, and so is not stored there.
+   */
+  void add_to_J_c(SplitComponent component, const CellCoordinate &cell,
+                  double value);
+  /**
+   * @brief Add to the dispersive current density of a split component at a
+   * cell.
+   * @see add_to_J_c
+   */
+  void add_to_J_s(SplitComponent component, const CellCoordinate &cell,
+                  double value);
 
   ~LoopVariables();
 };
@@ -51,7 +51,11 @@ public:
   ElectricSplitField E_s;//< The split electric-field values
   MagneticSplitField H_s;//< The split magnetic-field values
 
-  uint8_t ***materials;//< TODO
+  /*! The material of each cell, indexed (i, j, k), with 0 for the background:
+   * of every cell of the grid, or of the box of cells that read_materials
+   * read if fdtdgrid was not loaded with the other inputs */
+  Tensor3D<uint8_t> materials;
+  int max_material = 0;//< The largest material of the cells of the grid
   CMaterial Cmaterial; //< TODO
   DMaterial Dmaterial; //< TODO
   CCollection C;       //< TODO
@@ -89,7 +93,22 @@ public:
   IndependentObjectsFromInfile(InputMatrices matrices_from_input_file,
                                const InputFlags &in_flags);
 
-  ~IndependentObjectsFromInfile();
+  /**
+   * @brief Read the materials of a box of cells of the grid from the file that
+   * holds fdtdgrid, if fdtdgrid was not loaded with the other inputs (see
+   * InputMatrices::set_from_input_file).
+   *
+   * A process of a distributed grid reads the cells that it stores only, so
+   * that no process holds the materials of the whole grid. max_material is
+   * then the largest material of those cells.
+   *
+   * @param cells The cells whose materials to read
+   */
+  void read_materials(const CellBox &cells);
+
+private:
+  /*! The file that holds fdtdgrid */
+  std::string grid_filename_;
 };
 
 /**
@@ -0,0 +1,81 @@
+/**
+ * @file phasor_accumulator.h
+ * @brief Accumulation of the volume phasors of a steady-state simulation by
+ * the update kernels themselves, rather than by a separate pass over the grid.
+ */
+#pragma once
+
+#include <complex>
+
+#include "arrays/tensor3d.h"
+#include "cell_coordinate.h"
+#include "field.h"
+
+/**
+ * @brief The contributions of the timesteps of a period to the phasors of a
+ * Field, added by the update kernels as they visit each cell.
+ *
+ * The phasors of a Field are stored with i varying fastest, and the split
+ * fields with k varying fastest, so the kernels add to arrays of their own
+ * that are stored as the split fields are. These are added to the phasors of
+ * the Field, and zeroed, by flush: once at the end of each period of the
+ * source, rather than at every timestep.
+ *
+ * The contribution of a timestep is that of Field::set_phasors: the field at
+ * each cell times the phase term of the timestep, set by set_phase_term.
+ */
+class PhasorAccumulator {
+private:
+  bool enabled_ = false;//< Whether the kernels accumulate the phasors
+  CellBox box_;         //< The cells of the phasors of the Field
+  //! The phase term of the current timestep, divided by the number of
+  //! timesteps in the period
+  std::complex<double> phase_term_ = 0.;
+  //! The real and imaginary parts of the x, y, and z phasors, not yet flushed
+  Tensor3D<double, FieldAllocator<double>> real_[3], imag_[3];
+
+public:
+  /** @brief Accumulate the phasors of F, whose extraction range is final */
+  void allocate(const Field &F);
+
+  /** @brief Whether the kernels accumulate the phasors */
+  bool is_enabled() const { return enabled_; }
+
+  /**
+   * @brief Set the phase term of the timestep whose fields are added next
+   *
+   * @param F The Field whose phasors are accumulated
+   * @param n,omega,dt,Nt As for Field::set_phasors
+   */
+  void set_phase_term(Field &F, int n, double omega, double dt, int Nt);
+
+  /** @brief Whether the kernels accumulate phasors at any cell of row (i, j) */
+  bool accumulates(int i, int j) const {
+    return enabled_ && box_.contains(i, j);
+  }
+
+  /**
+   * @brief Add the field (x, y, z) at cell (i, j, k), a cell of a row for
+   * which accumulates(i, j) holds, times the phase term. Cells outside the
+   * phasors are ignored.
+   */
+  void add(int i, int j, int k, double x, double y, double z) {
+    if (k < box_.lower.k || k >= box_.upper.k) { return; }
+    int di = i - box_.lower.i, dj = j - box_.lower.j, dk = k - box_.lower.k;
+    double re = phase_term_.real(), im = phase_term_.imag();
+    real_[0](di, dj, dk) += x * re;
+    imag_[0](di, dj, dk) += x * im;
+    real_[1](di, dj, dk) += y * re;
+    imag_[1](di, dj, dk) += y * im;
+    real_[2](di, dj, dk) += z * re;
+    imag_[2](di, dj, dk) += z * im;
+  }
+
+  /**
+   * @brief Add the accumulated phasors to those of F, and zero them
+   *
+   * Shares the cells between the threads of the calling team, so must be
+   * called by every thread of the team, or outside of a parallel region.
+   */
+  void flush(Field &F);
+};
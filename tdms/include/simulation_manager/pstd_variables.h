@@ -5,10 +5,226 @@
  */
 #pragma once
 
-#include <fftw3.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 
-#include "arrays/tdms_matrix.h"
+#include "arrays/tensor3d.h"
 #include "cell_coordinate.h"
+#include "fft_backend.h"
+#include "grid_partition.h"
+#include "numerical_derivative.h"
+#include "solver_options.h"
+
+/**
+ * @brief Which samples of the lines of the grid, in each direction, the PSTD
+ * derivatives differentiate spectrally, for the hybrid PSTD/FDTD solver.
+ *
+ * A spectral derivative is only accurate where the field is smooth, which it
+ * is not across a material interface (a face between cells of different
+ * materials). The samples of a line within overlap cells of an interface along
+ * it are differentiated by the finite difference of the FDTD update instead,
+ * and the next overlap samples on either side blend the two derivatives, from
+ * the finite difference to the spectral one. The finite-difference segments
+ * around the interfaces are so coupled to the spectral segments of the line
+ * through an overlap, and the homogeneous regions (the background, and the
+ * interiors of the scatterers) keep the accuracy, and coarse grid, of PSTD.
+ *
+ * Until classify is called, every line is spectral.
+ */
+class SpectralLines {
+private:
+  /** @brief The interfaces along the lines of one direction */
+  struct Interfaces {
+    int n_b = 1;//< The number of lines of each a; line (a, b) is a * n_b + b
+    //! Where the interfaces of each line start in at, and where the last ends.
+    //! Empty if no line has an interface.
+    std::vector<int> first;
+    //! c, for each interface between samples c and c + 1 of a line
+    std::vector<int> at;
+  };
+  int overlap_ = 0;
+  Interfaces x_, y_, z_;
+  double spectral_fraction_ = 1.;
+
+  /**
+   * @brief Whether a line has an interface, and if so write the weight of the
+   * spectral derivative at each of its first n samples to weight
+   */
+  bool weights(const Interfaces &lines, int a, int b, int n,
+               double *weight) const;
+
+public:
+  /**
+   * @brief Find the interfaces along the lines of a grid from its materials
+   *
+   * @param materials The material of each cell, indexed (i, j, k), with 0 for
+   * the background: of every cell of the grid, or of the cells that this
+   * process of a distributed grid stores with their neighbours above
+   * @param IJK_tot The number of Yee cells of the grid in each direction
+   * @param overlap The number of cells on either side of an interface that are
+   * differentiated by finite differences, and the number beyond those over
+   * which the derivative blends into the spectral one
+   * @param partition The partition of a distributed grid, whose processes
+   * combine the interfaces in their cells. Collective.
+   */
+  void classify(const Tensor3D<uint8_t> &materials,
+                const IJKDimensions &IJK_tot, int overlap,
+                const GridPartition *partition = nullptr);
+
+  /** @brief The fraction of the samples of all the lines of the grid that are
+   * differentiated spectrally only */
+  double spectral_fraction() const { return spectral_fraction_; }
+
+  /**
+   * @brief Whether the line along x through (j, k) blends the spectral
+   * derivative with the finite difference, as the blend of
+   * BatchedDerivative::differentiate_lines
+   *
+   * @param j,k The line
+   * @param n The number of samples of the line to weight
+   * @param[out] weight The weight of the spectral derivative at each of the n
+   * samples, if the line is blended
+   */
+  bool x(int j, int k, int n, double *weight) const {
+    return weights(x_, j, k, n, weight);
+  }
+  /** @brief Whether the line along y through (i, k) is blended, as x() */
+  bool y(int i, int k, int n, double *weight) const {
+    return weights(y_, i, k, n, weight);
+  }
+  /** @brief Whether the line along z through (i, j) is blended, as x() */
+  bool z(int i, int j, int n, double *weight) const {
+    return weights(z_, i, j, n, weight);
+  }
+};
+
+/**
+ * @brief A PSTD derivative-shift operator of the update loops, which
+ * differentiates the lines of the grid on this process (BatchedDerivative), or
+ * of a grid that is distributed over several (DistributedDerivative).
+ *
+ * The update loops differentiate the lines along x as (outer, inner, x) =
+ * (j, k, i), along y as (i, k, j), and along z as (j, i, k). When the grid is
+ * distributed, the samples of the cells that this process owns are gathered
+ * in that order, differentiated together, and the update is applied to the
+ * owned cells only.
+ */
+class PSTDDerivative {
+private:
+  AxialDirection direction_ = AxialDirection::X;
+  int length_ = 0;//< The number of samples in each line
+  BatchedDerivative serial_;
+  std::unique_ptr<DistributedDerivative> distributed_;
+  CellBox owned_;//< The cells of the distributed grid that this process owns
+  //! The samples at, and derivative of, the owned cells in (i, j, k) order
+  std::vector<double> samples_, derivative_;
+
+  /** @brief Position of cell (i, j, k) in samples_ */
+  std::size_t index_of(int i, int j, int k) const {
+    std::size_t n_j = owned_.upper.j - owned_.lower.j,
+                n_k = owned_.upper.k - owned_.lower.k;
+    return ((std::size_t) (i - owned_.lower.i) * n_j + (j - owned_.lower.j)) *
+                   n_k +
+           (k - owned_.lower.k);
+  }
+
+public:
+  /**
+   * @brief Create the buffers that differentiate lines
+   *
+   * @param direction The direction of the lines
+   * @param delta The fraction of the spatial step to shift by
+   * @param n_threads The number of threads that will differentiate lines
+   * @param transform The transform, which sets the length of the lines
+   * @param partition The partition of the grid, which must outlive the
+   * operator, or nullptr if the grid is not distributed
+   */
+  void initialise(AxialDirection direction, double delta, int n_threads,
+                  std::shared_ptr<const BatchedRealFFT> transform,
+                  const GridPartition *partition = nullptr);
+
+  /** @brief The number of samples in each line */
+  int length() const { return length_; }
+
+  /**
+   * @brief Differentiate a grid of lines, and blend the derivative of the
+   * lines that blend selects with a finite difference, as
+   * BatchedDerivative::differentiate_lines. Must be called from within a
+   * parallel region, by every thread of the team on every process.
+   */
+  template<typename Sample, typename Update, typename Blend>
+  void differentiate_lines(int n_outer, int n_inner, int begin, int end,
+                           Sample sample, Update update, Blend blend) {
+    if (distributed_ == nullptr) {
+      serial_.differentiate_lines(n_outer, n_inner, begin, end, sample, update,
+                                  blend);
+      return;
+    }
+
+    // Call f(outer, inner, x) at cell (i, j, k)
+    auto at = [this](int i, int j, int k, auto f) {
+      switch (direction_) {
+        case AxialDirection::X:
+          return f(j, k, i);
+        case AxialDirection::Y:
+          return f(i, k, j);
+        default:
+          return f(j, i, k);
+      }
+    };
+    const CellBox &o = owned_;
+#pragma omp for collapse(2)
+    for (int i = o.lower.i; i < o.upper.i; i++) {
+      for (int j = o.lower.j; j < o.upper.j; j++) {
+        for (int k = o.lower.k; k < o.upper.k; k++) {
+          samples_[index_of(i, j, k)] = at(i, j, k, sample);
+        }
+      }
+    }
+
+    // the lines are blended by their (a, b) in the grid, and those that are
+    // not updated are not worth a transform, so take the finite difference
+    distributed_->differentiate(
+            samples_, derivative_, begin, end,
+            [&](int a, int b, int n, double *weight) {
+              int outer = direction_ == AxialDirection::Z ? b : a,
+                  inner = direction_ == AxialDirection::Z ? a : b;
+              if (outer < n_outer && inner < n_inner) {
+                return (bool) blend(outer, inner, n, weight);
+              }
+              std::fill_n(weight, n, 0.);
+              return true;
+            });
+
+    CellBox updated;
+    switch (direction_) {
+      case AxialDirection::X:
+        updated = {{begin, 0, 0}, {end, n_outer, n_inner}};
+        break;
+      case AxialDirection::Y:
+        updated = {{0, begin, 0}, {n_outer, end, n_inner}};
+        break;
+      default:
+        updated = {{0, 0, begin}, {n_inner, n_outer, end}};
+        break;
+    }
+    updated = updated.intersection(o);
+#pragma omp for collapse(2)
+    for (int i = updated.lower.i; i < updated.upper.i; i++) {
+      for (int j = updated.lower.j; j < updated.upper.j; j++) {
+        for (int k = updated.lower.k; k < updated.upper.k; k++) {
+          double derivative = derivative_[index_of(i, j, k)];
+          at(i, j, k, [&](int outer, int inner, int x) {
+            update(outer, inner, x, derivative);
+          });
+        }
+      }
+    }
+  }
+};
 
 /**
  * @brief Handles allocation and tear-down of memory/variables required when
@@ -16,33 +232,37 @@
  * variables of this class are needed.
  */
 class PSTDVariables {
-private:
-  //! Flags whether the dk-variables have been malloc'd or not
-  bool variables_allocated = false;
-
 public:
-  /*! TODO: what are these? */
-  CCoefficientMatrix ca, cb;
-
-  // The number of complex fourier coefficients in the derivative-shift
-  // operator, for each field component ( N_ex = # coeffs for Ex, for example)
-  int N_ex, N_ey, N_ez, N_hx, N_hy, N_hz;
-  // The coefficients of the PSTD derivative shift operator, for each field
-  // component ( dk_ex = coeffs for Ex, for example )
-  fftw_complex *dk_ex, *dk_ey, *dk_ez, *dk_hx, *dk_hy, *dk_hz;
+  // The PSTD derivative-shift operators, for each field component ( d_ex =
+  // the operator for Ex, for example ). The number of samples they
+  // differentiate is d_ex.length(), etc.
+  PSTDDerivative d_ex, d_ey, d_ez, d_hx, d_hy, d_hz;
+  // The samples of the lines that the operators differentiate spectrally,
+  // rather than by finite differences
+  SpectralLines spectral;
 
   PSTDVariables() = default;
   /*! @copydoc set_using_dimensions */
   PSTDVariables(const IJKDimensions &IJK_tot) { set_using_dimensions(IJK_tot); }
 
   /**
-   * @brief Allocate memory for PSTD method, for a simulation with the provided
-   * number of Yee cells in each dimension.
+   * @brief Create the derivative-shift operators for a simulation with the
+   * provided number of Yee cells in each dimension.
+   *
+   * The operators of the same length share their transforms, so at most one
+   * set of plans is made for each of the distinct lengths.
    *
    * @param IJK_tot Triple containing the number of Yee cells in the I,J,K
    * directions
+   * @param fft The FFT library that plans the transforms
+   * @param wisdom_file File that the plans of the library (FFTW wisdom) are
+   * imported from before planning, and exported to afterwards, by the root
+   * process of a distributed run. Not used if empty.
+   * @param partition The partition of the grid over the processes of a
+   * distributed run, which must outlive the operators, or nullptr
    */
-  void set_using_dimensions(const IJKDimensions &IJK_tot);
-
-  ~PSTDVariables();
+  void set_using_dimensions(const IJKDimensions &IJK_tot,
+                            const FFTBackend &fft = FFTWBackend(),
+                            const std::string &wisdom_file = "",
+                            const GridPartition *partition = nullptr);
 };
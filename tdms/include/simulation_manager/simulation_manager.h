@@ -7,20 +7,24 @@
 #pragma once
 
 #include <complex>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "arrays.h"
-#include "arrays/eh_vec.h"
 #include "cell_coordinate.h"
+#include "fft_backend.h"
 #include "globals.h"
+#include "grid_partition.h"
 #include "input_flags.h"
 #include "input_matrices.h"
 #include "output_matrices/output_matrices.h"
+#include "simulation_manager/convergence_monitor.h"
 #include "simulation_manager/loop_timers.h"
 #include "simulation_manager/loop_variables.h"
 #include "simulation_manager/objects_from_infile.h"
 #include "simulation_manager/pstd_variables.h"
+#include "solver_options.h"
 
 // Whether or not to time execution of loop subtasks
 #define TIME_EXEC false
@@ -45,6 +49,13 @@ private:
   tdms_flags::SolverMethod solver_method;
   /*! The interpolation methods to use in this simulation */
   tdms_flags::InterpolationMethod i_method;
+  /*! The execution options requested on the command line */
+  SolverOptions options;
+  /*! The FFT library of the PSTD derivatives and the detector transforms */
+  std::unique_ptr<FFTBackend> fft;
+  /*! The cells of the grid that this process owns, which are all of them
+   * unless the grid is distributed over MPI processes (--distributed) */
+  std::unique_ptr<GridPartition> partition;
 
   /*! The input objects that are generated from an input file */
   ObjectsFromInfile inputs;
@@ -56,8 +67,6 @@ private:
    * input file */
   OutputMatrices outputs;
 
-  EHVec eh_vec;//!< TODO
-
   /*! Width of the ramp when introducing the waveform in steady state mode */
   double ramp_width = 4.;
   /**
@@ -114,21 +123,18 @@ private:
    * @param zero_plane Whether we are updating terms on the 0-plane (true) or
    * the 1-plane (false). EG I0 would have this input as true, whereas J1 as
    * false.
-   * @param is_conductive Whether the medium is conductive (so J_c needs to be
-   * updated)
    * @param cell_b,cell_c The coordinates (cell_a, cell_b, cell_c) of the Yee
    * cell in which we are updating the field. See the Source doc for notation
    * information.
    * @param array_ind The index of the various material property arrays that
    * correspond to this particular Yee cell, and thus update equation.
-   * @param J_c The current density in the conductive medium
-   * @param J_s The current density in the dispersive medium
+   * @param lv The loop variables, holding the current densities in the
+   * conductive and dispersive media
    */
   void E_source_update_steadystate(double time_H, AxialDirection parallel,
-                                   bool C_axis, bool zero_plane,
-                                   bool is_conductive, int cell_b, int cell_c,
-                                   int array_ind, CurrentDensitySplitField &J_c,
-                                   CurrentDensitySplitField &J_s);
+                                   bool C_axis, bool zero_plane, int cell_b,
+                                   int cell_c, int array_ind,
+                                   LoopVariables &lv);
   /**
    * @brief Update magnetic-split field components AT A
    * PARTICULAR CELL in steady-state after an H-field timestep has been
@@ -157,41 +163,37 @@ private:
    * performed, in accordance with the I,J, and K-source terms.
    *
    * @param time_H The time the magnetic field is currently sitting at.
-   * @param is_conductive Whether the medium is conductive (so J_c needs to be
-   * updated)
-   * @param J_c The current density in the conductive medium
-   * @param J_s The current density in the dispersive medium
+   * @param lv The loop variables, holding the current densities in the
+   * conductive and dispersive media
+   * @param i_begin,i_end Only the cells with i_begin <= i < i_end are updated
    */
-  void E_source_update_all_steadystate(double time_H, bool is_conductive,
-                                       CurrentDensitySplitField &J_c,
-                                       CurrentDensitySplitField &J_s);
+  void E_source_update_all_steadystate(double time_H, LoopVariables &lv,
+                                       int i_begin, int i_end);
   /**
    * @brief [H-FIELD UPDATES] Performs updates to the magnetic-split field
    * components after an H-field timestep has been performed, in accordance with
    * the I,J, and K-source terms.
    *
    * @param time_E The time the electric field is currently sitting at.
+   * @param i_begin,i_end Only the cells with i_begin <= i < i_end are updated
    */
-  void H_source_update_all_steadystate(double time_E);
+  void H_source_update_all_steadystate(double time_E, int i_begin, int i_end);
 
   /*! @copydoc E_source_update_all_steadystate */
-  void E_Isource_update_steadystate(double time_H, bool is_conductive,
-                                    CurrentDensitySplitField &J_c,
-                                    CurrentDensitySplitField &J_s);
+  void E_Isource_update_steadystate(double time_H, LoopVariables &lv,
+                                    int i_begin, int i_end);
   /*! @copydoc E_source_update_all_steadystate */
-  void E_Jsource_update_steadystate(double time_H, bool is_conductive,
-                                    CurrentDensitySplitField &J_c,
-                                    CurrentDensitySplitField &J_s);
+  void E_Jsource_update_steadystate(double time_H, LoopVariables &lv,
+                                    int i_begin, int i_end);
   /*! @copydoc E_source_update_all_steadystate */
-  void E_Ksource_update_steadystate(double time_H, bool is_conductive,
-                                    CurrentDensitySplitField &J_c,
-                                    CurrentDensitySplitField &J_s);
+  void E_Ksource_update_steadystate(double time_H, LoopVariables &lv,
+                                    int i_begin, int i_end);
   /*! @copydoc H_source_update_all_steadystate */
-  void H_Isource_update_steadystate(double time_E);
+  void H_Isource_update_steadystate(double time_E, int i_begin, int i_end);
   /*! @copydoc H_source_update_all_steadystate */
-  void H_Jsource_update_steadystate(double time_E);
+  void H_Jsource_update_steadystate(double time_E, int i_begin, int i_end);
   /*! @copydoc H_source_update_all_steadystate */
-  void H_Ksource_update_steadystate(double time_E);
+  void H_Ksource_update_steadystate(double time_E, int i_begin, int i_end);
 
   /**
    * @brief [E-FIELD UPDATES] Performs the updates to the electric-split field
@@ -199,14 +201,12 @@ private:
    * performed, in accordance with the source terms.
    *
    * @param time_H The time the magnetic field is currently sitting at.
-   * @param is_conductive Whether the medium is conductive (so J_c needs to be
-   * updated)
-   * @param J_c The current density in the conductive medium
-   * @param J_s The current density in the dispersive medium
+   * @param lv The loop variables, holding the current densities in the
+   * conductive and dispersive media
+   * @param i_begin,i_end Only the cells with i_begin <= i < i_end are updated
    */
-  void update_source_terms_pulsed(double time_H, bool is_conductive,
-                                  CurrentDensitySplitField &J_c,
-                                  CurrentDensitySplitField &J_s);
+  void update_source_terms_pulsed(double time_H, LoopVariables &lv,
+                                  int i_begin, int i_end);
   /**
    * @brief [H-FIELD UPDATES] Performs the updates to the magnetic-split field
    * components and current density fields after an H-field timestep has been
@@ -214,8 +214,52 @@ private:
    *
    * @param time_E The time the electric field is currently sitting at.
    * @param tind The current iteration number
+   * @param i_begin,i_end Only the cells with i_begin <= i < i_end are updated
+   */
+  void update_source_terms_pulsed(double time_E, int tind, int i_begin,
+                                  int i_end);
+
+  /**
+   * @brief [E-FIELD UPDATES] Apply the source terms of the steady-state or
+   * pulsed source, whichever this simulation uses, after an E-field timestep.
+   *
+   * @param time_H The time the magnetic field is currently sitting at.
+   * @param lv Variables required from the main loop
+   * @param i_begin,i_end Only the cells with i_begin <= i < i_end are updated
+   */
+  void update_E_source_terms(double time_H, LoopVariables &lv, int i_begin,
+                             int i_end);
+  /**
+   * @brief [H-FIELD UPDATES] Apply the source terms of the steady-state or
+   * pulsed source, whichever this simulation uses, after an H-field timestep.
+   *
+   * @param time_E The time the electric field is currently sitting at.
+   * @param tind The current iteration number
+   * @param i_begin,i_end Only the cells with i_begin <= i < i_end are updated
+   */
+  void update_H_source_terms(double time_E, int tind, int i_begin, int i_end);
+
+  /**
+   * @brief Set outputs.H.ft, the time-dependence of the source of the steady-
+   * state or pulsed simulation, at the time the magnetic field is sitting at.
+   *
+   * @param time_H The time the magnetic field is currently sitting at.
+   */
+  void update_H_ft(double time_H);
+  /**
+   * @brief Set outputs.E.ft, the time-dependence of the source of the steady-
+   * state or pulsed simulation, at the time the electric field is sitting at.
+   *
+   * @param time_E The time the electric field is currently sitting at.
+   */
+  void update_E_ft(double time_E);
+  /**
+   * @brief Whether the source of a pulsed simulation has passed its peak, and
+   * its power (the square of its envelope) has fallen below fraction of its
+   * peak power, at time. The broadband incident field, which does not follow
+   * the envelope, is checked by EnergyDecay::incident_field_has_decayed.
    */
-  void update_source_terms_pulsed(double time_E, int tind);
+  bool source_has_decayed(double time, double fraction) const;
 
   /* execute() subfunctions to break up main loop */
 
@@ -223,17 +267,25 @@ private:
    * @brief Checks whether the phasors have converged in a steady-state
    * simulation.
    *
-   * E and H fields are zero'd in this method if convergence is reached. E_copy
-   * is updated to hold the converged values in this case.
+   * E and H fields are zero'd in this method if convergence is not reached,
+   * and the phasors of the period that has just ended are kept by convergence
+   * as those of the previous period.
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the comparison between them.
    *
    * @param[inout] dft_counter The number of DFTs that have been performed since
    * we began checking for convergence
-   * @param[inout] E_copy The field array that stores the phasors from the
-   * previous iteration.
+   * @param[inout] convergence The monitor that holds the phasors from the
+   * previous period.
+   * @param lv Variables required from the main loop, whose phasor
+   * accumulators are flushed to the output before the phasors are compared
    * @return true If the phasors have converged
    * @return false Phasors have not converged
    */
-  bool check_phasor_convergence(int &dft_counter, ElectricField &E_copy);
+  bool check_phasor_convergence(int &dft_counter,
+                                ConvergenceMonitor &convergence,
+                                LoopVariables &lv);
   /**
    * @brief Extracts the phasors in the volume, on the user-defined surface, and
    * at user-defined vertices.
@@ -242,17 +294,44 @@ private:
    * the corresponding steps are skipped. If the RunMode is not complete, then
    * this step is always bypassed.
    *
+   * Must be called by every thread of the parallel region of the main loop.
+   *
+   * @param dft_counter The number of DFTs that have been performed since we
+   * began checking for convergence
+   * @param tind The current iteration number
+   * @param lv Variables required from the main loop. If its phasor
+   * accumulators are enabled, the volume phasors are left to the update
+   * kernels, and only the phase terms of this timestep are set.
+   */
+  void extract_phasors(int &dft_counter, unsigned int tind, LoopVariables &lv);
+  /**
+   * @brief Extract the volume phasors of the fields at timestep tind, at the
+   * cells of cells only: every timestep of a steady-state simulation, or
+   * every Np of a pulsed one. Must be called by every thread of the team.
+   *
    * @param dft_counter The number of DFTs that have been performed since we
    * began checking for convergence
    * @param tind The current iteration number
+   * @param cells The cells whose phasors to extract
    */
-  void extract_phasors(int &dft_counter, unsigned int tind);
+  void extract_volume_phasors(int dft_counter, unsigned int tind,
+                              const CellBox &cells);
+  /**
+   * @brief Compile the interpolation stencils of the surface, vertex, and
+   * field-sample probes that are extracted in this simulation.
+   *
+   * Must be called once the storage of the split fields is final, before the
+   * main loop.
+   */
+  void compile_probes();
   /**
    * @brief Computes the detector function.
    *
    * Presumably this is the functional form of the fields/phasors at the
    * detector positions.
    *
+   * Must be called by every thread of the parallel region of the main loop.
+   *
    * @param tind The current iteraton number
    * @param lv Variables required from the main loop
    */
@@ -287,23 +366,288 @@ private:
    * we write to the log file whilst running this method, this value is updated
    * to the time of writing.
    * @param[in] tind The current iteration number.
-   * @param[inout] E_copy The object that is storing the phasors from the
-   * previous iteration, for use in convergence checking.
+   * @param[inout] convergence The monitor that is storing the phasors from
+   * the previous period, for use in convergence checking.
    */
   void end_of_iteration_steps(double &time_of_last_log, unsigned int tind,
-                              ElectricField &E_copy);
+                              ConvergenceMonitor &convergence);
 
   /* execute() subfunctions that time-propagate fields */
 
+  /*! Signature of the kernels that update the split-field components */
+  using UpdateKernel = void (SimulationManager::*)(LoopVariables &);
+
+  /**
+   * @brief Update the electric split-field components (and current densities)
+   * by one timestep. Must be called from within a parallel region.
+   *
+   * The kernel is instantiated for each combination of the solver method and
+   * the dispersive and conductive terms of the update equations, so that terms
+   * that are absent in a simulation are compiled out of the update loops.
+   *
+   * @tparam method The solver method
+   * @tparam dispersive Whether the medium or the matched layer is dispersive
+   * @tparam conductive Whether the background is conductive
+   * @param loop_variables Variables required from the main loop
+   */
+  template<tdms_flags::SolverMethod method, bool dispersive, bool conductive>
+  void update_E_split(LoopVariables &loop_variables);
+  /**
+   * @brief Update the magnetic split-field components by one timestep. Must be
+   * called from within a parallel region.
+   *
+   * @tparam method The solver method
+   * @param loop_variables Variables required from the main loop
+   */
+  template<tdms_flags::SolverMethod method>
+  void update_H_split(LoopVariables &loop_variables);
+
+  /*! @brief The Exy part of update_E_split */
+  template<tdms_flags::SolverMethod method, bool dispersive, bool conductive>
   void update_Exy(LoopVariables &lv);
+  /*! @brief The Exz part of update_E_split */
+  template<tdms_flags::SolverMethod method, bool dispersive, bool conductive>
   void update_Exz(LoopVariables &lv);
 
+  /**
+   * @brief The update_E_split kernel for FDTD simulations of non-dispersive,
+   * non-conductive media in 3D or TE mode.
+   *
+   * Each split component is updated a row at a time along the contiguous
+   * k-direction, using the vectorised kernels in stencil_kernels.h. The
+   * component loops do not wait for each other, so the caller is responsible
+   * for synchronising the threads before the updated values are read.
+   *
+   * @param loop_variables Variables required from the main loop
+   * @param cells Only the cells in this box are updated
+   */
+  void update_E_split_vectorised(LoopVariables &loop_variables,
+                                 const CellBox &cells);
+  /**
+   * @brief The update_H_split kernel for FDTD simulations in 3D or TE mode.
+   * @see update_E_split_vectorised
+   */
+  void update_H_split_vectorised(LoopVariables &loop_variables,
+                                 const CellBox &cells);
+
+  /**
+   * @brief The update_E_split kernel for FDTD simulations of a grid
+   * distributed over processes, each of which updates the cells that it owns.
+   * Must be called from within a parallel region.
+   *
+   * The halo of the H field below the owned cells is exchanged while the
+   * cells that do not read it are updated by update_E_split_vectorised, and
+   * the cells on the low faces are updated once it has arrived. The
+   * dispersive and conductive terms are applied by update_E_sparse_currents.
+   *
+   * @param lv Variables required from the main loop
+   */
+  void update_E_split_distributed(LoopVariables &lv);
+  /**
+   * @brief The update_H_split kernel for FDTD simulations of a distributed
+   * grid, which reads the halo of the E field above the owned cells.
+   * @see update_E_split_distributed
+   */
+  void update_H_split_distributed(LoopVariables &lv);
+
+  /**
+   * @brief Whether the fused engine (update_E_split_fused and
+   * update_H_split_fused) can be used: FDTD simulations in 3D or TE mode.
+   */
+  bool supports_fused_updates() const;
+  /**
+   * @brief Whether the kernels of the fused engine can accumulate the volume
+   * phasors (see PhasorAccumulator): complete steady-state runs that extract
+   * them, with the fused engine.
+   */
+  bool supports_fused_phasors() const;
+  /**
+   * @brief The update_E_split kernel of the fused engine, which updates all six
+   * split E components of a Yee cell in a single sweep over the grid. Must be
+   * called from within a parallel region.
+   *
+   * The coefficients of each field direction are looked up once per cell, and
+   * shared by its two split components, rather than in a separate pass over the
+   * grid for each component. The fields are identical to those of
+   * update_E_split.
+   *
+   * If the phasor accumulator of E is enabled, the field at each cell is added
+   * to it before the cell is updated, while the field is in cache.
+   *
+   * @tparam dispersive Whether the medium or the matched layer is dispersive
+   * @tparam conductive Whether the background is conductive
+   * @param lv Variables required from the main loop
+   */
+  template<bool dispersive, bool conductive>
+  void update_E_split_fused(LoopVariables &lv);
+  /**
+   * @brief The update_H_split kernel of the fused engine, which likewise adds
+   * the field at each cell to the phasor accumulator of H, if it is enabled.
+   * @see update_E_split_fused
+   */
+  void update_H_split_fused(LoopVariables &lv);
+
+  /**
+   * @brief Whether the fields can be stored unsplit in the interior of the
+   * grid (see unsplit_interior): FDTD simulations in 3D.
+   */
+  bool supports_unsplit_interior() const;
+  /**
+   * @brief Allocate the fields to be stored unsplit in the cells that lie
+   * outside the PML, if the update coefficients there are the same for both
+   * split components of each field direction, or split throughout the grid
+   * otherwise.
+   *
+   * The split fields of the inputs then only store the xz, yz, and zy
+   * components in the PML, which is all the storage they are ever allocated.
+   * The auxiliary fields of the loop variables follow when they are
+   * allocated, see LoopVariables::allocate_currents.
+   *
+   * @param lv Variables required from the main loop
+   * @return Whether the fields are now stored unsplit in the interior
+   */
+  bool unsplit_interior(LoopVariables &lv);
+  /**
+   * @brief The update_E_split kernel for fields that are stored unsplit in the
+   * interior. Must be called from within a parallel region.
+   *
+   * In the PML the split components are updated as by update_E_split_fused. In
+   * the interior, the xy, yx, and zx components hold the whole field, and are
+   * driven by the curl of the whole H field.
+   *
+   * @tparam dispersive Whether the medium or the matched layer is dispersive
+   * @tparam conductive Whether the background is conductive
+   * @param lv Variables required from the main loop
+   */
+  template<bool dispersive, bool conductive>
+  void update_E_unsplit(LoopVariables &lv);
+  /**
+   * @brief The update_H_split kernel for fields that are stored unsplit in the
+   * interior.
+   * @see update_E_unsplit
+   */
+  void update_H_unsplit(LoopVariables &lv);
+
+  /**
+   * @brief The update_E_split kernel for auxiliary fields that are stored only
+   * in the cells that need them (see SparseCurrents). Must be called from
+   * within a parallel region.
+   *
+   * The whole grid is updated by the non-dispersive, non-conductive kernel
+   * base, and the dispersive and conductive terms are then applied to the
+   * listed cells.
+   *
+   * @tparam base The kernel that updates the grid without the terms
+   * @param lv Variables required from the main loop
+   */
+  template<UpdateKernel base>
+  void update_E_sparse_currents(LoopVariables &lv);
+
+  /**
+   * @brief Whether the E and H fields can be advanced by update_EH_blocked:
+   * FDTD simulations of non-dispersive, non-conductive media in 3D or TE mode,
+   * with split fields throughout the grid.
+   */
+  bool supports_cache_blocking(const LoopVariables &lv) const;
+  /**
+   * @brief The width (in the i-direction) of the slabs used by
+   * update_EH_blocked, chosen so that two slabs, and the planes that n_steps
+   * timesteps shift them by, fit in the last-level cache.
+   */
+  int cache_blocking_slab_width(int n_steps);
+  /**
+   * @brief The number of timesteps, from tind and at most max_steps, that
+   * update_EH_blocked can advance the fields by in one sweep over the grid:
+   * those before the next at which the whole grid is read, by the probes, the
+   * detector functions, the measurement of the field energy, or the export of
+   * the time-domain fields, or the end of the simulation.
+   *
+   * The volume phasors are extracted by update_EH_blocked itself. The
+   * convergence of steady-state phasors is only checked once the surface
+   * phasors have been extracted Nsteps times, which ends every tile.
+   *
+   * @param tind The current iteration number
+   * @param max_steps The largest number of timesteps to return
+   * @param measures_energy Whether the field energy is measured every
+   * EnergyDecay::CHECK_INTERVAL timesteps
+   */
+  int steps_in_tile(unsigned int tind, int max_steps, bool measures_energy);
+  /**
+   * @brief Advance the E field, its source terms, and then the H field and its
+   * source terms by n_steps timesteps, one slab of the grid (in the
+   * i-direction) at a time. Must be called from within a parallel region.
+   *
+   * The H field lags the E field by one cell in the i-direction, since H at i
+   * depends on E at i + 1, and E at i on H at i - 1. The fields of a slab are
+   * therefore read from cache by the H update, rather than from memory as in a
+   * separate pass over the grid. Each later timestep of a slab lags the one
+   * before it by another cell (a skewed wavefront), so a slab is advanced by
+   * every timestep while it is in cache, and the volume phasors of the cells
+   * that have reached each timestep after the first are extracted on the way.
+   *
+   * @param lv Variables required from the main loop
+   * @param tind The iteration number of the first timestep, whose phasors
+   * have already been extracted
+   * @param n_steps The number of timesteps to advance by, at most
+   * steps_in_tile
+   * @param slab_width The number of cells in the i-direction of each slab
+   * @param dft_counter The number of DFTs that have been performed since we
+   * began checking for convergence
+   */
+  void update_EH_blocked(LoopVariables &lv, unsigned int tind, int n_steps,
+                         int slab_width, int dft_counter);
+
+  /**
+   * @brief Whether the updates can be restricted to the active region (see
+   * ActiveRegion): pulsed simulations that support cache blocking, whose
+   * E and H updates are those of update_E_split_vectorised and
+   * update_H_split_vectorised.
+   */
+  bool supports_active_region(const LoopVariables &lv) const;
+  /**
+   * @brief Whether the grid can be distributed over processes: FDTD and PSTD
+   * simulations in 3D that neither compute the detector functions
+   * (exdetintegral) nor export the time-domain fields, as those read planes
+   * of the whole grid.
+   */
+  bool supports_distributed() const;
+
+  /**
+   * @brief The cells whose fields the pulsed source terms update: the planes
+   * either side of the K0 interface, through which the pulse enters
+   */
+  CellBox pulsed_source_cells();
+
+  /**
+   * @brief Select the instantiation of update_E_split that matches the
+   * solver method and the medium of this simulation, of update_E_unsplit if
+   * the fields are stored unsplit in the interior, or of update_E_split_fused
+   * if the fused engine was requested and is supported, or
+   * update_E_split_distributed for FDTD on a distributed grid. Any of these
+   * is wrapped by update_E_sparse_currents if the auxiliary fields are sparse.
+   *
+   * @param lv Variables required from the main loop
+   */
+  UpdateKernel select_E_update_kernel(const LoopVariables &lv) const;
+  /** @brief Select the instantiation of update_H_split that matches the solver
+   * method of this simulation, update_H_unsplit, update_H_split_fused, or
+   * update_H_split_distributed. */
+  UpdateKernel select_H_update_kernel() const;
+
 public:
-  SimulationManager(InputMatrices in_matrices, const InputFlags &in_flags);
+  SimulationManager(InputMatrices in_matrices, const InputFlags &in_flags,
+                    const SolverOptions &options = SolverOptions());
 
   /** @brief Fetch the number of Yee cells in each dimension */
   IJKDimensions n_Yee_cells() { return inputs.IJK_tot; }
 
+  /** @brief Fetch the split E field, as advanced by execute() */
+  const ElectricSplitField &E_field() const { return inputs.E_s; }
+  /** @brief Fetch the split H field, as advanced by execute() */
+  const MagneticSplitField &H_field() const { return inputs.H_s; }
+  /** @brief Fetch the outputs, such as the phasors extracted by execute() */
+  const OutputMatrices &get_outputs() const { return outputs; }
+
   /** @brief Run the time-stepping algorithm given the current inputs. */
   void execute();
 
@@ -312,6 +656,8 @@ public:
    * depending on the simulation inputs and run specifications.
    *
    * This should only be run AFTER a successful run of the execute() method.
+   * If the grid is distributed, the outputs other than maxresfield are
+   * completed on the root process only.
    */
   void post_loop_processing();
 
@@ -319,12 +665,16 @@ public:
    * @brief Write the outputs to the file provided. Wrapper for
    * outputs.save_outputs
    *
+   * If the grid is distributed, only the root process, which holds the
+   * phasors of every process, writes the outputs.
+   *
    * @param output_file The filename to write the outputs to
    * @param compressed_format If true, write compressed output (do not write
    * facets and vertices)
    */
   void write_outputs_to_file(std::string output_file,
                              bool compressed_format = false) {
+    if (!partition->is_root()) { return; }
     outputs.save_outputs(output_file, compressed_format);
   }
 };
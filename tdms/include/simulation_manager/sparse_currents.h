@@ -0,0 +1,132 @@
+/**
+ * @file sparse_currents.h
+ * @brief Storage of the auxiliary fields of the dispersive and conductive
+ * update terms at only the cells in which those terms are present.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "cell_coordinate.h"
+#include "field.h"
+#include "simulation_manager/update_coefficients.h"
+
+/**
+ * @brief The auxiliary fields (E_nm1, J_s, J_nm1, and J_c) of the dispersive
+ * and conductive terms of the E-field update equations, stored for each split
+ * component as a list of the cells in which the terms are present.
+ *
+ * The dispersive terms are only present where the gamma of a component is
+ * non-zero, and the conductive term where its rho is, which in a simulation
+ * of a scatterer is a small part of the grid. The terms are applied by passes
+ * over the listed cells either side of the update of the whole grid without
+ * them:
+ * - save_fields records the field in the listed cells before the update,
+ * - apply then adds the dispersive and conductive terms to the updated field,
+ * and advances the auxiliary fields.
+ *
+ * The arithmetic is that of the dispersive update loops, so the memory and
+ * bandwidth of the auxiliary fields scale with the size of the scatterer
+ * rather than that of the grid, without changing the fields.
+ */
+class SparseCurrents {
+private:
+  /*! The cells of one split component in which its terms are present, and
+   * the auxiliary fields in those cells */
+  struct ComponentCells {
+    /*! The cells, in lexicographic (i, j, k) order */
+    std::vector<CellCoordinate> cells;
+    /*! The coefficients of the component in each cell */
+    std::vector<const ECoefficients *> coefficients;
+    /*! The field in each cell before the update of the grid */
+    std::vector<double> E_n;
+    std::vector<double> E_nm1, J_s, J_nm1;//< Empty if not dispersive
+    std::vector<double> J_c;              //< Empty if not conductive
+    /*! The grid spacing of the finite difference driving the component */
+    double delta = 0.;
+  };
+
+  /*! The split components, in the order xy, xz, yx, yz, zx, zy */
+  ComponentCells components_[6];
+  bool active_ = false;
+  bool dispersive_ = false, conductive_ = false;
+  double dt_ = 0.;
+  /*! The cells in which the E field is stored unsplit */
+  CellBox unsplit_;
+
+  /** @brief Position of a split component in components_ */
+  static int index_of(SplitComponent component);
+
+  /**
+   * @brief The value of an auxiliary field of a component at a cell, or
+   * nullptr if it is not stored there.
+   *
+   * Where the E field is stored unsplit, the xz, yz, and zy components are
+   * accounted for by the xy, yx, and zx components respectively.
+   */
+  double *find(std::vector<double> ComponentCells::*field,
+               SplitComponent component, const CellCoordinate &cell);
+
+public:
+  /**
+   * @brief List the cells in which the dispersive or conductive terms of each
+   * split component are present, and allocate (and zero) their auxiliary
+   * fields.
+   *
+   * Only the cells in cells that the E-field update loops of an FDTD
+   * simulation visit, and that E_s stores, are listed.
+   *
+   * @param coefficients The update coefficients of every cell
+   * @param E_s The electric split field that will be updated
+   * @param cells The cells that are updated: those that this process owns, if
+   * the grid is distributed
+   * @param J_loop_upper_bound,J_loop_upper_bound_plus_1 The bounds of the
+   * update loops in the j-direction, see LoopVariables
+   * @param delta The dimensions of the Yee cells
+   * @param dt The timestep
+   * @param dispersive Whether the dispersive terms are present
+   * @param conductive Whether the conductive terms are present
+   */
+  void build(const UpdateCoefficientPlan &coefficients,
+             const ElectricSplitField &E_s, const CellBox &cells,
+             int J_loop_upper_bound,
+             int J_loop_upper_bound_plus_1, const YeeCellDimensions &delta,
+             double dt, bool dispersive, bool conductive);
+
+  /** @brief Discard the cells and their auxiliary fields */
+  void clear();
+
+  /** @brief Whether the auxiliary fields are stored in this object */
+  bool is_active() const { return active_; }
+
+  /** @brief Total number of cells listed, across all the split components */
+  size_t n_cells() const;
+
+  /** @brief Number of bytes used to store the cells and auxiliary fields */
+  size_t n_bytes() const;
+
+  /**
+   * @brief Record the field in the listed cells, before it is updated. Must be
+   * called from within a parallel region.
+   */
+  void save_fields(const ElectricSplitField &E_s);
+
+  /**
+   * @brief Add the dispersive and conductive terms to the field in the listed
+   * cells, and advance their auxiliary fields, once the field has been updated
+   * without them. Must be called from within a parallel region.
+   */
+  void apply(ElectricSplitField &E_s);
+
+  /** @brief The conductive current density of a component at a cell, or
+   * nullptr if the component is not conductive there */
+  double *J_c(SplitComponent component, const CellCoordinate &cell) {
+    return find(&ComponentCells::J_c, component, cell);
+  }
+  /** @brief The dispersive current density of a component at a cell, or
+   * nullptr if the component is not dispersive there */
+  double *J_s(SplitComponent component, const CellCoordinate &cell) {
+    return find(&ComponentCells::J_s, component, cell);
+  }
+};
@@ -0,0 +1,303 @@
+/**
+ * @file update_coefficients.h
+ * @brief Per-cell coefficients of the split-field update equations, resolved
+ * once before the main loop so that the update loops can stream them without
+ * re-deriving them from the materials array at every timestep.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <omp.h>
+
+#include "arrays/tensor3d.h"
+#include "cell_coordinate.h"
+#include "simulation_manager/objects_from_infile.h"
+
+/**
+ * @brief Coefficients entering the update equation of one split E-field
+ * component at one Yee cell.
+ *
+ * Ca, Cb, Cc already include the averaging across the material interface (when
+ * interp_mat_props is set), and the dispersive parameters include the
+ * averaging between the cell and its neighbour.
+ */
+struct ECoefficients {
+  double Ca = 0., Cb = 0., Cc = 0.;//< Update coefficients
+  double rho = 0.;  //< Conductivity of the background (0 if not conductive)
+  double alpha = 0.;//< Dispersion parameter alpha of the (averaged) layer
+  double beta = 0.; //< Dispersion parameter beta of the (averaged) layer
+  double gamma = 0.;//< Attenuation constant of the (averaged) layer
+  double kappa = 1.;//< Matched-layer kappa
+  double sigma = 0.;//< Matched-layer sigma
+};
+
+/**
+ * @brief Coefficients entering the update equation of one split H-field
+ * component at one Yee cell.
+ */
+struct HCoefficients {
+  double Da = 0., Db = 0.;
+};
+
+/**
+ * @brief The coefficients of both split components of a field direction at one
+ * Yee cell.
+ *
+ * For the x-direction the split components are ordered {xy, xz}, for y {yx,
+ * yz}, and for z {zx, zy}.
+ */
+struct CellCoefficients {
+  ECoefficients E[2];
+  HCoefficients H[2];
+};
+
+/**
+ * @brief Compact per-cell lookup of CellCoefficients.
+ *
+ * The distinct coefficient records are stored once, and each Yee cell stores a
+ * 32-bit index into them. Since the number of distinct records is governed by
+ * the number of layers and materials rather than the number of cells, the
+ * record table is small and stays resident in cache during the update loops.
+ */
+class CoefficientTable {
+private:
+  std::vector<CellCoefficients> records_;//< The distinct records
+  //! Index into records_, per Yee cell
+  Tensor3D<uint32_t, FieldAllocator<uint32_t>> index_;
+
+  struct RecordHash {
+    size_t operator()(const CellCoefficients &record) const {
+      return std::hash<std::string_view>{}(std::string_view(
+              reinterpret_cast<const char *>(&record), sizeof(record)));
+    }
+  };
+  struct RecordEqual {
+    bool operator()(const CellCoefficients &a,
+                    const CellCoefficients &b) const {
+      return std::memcmp(&a, &b, sizeof(CellCoefficients)) == 0;
+    }
+  };
+
+public:
+  /** @brief Retrieve the coefficients at Yee cell (i, j, k) */
+  const CellCoefficients &operator()(int i, int j, int k) const {
+    return records_[index_(i, j, k)];
+  }
+
+  /** @brief Number of distinct records in the table */
+  size_t n_records() const { return records_.size(); }
+
+  /**
+   * @brief Populate the table over the Yee cells (0..I_tot, 0..J_tot, 0..K_tot)
+   *
+   * Each thread deduplicates the records of the slabs it is assigned, and the
+   * per-thread tables are then concatenated. Identical records found by
+   * different threads are stored more than once, which is harmless.
+   *
+   * @param I_tot,J_tot,K_tot Number of Yee cells in each axial direction
+   * @param coefficients_at Callable (i, j, k) -> CellCoefficients
+   */
+  template<typename CoefficientFunction>
+  void build(int I_tot, int J_tot, int K_tot,
+             CoefficientFunction coefficients_at) {
+    build({{0, 0, 0}, {I_tot + 1, J_tot + 1, K_tot + 1}}, coefficients_at);
+  }
+  /**
+   * @brief Populate the table over a box of Yee cells only, those that a
+   * process of a distributed grid stores. The coefficients of the other cells
+   * must not be retrieved.
+   */
+  template<typename CoefficientFunction>
+  void build(const CellBox &cells, CoefficientFunction coefficients_at) {
+    index_.allocate(cells);
+    int max_threads = omp_get_max_threads();
+    std::vector<std::vector<CellCoefficients>> thread_records(max_threads);
+    std::vector<uint32_t> offsets(max_threads + 1, 0);
+
+#pragma omp parallel default(shared)
+    {
+      int n = omp_get_thread_num();
+      std::vector<CellCoefficients> &local_records = thread_records[n];
+      std::unordered_map<CellCoefficients, uint32_t, RecordHash, RecordEqual>
+              seen;
+      uint32_t last = 0;//< Index of the most recently used record
+
+#pragma omp for schedule(static)
+      for (int i = cells.lower.i; i < cells.upper.i; i++) {
+        for (int j = cells.lower.j; j < cells.upper.j; j++) {
+          for (int k = cells.lower.k; k < cells.upper.k; k++) {
+            CellCoefficients record = coefficients_at(i, j, k);
+            // neighbouring cells usually share their record, so avoid hashing
+            if (local_records.empty() ||
+                !RecordEqual()(record, local_records[last])) {
+              auto found = seen.find(record);
+              if (found == seen.end()) {
+                found = seen.emplace(record, (uint32_t) local_records.size())
+                                .first;
+                local_records.push_back(record);
+              }
+              last = found->second;
+            }
+            index_(i, j, k) = last;
+          }
+        }
+      }
+
+#pragma omp single
+      {
+        for (int t = 0; t < max_threads; t++) {
+          offsets[t + 1] = offsets[t] + (uint32_t) thread_records[t].size();
+        }
+      }
+
+      // The static schedule assigns the same slabs to the same threads
+#pragma omp for schedule(static)
+      for (int i = cells.lower.i; i < cells.upper.i; i++) {
+        for (int j = cells.lower.j; j < cells.upper.j; j++) {
+          for (int k = cells.lower.k; k < cells.upper.k; k++) {
+            index_(i, j, k) += offsets[n];
+          }
+        }
+      }
+    }
+
+    records_.clear();
+    records_.reserve(offsets[max_threads]);
+    for (auto &local_records : thread_records) {
+      records_.insert(records_.end(), local_records.begin(),
+                      local_records.end());
+    }
+  }
+};
+
+/**
+ * @brief The update coefficients of every split field component, at every Yee
+ * cell, for the duration of the main loop.
+ *
+ * The coefficients reproduce exactly the values that the update loops derive
+ * from the materials array, the layer structure (is_structure,
+ * is_multilayer), interp_mat_props, and the dispersive and conductive
+ * properties of the medium.
+ */
+class UpdateCoefficientPlan {
+private:
+  CoefficientTable x_, y_, z_;//< Tables for the x, y, and z field directions
+
+public:
+  UpdateCoefficientPlan() = default;
+
+  /**
+   * @brief Resolve the update coefficients at every Yee cell that data.E_s
+   * stores
+   *
+   * @param data The objects and data obtained from the input file
+   * @param is_dispersive Whether the medium is dispersive
+   * @param is_conductive Whether the background is conductive
+   * @param n_non_pml_cells_in_K Number of non-pml cells in the K-direction
+   */
+  UpdateCoefficientPlan(const ObjectsFromInfile &data, bool is_dispersive,
+                        bool is_conductive, int n_non_pml_cells_in_K);
+
+  /**
+   * @brief Populate the plan from the coefficients of each field direction
+   *
+   * @param I_tot,J_tot,K_tot Number of Yee cells in each axial direction
+   * @param x_at,y_at,z_at Callables (i, j, k) -> CellCoefficients of the x,
+   * y, and z-directed components
+   */
+  template<typename XFunction, typename YFunction, typename ZFunction>
+  void build(int I_tot, int J_tot, int K_tot, XFunction x_at, YFunction y_at,
+             ZFunction z_at) {
+    build({{0, 0, 0}, {I_tot + 1, J_tot + 1, K_tot + 1}}, x_at, y_at, z_at);
+  }
+  /**
+   * @brief Populate the plan over a box of Yee cells only
+   * @see CoefficientTable::build(const CellBox &, CoefficientFunction)
+   */
+  template<typename XFunction, typename YFunction, typename ZFunction>
+  void build(const CellBox &cells, XFunction x_at, YFunction y_at,
+             ZFunction z_at) {
+    x_.build(cells, x_at);
+    y_.build(cells, y_at);
+    z_.build(cells, z_at);
+  }
+
+  /** @brief The coefficients of the x-directed components at cell (i, j, k) */
+  const CellCoefficients &x(int i, int j, int k) const { return x_(i, j, k); }
+  /** @brief The coefficients of the y-directed components at cell (i, j, k) */
+  const CellCoefficients &y(int i, int j, int k) const { return y_(i, j, k); }
+  /** @brief The coefficients of the z-directed components at cell (i, j, k) */
+  const CellCoefficients &z(int i, int j, int k) const { return z_(i, j, k); }
+
+  const ECoefficients &Exy(int i, int j, int k) const {
+    return x_(i, j, k).E[0];
+  }
+  const ECoefficients &Exz(int i, int j, int k) const {
+    return x_(i, j, k).E[1];
+  }
+  const ECoefficients &Eyx(int i, int j, int k) const {
+    return y_(i, j, k).E[0];
+  }
+  const ECoefficients &Eyz(int i, int j, int k) const {
+    return y_(i, j, k).E[1];
+  }
+  const ECoefficients &Ezx(int i, int j, int k) const {
+    return z_(i, j, k).E[0];
+  }
+  const ECoefficients &Ezy(int i, int j, int k) const {
+    return z_(i, j, k).E[1];
+  }
+
+  const HCoefficients &Hxy(int i, int j, int k) const {
+    return x_(i, j, k).H[0];
+  }
+  const HCoefficients &Hxz(int i, int j, int k) const {
+    return x_(i, j, k).H[1];
+  }
+  const HCoefficients &Hyx(int i, int j, int k) const {
+    return y_(i, j, k).H[0];
+  }
+  const HCoefficients &Hyz(int i, int j, int k) const {
+    return y_(i, j, k).H[1];
+  }
+  const HCoefficients &Hzx(int i, int j, int k) const {
+    return z_(i, j, k).H[0];
+  }
+  const HCoefficients &Hzy(int i, int j, int k) const {
+    return z_(i, j, k).H[1];
+  }
+
+  /**
+   * @brief Whether the two split components of each field direction have the
+   * same update coefficients throughout a box of cells, so that only the sum
+   * of the components needs to be stored there.
+   *
+   * Cb is inversely proportional to the grid spacing of the finite difference
+   * that it multiplies, so may differ between the components. The terms of
+   * the current densities are proportional to Cb times that spacing, which
+   * must then agree.
+   *
+   * @param box The cells to check
+   * @param delta The dimensions of the Yee cells
+   * @param with_currents Whether the dispersive or conductive terms are present
+   */
+  bool is_isotropic_in(const CellBox &box, const YeeCellDimensions &delta,
+                       bool with_currents) const;
+
+  /** @brief Total number of distinct records across the three tables */
+  size_t n_records() const {
+    return x_.n_records() + y_.n_records() + z_.n_records();
+  }
+};
+
+/*! Accessor of the coefficients of one split E-field component */
+using ECoefficientsAt =
+        const ECoefficients &(UpdateCoefficientPlan::*)(int, int, int) const;
+/*! Accessor of the coefficients of one split H-field component */
+using HCoefficientsAt =
+        const HCoefficients &(UpdateCoefficientPlan::*)(int, int, int) const;
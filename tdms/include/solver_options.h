@@ -0,0 +1,112 @@
+/**
+ * @file solver_options.h
+ * @brief Options, set on the command line, that affect how the solver carries
+ * out a simulation, but not the physics that it simulates.
+ */
+#pragma once
+
+#include <string>
+
+/**
+ * @brief How thoroughly FFTW searches for the fastest plan of each transform
+ * of the PSTD derivatives. A more rigorous search takes longer, but may find a
+ * faster plan.
+ */
+enum class FFTPlanning { Estimate, Measure, Patient, Exhaustive };
+
+/**
+ * @brief The library that computes the FFTs of the PSTD derivatives and of the
+ * detector transforms.
+ */
+enum class FFTLibrary { FFTW, Builtin };
+
+/**
+ * @brief The phasors whose change over a period decides whether a
+ * steady-state simulation has converged: those in the volume, or those on the
+ * surface.
+ */
+enum class ConvergenceSet { Volume, Surface };
+
+/**
+ * @brief Execution options of the solver.
+ *
+ * Unlike the InputFlags, which are read from the input file and select the
+ * numerical method, these options are performance-related. The defaults
+ * reproduce the behaviour of TDMS without any options passed.
+ */
+struct SolverOptions {
+  /*! Advance the FDTD E and H fields together, a cache-sized slab of the grid
+   * at a time (-b, --cache-blocking) */
+  bool cache_blocking = false;
+  /*! The largest number of timesteps by which cache blocking advances each
+   * slab before moving on to the next (--tile-steps=<steps>, which implies
+   * --cache-blocking) */
+  int tile_steps = 4;
+  /*! The width, in cells along i, of the slabs of cache blocking, or 0 to fit
+   * two slabs in the last-level cache (--slab-width=<cells>, which implies
+   * --cache-blocking) */
+  int slab_width = 0;
+  /*! Update all the split components of a Yee cell in a single sweep over the
+   * grid, rather than a sweep per component (-f, --fused-updates). Has no
+   * effect when cache blocking is in use. */
+  bool fused_updates = false;
+  /*! Accumulate the volume phasors of a steady-state simulation in the sweeps
+   * of the fused engine, rather than in a sweep of their own
+   * (--fused-phasors, which implies --fused-updates). Has no effect when cache
+   * blocking is in use or the interior of the grid is unsplit. */
+  bool fused_phasors = false;
+  /*! Back the field arrays with transparent huge pages (--huge-pages) */
+  bool huge_pages = false;
+  /*! Pad the rows of the split fields to whole cache lines (--pad-rows) */
+  bool pad_rows = false;
+  /*! Store the FDTD fields unsplit outside the PML, keeping the split
+   * components in the PML only (--unsplit-interior). Has no effect when the
+   * update coefficients of the split components differ outside the PML, and
+   * takes precedence over cache blocking and fused updates. */
+  bool unsplit_interior = false;
+  /*! The library that computes the FFTs (--fft-backend=fftw or builtin) */
+  FFTLibrary fft_library = FFTLibrary::FFTW;
+  /*! The rigour of the FFTW planner (--fftw-planning=estimate, measure,
+   * patient, or exhaustive) */
+  FFTPlanning fftw_planning = FFTPlanning::Measure;
+  /*! File that FFTW wisdom is imported from before planning, and exported to
+   * afterwards, or empty for none (--fftw-wisdom=<file>) */
+  std::string fftw_wisdom;
+  /*! Differentiate the segments of the lines of the grid around the
+   * interfaces between materials by finite differences, and the rest of the
+   * lines spectrally (--hybrid-pstd). Has no effect in an FDTD simulation. */
+  bool hybrid_pstd = false;
+  /*! The number of cells either side of an interface that the hybrid solver
+   * differentiates by finite differences, and over which it then blends them
+   * into the spectral derivative (--hybrid-overlap=<cells>) */
+  int hybrid_overlap = 2;
+  /*! Only update the cells that the fields of a pulsed simulation can have
+   * reached (--active-region). Has no effect unless the simulation supports
+   * cache blocking, and takes precedence over fused updates. */
+  bool active_region = false;
+  /*! Shrink the active region to the cells whose fields exceed this fraction
+   * of the largest field, or 0 to never shrink it
+   * (--active-region-threshold=<fraction>, which implies --active-region) */
+  double active_region_threshold = 0.;
+  /*! Stop a pulsed simulation early once the source has passed and the field
+   * energy has decayed below this fraction of its peak, or 0 to always run
+   * all Nt timesteps (--energy-decay=<fraction>) */
+  double energy_decay = 0.;
+  /*! The phasors whose convergence is checked in a steady-state simulation
+   * (--convergence-on=volume or surface) */
+  ConvergenceSet convergence_set = ConvergenceSet::Volume;
+  /*! Check the convergence of the volume phasors at every this many cells in
+   * each direction only (--convergence-stride=<cells>) */
+  int convergence_stride = 1;
+  /*! Extract the volume phasors of a pulsed simulation at every frequency of
+   * the frequency extraction vector, as well as at omega_an
+   * (--volume-spectrum) */
+  bool volume_spectrum = false;
+  /*! Evaluate the fields at the surface, vertex, and field-sample probes with
+   * interpolation stencils compiled before the main loop, rather than
+   * interpolating at each probe in turn (--compiled-probes) */
+  bool compiled_probes = false;
+  /*! Distribute the cells of the grid over the MPI processes that TDMS is
+   * launched on (--distributed). Only available in builds with TDMS_MPI. */
+  bool distributed = false;
+};
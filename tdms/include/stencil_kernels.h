@@ -0,0 +1,68 @@
+/**
+ * @file stencil_kernels.h
+ * @brief Vectorised kernels for the finite-difference update equations.
+ *
+ * The kernels update a contiguous row of a split-field component (along the
+ * fastest-varying k-direction of a Tensor3D), and are implemented for AVX-512,
+ * AVX2, and plain scalar code. The implementation is selected at runtime, from
+ * the instruction sets that the CPU supports.
+ *
+ * Kernels are provided for double and single precision fields (see field_t).
+ * The update coefficients are double precision in both cases.
+ */
+#pragma once
+
+#include <string>
+
+/** @brief The instruction sets that the stencil kernels are implemented for */
+enum class SimdLevel { SCALAR, AVX2, AVX512 };
+
+/**
+ * @brief The widest instruction set supported by both the build and a CPU with
+ * the given extensions: the scalar kernels if the build has no vectorised
+ * kernels, or the CPU supports neither AVX2 nor AVX-512F.
+ */
+SimdLevel select_simd_level(bool cpu_has_avx2, bool cpu_has_avx512f);
+
+/** @brief The widest instruction set supported by both the build and the CPU */
+SimdLevel detected_simd_level();
+
+/** @brief Name of an instruction set, for logging */
+std::string to_string(SimdLevel level);
+
+/**
+ * @brief Signature of the kernels that update a row of a field component,
+ *
+ *   field[k] = a[k] * field[k] + b[k] * (plus_1[k] + plus_2[k] - minus_1[k] -
+ *   minus_2[k]),
+ *
+ * for k = 0, ..., n - 1. The terms are evaluated in exactly this order, so
+ * every implementation reproduces the result of the scalar update bit-for-bit.
+ * For single precision fields that is: the difference of the fields in single
+ * precision, the remainder in double precision, rounded to single precision
+ * when stored.
+ *
+ * @tparam T Scalar type of the field
+ */
+template<typename T>
+using CurlUpdateRow = void (*)(int n, T *field, const double *a,
+                               const double *b, const T *plus_1,
+                               const T *plus_2, const T *minus_1,
+                               const T *minus_2);
+
+/**
+ * @brief The implementation of the row update for the given instruction set.
+ * @note The instruction set must be supported by the CPU, see
+ * detected_simd_level.
+ */
+template<typename T>
+CurlUpdateRow<T> curl_update_row_kernel(SimdLevel level);
+
+/**
+ * @brief Update a row of a field component with the widest implementation that
+ * the CPU supports. See CurlUpdateRow for the update performed.
+ */
+template<typename T>
+void curl_update_row(int n, T *field, const double *a, const double *b,
+                     const T *plus_1, const T *plus_2, const T *minus_1,
+                     const T *minus_2);
@@ -4,9 +4,13 @@
  */
 #pragma once
 
+#include <complex>
+#include <vector>
+
 #include "arrays.h"
 #include "field.h"
 #include "grid_labels.h"
+#include "probe_stencils.h"
 
 /**
  * @brief A class that handles the extraction of the phasors on the
@@ -43,6 +47,18 @@ private:
   double ***surface_EHr = nullptr,
          ***surface_EHi = nullptr;//!< @copydoc surface_EHr
 
+  /**
+   * @brief The fields at a vertex of the surface, interpolated to its centre if
+   * interpolate is true, and otherwise those at the vertex itself
+   */
+  FullFieldSnapshot fields_at(int vertex_index, ElectricSplitField &E,
+                              MagneticSplitField &H, Dimension dimension,
+                              bool interpolate);
+
+  /*! Probes of Ex, Ey, Ez (and Hx, Hy, Hz) at each vertex, in that order, if
+   * they have been compiled */
+  ProbeStencils E_probes, H_probes;
+
 public:
   SurfacePhasors() = default;
   /**
@@ -80,6 +96,12 @@ public:
    */
   int get_n_surface_vertices() { return n_surface_vertices; };
 
+  /**
+   * @brief The complex amplitudes of every frequency, field component, and
+   * vertex, in that order (the vertex index varying fastest)
+   */
+  std::vector<std::complex<double>> amplitudes() const;
+
   /**
    * @brief Get the list of vertices
    */
@@ -117,12 +139,58 @@ public:
    * @param params The parameters for this simulation
    * @param interpolate If true, perform interpolation on the fields when
    * extracting phasors
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the vertices between them.
    */
   void extractPhasorsSurface(int frequency_index, ElectricSplitField &E,
                              MagneticSplitField &H, int n, double omega, int Nt,
                              SimulationParameters &params,
                              bool interpolate = true);
 
+  /**
+   * @brief Compile the stencils of the fields at the vertices on the surface,
+   * which the extraction at every frequency then uses in place of
+   * interpolating the fields at each vertex in turn
+   *
+   * @param E,H The electric,magnetic field, whose storage is final
+   * @param dimension The dimension of the simulation
+   * @param interpolate If true, interpolate the fields to the vertices
+   * @param partition The partition of the grid over the processes, or nullptr
+   * if the grid is not distributed
+   */
+  void compile_probes(ElectricSplitField &E, MagneticSplitField &H,
+                      Dimension dimension, bool interpolate,
+                      const GridPartition *partition = nullptr);
+
+  /**
+   * @brief Extract the phasor values at the vertices on the surface, for every
+   * frequency of the frequency extraction vector
+   *
+   * Equivalent to calling extractPhasorsSurface for each frequency index in
+   * turn, but the fields at each vertex are interpolated once, rather than
+   * once per frequency, and the phase terms of every frequency are computed
+   * before the vertices are visited.
+   * If the probes have been compiled, the fields at every vertex are
+   * evaluated with them (and interpolate is that of compile_probes).
+   *
+   * @param E,H The electric,magnetic field
+   * @param n Current timestep index
+   * @param frequencies The frequency extraction vector, of f_ex_vector_size
+   * frequencies (not angular frequencies)
+   * @param Nt The number of timesteps in a sinusoidal period
+   * @param params The parameters for this simulation
+   * @param interpolate If true, perform interpolation on the fields when
+   * extracting phasors
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the vertices between them.
+   */
+  void extractPhasorsSurface(ElectricSplitField &E, MagneticSplitField &H,
+                             int n, const std::vector<double> &frequencies,
+                             int Nt, SimulationParameters &params,
+                             bool interpolate = true);
+
   /**
    * @brief Pulls the GridLabels information of vertices on the surface into
    * vertex_list, a continuous block of memory.
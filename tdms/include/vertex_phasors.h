@@ -11,6 +11,7 @@
 #include "arrays/vector_typedefs.h"
 #include "field.h"
 #include "grid_labels.h"
+#include "probe_stencils.h"
 #include "utils.h"
 
 /**
@@ -54,6 +55,14 @@ private:
   double ***camplitudesR = nullptr,
          ***camplitudesI = nullptr;//!< @copydoc camplitudesR
 
+  /** @brief The fields at a vertex, interpolated to its centre */
+  FullFieldSnapshot fields_at(int vertex_index, ElectricSplitField &E,
+                              MagneticSplitField &H, Dimension dimension);
+
+  /*! Probes of Ex, Ey, Ez (and Hx, Hy, Hz) at each vertex, in that order, if
+   * they have been compiled */
+  ProbeStencils E_probes, H_probes;
+
 public:
   VertexPhasors() = default;
   /*! @copydoc set_from */
@@ -120,11 +129,52 @@ public:
    * @param n Current timestep index
    * @param omega Angular frequency
    * @param params The parameters for this simulation
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the vertices between them.
    */
   void extractPhasorsVertices(int frequency_index, ElectricSplitField &E,
                               MagneticSplitField &H, int n, double omega,
                               SimulationParameters &params);
 
+  /**
+   * @brief Compile the stencils of the fields at the vertices, which the
+   * extraction at every frequency then uses in place of interpolating the
+   * fields at each vertex in turn
+   *
+   * @param E,H The electric,magnetic split field, whose storage is final
+   * @param dimension The dimension of the simulation
+   * @param partition The partition of the grid over the processes, or nullptr
+   * if the grid is not distributed
+   */
+  void compile_probes(ElectricSplitField &E, MagneticSplitField &H,
+                      Dimension dimension,
+                      const GridPartition *partition = nullptr);
+
+  /**
+   * @brief Extract the phasor values at the vertices, for every frequency of
+   * the frequency extraction vector
+   *
+   * Equivalent to calling extractPhasorsVertices for each frequency index in
+   * turn, but the fields at each vertex are interpolated once, rather than
+   * once per frequency, and the phase terms of every frequency are computed
+   * before the vertices are visited.
+   * If the probes have been compiled, the fields at every vertex are
+   * evaluated with them.
+   *
+   * @param E,H The electric,magnetic split field
+   * @param n Current timestep index
+   * @param frequencies The frequency extraction vector, of f_ex_vector_size
+   * frequencies (not angular frequencies)
+   * @param params The parameters for this simulation
+   *
+   * Within a parallel region, must be called by every thread of the team,
+   * which share the vertices between them.
+   */
+  void extractPhasorsVertices(ElectricSplitField &E, MagneticSplitField &H,
+                              int n, const std::vector<double> &frequencies,
+                              SimulationParameters &params);
+
   /**
    * @brief Incriments camplitudes{R,I} at the given index by the field values
    * provided.
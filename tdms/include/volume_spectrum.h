@@ -0,0 +1,140 @@
+/**
+ * @file volume_spectrum.h
+ * @brief Contains a class that handles the extraction of the volume phasors at
+ * every frequency of the frequency extraction vector.
+ */
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "cell_coordinate.h"
+#include "field.h"
+#include "grid_partition.h"
+
+/**
+ * @brief The phasors of the E and H fields over the volume of the output
+ * fields (outputs.E and outputs.H), at several frequencies, extracted in a
+ * single pulsed simulation.
+ *
+ * The phasors are accumulated as those of outputs.E and outputs.H are, at the
+ * frequencies of the frequency extraction vector rather than at omega_an.
+ * The phase terms of a timestep are those of the previous extraction times a
+ * fixed rotation per frequency, rather than an exponential of each, and are
+ * recomputed exactly every RESEED_INTERVAL extractions to bound the rounding
+ * errors of the recurrence.
+ *
+ * The phasors of a cell are stored with the frequency varying fastest, so that
+ * the accumulation of a field value at every frequency is a single vectorised
+ * loop, and the cells with k varying fastest, as the split fields are.
+ *
+ * Components are indexed 0 to 5 for Ex, Ey, Ez, Hx, Hy, and Hz.
+ */
+class VolumeSpectrum {
+private:
+  std::vector<double> omega_;//< Angular frequencies of the phasors
+  double dt_ = 0.;           //< Timestep of the simulation
+  int interval_ = 1;         //< Number of timesteps between extractions
+  int Nt_ = 1;               //< Number of extractions the phasors sum over
+  CellBox box_;              //< The cells of the phasors
+
+  //! The phase terms of E at the last extraction, divided by Nt_
+  std::vector<std::complex<double>> E_phase_;
+  //! The rotation of the phase terms of E between extractions
+  std::vector<std::complex<double>> rotation_;
+  //! The phase of H, half a timestep after E, relative to that of E
+  std::vector<std::complex<double>> half_step_;
+  //! The real and imaginary parts of the phase terms of E (0) and H (1) of the
+  //! current extraction
+  std::vector<double> phase_real_[2], phase_imag_[2];
+  int last_tind_ = -1;  //< The timestep of the last extraction
+  int n_rotations_ = 0; //< Extractions since the phases were last recomputed
+
+  //! The real and imaginary parts of the phasors of each component, indexed
+  //! by cell then frequency
+  std::vector<double> real_[6], imag_[6];
+
+  /** @brief The index of the first phasor of cell (i, j, k) */
+  size_t index_of(int i, int j, int k) const {
+    size_t n_j = box_.upper.j - box_.lower.j, n_k = box_.upper.k - box_.lower.k;
+    return (((i - box_.lower.i) * n_j + (j - box_.lower.j)) * n_k +
+            (k - box_.lower.k)) *
+           omega_.size();
+  }
+
+  /** @brief Set the phase terms of the extraction at timestep tind */
+  void set_phase_terms(int tind);
+
+public:
+  /*! Number of extractions after which the phase terms are recomputed */
+  static const int RESEED_INTERVAL = 64;
+
+  /**
+   * @brief Allocate (and zero) the phasors
+   *
+   * @param F The output field, whose extraction range the phasors cover
+   * @param frequencies The frequencies to extract the phasors at
+   * @param dt The timestep of the simulation
+   * @param interval The number of timesteps between extractions (Np)
+   * @param Nt The number of extractions that the phasors sum over (Npe)
+   */
+  void allocate(const Field &F, const std::vector<double> &frequencies,
+                double dt, int interval, int Nt);
+
+  /** @brief Whether the phasors are extracted */
+  bool is_enabled() const { return !omega_.empty(); }
+
+  /** @brief Number of frequencies at which the phasors are extracted */
+  int n_frequencies() const { return (int) omega_.size(); }
+
+  /** @brief The cells of the phasors */
+  const CellBox &cells() const { return box_; }
+
+  /**
+   * @brief Add the fields at timestep tind to the phasors at every frequency
+   *
+   * The E field is that at time tind * dt, and the H field that half a
+   * timestep later. Within a parallel region, must be called by every thread
+   * of the team, which share the cells between them.
+   */
+  void extract(const ElectricSplitField &E, const MagneticSplitField &H,
+               int tind);
+  /**
+   * @brief Add the fields at timestep tind to the phasors of the cells that
+   * are also in cells, as extract does for every cell: a process of a
+   * distributed grid extracts those of the cells that it owns.
+   */
+  void extract(const ElectricSplitField &E, const MagneticSplitField &H,
+               int tind, const CellBox &cells);
+
+  /**
+   * @brief Divide the E- and H-phasors at each frequency by the (complex)
+   * norms of that frequency
+   */
+  void normalise(const std::vector<std::complex<double>> &E_norm,
+                 const std::vector<std::complex<double>> &H_norm);
+
+  /** @brief The phasor of a component at cell (i, j, k) and a frequency */
+  std::complex<double> phasor(int component, int i, int j, int k,
+                              int frequency_index) const {
+    size_t index = index_of(i, j, k) + frequency_index;
+    return {real_[component][index], imag_[component][index]};
+  }
+
+  /**
+   * @brief Gather the phasors of the cells of every process of a distributed
+   * grid onto the root process, whose phasors then cover cells. Collective,
+   * and serial on each process.
+   *
+   * @param partition The partition of the grid, whose processes each hold the
+   * phasors of the cells that they own
+   * @param cells The cells of the phasors of the whole grid
+   */
+  void gather_to_root(const GridPartition &partition, const CellBox &cells);
+
+  /**
+   * @brief Copy the phasors of a component to arrays in MATLAB order: the
+   * cells with i varying fastest, then the frequency slowest
+   */
+  void copy_to(int component, double *real, double *imag) const;
+};
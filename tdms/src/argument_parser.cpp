@@ -52,12 +52,65 @@ void ArgumentParser::print_help_message() {
                   "-q, --quiet:\tQuiet operation. Silence all logging\n"
                   "-m, --minimise-file-size:\tMinimise output file size by not "
                   "saving vertex and facet "
-                  "information\n\n");
+                  "information\n"
+                  "-b, --cache-blocking:\tAdvance the E and H fields together, "
+                  "one cache-sized slab of the grid at a time (FDTD only)\n"
+                  "--tile-steps=<steps>:\tAdvance each slab of "
+                  "--cache-blocking by up to this many timesteps before the "
+                  "next (default 4)\n"
+                  "--slab-width=<cells>:\tAdvance the grid in slabs of "
+                  "--cache-blocking this many cells wide (default: sized to "
+                  "the last-level cache)\n"
+                  "-f, --fused-updates:\tUpdate all the split field "
+                  "components of a cell in a single sweep over the grid (FDTD "
+                  "only)\n"
+                  "--fused-phasors:\tAccumulate the volume phasors in the "
+                  "sweeps of --fused-updates (steady-state FDTD only)\n"
+                  "--huge-pages:\tBack the field arrays with transparent huge "
+                  "pages (Linux only)\n"
+                  "--pad-rows:\tPad the rows of the split fields so that each "
+                  "starts on a cache line\n"
+                  "--unsplit-interior:\tStore the fields unsplit outside the "
+                  "PML (FDTD in 3D only)\n"
+                  "--fft-backend=<library>:\tLibrary that computes the "
+                  "FFTs: fftw (default), or builtin\n"
+                  "--fftw-planning=<rigour>:\tRigour of the planning of the "
+                  "FFTs: estimate, measure (default), patient, or exhaustive "
+                  "(PSTD only)\n"
+                  "--fftw-wisdom=<file>:\tImport FFTW wisdom from, and export "
+                  "it to, file (PSTD only)\n"
+                  "--hybrid-pstd:\tDifferentiate around the interfaces "
+                  "between materials by finite differences, and elsewhere "
+                  "spectrally (PSTD only)\n"
+                  "--hybrid-overlap=<cells>:\tThe cells either side of an "
+                  "interface that --hybrid-pstd differentiates by finite "
+                  "differences, and then blends over (default 2)\n"
+                  "--active-region:\tOnly update the cells that the pulse "
+                  "can have reached (pulsed FDTD only)\n"
+                  "--active-region-threshold=<fraction>:\tAlso stop "
+                  "updating the cells whose fields have decayed below this "
+                  "fraction of the largest field\n"
+                  "--energy-decay=<fraction>:\tStop once the field energy "
+                  "has decayed below this fraction of its peak (pulsed "
+                  "only)\n"
+                  "--convergence-on=<phasors>:\tPhasors whose convergence "
+                  "ends a steady-state run: volume (default), or surface\n"
+                  "--convergence-stride=<cells>:\tCheck the convergence of "
+                  "the volume phasors at every this many cells only\n"
+                  "--volume-spectrum:\tAlso extract the volume phasors at "
+                  "every frequency of f_ex_vec (pulsed only)\n"
+                  "--compiled-probes:\tInterpolate the fields to the surface, "
+                  "vertex, and field-sample probes with stencils compiled "
+                  "before the main loop\n"
+                  "--distributed:\tDistribute the grid over the MPI processes "
+                  "that TDMS is launched on (3D only, MPI builds only)\n\n");
 }
 
 void ArgumentParser::print_version() {
   fprintf(stdout, "TDMS version: %s\n", tdms::VERSION.c_str());
   fprintf(stdout, "OpenMP version: %i\n", _OPENMP);
+  fprintf(stdout, "Field precision: %s\n",
+          sizeof(field_t) == sizeof(float) ? "single" : "double");
 }
 
 ArgumentNamespace::ArgumentNamespace(int n_args, char *arg_ptrs[]) {
@@ -86,6 +139,18 @@ bool ArgumentNamespace::have_flag(std::string const &flag) const {
   return false;
 }
 
+std::string ArgumentNamespace::flag_value(std::string const &flag) const {
+
+  std::string prefix = flag + "=";
+  for (const auto &arg : arguments) {
+    if (arg.compare(0, prefix.size(), prefix) == 0) {
+      return arg.substr(prefix.size());
+    }
+  }
+
+  return "";
+}
+
 const char *ArgumentNamespace::output_filename() {
 
   if (has_grid_filename()) {
@@ -140,3 +205,112 @@ bool ArgumentNamespace::have_correct_number_of_filenames() const {
 bool ArgumentNamespace::compressed_output() const {
   return have_flag("-m") || have_flag("--minimise-file-size");
 }
+
+SolverOptions ArgumentNamespace::solver_options() const {
+  SolverOptions options;
+  string tile_steps = flag_value("--tile-steps");
+  string slab_width = flag_value("--slab-width");
+  options.cache_blocking = have_flag("-b") || have_flag("--cache-blocking") ||
+                           !tile_steps.empty() || !slab_width.empty();
+  if (!tile_steps.empty()) {
+    size_t n_parsed = 0;
+    try {
+      options.tile_steps = stoi(tile_steps, &n_parsed);
+    } catch (const logic_error &) { n_parsed = 0; }
+    if (n_parsed != tile_steps.size() || options.tile_steps < 1) {
+      throw runtime_error("Invalid number of tile steps " + tile_steps);
+    }
+  }
+  if (!slab_width.empty()) {
+    size_t n_parsed = 0;
+    try {
+      options.slab_width = stoi(slab_width, &n_parsed);
+    } catch (const logic_error &) { n_parsed = 0; }
+    if (n_parsed != slab_width.size() || options.slab_width < 1) {
+      throw runtime_error("Invalid slab width " + slab_width);
+    }
+  }
+  options.fused_phasors = have_flag("--fused-phasors");
+  options.fused_updates = have_flag("-f") || have_flag("--fused-updates") ||
+                          options.fused_phasors;
+  options.huge_pages = have_flag("--huge-pages");
+  options.pad_rows = have_flag("--pad-rows");
+  options.unsplit_interior = have_flag("--unsplit-interior");
+
+  string library = flag_value("--fft-backend");
+  if (library == "builtin") {
+    options.fft_library = FFTLibrary::Builtin;
+  } else if (!library.empty() && library != "fftw") {
+    throw runtime_error("Unknown FFT backend " + library);
+  }
+
+  string planning = flag_value("--fftw-planning");
+  if (planning == "estimate") {
+    options.fftw_planning = FFTPlanning::Estimate;
+  } else if (planning == "patient") {
+    options.fftw_planning = FFTPlanning::Patient;
+  } else if (planning == "exhaustive") {
+    options.fftw_planning = FFTPlanning::Exhaustive;
+  } else if (!planning.empty() && planning != "measure") {
+    throw runtime_error("Unknown FFTW planning rigour " + planning);
+  }
+  options.fftw_wisdom = flag_value("--fftw-wisdom");
+
+  options.hybrid_pstd = have_flag("--hybrid-pstd");
+  string overlap = flag_value("--hybrid-overlap");
+  if (!overlap.empty()) {
+    size_t n_parsed = 0;
+    try {
+      options.hybrid_overlap = stoi(overlap, &n_parsed);
+    } catch (const logic_error &) { n_parsed = 0; }
+    if (n_parsed != overlap.size() || options.hybrid_overlap < 0) {
+      throw runtime_error("Invalid hybrid PSTD overlap " + overlap);
+    }
+  }
+
+  string threshold = flag_value("--active-region-threshold");
+  options.active_region = have_flag("--active-region") || !threshold.empty();
+  if (!threshold.empty()) {
+    size_t n_parsed = 0;
+    try {
+      options.active_region_threshold = stod(threshold, &n_parsed);
+    } catch (const logic_error &) { n_parsed = 0; }
+    if (n_parsed != threshold.size() || options.active_region_threshold < 0. ||
+        options.active_region_threshold >= 1.) {
+      throw runtime_error("Invalid active region threshold " + threshold);
+    }
+  }
+
+  string decay = flag_value("--energy-decay");
+  if (!decay.empty()) {
+    size_t n_parsed = 0;
+    try {
+      options.energy_decay = stod(decay, &n_parsed);
+    } catch (const logic_error &) { n_parsed = 0; }
+    if (n_parsed != decay.size() || options.energy_decay <= 0. ||
+        options.energy_decay >= 1.) {
+      throw runtime_error("Invalid energy decay fraction " + decay);
+    }
+  }
+
+  string convergence_set = flag_value("--convergence-on");
+  if (convergence_set == "surface") {
+    options.convergence_set = ConvergenceSet::Surface;
+  } else if (!convergence_set.empty() && convergence_set != "volume") {
+    throw runtime_error("Unknown convergence phasors " + convergence_set);
+  }
+  string stride = flag_value("--convergence-stride");
+  if (!stride.empty()) {
+    size_t n_parsed = 0;
+    try {
+      options.convergence_stride = stoi(stride, &n_parsed);
+    } catch (const logic_error &) { n_parsed = 0; }
+    if (n_parsed != stride.size() || options.convergence_stride < 1) {
+      throw runtime_error("Invalid convergence stride " + stride);
+    }
+  }
+  options.volume_spectrum = have_flag("--volume-spectrum");
+  options.compiled_probes = have_flag("--compiled-probes");
+  options.distributed = have_flag("--distributed");
+  return options;
+}
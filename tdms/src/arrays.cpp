@@ -10,10 +10,11 @@
 using namespace std;
 using namespace tdms_math_constants;
 
-void DetectorSensitivityArrays::initialise(int n_rows, int n_cols) {
+void DetectorSensitivityArrays::initialise(int n_rows, int n_cols,
+                                           const FFTBackend &fft) {
 
   v = (fftw_complex *) fftw_malloc(n_rows * n_cols * sizeof(fftw_complex));
-  plan = fftw_plan_dft_2d(n_cols, n_rows, v, v, FFTW_FORWARD, FFTW_MEASURE);
+  plan = fft.plan_complex_2d(n_cols, n_rows, v);
 
   cm = (complex<double> **) malloc(sizeof(complex<double> *) * n_rows);
   for (int j = 0; j < n_rows; j++) {
@@ -23,6 +24,6 @@ void DetectorSensitivityArrays::initialise(int n_rows, int n_cols) {
 }
 
 DetectorSensitivityArrays::~DetectorSensitivityArrays() {
+  plan.reset();
   fftw_free(v);
-  fftw_destroy_plan(plan);
 }
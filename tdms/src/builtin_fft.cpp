@@ -0,0 +1,212 @@
+/**
+ * @file builtin_fft.cpp
+ * @brief The transforms of BuiltinFFTBackend, which need no FFT library.
+ */
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "fft_backend.h"
+#include "globals.h"
+
+using namespace std;
+using tdms_math_constants::DCPI;
+
+namespace {
+
+/**
+ * @brief The unnormalised discrete Fourier transform of N complex numbers, in
+ * place.
+ *
+ * A length that is a power of two is transformed by the iterative radix-2
+ * algorithm. Any other length N is transformed by Bluestein's algorithm, which
+ * writes the transform as the convolution of the data, multiplied by a chirp,
+ * with the conjugate chirp, and computes the convolution with radix-2
+ * transforms of the next power of two of at least 2N - 1.
+ */
+class ComplexTransform {
+private:
+  int N_;              //< Number of elements transformed
+  int M_;              //< Length of the radix-2 transforms
+  bool bluestein_;     //< Whether N_ is not a power of two
+  //! exp(-2 pi i k / M) for k < M / 2
+  vector<complex<double>> twiddles_;
+  //! exp(-pi i n^2 / N) for n < N, and the transform of its (periodic)
+  //! conjugate over M elements, divided by M
+  vector<complex<double>> chirp_, kernel_;
+
+  /** @brief The radix-2 transform of M_ elements, in place */
+  void radix2(complex<double> *a, bool inverse) const {
+    // bit-reversal permutation
+    for (int i = 1, j = 0; i < M_; i++) {
+      int bit = M_ >> 1;
+      for (; j & bit; bit >>= 1) { j ^= bit; }
+      j ^= bit;
+      if (i < j) { swap(a[i], a[j]); }
+    }
+    for (int length = 2; length <= M_; length <<= 1) {
+      int half = length / 2, stride = M_ / length;
+      for (int start = 0; start < M_; start += length) {
+        for (int k = 0; k < half; k++) {
+          complex<double> w = twiddles_[k * stride];
+          if (inverse) { w = conj(w); }
+          complex<double> u = a[start + k], v = a[start + k + half] * w;
+          a[start + k] = u + v;
+          a[start + k + half] = u - v;
+        }
+      }
+    }
+  }
+
+public:
+  explicit ComplexTransform(int N) : N_(N), M_(1) {
+    while (M_ < N) { M_ <<= 1; }
+    bluestein_ = M_ != N;
+    if (bluestein_) {
+      M_ = 1;
+      while (M_ < 2 * N - 1) { M_ <<= 1; }
+    }
+    twiddles_.resize(M_ / 2);
+    for (int k = 0; k < M_ / 2; k++) {
+      twiddles_[k] = polar(1., -2. * DCPI * k / M_);
+    }
+    if (!bluestein_) { return; }
+
+    // n^2 is reduced modulo 2N, over which the chirp is periodic, to keep the
+    // phase accurate for long lines
+    chirp_.resize(N);
+    for (int n = 0; n < N; n++) {
+      long long n_squared = (long long) n * n % (2LL * N);
+      chirp_[n] = polar(1., -DCPI * (double) n_squared / N);
+    }
+    kernel_.assign(M_, 0.);
+    kernel_[0] = conj(chirp_[0]);
+    for (int n = 1; n < N; n++) {
+      kernel_[n] = kernel_[M_ - n] = conj(chirp_[n]);
+    }
+    radix2(kernel_.data(), false);
+    for (complex<double> &k : kernel_) { k /= (double) M_; }
+  }
+
+  /** @brief The number of elements of scratch space that execute needs */
+  int scratch_size() const { return bluestein_ ? M_ : 0; }
+
+  /**
+   * @brief Transform N elements in place
+   *
+   * @param data The elements
+   * @param inverse Whether the transform is backward (exp(+2 pi i k n / N))
+   * rather than forward
+   * @param scratch scratch_size() elements of scratch space
+   */
+  void execute(complex<double> *data, bool inverse,
+               complex<double> *scratch) const {
+    if (!bluestein_) {
+      radix2(data, inverse);
+      return;
+    }
+    // the backward transform is the conjugate of the forward transform of the
+    // conjugate
+    for (int n = 0; n < N_; n++) {
+      scratch[n] = (inverse ? conj(data[n]) : data[n]) * chirp_[n];
+    }
+    fill(scratch + N_, scratch + M_, 0.);
+    radix2(scratch, false);
+    for (int m = 0; m < M_; m++) { scratch[m] *= kernel_[m]; }
+    radix2(scratch, true);
+    for (int k = 0; k < N_; k++) {
+      complex<double> X = scratch[k] * chirp_[k];
+      data[k] = inverse ? conj(X) : X;
+    }
+  }
+};
+
+/**
+ * @brief Scratch space of the calling thread, of at least n elements. Shared by
+ * every transform that the thread executes.
+ */
+complex<double> *thread_scratch(size_t n) {
+  thread_local vector<complex<double>> scratch;
+  if (scratch.size() < n) { scratch.resize(n); }
+  return scratch.data();
+}
+
+class BuiltinBatchedRealFFT : public BatchedRealFFT {
+private:
+  ComplexTransform transform_;
+
+public:
+  BuiltinBatchedRealFFT(int N, int batch_size)
+      : BatchedRealFFT(N, batch_size), transform_(N) {}
+
+  void forward(double *lines, fftw_complex *modes,
+               int n_lines) const override {
+    complex<double> *line = thread_scratch(N + transform_.scratch_size());
+    for (int b = 0; b < n_lines; b++) {
+      for (int x = 0; x < N; x++) { line[x] = lines[x * batch_size + b]; }
+      transform_.execute(line, false, line + N);
+      for (int m = 0; m <= N / 2; m++) {
+        modes[m * batch_size + b][0] = line[m].real();
+        modes[m * batch_size + b][1] = line[m].imag();
+      }
+    }
+  }
+
+  void backward(fftw_complex *modes, double *lines,
+                int n_lines) const override {
+    complex<double> *line = thread_scratch(N + transform_.scratch_size());
+    for (int b = 0; b < n_lines; b++) {
+      // the negative frequencies of a real line are the conjugates of the
+      // positive ones
+      for (int m = 0; m <= N / 2; m++) {
+        line[m] = {modes[m * batch_size + b][0], modes[m * batch_size + b][1]};
+      }
+      for (int m = N / 2 + 1; m < N; m++) { line[m] = conj(line[N - m]); }
+      transform_.execute(line, true, line + N);
+      for (int x = 0; x < N; x++) {
+        lines[x * batch_size + b] = line[x].real();
+      }
+    }
+  }
+};
+
+class BuiltinComplexFFT2D : public ComplexFFT2D {
+private:
+  int n_0_, n_1_;
+  complex<double> *data_;
+  ComplexTransform rows_, columns_;
+
+public:
+  BuiltinComplexFFT2D(int n_0, int n_1, fftw_complex *data)
+      : n_0_(n_0), n_1_(n_1), data_(reinterpret_cast<complex<double> *>(data)),
+        rows_(n_1), columns_(n_0) {}
+
+  void forward() override {
+    // the rows are contiguous, and each column is copied to a buffer of its
+    // own
+    int n_scratch = max(rows_.scratch_size(), columns_.scratch_size());
+    complex<double> *scratch = thread_scratch(n_scratch + n_0_),
+                    *column = scratch + n_scratch;
+    for (int a = 0; a < n_0_; a++) {
+      rows_.execute(data_ + (size_t) a * n_1_, false, scratch);
+    }
+    for (int b = 0; b < n_1_; b++) {
+      for (int a = 0; a < n_0_; a++) { column[a] = data_[a * n_1_ + b]; }
+      columns_.execute(column, false, scratch);
+      for (int a = 0; a < n_0_; a++) { data_[a * n_1_ + b] = column[a]; }
+    }
+  }
+};
+
+}// namespace
+
+shared_ptr<const BatchedRealFFT>
+BuiltinFFTBackend::plan_batched_real(int N, int batch_size) const {
+  return make_shared<const BuiltinBatchedRealFFT>(N, batch_size);
+}
+
+unique_ptr<ComplexFFT2D>
+BuiltinFFTBackend::plan_complex_2d(int n_0, int n_1,
+                                   fftw_complex *data) const {
+  return make_unique<BuiltinComplexFFT2D>(n_0, n_1, data);
+}
@@ -0,0 +1,108 @@
+#include "distributed/distributed_fdtd.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+/*! The H (E) components read across the faces of constant i by the E (H)
+ * update, and across the faces of constant j */
+const SplitComponent I_FACE[4] = {&SplitField::yx, &SplitField::yz,
+                                  &SplitField::zx, &SplitField::zy};
+const SplitComponent J_FACE[4] = {&SplitField::xy, &SplitField::xz,
+                                  &SplitField::zx, &SplitField::zy};
+
+MPI_Datatype field_type() {
+  return sizeof(field_t) == sizeof(float) ? MPI_FLOAT : MPI_DOUBLE;
+}
+
+/**
+ * @brief Copy the rows of a face of the components of a field to or from a
+ * contiguous buffer
+ *
+ * @param field The field
+ * @param components The components that are copied
+ * @param i_face Whether the face is of constant i (or j)
+ * @param layer The i (or j) of the face
+ * @param block The block of the process, whose rows along the face are copied
+ */
+template<bool to_buffer>
+void copy_face(SplitField &field, const SplitComponent (&components)[4],
+               bool i_face, int layer, const CellBox &block, field_t *buffer) {
+  int n_k = block.upper.k - block.lower.k;
+  int begin = i_face ? block.lower.j : block.lower.i,
+      end = i_face ? block.upper.j : block.upper.i;
+  for (SplitComponent component : components) {
+    for (int n = begin; n < end; n++) {
+      field_t *row = i_face ? &(field.*component)(layer, n, block.lower.k)
+                            : &(field.*component)(n, layer, block.lower.k);
+      if (to_buffer) {
+        copy(row, row + n_k, buffer);
+      } else {
+        copy(buffer, buffer + n_k, row);
+      }
+      buffer += n_k;
+    }
+  }
+}
+
+}// namespace
+
+DistributedFDTD::DistributedFDTD(MPI_Comm cart, const CellBox &block)
+    : cart_(cart), block_(block) {
+  MPI_Cart_shift(cart_, 0, 1, &low_i_, &high_i_);
+  MPI_Cart_shift(cart_, 1, 1, &low_j_, &high_j_);
+
+  size_t n_i = block_.upper.i - block_.lower.i,
+         n_j = block_.upper.j - block_.lower.j,
+         n_k = block_.upper.k - block_.lower.k;
+  send_i_.resize(4 * n_j * n_k);
+  receive_i_.resize(send_i_.size());
+  send_j_.resize(4 * n_i * n_k);
+  receive_j_.resize(send_j_.size());
+}
+
+void DistributedFDTD::start_exchange(SplitField &field, bool upwards) {
+  int send_to_i = upwards ? high_i_ : low_i_,
+      receive_from_i = upwards ? low_i_ : high_i_;
+  int send_to_j = upwards ? high_j_ : low_j_,
+      receive_from_j = upwards ? low_j_ : high_j_;
+
+  MPI_Irecv(receive_i_.data(), (int) receive_i_.size(), field_type(),
+            receive_from_i, 0, cart_, &requests_[0]);
+  MPI_Irecv(receive_j_.data(), (int) receive_j_.size(), field_type(),
+            receive_from_j, 1, cart_, &requests_[1]);
+
+  // there is no halo to send to at the edges of the grid
+  if (send_to_i != MPI_PROC_NULL) {
+    copy_face<true>(field, I_FACE, true,
+                    upwards ? block_.upper.i - 1 : block_.lower.i, block_,
+                    send_i_.data());
+  }
+  if (send_to_j != MPI_PROC_NULL) {
+    copy_face<true>(field, J_FACE, false,
+                    upwards ? block_.upper.j - 1 : block_.lower.j, block_,
+                    send_j_.data());
+  }
+  MPI_Isend(send_i_.data(), (int) send_i_.size(), field_type(), send_to_i, 0,
+            cart_, &requests_[2]);
+  MPI_Isend(send_j_.data(), (int) send_j_.size(), field_type(), send_to_j, 1,
+            cart_, &requests_[3]);
+}
+
+void DistributedFDTD::finish_exchange(SplitField &field, bool upwards) {
+  MPI_Waitall(4, requests_, MPI_STATUSES_IGNORE);
+
+  // nor anything to receive
+  if ((upwards ? low_i_ : high_i_) != MPI_PROC_NULL) {
+    copy_face<false>(field, I_FACE, true,
+                     upwards ? block_.lower.i - 1 : block_.upper.i, block_,
+                     receive_i_.data());
+  }
+  if ((upwards ? low_j_ : high_j_) != MPI_PROC_NULL) {
+    copy_face<false>(field, J_FACE, false,
+                     upwards ? block_.lower.j - 1 : block_.upper.j, block_,
+                     receive_j_.data());
+  }
+}
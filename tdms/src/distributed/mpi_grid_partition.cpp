@@ -0,0 +1,112 @@
+#include "distributed/mpi_grid_partition.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <string>
+
+#include "distributed/pencil_derivative.h"
+
+using namespace std;
+
+MPIGridPartition::MPIGridPartition(const IJKDimensions &IJK_tot,
+                                   MPI_Comm comm)
+    : GridPartition(IJK_tot),
+      decomposition_({IJK_tot.i + 1, IJK_tot.j + 1, IJK_tot.k + 1}, comm) {
+  MPI_Comm cart = decomposition_.communicator();
+  MPI_Comm_rank(cart, &rank_);
+  MPI_Comm_size(cart, &n_processes_);
+  if (grid_.upper.i < decomposition_.n_ranks(0) ||
+      grid_.upper.j < decomposition_.n_ranks(1)) {
+    throw runtime_error("The grid has too few cells to distribute over " +
+                        to_string(n_processes_) + " processes");
+  }
+  owned_ = decomposition_.pencil(AxialDirection::Z);
+  exchange_ = make_unique<DistributedFDTD>(cart, owned_);
+}
+
+void MPIGridPartition::sum(double *values, int n) const {
+  MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_DOUBLE, MPI_SUM,
+                decomposition_.communicator());
+}
+
+void MPIGridPartition::maximum(double *values, int n) const {
+  MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_DOUBLE, MPI_MAX,
+                decomposition_.communicator());
+}
+
+void MPIGridPartition::broadcast_from_root(string &value) const {
+  MPI_Comm comm = decomposition_.communicator();
+  int n = (int) value.size();
+  MPI_Bcast(&n, 1, MPI_INT, 0, comm);
+  value.resize(n);
+  MPI_Bcast(&value[0], n, MPI_CHAR, 0, comm);
+}
+
+CellBox MPIGridPartition::owned_by(int process) const {
+  int coords[2];
+  MPI_Cart_coords(decomposition_.communicator(), process, 2, coords);
+  return decomposition_.pencil(AxialDirection::Z, coords[0], coords[1]);
+}
+
+vector<double>
+MPIGridPartition::gather_to_root(const vector<double> &values) const {
+  MPI_Comm comm = decomposition_.communicator();
+  // the count of a message is an int, so a large volume is sent in parts
+  auto parts = [](size_t n, auto transfer) {
+    for (size_t first = 0; first < n; first += INT_MAX) {
+      transfer(first, (int) min(n - first, (size_t) INT_MAX));
+    }
+  };
+
+  unsigned long long n = values.size();
+  if (!is_root()) {
+    MPI_Send(&n, 1, MPI_UNSIGNED_LONG_LONG, 0, 0, comm);
+    parts(n, [&](size_t first, int count) {
+      MPI_Send(values.data() + first, count, MPI_DOUBLE, 0, 1, comm);
+    });
+    return {};
+  }
+  vector<double> gathered(values);
+  for (int process = 1; process < n_processes_; process++) {
+    MPI_Recv(&n, 1, MPI_UNSIGNED_LONG_LONG, process, 0, comm,
+             MPI_STATUS_IGNORE);
+    gathered.resize(gathered.size() + n);
+    double *received = gathered.data() + gathered.size() - n;
+    parts(n, [&](size_t first, int count) {
+      MPI_Recv(received + first, count, MPI_DOUBLE, process, 1, comm,
+               MPI_STATUS_IGNORE);
+    });
+  }
+  return gathered;
+}
+
+vector<int> MPIGridPartition::gather_to_all(const vector<int> &values) const {
+  MPI_Comm comm = decomposition_.communicator();
+  int n = (int) values.size();
+  vector<int> counts(n_processes_), offsets(n_processes_, 0);
+  MPI_Allgather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+  for (int process = 1; process < n_processes_; process++) {
+    offsets[process] = offsets[process - 1] + counts[process - 1];
+  }
+  vector<int> gathered(offsets.back() + counts.back());
+  MPI_Allgatherv(values.data(), n, MPI_INT, gathered.data(), counts.data(),
+                 offsets.data(), MPI_INT, comm);
+  return gathered;
+}
+
+void MPIGridPartition::start_exchange(SplitField &field, bool upwards) {
+  exchange_->start_exchange(field, upwards);
+}
+
+void MPIGridPartition::finish_exchange(SplitField &field, bool upwards) {
+  exchange_->finish_exchange(field, upwards);
+}
+
+unique_ptr<DistributedDerivative>
+MPIGridPartition::make_derivative(AxialDirection direction, double delta,
+                                  shared_ptr<const BatchedRealFFT> transform)
+        const {
+  return make_unique<PencilDerivative>(decomposition_, direction, delta,
+                                       move(transform));
+}
@@ -0,0 +1,160 @@
+#include "distributed/pencil_decomposition.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+/** @brief The range of indices [lower, upper) of part of n split in parts */
+pair<int, int> split(int n, int parts, int part) {
+  int base = n / parts, extra = n % parts;
+  int lower = part * base + min(part, extra);
+  return {lower, lower + base + (part < extra ? 1 : 0)};
+}
+
+CellBox intersection(const CellBox &a, const CellBox &b) {
+  CellBox box;
+  box.lower = {max(a.lower.i, b.lower.i), max(a.lower.j, b.lower.j),
+               max(a.lower.k, b.lower.k)};
+  box.upper = {min(a.upper.i, b.upper.i), min(a.upper.j, b.upper.j),
+               min(a.upper.k, b.upper.k)};
+  return box;
+}
+
+/** @brief Position of the sample (i, j, k) in the storage of a block */
+long long index_in(const CellBox &block, int i, int j, int k) {
+  long long n_j = block.upper.j - block.lower.j,
+            n_k = block.upper.k - block.lower.k;
+  return ((i - block.lower.i) * n_j + (j - block.lower.j)) * n_k +
+         (k - block.lower.k);
+}
+
+/**
+ * @brief Copy the samples of part of a block to or from a contiguous buffer,
+ * in (i, j, k) order
+ */
+template<bool to_buffer>
+void copy_part(double *block_data, const CellBox &block, const CellBox &part,
+               double *buffer) {
+  if (part.empty()) { return; }
+  int n_k = part.upper.k - part.lower.k;
+  for (int i = part.lower.i; i < part.upper.i; i++) {
+    for (int j = part.lower.j; j < part.upper.j; j++) {
+      double *row = block_data + index_in(block, i, j, part.lower.k);
+      if (to_buffer) {
+        copy(row, row + n_k, buffer);
+      } else {
+        copy(buffer, buffer + n_k, row);
+      }
+      buffer += n_k;
+    }
+  }
+}
+
+}// namespace
+
+PencilDecomposition::PencilDecomposition(const IJKDimensions &n_samples,
+                                         MPI_Comm comm)
+    : n_samples_(n_samples) {
+  int n_ranks;
+  MPI_Comm_size(comm, &n_ranks);
+  dims_[0] = dims_[1] = 0;
+  MPI_Dims_create(n_ranks, 2, dims_);
+
+  int periods[2] = {0, 0};
+  MPI_Cart_create(comm, 2, dims_, periods, 0, &cart_);
+  int rank;
+  MPI_Comm_rank(cart_, &rank);
+  MPI_Cart_coords(cart_, rank, 2, coords_);
+
+  int vary_p2[2] = {0, 1}, vary_p1[2] = {1, 0};
+  MPI_Cart_sub(cart_, vary_p2, &same_p1_);
+  MPI_Cart_sub(cart_, vary_p1, &same_p2_);
+}
+
+PencilDecomposition::~PencilDecomposition() {
+  for (MPI_Comm *comm : {&same_p1_, &same_p2_, &cart_}) {
+    if (*comm != MPI_COMM_NULL) { MPI_Comm_free(comm); }
+  }
+}
+
+CellBox PencilDecomposition::pencil(AxialDirection direction, int p1,
+                                    int p2) const {
+  CellBox box;
+  box.upper = n_samples_;
+  // the two directions across the pencil, split over P1 and P2
+  int *lower[2], *upper[2];
+  int n[2];
+  switch (direction) {
+    case AxialDirection::Z:
+      lower[0] = &box.lower.i, upper[0] = &box.upper.i, n[0] = n_samples_.i;
+      lower[1] = &box.lower.j, upper[1] = &box.upper.j, n[1] = n_samples_.j;
+      break;
+    case AxialDirection::Y:
+      lower[0] = &box.lower.i, upper[0] = &box.upper.i, n[0] = n_samples_.i;
+      lower[1] = &box.lower.k, upper[1] = &box.upper.k, n[1] = n_samples_.k;
+      break;
+    default:
+      lower[0] = &box.lower.j, upper[0] = &box.upper.j, n[0] = n_samples_.j;
+      lower[1] = &box.lower.k, upper[1] = &box.upper.k, n[1] = n_samples_.k;
+      break;
+  }
+  int p[2] = {p1, p2};
+  for (int d = 0; d < 2; d++) {
+    pair<int, int> range = split(n[d], dims_[d], p[d]);
+    *lower[d] = range.first;
+    *upper[d] = range.second;
+  }
+  return box;
+}
+
+void PencilDecomposition::transpose(const vector<double> &in,
+                                    AxialDirection from, vector<double> &out,
+                                    AxialDirection to) const {
+  bool z_and_y = (from == AxialDirection::Z && to == AxialDirection::Y) ||
+                 (from == AxialDirection::Y && to == AxialDirection::Z);
+  bool y_and_x = (from == AxialDirection::Y && to == AxialDirection::X) ||
+                 (from == AxialDirection::X && to == AxialDirection::Y);
+  if (!z_and_y && !y_and_x) {
+    throw runtime_error("Pencils can only be transposed between Z and Y, or "
+                        "Y and X");
+  }
+  // Z and Y pencils share the split of i over P1, Y and X that of k over P2
+  MPI_Comm comm = z_and_y ? same_p1_ : same_p2_;
+  int n_partners = z_and_y ? dims_[1] : dims_[0];
+
+  CellBox mine_in = pencil(from), mine_out = pencil(to);
+  out.resize(mine_out.n_cells());
+  vector<double> send(in.size()), receive(out.size());
+  vector<int> send_counts(n_partners), send_displs(n_partners),
+          receive_counts(n_partners), receive_displs(n_partners);
+
+  int sent = 0, received = 0;
+  for (int q = 0; q < n_partners; q++) {
+    int p1 = z_and_y ? coords_[0] : q, p2 = z_and_y ? q : coords_[1];
+    CellBox to_q = intersection(mine_in, pencil(to, p1, p2));
+    CellBox from_q = intersection(pencil(from, p1, p2), mine_out);
+
+    send_displs[q] = sent;
+    send_counts[q] = (int) to_q.n_cells();
+    copy_part<true>(const_cast<double *>(in.data()), mine_in, to_q,
+                    send.data() + sent);
+    sent += send_counts[q];
+    receive_displs[q] = received;
+    receive_counts[q] = (int) from_q.n_cells();
+    received += receive_counts[q];
+  }
+
+  MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(),
+                MPI_DOUBLE, receive.data(), receive_counts.data(),
+                receive_displs.data(), MPI_DOUBLE, comm);
+
+  for (int q = 0; q < n_partners; q++) {
+    int p1 = z_and_y ? coords_[0] : q, p2 = z_and_y ? q : coords_[1];
+    CellBox from_q = intersection(pencil(from, p1, p2), mine_out);
+    copy_part<false>(out.data(), mine_out, from_q,
+                     receive.data() + receive_displs[q]);
+  }
+}
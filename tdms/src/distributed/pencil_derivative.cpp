@@ -0,0 +1,145 @@
+#include "distributed/pencil_derivative.h"
+
+#include <stdexcept>
+
+#include <omp.h>
+
+using namespace std;
+
+namespace {
+
+/** @brief The number of samples of each line of the grid along direction */
+int samples_along(const PencilDecomposition &decomposition,
+                  AxialDirection direction) {
+  const IJKDimensions &n = decomposition.n_samples();
+  return direction == AxialDirection::X
+                 ? n.i
+                 : (direction == AxialDirection::Y ? n.j : n.k);
+}
+
+}// namespace
+
+PencilDerivative::PencilDerivative(const PencilDecomposition &decomposition,
+                                   AxialDirection direction, double delta,
+                                   shared_ptr<const BatchedRealFFT> transform)
+    : decomposition_(decomposition), direction_(direction) {
+  if (transform == nullptr ||
+      transform->N > samples_along(decomposition, direction)) {
+    throw runtime_error("The lines of a distributed derivative cannot be "
+                        "longer than those of the grid");
+  }
+  derivative_.initialise(delta, omp_get_max_threads(), move(transform));
+}
+
+PencilDerivative::PencilDerivative(const PencilDecomposition &decomposition,
+                                   AxialDirection direction, double delta)
+    : PencilDerivative(decomposition, direction, delta,
+                       FFTWBackend().plan_batched_real(
+                               samples_along(decomposition, direction), 16)) {}
+
+void PencilDerivative::differentiate_block(
+        const vector<double> &in, const CellBox &block, vector<double> &out,
+        int begin, int end,
+        const function<bool(int, int, int, double *)> &blend) {
+  IJKDimensions size = {block.upper.i - block.lower.i,
+                        block.upper.j - block.lower.j,
+                        block.upper.k - block.lower.k};
+  auto index = [&](int i, int j, int k) {
+    return ((long long) i * size.j + j) * size.k + k;
+  };
+
+  // the lines of a batch are consecutive in k, unless they run along it, and
+  // are blended according to their position in the whole grid
+  switch (direction_) {
+    case AxialDirection::X:
+      derivative_.differentiate_lines(
+              size.j, size.k, begin, end,
+              [&](int j, int k, int i) { return in[index(i, j, k)]; },
+              [&](int j, int k, int i, double derivative) {
+                out[index(i, j, k)] = derivative;
+              },
+              [&](int j, int k, int n, double *weight) {
+                return blend(block.lower.j + j, block.lower.k + k, n, weight);
+              });
+      break;
+    case AxialDirection::Y:
+      derivative_.differentiate_lines(
+              size.i, size.k, begin, end,
+              [&](int i, int k, int j) { return in[index(i, j, k)]; },
+              [&](int i, int k, int j, double derivative) {
+                out[index(i, j, k)] = derivative;
+              },
+              [&](int i, int k, int n, double *weight) {
+                return blend(block.lower.i + i, block.lower.k + k, n, weight);
+              });
+      break;
+    default:
+      derivative_.differentiate_lines(
+              size.i, size.j, begin, end,
+              [&](int i, int j, int k) { return in[index(i, j, k)]; },
+              [&](int i, int j, int k, double derivative) {
+                out[index(i, j, k)] = derivative;
+              },
+              [&](int i, int j, int n, double *weight) {
+                return blend(block.lower.i + i, block.lower.j + j, n, weight);
+              });
+      break;
+  }
+}
+
+void PencilDerivative::differentiate(
+        const vector<double> &samples, vector<double> &derivative, int begin,
+        int end, const function<bool(int, int, int, double *)> &blend) {
+  // the transposes are made by the master thread, which initialised MPI, and
+  // the lines of each pencil are shared between the team
+  const PencilDecomposition &d = decomposition_;
+  switch (direction_) {
+    case AxialDirection::Z:
+      differentiate_block(samples, d.pencil(AxialDirection::Z), derivative,
+                          begin, end, blend);
+      break;
+    case AxialDirection::Y:
+#pragma omp master
+      {
+        d.transpose(samples, AxialDirection::Z, y_pencil_, AxialDirection::Y);
+        derivative_pencil_.resize(y_pencil_.size());
+      }
+#pragma omp barrier
+      differentiate_block(y_pencil_, d.pencil(AxialDirection::Y),
+                          derivative_pencil_, begin, end, blend);
+#pragma omp master
+      d.transpose(derivative_pencil_, AxialDirection::Y, derivative,
+                  AxialDirection::Z);
+#pragma omp barrier
+      break;
+    default:
+#pragma omp master
+      {
+        d.transpose(samples, AxialDirection::Z, y_pencil_, AxialDirection::Y);
+        d.transpose(y_pencil_, AxialDirection::Y, x_pencil_,
+                    AxialDirection::X);
+        derivative_pencil_.resize(x_pencil_.size());
+      }
+#pragma omp barrier
+      differentiate_block(x_pencil_, d.pencil(AxialDirection::X),
+                          derivative_pencil_, begin, end, blend);
+#pragma omp master
+      {
+        d.transpose(derivative_pencil_, AxialDirection::X, y_pencil_,
+                    AxialDirection::Y);
+        d.transpose(y_pencil_, AxialDirection::Y, derivative,
+                    AxialDirection::Z);
+      }
+#pragma omp barrier
+      break;
+  }
+}
+
+void PencilDerivative::differentiate(const vector<double> &in,
+                                     vector<double> &out) {
+#pragma omp master
+  out.resize(in.size());
+#pragma omp barrier
+  differentiate(in, out, 0, derivative_.length(),
+                [](int, int, int, double *) { return false; });
+}
@@ -11,9 +11,11 @@ fdtdGridInitialiser::fdtdGridInitialiser(const mxArray *fdtd_pointer,
   pointer = fdtd_pointer;
   mat_filename = fdtd_filename;
 
-  dimensions = {value_of_attribute("I_tot") + 1,
-                value_of_attribute("J_tot") + 1,
-                value_of_attribute("K_tot") + 1};
+  // the split fields are allocated by the SimulationManager, so only the
+  // materials, whose dimensions are those of the grid, are kept
+  for (const char *key : {"I_tot", "J_tot", "K_tot"}) {
+    value_of_attribute(key);
+  }
 }
 
 /**
@@ -37,15 +39,3 @@ mwSize fdtdGridInitialiser::value_of_attribute(const string &key) {
 
   return value;
 }
-
-void fdtdGridInitialiser::add_tensor(const string &name) {
-
-  mxAddField((mxArray *) pointer, name.c_str());
-
-  auto element = mxGetField((mxArray *) pointer, 0, name.c_str());
-  element = mxCreateNumericArray((const mwSize) dimensions.size(),
-                                 (const mwSize *) &dimensions.front(),
-                                 mxDOUBLE_CLASS, mxREAL);
-
-  mxSetField((mxArray *) pointer, 0, name.c_str(), element);
-}
@@ -0,0 +1,183 @@
+#include "fft_backend.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+using namespace std;
+
+namespace {
+
+/** @brief The FFTW planner flag of a planning rigour */
+unsigned planner_flag(FFTPlanning planning) {
+  switch (planning) {
+    case FFTPlanning::Estimate:
+      return FFTW_ESTIMATE;
+    case FFTPlanning::Patient:
+      return FFTW_PATIENT;
+    case FFTPlanning::Exhaustive:
+      return FFTW_EXHAUSTIVE;
+    default:
+      return FFTW_MEASURE;
+  }
+}
+
+/**
+ * @brief The FFTW plans of a batch of lines, and of a single line of a batch.
+ *
+ * The plans are executed on the buffers of each thread by the new-array
+ * execute functions of FFTW, so one set of plans serves every thread, and
+ * every derivative of the same length.
+ */
+class FFTWBatchedRealFFT : public BatchedRealFFT {
+private:
+  fftw_plan forward_ = nullptr, backward_ = nullptr, forward_line_ = nullptr,
+            backward_line_ = nullptr;
+
+public:
+  FFTWBatchedRealFFT(int N, int batch_size, unsigned rigour)
+      : BatchedRealFFT(N, batch_size) {
+    int n_modes = N / 2 + 1;
+    // the planner may overwrite the arrays, so plans are made on arrays of
+    // their own
+    auto *lines = (double *) fftw_malloc(sizeof(double) * N * batch_size);
+    auto *modes = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) *
+                                               n_modes * batch_size);
+
+    // the lines are interleaved: stride batch_size between samples, and 1
+    // between lines
+    forward_ = fftw_plan_many_dft_r2c(1, &N, batch_size, lines, nullptr,
+                                      batch_size, 1, modes, nullptr,
+                                      batch_size, 1, rigour);
+    backward_ = fftw_plan_many_dft_c2r(1, &N, batch_size, modes, nullptr,
+                                       batch_size, 1, lines, nullptr,
+                                       batch_size, 1, rigour);
+    // a single line of a batch is not aligned as the buffer is
+    forward_line_ = fftw_plan_many_dft_r2c(1, &N, 1, lines, nullptr,
+                                           batch_size, 1, modes, nullptr,
+                                           batch_size, 1,
+                                           rigour | FFTW_UNALIGNED);
+    backward_line_ = fftw_plan_many_dft_c2r(1, &N, 1, modes, nullptr,
+                                            batch_size, 1, lines, nullptr,
+                                            batch_size, 1,
+                                            rigour | FFTW_UNALIGNED);
+
+    fftw_free(lines);
+    fftw_free(modes);
+  }
+  FFTWBatchedRealFFT(const FFTWBatchedRealFFT &) = delete;
+  FFTWBatchedRealFFT &operator=(const FFTWBatchedRealFFT &) = delete;
+  ~FFTWBatchedRealFFT() override {
+    for (fftw_plan plan :
+         {forward_, backward_, forward_line_, backward_line_}) {
+      if (plan != nullptr) { fftw_destroy_plan(plan); }
+    }
+  }
+
+  void forward(double *lines, fftw_complex *modes,
+               int n_lines) const override {
+    // a partial batch is transformed line by line
+    if (n_lines == batch_size) {
+      fftw_execute_dft_r2c(forward_, lines, modes);
+      return;
+    }
+    for (int b = 0; b < n_lines; b++) {
+      fftw_execute_dft_r2c(forward_line_, lines + b, modes + b);
+    }
+  }
+
+  void backward(fftw_complex *modes, double *lines,
+                int n_lines) const override {
+    if (n_lines == batch_size) {
+      fftw_execute_dft_c2r(backward_, modes, lines);
+      return;
+    }
+    for (int b = 0; b < n_lines; b++) {
+      fftw_execute_dft_c2r(backward_line_, modes + b, lines + b);
+    }
+  }
+};
+
+class FFTWComplexFFT2D : public ComplexFFT2D {
+private:
+  fftw_plan plan_;
+
+public:
+  explicit FFTWComplexFFT2D(fftw_plan plan) : plan_(plan) {}
+  FFTWComplexFFT2D(const FFTWComplexFFT2D &) = delete;
+  FFTWComplexFFT2D &operator=(const FFTWComplexFFT2D &) = delete;
+  ~FFTWComplexFFT2D() override { fftw_destroy_plan(plan_); }
+
+  void forward() override { fftw_execute(plan_); }
+};
+
+}// namespace
+
+FFTWBackend::FFTWBackend(FFTPlanning planning, int n_threads)
+    : rigour_(planner_flag(planning)), n_threads_(max(n_threads, 1)) {
+#ifdef TDMS_FFTW_THREADS
+  // must precede any other call to FFTW, and be made once only
+  static once_flag threads_initialised;
+  call_once(threads_initialised, []() {
+    if (!fftw_init_threads()) {
+      spdlog::warn("Could not initialise the threads of FFTW");
+    }
+  });
+#endif
+}
+
+shared_ptr<const BatchedRealFFT>
+FFTWBackend::plan_batched_real(int N, int batch_size) const {
+  return make_shared<const FFTWBatchedRealFFT>(N, batch_size, rigour_);
+}
+
+unique_ptr<ComplexFFT2D>
+FFTWBackend::plan_complex_2d(int n_0, int n_1, fftw_complex *data) const {
+#ifdef TDMS_FFTW_THREADS
+  // the PSTD transforms are already executed by many threads, one line batch
+  // each, so only this plan is split between threads
+  fftw_plan_with_nthreads(n_threads_);
+#endif
+  fftw_plan plan =
+          fftw_plan_dft_2d(n_0, n_1, data, data, FFTW_FORWARD, rigour_);
+#ifdef TDMS_FFTW_THREADS
+  fftw_plan_with_nthreads(1);
+#endif
+  if (plan == nullptr) {
+    throw runtime_error("FFTW could not plan a 2D transform of " +
+                        to_string(n_0) + "x" + to_string(n_1));
+  }
+  return make_unique<FFTWComplexFFT2D>(plan);
+}
+
+bool FFTWBackend::import_wisdom(const string &file) const {
+  return fftw_import_wisdom_from_filename(file.c_str()) != 0;
+}
+
+bool FFTWBackend::export_wisdom(const string &file) const {
+  return fftw_export_wisdom_to_filename(file.c_str()) != 0;
+}
+
+bool FFTWBackend::import_wisdom_from_string(const string &wisdom) const {
+  return fftw_import_wisdom_from_string(wisdom.c_str()) != 0;
+}
+
+string FFTWBackend::export_wisdom_to_string() const {
+  char *exported = fftw_export_wisdom_to_string();
+  if (exported == nullptr) { return ""; }
+  string wisdom(exported);
+  free(exported);
+  return wisdom;
+}
+
+unique_ptr<FFTBackend> make_fft_backend(FFTLibrary library,
+                                        FFTPlanning planning, int n_threads) {
+  switch (library) {
+    case FFTLibrary::Builtin:
+      return make_unique<BuiltinFFTBackend>();
+    default:
+      return make_unique<FFTWBackend>(planning, n_threads);
+  }
+}
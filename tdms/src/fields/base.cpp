@@ -198,29 +198,36 @@ Field::~Field() {
 }
 
 void Field::set_phasors(SplitField &F, int n, double omega, double dt, int Nt) {
+  set_phasors(F, n, omega, dt, Nt,
+              {{il, jl, kl}, {iu + 1, ju + 1, ku + 1}});
+}
 
-  complex<double> subResult;
-  double x_m, y_m, z_m;
+void Field::set_phasors(SplitField &F, int n, double omega, double dt, int Nt,
+                        const CellBox &cells) {
+  CellBox box = cells.intersection({{il, jl, kl}, {iu + 1, ju + 1, ku + 1}});
 
   auto phaseTerm =
           exp(phase(n, omega, dt) * IMAGINARY_UNIT) * 1. / ((double) Nt);
 
-#pragma omp parallel default(shared) private(x_m, y_m, z_m, subResult)
-  {
-#pragma omp for
-    for (int k = kl; k <= ku; k++)
-      for (int j = jl; j <= ju; j++)
-        for (int i = il; i <= iu; i++) {
+  // The split field is stored with k varying fastest, and the phasors with i
+  // varying fastest, so the cells are visited in tiles of PHASOR_TILE k-layers:
+  // each i reads a short run of k from the split field, and consecutive i
+  // write to the same few rows of the phasors, which stay in cache.
+#pragma omp for collapse(2)
+  for (int k_tile = box.lower.k; k_tile < box.upper.k; k_tile += PHASOR_TILE)
+    for (int j = box.lower.j; j < box.upper.j; j++)
+      for (int i = box.lower.i; i < box.upper.i; i++)
+        for (int k = k_tile; k < min(k_tile + PHASOR_TILE, box.upper.k); k++) {
 
-          x_m = F.xy(i, j, k) + F.xz(i, j, k);
-          y_m = F.yx(i, j, k) + F.yz(i, j, k);
-          z_m = F.zx(i, j, k) + F.zy(i, j, k);
+          double x_m = F.x(i, j, k);
+          double y_m = F.y(i, j, k);
+          double z_m = F.z(i, j, k);
 
           int di = i - il;
           int dj = j - jl;
           int dk = k - kl;
 
-          subResult = x_m * phaseTerm;
+          complex<double> subResult = x_m * phaseTerm;
           real.x[dk][dj][di] += std::real(subResult);
           imag.x[dk][dj][di] += std::imag(subResult);
 
@@ -232,7 +239,14 @@ void Field::set_phasors(SplitField &F, int n, double omega, double dt, int Nt) {
           real.z[dk][dj][di] += std::real(subResult);
           imag.z[dk][dj][di] += std::imag(subResult);
         }
+}
+
+void Field::swap_values(Field &other) {
+  if (other.tot.i != tot.i || other.tot.j != tot.j || other.tot.k != tot.k) {
+    throw runtime_error("Cannot swap the values of fields of different sizes");
   }
+  std::swap(real, other.real);
+  std::swap(imag, other.imag);
 }
 
 void Field::set_values_from(Field &other) {
@@ -341,8 +341,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
         for (int ind = b_scheme->first_nonzero_coeff;
              ind <= b_scheme->last_nonzero_coeff; ind++) {
           data_for_first_scheme[ind] =
-                  xy(i, j, k - b_scheme->number_of_datapoints_to_left + ind) +
-                  xz(i, j, k - b_scheme->number_of_datapoints_to_left + ind);
+                  x(i, j, k - b_scheme->number_of_datapoints_to_left + ind);
         }
 
         // now run the interpolation scheme and place the result into the output
@@ -367,8 +366,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
               // don't need to define this here)
               int cell_k = k - c_scheme->number_of_datapoints_to_left + kk;
               // gather the data for interpolating in the z dimension
-              data_for_first_scheme[kk] =
-                      xy(i, cell_j, cell_k) + xz(i, cell_j, cell_k);
+              data_for_first_scheme[kk] = x(i, cell_j, cell_k);
             }
             // interpolate in z to obtain a value for the Hx field at position
             // (i, cell_j+Dy, k) place this into the appropriate index in the
@@ -394,8 +392,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
               // don't need to define this here)
               int cell_j = j - b_scheme->number_of_datapoints_to_left + jj;
               // gather the data for interpolating in the y dimension
-              data_for_first_scheme[jj] =
-                      xy(i, cell_j, cell_k) + xz(i, cell_j, cell_k);
+              data_for_first_scheme[jj] = x(i, cell_j, cell_k);
             }
             // interpolate in y to obtain a value for the Hx field at position
             // (i, j, cell_k+Dz) place this into the appropriate index in the
@@ -431,8 +428,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
             // don't need to define this here)
             int cell_k = k - b_scheme->number_of_datapoints_to_left + kk;
             // gather the data for interpolating in the z dimension
-            data_for_first_scheme[kk] =
-                    yx(cell_i, j, cell_k) + yz(cell_i, j, cell_k);
+            data_for_first_scheme[kk] = y(cell_i, j, cell_k);
           }
           // interpolate in z to obtain a value for the Hy field at position
           // (cell_i+Dx, j, k) place this into the appropriate index in the data
@@ -457,8 +453,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
             // don't need to define this here)
             int cell_i = i - c_scheme->number_of_datapoints_to_left + ii;
             // gather the data for interpolating in the x dimension
-            data_for_first_scheme[ii] =
-                    yx(cell_i, j, cell_k) + yz(cell_i, j, cell_k);
+            data_for_first_scheme[ii] = y(cell_i, j, cell_k);
           }
           // interpolate in x to obtain a value for the Hy field at position (i,
           // j, cell_k+Dz) place this into the appropriate index in the data
@@ -481,8 +476,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
         for (int ind = b_scheme->first_nonzero_coeff;
              ind <= b_scheme->last_nonzero_coeff; ind++) {
           data_for_first_scheme[ind] =
-                  zx(i - b_scheme->number_of_datapoints_to_left + ind, j, k) +
-                  zy(i - b_scheme->number_of_datapoints_to_left + ind, j, k);
+                  z(i - b_scheme->number_of_datapoints_to_left + ind, j, k);
         }
 
         // now run the interpolation scheme and place the result into the output
@@ -507,8 +501,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
               // don't need to define this here)
               int cell_j = j - c_scheme->number_of_datapoints_to_left + jj;
               // gather the data for interpolating in the y dimension
-              data_for_first_scheme[jj] =
-                      zx(cell_i, cell_j, k) + zy(cell_i, cell_j, k);
+              data_for_first_scheme[jj] = z(cell_i, cell_j, k);
             }
             // interpolate in y to obtain a value for the Hz field at position
             // (cell_i+Dx, j, k) place this into the appropriate index in the
@@ -534,8 +527,7 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
               // don't need to define this here)
               int cell_i = i - b_scheme->number_of_datapoints_to_left + ii;
               // gather the data for interpolating in the x dimension
-              data_for_first_scheme[ii] =
-                      zx(cell_i, cell_j, k) + zy(cell_i, cell_j, k);
+              data_for_first_scheme[ii] = z(cell_i, cell_j, k);
             }
             // interpolate in x to obtain a value for the Hz field at position
             // (i, j, cell_k+Dz) place this into the appropriate index in the
@@ -554,3 +546,23 @@ double MagneticSplitField::interpolate_to_centre_of(AxialDirection d,
               "Error: invalid axial direction selected for interpolation\n");
   }
 }
+
+InterpolationStencil
+MagneticSplitField::interpolation_stencil(AxialDirection d,
+                                          CellCoordinate cell) {
+  // Each component is interpolated along the two directions it is offset in
+  // from the centre, of which there is one for Hx and Hz in a 2D simulation
+  switch (d) {
+    case X:
+      if (tot.j <= 1) { return stencil_along(Z, cell); }
+      return combine(stencil_along(Y, cell), stencil_along(Z, cell), cell);
+    case Y:
+      return combine(stencil_along(X, cell), stencil_along(Z, cell), cell);
+    case Z:
+      if (tot.j <= 1) { return stencil_along(X, cell); }
+      return combine(stencil_along(X, cell), stencil_along(Y, cell), cell);
+    default:
+      throw runtime_error(
+              "Error: invalid axial direction selected for interpolation\n");
+  }
+}
@@ -7,41 +7,115 @@
 using namespace std;
 
 
-void SplitFieldComponent::initialise_fftw_plan(int n_threads, int size,
-                                               EHVec &eh_vec) {
-
-  this->n_threads = n_threads;
-  plan_f = (fftw_plan *) malloc(sizeof(fftw_plan *) * n_threads);
-  plan_b = (fftw_plan *) malloc(sizeof(fftw_plan *) * n_threads);
-
-  for (int i = 0; i < n_threads; i++) {
-    plan_f[i] = fftw_plan_dft_1d(size, eh_vec[i], eh_vec[i], FFTW_FORWARD,
-                                 FFTW_MEASURE);
-    plan_b[i] = fftw_plan_dft_1d(size, eh_vec[i], eh_vec[i], FFTW_BACKWARD,
-                                 FFTW_MEASURE);
-  }
-}
-
 void SplitFieldComponent::initialise_from_matlab(double ***tensor,
                                                  Dimensions &dims) {
+  set_layer_padding(FieldStorage::pad_rows);
   initialise(tensor, dims[2], dims[1], dims[0], true);
 }
 
-SplitFieldComponent::~SplitFieldComponent() {
+bool SplitFieldComponent::lay_out_pml_rows(const CellBox &interior) {
+  CellBox omitted = {{max(interior.lower.i, 0), max(interior.lower.j, 0),
+                      max(interior.lower.k, 0)},
+                     {min(interior.upper.i, n_rows_),
+                      min(interior.upper.j, n_cols_),
+                      min(interior.upper.k, n_layers_)}};
+  if (omitted.empty()) { return false; }
+  omitted_ = omitted;
+
+  int n_omitted = omitted_.upper.k - omitted_.lower.k;
+  rows_.assign((size_t) n_rows_ * n_cols_, PmlRow());
+  ptrdiff_t n_stored = 0;
+  for (int i = 0; i < n_rows_; i++) {
+    for (int j = 0; j < n_cols_; j++) {
+      PmlRow &row = rows_[i * n_cols_ + j];
+      row.start = n_stored;
+      row.n_omitted = omitted_.contains(i, j) ? n_omitted : 0;
+      n_stored += n_layers_ - row.n_omitted;
+    }
+  }
+  pml_data_ = vector<field_t, FieldAllocator<field_t>>(n_stored);
+  return true;
+}
 
-  for (auto plan : {plan_f, plan_b}) {
-    if (plan == nullptr) continue;
+void SplitFieldComponent::store_pml_only(const CellBox &interior) {
+  if (!has_elements() || !lay_out_pml_rows(interior)) { return; }
+
+  // first touch the compact storage with the same partitioning as allocate()
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < n_rows_; i++) {
+    for (int j = 0; j < n_cols_; j++) {
+      for (int k = 0; k < n_layers_; k++) {
+        if (!omitted_.contains(i, j, k)) {
+          pml_data_[pml_index(i, j, k)] = operator()(i, j, k);
+        }
+      }
+    }
+  }
+  // release the storage of the whole grid
+  vector<field_t, FieldAllocator<field_t>>().swap(data_);
+}
 
-    for (int i = 0; i < n_threads; i++) { fftw_destroy_plan(plan[i]); }
-    free(plan);
+void SplitFieldComponent::allocate_pml_only(int n_layers, int n_cols,
+                                            int n_rows,
+                                            const CellBox &interior) {
+  n_layers_ = n_layers;
+  n_cols_ = n_cols;
+  n_rows_ = n_rows;
+  origin_ = {0, 0, 0};
+  layer_stride_ = n_layers;
+  if (!lay_out_pml_rows(interior)) {
+    // nothing is omitted, so store the whole grid
+    rows_.clear();
+    pml_data_.clear();
+    set_layer_padding(FieldStorage::pad_rows);
+    allocate(n_layers, n_cols, n_rows);
+    return;
+  }
+  vector<field_t, FieldAllocator<field_t>>().swap(data_);
+
+  // first touch the compact storage with the same partitioning as allocate()
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < n_rows_; i++) {
+    for (int j = 0; j < n_cols_; j++) {
+      for (int k = 0; k < n_layers_; k++) {
+        if (!omitted_.contains(i, j, k)) { pml_data_[pml_index(i, j, k)] = 0; }
+      }
+    }
   }
 }
 
+void SplitFieldComponent::zero() {
+  Tensor3D::zero();
+  fill(pml_data_.begin(), pml_data_.end(), 0);
+}
+
 void SplitField::allocate() {
+  allocate({{0, 0, 0}, {tot.i + 1, tot.j + 1, tot.k + 1}});
+}
+
+void SplitField::allocate(const CellBox &cells) {
+
+  for (auto component : {&xy, &xz, &yx, &yz, &zx, &zy}) {
+    component->set_layer_padding(FieldStorage::pad_rows);
+    component->allocate(cells);
+  }
+}
+
+void SplitField::restrict_to(const CellBox &cells) {
+  if (has_unsplit_interior()) {
+    throw runtime_error("A field stored unsplit in its interior cannot be "
+                        "restricted to a box of cells");
+  }
+  for (auto component : {&xy, &xz, &yx, &yz, &zx, &zy}) {
+    component->restrict_to(cells);
+  }
+}
 
+CellBox SplitField::stored_cells() const {
   for (auto component : {&xy, &xz, &yx, &yz, &zx, &zy}) {
-    component->allocate(tot.k + 1, tot.j + 1, tot.i + 1);
+    if (component->has_elements()) { return component->stored_cells(); }
   }
+  return {{0, 0, 0}, {tot.i + 1, tot.j + 1, tot.k + 1}};
 }
 
 SplitField::SplitField(int I_total, int J_total, int K_total) {
@@ -55,29 +129,18 @@ void SplitField::zero() {
   for (auto component : {&xy, &xz, &yx, &yz, &zx, &zy}) { component->zero(); }
 }
 
-void SplitField::initialise_fftw_plan(int n_threads, EHVec &eh_vec) {
-
-  // N_e_y
-  int n_x = tot.i + delta_n() + 1;
-  int n_y = tot.j + delta_n() + 1;
-  int n_z = tot.k + delta_n() + 1;
-
-  xy.initialise_fftw_plan(n_threads, n_y, eh_vec);
-  xz.initialise_fftw_plan(n_threads, n_z, eh_vec);
-  yx.initialise_fftw_plan(n_threads, n_x, eh_vec);
-  yz.initialise_fftw_plan(n_threads, n_z, eh_vec);
-  zx.initialise_fftw_plan(n_threads, n_x, eh_vec);
-  zy.initialise_fftw_plan(n_threads, n_y, eh_vec);
+double SplitField::largest_field_value() {
+  return largest_field_value(stored_cells());
 }
 
-double SplitField::largest_field_value() {
+double SplitField::largest_field_value(const CellBox &cells) {
   double largest_value = 0.;
-  for (int k = 0; k < (tot.k + 1); k++) {
-    for (int j = 0; j < (tot.j + 1); j++) {
-      for (int i = 0; i < (tot.i + 1); i++) {
-        double x_field = fabs(xy(i, j, k) + xz(i, j, k));
-        double y_field = fabs(yx(i, j, k) + yz(i, j, k));
-        double z_field = fabs(zx(i, j, k) + zy(i, j, k));
+  for (int i = cells.lower.i; i < cells.upper.i; i++) {
+    for (int j = cells.lower.j; j < cells.upper.j; j++) {
+      for (int k = cells.lower.k; k < cells.upper.k; k++) {
+        double x_field = fabs(x(i, j, k));
+        double y_field = fabs(y(i, j, k));
+        double z_field = fabs(z(i, j, k));
         if (largest_value < x_field) { largest_value = x_field; }
         if (largest_value < y_field) { largest_value = y_field; }
         if (largest_value < z_field) { largest_value = z_field; }
@@ -86,3 +149,105 @@ double SplitField::largest_field_value() {
   }
   return largest_value;
 }
+
+void SplitField::unsplit_interior(const CellBox &interior) {
+  unsplit_ = interior;
+
+  // {the component that holds the whole field, the component that is omitted}
+  pair<SplitFieldComponent *, SplitFieldComponent *> pairs[3] = {
+          {&xy, &xz}, {&yx, &yz}, {&zx, &zy}};
+  for (auto [whole, part] : pairs) {
+    if (!whole->has_elements() || !part->has_elements()) { continue; }
+
+#pragma omp parallel for schedule(static)
+    for (int i = interior.lower.i; i < interior.upper.i; i++) {
+      for (int j = interior.lower.j; j < interior.upper.j; j++) {
+        for (int k = interior.lower.k; k < interior.upper.k; k++) {
+          (*whole)(i, j, k) += (*part)(i, j, k);
+        }
+      }
+    }
+    part->store_pml_only(interior);
+  }
+}
+
+void SplitField::allocate_unsplit(const CellBox &interior) {
+  unsplit_ = interior;
+  for (auto whole : {&xy, &yx, &zx}) {
+    whole->set_layer_padding(FieldStorage::pad_rows);
+    whole->allocate(tot.k + 1, tot.j + 1, tot.i + 1);
+  }
+  for (auto part : {&xz, &yz, &zy}) {
+    part->allocate_pml_only(tot.k + 1, tot.j + 1, tot.i + 1, interior);
+  }
+}
+
+field_t &SplitField::element(SplitFieldComponent &component,
+                             const CellCoordinate &cell) {
+  if (component.stores(cell.i, cell.j, cell.k)) { return component.at(cell); }
+  // only the xz, yz, and zy components are ever omitted
+  if (&component == &xz) { return xy[cell]; }
+  if (&component == &yz) { return yx[cell]; }
+  return zx[cell];
+}
+
+InterpolationStencil
+SplitField::stencil_along(AxialDirection axis,
+                          const CellCoordinate &cell) const {
+  int datapoints, position;
+  switch (axis) {
+    case X:
+      datapoints = tot.i, position = cell.i;
+      break;
+    case Y:
+      datapoints = tot.j, position = cell.j;
+      break;
+    case Z:
+      datapoints = tot.k, position = cell.k;
+      break;
+    default:
+      throw runtime_error(
+              "Invalid axial direction selected for interpolation!\n");
+  }
+  const InterpolationScheme &scheme =
+          best_scheme(datapoints, position, interpolation_method);
+
+  InterpolationStencil stencil;
+  for (int ind = scheme.first_nonzero_coeff; ind <= scheme.last_nonzero_coeff;
+       ind++) {
+    // as in interpolate_to_centre_of, the cell that plays the role of v0 is
+    // number_of_datapoints_to_left before cell
+    int shift = ind - scheme.number_of_datapoints_to_left;
+    CellCoordinate point = cell;
+    switch (axis) {
+      case X:
+        point.i += shift;
+        break;
+      case Y:
+        point.j += shift;
+        break;
+      default:
+        point.k += shift;
+        break;
+    }
+    stencil.push_back({point, scheme.coefficient(ind)});
+  }
+  return stencil;
+}
+
+InterpolationStencil SplitField::combine(const InterpolationStencil &a,
+                                         const InterpolationStencil &b,
+                                         const CellCoordinate &cell) {
+  InterpolationStencil stencil;
+  stencil.reserve(a.size() * b.size());
+  for (const StencilPoint &p : a) {
+    for (const StencilPoint &q : b) {
+      // each point is displaced from cell along the axis of its stencil
+      CellCoordinate point = {p.cell.i + q.cell.i - cell.i,
+                              p.cell.j + q.cell.j - cell.j,
+                              p.cell.k + q.cell.k - cell.k};
+      stencil.push_back({point, p.weight * q.weight});
+    }
+  }
+  return stencil;
+}
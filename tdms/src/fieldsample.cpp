@@ -24,41 +24,68 @@ void FieldSample::set_from(const mxArray *ptr) {
   }
 }
 
+void FieldSample::compile_probes(ElectricSplitField &E_split,
+                                 const PerfectlyMatchedLayer &pml,
+                                 const GridPartition *partition) {
+  probes.clear();
+  probes.distribute(partition);
+  for (int kt = 0; kt < k.size(); kt++) {
+    for (int jt = 0; jt < j.size(); jt++) {
+      for (int it = 0; it < i.size(); it++) {
+        CellCoordinate current_cell = cell_of(it, jt, kt, pml);
+        probes.add_interpolated(E_split, AxialDirection::X, current_cell);
+        if (current_cell.j != 0) {
+          probes.add_interpolated(E_split, AxialDirection::Y, current_cell);
+        } else {
+          probes.add_value(E_split, AxialDirection::Y, current_cell);
+        }
+        probes.add_interpolated(E_split, AxialDirection::Z, current_cell);
+      }
+    }
+  }
+}
+
 void FieldSample::extract(ElectricSplitField &E_split,
                           PerfectlyMatchedLayer &pml,
                           int n_simulation_timesteps) {
-  double Ex_temp = 0., Ey_temp = 0., Ez_temp = 0.;
+  // evaluate the compiled probes, if there are any, all at once
+  bool compiled = !probes.empty();
+  if (compiled) { probes.evaluate(E_split); }
 
 /* Extract the (electric) field at each of the vertices.
 Since the split-field has already been computed, we can do this in parallel by
 reading the values from the split field and interpolating to the vertices
 independently of each other.
 */
-#pragma omp parallel default(shared) private(Ex_temp, Ey_temp, Ez_temp)
-  {
 #pragma omp for
-    for (int kt = 0; kt < k.size(); kt++) {
-      for (int jt = 0; jt < j.size(); jt++) {
-        for (int it = 0; it < i.size(); it++) {
-          CellCoordinate current_cell{i[it] + pml.Dxl - 1, j[jt] + pml.Dyl - 1,
-                                      k[kt] + pml.Dzl - 1};
+  for (int kt = 0; kt < k.size(); kt++) {
+    for (int jt = 0; jt < j.size(); jt++) {
+      for (int it = 0; it < i.size(); it++) {
+        double Ex_temp, Ey_temp, Ez_temp;
+        if (compiled) {
+          int probe = 3 * ((kt * j.size() + jt) * i.size() + it);
+          Ex_temp = probes.value(probe);
+          Ey_temp = probes.value(probe + 1);
+          Ez_temp = probes.value(probe + 2);
+        } else {
+          CellCoordinate current_cell = cell_of(it, jt, kt, pml);
           Ex_temp = E_split.interpolate_to_centre_of(AxialDirection::X,
                                                      current_cell);
           if (current_cell.j != 0) {
             Ey_temp = E_split.interpolate_to_centre_of(AxialDirection::Y,
                                                        current_cell);
           } else {
-            Ey_temp = E_split.yx[current_cell] + E_split.yz[current_cell];
+            Ey_temp = E_split.y(current_cell);
           }
           Ez_temp = E_split.interpolate_to_centre_of(AxialDirection::Z,
                                                      current_cell);
-          for (int nt = 0; nt < n.size(); nt++)
-            tensor[nt][kt][jt][it] +=
-                    pow(Ex_temp * Ex_temp + Ey_temp * Ey_temp +
-                                Ez_temp * Ez_temp,
-                        n[nt] / 2.) /
-                    n_simulation_timesteps;
         }
+        for (int nt = 0; nt < n.size(); nt++)
+          tensor[nt][kt][jt][it] +=
+                  pow(Ex_temp * Ex_temp + Ey_temp * Ey_temp +
+                              Ez_temp * Ez_temp,
+                      n[nt] / 2.) /
+                  n_simulation_timesteps;
       }
     }
   }
@@ -0,0 +1,53 @@
+#include "grid_partition.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#ifdef TDMS_MPI
+#include <mpi.h>
+
+#include "distributed/mpi_grid_partition.h"
+#endif
+
+using namespace std;
+
+GridPartition::GridPartition(const IJKDimensions &IJK_tot) {
+  grid_ = {{0, 0, 0}, {IJK_tot.i + 1, IJK_tot.j + 1, IJK_tot.k + 1}};
+  owned_ = grid_;
+}
+
+CellBox GridPartition::with_halo(int width) const {
+  CellBox box = owned_;
+  box.lower.i -= width;
+  box.lower.j -= width;
+  box.upper.i += width;
+  box.upper.j += width;
+  return box.intersection(grid_);
+}
+
+unique_ptr<GridPartition> make_grid_partition(bool distributed,
+                                              const IJKDimensions &IJK_tot) {
+#ifdef TDMS_MPI
+  int initialised = 0, n_processes = 1;
+  MPI_Initialized(&initialised);
+  if (initialised) { MPI_Comm_size(MPI_COMM_WORLD, &n_processes); }
+  if (distributed) {
+    if (!initialised) {
+      throw runtime_error("--distributed requires MPI to be initialised");
+    }
+    return make_unique<MPIGridPartition>(IJK_tot, MPI_COMM_WORLD);
+  }
+  if (n_processes > 1) {
+    // every process would otherwise run the whole simulation
+    throw runtime_error("TDMS was launched on " + to_string(n_processes) +
+                        " MPI processes without --distributed");
+  }
+#else
+  if (distributed) {
+    throw runtime_error("--distributed requires TDMS to be built with "
+                        "-DTDMS_MPI=ON");
+  }
+#endif
+  return make_unique<GridPartition>(IJK_tot);
+}
@@ -23,9 +23,13 @@ int InputMatrices::index_from_matrix_name(const string &matrix_name) {
   return distance(matrixnames_input_with_grid.begin(), position);
 }
 
-void InputMatrices::set_from_input_file(const char *mat_filename) {
-  input_filename = std::string(mat_filename);
-  MatrixCollection infile_expected(matrixnames_input_with_grid);
+void InputMatrices::set_from_input_file(const char *mat_filename,
+                                        bool read_grid) {
+  input_filename = grid_filename = std::string(mat_filename);
+  // the input file holds every matrix, fdtdgrid among them, which is loaded
+  // only if read_grid
+  MatrixCollection infile_expected(read_grid ? matrixnames_input_with_grid
+                                             : matrixnames_infile);
   MatFileMatrixCollection infile_contains(mat_filename);
   spdlog::info("Input file: " + input_filename + " | No gridfile supplied");
 
@@ -35,50 +39,49 @@ void InputMatrices::set_from_input_file(const char *mat_filename) {
   // assign the pointers to the matrices
   assign_matrix_pointers(infile_expected, infile_contains);
 
-  // Add fields to fdtdgrid
-  auto initialiser = fdtdGridInitialiser(
-          matrix_pointers[index_from_matrix_name("fdtdgrid")], mat_filename);
-  const vector<string> fdtdgrid_element_names = {"Exy", "Exz", "Eyx", "Eyz",
-                                                 "Ezx", "Ezy", "Hxy", "Hxz",
-                                                 "Hyx", "Hyz", "Hzx", "Hzy"};
-
-  for (const auto &name : fdtdgrid_element_names) {
-    initialiser.add_tensor(name);
+  // Strip the dimensions from fdtdgrid, which leaves its materials. The split
+  // fields are not read from it, see init_grid_arrays.
+  if (read_grid) {
+    fdtdGridInitialiser(matrix_pointers[index_from_matrix_name("fdtdgrid")],
+                        mat_filename);
   }
 
   // validate the input arguments
   validate_assigned_pointers();
 }
 void InputMatrices::set_from_input_file(const char *mat_filename,
-                                        const char *gridfile) {
+                                        const char *gridfile, bool read_grid) {
   input_filename = std::string(mat_filename);
+  grid_filename = std::string(gridfile);
   MatrixCollection infile_expected(matrixnames_infile);
   MatFileMatrixCollection infile_contains(mat_filename);
   spdlog::info("Input file: " + input_filename +
                " | Gridfile: " + string(gridfile));
 
-  // first extract fdtdgrid from the gridfile provided
+  // first extract fdtdgrid from the gridfile provided, unless the materials
+  // of the grid are to be read later, a block at a time
   MatrixCollection gridfile_expected(matrixnames_gridfile);
   MatFileMatrixCollection gridfile_contains(gridfile);
   gridfile_contains.check_has_at_least_as_many_matrices_as(gridfile_expected);
-
-  // this is the matrix name we are searching for in the gridfile
-  string fdtd_matrix_search_string = gridfile_expected.matrix_names[0];
-  // check that the gridfile actually contains the fdtdgrid
-  auto position =
-          find(gridfile_contains.matrix_names.begin(),
-               gridfile_contains.matrix_names.end(), fdtd_matrix_search_string);
-  if (position == matrixnames_input_with_grid.end()) {
-    throw runtime_error(fdtd_matrix_search_string + " not found in gridfile");
-  }
-  // attempt to set the pointer
-  auto pointer = matGetVariable(gridfile_contains.mat_file,
-                                fdtd_matrix_search_string.c_str());
-  if (pointer == nullptr) {
-    throw runtime_error("Could not get pointer to " +
-                        fdtd_matrix_search_string);
+  if (read_grid) {
+    // this is the matrix name we are searching for in the gridfile
+    string fdtd_matrix_search_string = gridfile_expected.matrix_names[0];
+    // check that the gridfile actually contains the fdtdgrid
+    auto position = find(gridfile_contains.matrix_names.begin(),
+                         gridfile_contains.matrix_names.end(),
+                         fdtd_matrix_search_string);
+    if (position == matrixnames_input_with_grid.end()) {
+      throw runtime_error(fdtd_matrix_search_string + " not found in gridfile");
+    }
+    // attempt to set the pointer
+    auto pointer = matGetVariable(gridfile_contains.mat_file,
+                                  fdtd_matrix_search_string.c_str());
+    if (pointer == nullptr) {
+      throw runtime_error("Could not get pointer to " +
+                          fdtd_matrix_search_string);
+    }
+    set_matrix_pointer("fdtdgrid", pointer);
   }
-  set_matrix_pointer("fdtdgrid", pointer);
 
   // now pick up the other matrix inputs from the usual input file
   // check that the input file actually has enough matrices for what we're
@@ -87,15 +90,11 @@ void InputMatrices::set_from_input_file(const char *mat_filename,
   // assign the pointers to the matrices
   assign_matrix_pointers(infile_expected, infile_contains);
 
-  // Add fields to fdtdgrid
-  auto initialiser = fdtdGridInitialiser(
-          matrix_pointers[index_from_matrix_name("fdtdgrid")], mat_filename);
-  const vector<string> fdtdgrid_element_names = {"Exy", "Exz", "Eyx", "Eyz",
-                                                 "Ezx", "Ezy", "Hxy", "Hxz",
-                                                 "Hyx", "Hyz", "Hzx", "Hzy"};
-
-  for (const auto &name : fdtdgrid_element_names) {
-    initialiser.add_tensor(name);
+  // Strip the dimensions from fdtdgrid, which leaves its materials. The split
+  // fields are not read from it, see init_grid_arrays.
+  if (read_grid) {
+    fdtdGridInitialiser(matrix_pointers[index_from_matrix_name("fdtdgrid")],
+                        mat_filename);
   }
 
   // validate the input arguments
@@ -124,9 +123,12 @@ void InputMatrices::assign_matrix_pointers(MatrixCollection &expected,
 }
 
 void InputMatrices::validate_assigned_pointers() {
-  // certain arrays must be structure arrays
-  assert_is_struct(matrix_pointers[index_from_matrix_name("fdtdgrid")],
-                   "fdtdgrid");
+  // certain arrays must be structure arrays. fdtdgrid may have been left
+  // unread, see set_from_input_file.
+  if (matrix_pointers[index_from_matrix_name("fdtdgrid")] != nullptr) {
+    assert_is_struct(matrix_pointers[index_from_matrix_name("fdtdgrid")],
+                     "fdtdgrid");
+  }
   assert_is_struct(matrix_pointers[index_from_matrix_name("Cmaterial")],
                    "Cmaterial");
   assert_is_struct(matrix_pointers[index_from_matrix_name("Dmaterial")],
@@ -2,6 +2,15 @@
  * @file main.cpp
  * @brief The main function. Launches TDMS.
  */
+#include <cstdlib>
+#include <exception>
+
+#ifdef TDMS_MPI
+#include <mpi.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
 #include "argument_parser.h"
 #include "input_flags.h"
 #include "input_matrices.h"
@@ -9,35 +18,80 @@
 
 using namespace tdms_matrix_names;
 
-int main(int nargs, char *argv[]) {
+#ifdef TDMS_MPI
+/**
+ * @brief Initialises MPI for the lifetime of the object, and finalises it when
+ * the object goes out of scope.
+ *
+ * Every process of an MPI run reads the inputs, and communicates from the
+ * master thread of its OpenMP team only, so MPI must provide (at least)
+ * MPI_THREAD_FUNNELED support. The run is aborted if it does not.
+ */
+class MPISession {
+public:
+  MPISession(int *nargs, char ***argv) {
+    int thread_support;
+    MPI_Init_thread(nargs, argv, MPI_THREAD_FUNNELED, &thread_support);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+    if (thread_support < MPI_THREAD_FUNNELED) {
+      spdlog::critical("The MPI library does not support calls from the master "
+                       "thread of an OpenMP team (MPI_THREAD_FUNNELED)");
+      MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+  }
+  MPISession(const MPISession &) = delete;
+  MPISession &operator=(const MPISession &) = delete;
+  ~MPISession() { MPI_Finalize(); }
 
-// Set the logging level with a compile-time #define for debugging
-#if SPDLOG_ACTIVE_LEVEL == SPDLOG_LEVEL_DEBUG
-  spdlog::set_level(spdlog::level::debug);
-#elif SPDLOG_ACTIVE_LEVEL == SPDLOG_LEVEL_INFO
-  spdlog::set_level(spdlog::level::info);
+  /** @brief The rank of this process in MPI_COMM_WORLD */
+  int rank() const { return rank_; }
+
+  /**
+   * @brief Stop every process of the run after this one has failed.
+   *
+   * The other processes may be waiting for this one in a collective call, so
+   * cannot be finalised, and are aborted instead.
+   */
+  [[noreturn]] void abort(const std::exception &e) const {
+    spdlog::critical("Process {} failed: {}", rank_, e.what());
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    std::abort();
+  }
+
+private:
+  int rank_ = 0;
+};
 #endif
 
+/** @brief Read the inputs, run the simulation, and write the outputs */
+static void run_tdms(int nargs, char *argv[]) {
   InputMatrices matrix_inputs;
 
   auto args = ArgumentParser::parse_args(nargs, argv);
   args.check_files_can_be_accessed();
 
   // now it is safe to use matlab routines to open the file and order the
-  // matrices
+  // matrices. Each process of a distributed grid reads the materials of its
+  // own block of the grid only, once the grid has been partitioned.
+  SolverOptions options = args.solver_options();
+  bool read_grid = !options.distributed;
   if (!args.has_grid_filename()) {
-    matrix_inputs.set_from_input_file(args.input_filename());
+    matrix_inputs.set_from_input_file(args.input_filename(), read_grid);
   } else {
     matrix_inputs.set_from_input_file(args.input_filename(),
-                                      args.grid_filename());
+                                      args.grid_filename(), read_grid);
   }
 
   // read flag-variables from the input file next
   InputFlags flags_in_input_file(args.input_filename());
   flags_in_input_file.report_flag_state();
 
+  // The storage of the field arrays must be chosen before they are allocated
+  FieldStorage::huge_pages = options.huge_pages;
+  FieldStorage::pad_rows = options.pad_rows;
+
   // Handles the running of the simulation, given the inputs to the executable.
-  SimulationManager simulation(matrix_inputs, flags_in_input_file);
+  SimulationManager simulation(matrix_inputs, flags_in_input_file, options);
 
   // now run the time propagation code
   simulation.execute();
@@ -48,6 +102,27 @@ int main(int nargs, char *argv[]) {
   // save the outputs, possibly in compressed format
   simulation.write_outputs_to_file(args.output_filename(),
                                    args.compressed_output());
+}
+
+int main(int nargs, char *argv[]) {
+
+// Set the logging level with a compile-time #define for debugging
+#if SPDLOG_ACTIVE_LEVEL == SPDLOG_LEVEL_DEBUG
+  spdlog::set_level(spdlog::level::debug);
+#elif SPDLOG_ACTIVE_LEVEL == SPDLOG_LEVEL_INFO
+  spdlog::set_level(spdlog::level::info);
+#endif
+
+#ifdef TDMS_MPI
+  MPISession mpi(&nargs, &argv);
+  // the root process logs the progress of the run for every process
+  if (mpi.rank() != 0) { spdlog::set_level(spdlog::level::warn); }
 
+  try {
+    run_tdms(nargs, argv);
+  } catch (const std::exception &e) { mpi.abort(e); }
+#else
+  run_tdms(nargs, argv);
+#endif
   return 0;
 }
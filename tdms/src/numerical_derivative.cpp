@@ -1,7 +1,9 @@
 #include "numerical_derivative.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <utility>
 
 #include <fftw3.h>
 #include <spdlog/spdlog.h>
@@ -81,3 +83,78 @@ void first_derivative(fftw_complex *in_pb_pf, fftw_complex *out_pb_pf,
     out_pb_pf[i][IMAG] = out_pb_pf[i][IMAG] / ((double) N);
   }
 }
+
+void init_diff_shift_op_r2c(double delta, fftw_complex *Dk, int N) {
+  auto *full = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * N);
+  init_diff_shift_op(delta, full, N);
+  for (int i = 0; i <= N / 2; i++) {
+    Dk[i][REAL] = full[i][REAL];
+    Dk[i][IMAG] = full[i][IMAG];
+  }
+  fftw_free(full);
+}
+
+void BatchedDerivative::initialise(
+        double delta, int n_threads,
+        std::shared_ptr<const BatchedRealFFT> transform) {
+  release();
+  if (transform == nullptr || transform->N < 1) { return; }
+
+  transform_ = std::move(transform);
+  N_ = transform_->N;
+  batch_size_ = transform_->batch_size;
+  n_modes_ = N_ / 2 + 1;
+  forward_difference_ = delta > 0.;
+
+  // The transforms are unnormalised, and the derivative is with respect to
+  // the sample index rather than to the whole line, hence 1/N^2
+  Dk_ = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * n_modes_);
+  init_diff_shift_op_r2c(delta, Dk_, N_);
+  double normalisation = 1. / ((double) N_ * (double) N_);
+  for (int m = 0; m < n_modes_; m++) {
+    Dk_[m][REAL] *= normalisation;
+    Dk_[m][IMAG] *= normalisation;
+  }
+
+  // lines beyond a partial batch are transformed but never written, so start
+  // from zero
+  lines_.resize(n_threads);
+  modes_.resize(n_threads);
+  blended_.assign(n_threads, std::vector<char>(batch_size_));
+  weights_.assign(n_threads, std::vector<double>((size_t) N_ * batch_size_));
+  for (int n = 0; n < n_threads; n++) {
+    lines_[n] = (double *) fftw_malloc(sizeof(double) * N_ * batch_size_);
+    modes_[n] = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * n_modes_ *
+                                             batch_size_);
+    std::fill_n(lines_[n], N_ * batch_size_, 0.);
+  }
+}
+
+void BatchedDerivative::release() {
+  transform_.reset();
+  for (double *buffer : lines_) { fftw_free(buffer); }
+  for (fftw_complex *buffer : modes_) { fftw_free(buffer); }
+  lines_.clear();
+  modes_.clear();
+  if (Dk_ != nullptr) { fftw_free(Dk_); }
+  Dk_ = nullptr;
+  N_ = 0;
+}
+
+void BatchedDerivative::differentiate(int thread, int n_lines) {
+  double *in = lines_[thread];
+  fftw_complex *out = modes_[thread];
+
+  transform_->forward(in, out, n_lines);
+  // every line of the batch is multiplied by the same coefficient of each mode
+  for (int m = 0; m < n_modes_; m++) {
+    double Dk_re = Dk_[m][REAL], Dk_im = Dk_[m][IMAG];
+    for (int b = 0; b < n_lines; b++) {
+      fftw_complex &mode = out[m * batch_size_ + b];
+      double re = mode[REAL] * Dk_re - mode[IMAG] * Dk_im;
+      mode[IMAG] = mode[REAL] * Dk_im + mode[IMAG] * Dk_re;
+      mode[REAL] = re;
+    }
+  }
+  transform_->backward(out, in, n_lines);
+}
@@ -55,6 +55,41 @@ void OutputMatrices::setup_vertex_phasors(const mxArray *vp_ptr,
   }
 }
 
+void OutputMatrices::setup_volume_spectrum(
+        const SimulationParameters &params, const vector<double> &frequencies) {
+  if (params.source_mode != SourceMode::pulsed ||
+      params.run_mode != RunMode::complete || !params.exphasorsvolume ||
+      frequencies.empty()) {
+    spdlog::warn("The volume spectrum is only extracted by complete pulsed "
+                 "runs that extract the volume phasors, at the frequencies of "
+                 "f_ex_vec; skipping it");
+    return;
+  }
+  volume_spectrum.allocate(E, frequencies, params.dt, params.Np, params.Npe);
+  spdlog::info("Extracting the volume phasors at {} frequencies",
+               volume_spectrum.n_frequencies());
+}
+
+void OutputMatrices::assign_volume_spectrum_outputs() {
+  if (!volume_spectrum.is_enabled()) { return; }
+  vector<string> spectrum_matrices = {"Ex_spectrum", "Ey_spectrum",
+                                      "Ez_spectrum", "Hx_spectrum",
+                                      "Hy_spectrum", "Hz_spectrum"};
+  // avoid memory leaks
+  output_arrays.error_on_memory_assigned(spectrum_matrices);
+
+  const CellBox &cells = volume_spectrum.cells();
+  int dims[4] = {cells.upper.i - cells.lower.i, cells.upper.j - cells.lower.j,
+                 cells.upper.k - cells.lower.k,
+                 volume_spectrum.n_frequencies()};
+  for (int c = 0; c < 6; c++) {
+    mxArray *&matrix = output_arrays[spectrum_matrices[c]];
+    matrix = mxCreateNumericArray(4, (const mwSize *) dims, mxDOUBLE_CLASS,
+                                  mxCOMPLEX);
+    volume_spectrum.copy_to(c, mxGetPr(matrix), mxGetPi(matrix));
+  }
+}
+
 void OutputMatrices::setup_fieldsample(const mxArray *fieldsample_input_data) {
   fieldsample.set_from(fieldsample_input_data);
   output_arrays["fieldsample"] = fieldsample.mx;
@@ -79,9 +114,76 @@ void OutputMatrices::set_maxresfield(double maxfield, bool overwrite_existing) {
   *mxGetPr(output_arrays["maxresfield"]) = maxfield;
 }
 
+void OutputMatrices::set_EH_cells(const CellBox &cells) {
+  E.il = H.il = cells.lower.i;
+  E.iu = H.iu = cells.upper.i - 1;
+  E.jl = H.jl = cells.lower.j;
+  E.ju = H.ju = cells.upper.j - 1;
+  E.kl = H.kl = cells.lower.k;
+  E.ku = H.ku = cells.upper.k - 1;
+  // a process may own none of the cells of the volume
+  E.tot.i = H.tot.i = max(E.iu - E.il + 1, 0);
+  E.tot.j = H.tot.j = max(E.ju - E.jl + 1, 0);
+  E.tot.k = H.tot.k = max(E.ku - E.kl + 1, 0);
+}
+
+void OutputMatrices::create_EH_arrays() {
+  // field matrices we will be assigning
+  vector<string> field_matrices = {"Ex_out", "Ey_out", "Ez_out",
+                                   "Hx_out", "Hy_out", "Hz_out"};
+  // avoid memory leaks
+  output_arrays.error_on_memory_assigned(field_matrices);
+
+  // initialise to actual, proper arrays
+  int dims[3] = {E.tot.i, E.tot.j, E.tot.k};
+  spdlog::info("dims: ({0:d},{1:d},{2:d})", dims[0], dims[1], dims[2]);
+
+  // create MATLAB data storage for the field-component outputs
+  for (string matrix : field_matrices) {
+    output_arrays[matrix] = mxCreateNumericArray(3, (const mwSize *) dims,
+                                                 mxDOUBLE_CLASS, mxCOMPLEX);
+  }
+
+  // cast E and H members to the MATLAB structures
+  E.real.x = cast_matlab_3D_array(mxGetPr(output_arrays["Ex_out"]), E.tot.i,
+                                  E.tot.j, E.tot.k);
+  E.imag.x = cast_matlab_3D_array(mxGetPi(output_arrays["Ex_out"]), E.tot.i,
+                                  E.tot.j, E.tot.k);
+
+  E.real.y = cast_matlab_3D_array(mxGetPr(output_arrays["Ey_out"]), E.tot.i,
+                                  E.tot.j, E.tot.k);
+  E.imag.y = cast_matlab_3D_array(mxGetPi(output_arrays["Ey_out"]), E.tot.i,
+                                  E.tot.j, E.tot.k);
+
+  E.real.z = cast_matlab_3D_array(mxGetPr(output_arrays["Ez_out"]), E.tot.i,
+                                  E.tot.j, E.tot.k);
+  E.imag.z = cast_matlab_3D_array(mxGetPi(output_arrays["Ez_out"]), E.tot.i,
+                                  E.tot.j, E.tot.k);
+
+  H.real.x = cast_matlab_3D_array(mxGetPr(output_arrays["Hx_out"]), H.tot.i,
+                                  H.tot.j, H.tot.k);
+  H.imag.x = cast_matlab_3D_array(mxGetPi(output_arrays["Hx_out"]), H.tot.i,
+                                  H.tot.j, H.tot.k);
+
+  H.real.y = cast_matlab_3D_array(mxGetPr(output_arrays["Hy_out"]), H.tot.i,
+                                  H.tot.j, H.tot.k);
+  H.imag.y = cast_matlab_3D_array(mxGetPi(output_arrays["Hy_out"]), H.tot.i,
+                                  H.tot.j, H.tot.k);
+
+  H.real.z = cast_matlab_3D_array(mxGetPr(output_arrays["Hz_out"]), H.tot.i,
+                                  H.tot.j, H.tot.k);
+  H.imag.z = cast_matlab_3D_array(mxGetPi(output_arrays["Hz_out"]), H.tot.i,
+                                  H.tot.j, H.tot.k);
+
+  // initialise field arrays
+  E.zero();
+  H.zero();
+}
+
 void OutputMatrices::setup_EH_and_gridlabels(
         const SimulationParameters &params, const GridLabels &input_grid_labels,
-        InterpolationMethod interpolation_method) {
+        InterpolationMethod interpolation_method,
+        const GridPartition *partition) {
   // set the interpolation methods
   set_interpolation_methods(interpolation_method);
 
@@ -90,19 +192,20 @@ void OutputMatrices::setup_EH_and_gridlabels(
   will form the range of cells over which we interpolate. This also provides a
   translation between the global Yee cell indexing system and the local indexing
   system, cell (il, jl, kl) is local cell (0,0,0). */
-  E.il = H.il = (params.pml.Dxl) ? params.pml.Dxl + 2 : 0;
-  E.iu = H.iu =
-          (params.pml.Dxu) ? n_Yee_cells.i - params.pml.Dxu - 1 : n_Yee_cells.i;
-  E.jl = H.jl = (params.pml.Dyl) ? params.pml.Dyl + 2 : 0;
-  E.ju = H.ju =
-          (params.pml.Dyu) ? n_Yee_cells.j - params.pml.Dyu - 1 : n_Yee_cells.j;
-  E.kl = H.kl = (params.pml.Dzl) ? params.pml.Dzl + 2 : 0;
-  E.ku = H.ku =
-          (params.pml.Dzu) ? n_Yee_cells.k - params.pml.Dzu - 1 : n_Yee_cells.k;
-  // upper/lower limits of cell extraction
-  E.tot.i = H.tot.i = E.iu - E.il + 1;
-  E.tot.j = H.tot.j = E.ju - E.jl + 1;
-  E.tot.k = H.tot.k = E.ku - E.kl + 1;
+  volume_cells.lower.i = (params.pml.Dxl) ? params.pml.Dxl + 2 : 0;
+  volume_cells.upper.i =
+          (params.pml.Dxu) ? n_Yee_cells.i - params.pml.Dxu : n_Yee_cells.i + 1;
+  volume_cells.lower.j = (params.pml.Dyl) ? params.pml.Dyl + 2 : 0;
+  volume_cells.upper.j =
+          (params.pml.Dyu) ? n_Yee_cells.j - params.pml.Dyu : n_Yee_cells.j + 1;
+  volume_cells.lower.k = (params.pml.Dzl) ? params.pml.Dzl + 2 : 0;
+  volume_cells.upper.k =
+          (params.pml.Dzu) ? n_Yee_cells.k - params.pml.Dzu : n_Yee_cells.k + 1;
+  // upper/lower limits of cell extraction: a process of a distributed grid
+  // extracts the phasors of the cells that it owns
+  set_EH_cells(partition != nullptr
+                       ? volume_cells.intersection(partition->owned())
+                       : volume_cells);
 
   // depending on the simulation, we might not need to assign this memory
   bool need_EH_memory =
@@ -118,22 +221,15 @@ void OutputMatrices::setup_EH_and_gridlabels(
     output_arrays.assign_empty_matrix(grid_matrices);
   } else {
     // avoid memory leaks
-    output_arrays.error_on_memory_assigned(field_matrices);
     output_arrays.error_on_memory_assigned(grid_matrices);
 
-    // initialise to actual, proper arrays
-    int dims[3] = {E.tot.i, E.tot.j, E.tot.k};
-    spdlog::info("dims: ({0:d},{1:d},{2:d})", dims[0], dims[1], dims[2]);
+    create_EH_arrays();
 
-    // create MATLAB data storage for the field-component outputs
-    for (string matrix : field_matrices) {
-      output_arrays[matrix] = mxCreateNumericArray(3, (const mwSize *) dims,
-                                                   mxDOUBLE_CLASS, mxCOMPLEX);
-    }
-    // create MATLAB data storage for the gridlabel outputs
-    int label_dims_x[2] = {1, E.tot.i};
-    int label_dims_y[2] = {1, E.tot.j};
-    int label_dims_z[2] = {1, E.tot.k};
+    // create MATLAB data storage for the gridlabel outputs, which label the
+    // whole volume
+    int label_dims_x[2] = {1, volume_cells.upper.i - volume_cells.lower.i};
+    int label_dims_y[2] = {1, volume_cells.upper.j - volume_cells.lower.j};
+    int label_dims_z[2] = {1, volume_cells.upper.k - volume_cells.lower.k};
     output_arrays["x_out"] = mxCreateNumericArray(
             2, (const mwSize *) label_dims_x, mxDOUBLE_CLASS, mxREAL);
     output_arrays["y_out"] = mxCreateNumericArray(
@@ -141,50 +237,78 @@ void OutputMatrices::setup_EH_and_gridlabels(
     output_arrays["z_out"] = mxCreateNumericArray(
             2, (const mwSize *) label_dims_z, mxDOUBLE_CLASS, mxREAL);
 
-    // cast E, H, and gridlabel members to the MATLAB structures
-    E.real.x = cast_matlab_3D_array(mxGetPr(output_arrays["Ex_out"]), E.tot.i,
-                                    E.tot.j, E.tot.k);
-    E.imag.x = cast_matlab_3D_array(mxGetPi(output_arrays["Ex_out"]), E.tot.i,
-                                    E.tot.j, E.tot.k);
-
-    E.real.y = cast_matlab_3D_array(mxGetPr(output_arrays["Ey_out"]), E.tot.i,
-                                    E.tot.j, E.tot.k);
-    E.imag.y = cast_matlab_3D_array(mxGetPi(output_arrays["Ey_out"]), E.tot.i,
-                                    E.tot.j, E.tot.k);
-
-    E.real.z = cast_matlab_3D_array(mxGetPr(output_arrays["Ez_out"]), E.tot.i,
-                                    E.tot.j, E.tot.k);
-    E.imag.z = cast_matlab_3D_array(mxGetPi(output_arrays["Ez_out"]), E.tot.i,
-                                    E.tot.j, E.tot.k);
-
-    H.real.x = cast_matlab_3D_array(mxGetPr(output_arrays["Hx_out"]), H.tot.i,
-                                    H.tot.j, H.tot.k);
-    H.imag.x = cast_matlab_3D_array(mxGetPi(output_arrays["Hx_out"]), H.tot.i,
-                                    H.tot.j, H.tot.k);
-
-    H.real.y = cast_matlab_3D_array(mxGetPr(output_arrays["Hy_out"]), H.tot.i,
-                                    H.tot.j, H.tot.k);
-    H.imag.y = cast_matlab_3D_array(mxGetPi(output_arrays["Hy_out"]), H.tot.i,
-                                    H.tot.j, H.tot.k);
-
-    H.real.z = cast_matlab_3D_array(mxGetPr(output_arrays["Hz_out"]), H.tot.i,
-                                    H.tot.j, H.tot.k);
-    H.imag.z = cast_matlab_3D_array(mxGetPi(output_arrays["Hz_out"]), H.tot.i,
-                                    H.tot.j, H.tot.k);
-
     // now construct the grid labels
     output_grid_labels.x = mxGetPr(output_arrays["x_out"]);
     output_grid_labels.y = mxGetPr(output_arrays["y_out"]);
     output_grid_labels.z = mxGetPr(output_arrays["z_out"]);
 
-    // initialise field arrays
-    E.zero();
-    H.zero();
-
     // initialise the gridlabels from the input grid labels (essentially shave
     // off the PML labels)
-    output_grid_labels.initialise_from(input_grid_labels, E.il, E.iu, E.jl,
-                                       E.ju, E.kl, E.ku);
+    output_grid_labels.initialise_from(
+            input_grid_labels, volume_cells.lower.i, volume_cells.upper.i - 1,
+            volume_cells.lower.j, volume_cells.upper.j - 1,
+            volume_cells.lower.k, volume_cells.upper.k - 1);
+  }
+}
+
+void OutputMatrices::gather_volume_phasors(const GridPartition &partition) {
+  // the phasors of the cells of this process, a component at a time
+  vector<double> phasors;
+  phasors.reserve(12 * (size_t) E.tot.i * E.tot.j * E.tot.k);
+  for (Field *F : {(Field *) &E, (Field *) &H}) {
+    for (XYZTensor3D<double> *part : {&F->real, &F->imag}) {
+      for (double ***component : {part->x, part->y, part->z}) {
+        for (int k = 0; k < F->tot.k; k++) {
+          for (int j = 0; j < F->tot.j; j++) {
+            double *row = component[k][j];
+            phasors.insert(phasors.end(), row, row + F->tot.i);
+          }
+        }
+      }
+    }
+  }
+  vector<double> gathered = partition.gather_to_root(phasors);
+  if (volume_spectrum.is_enabled()) {
+    volume_spectrum.gather_to_root(partition, volume_cells);
+  }
+  if (!partition.is_root()) { return; }
+
+  // replace the arrays of the cells of this process by those of the volume
+  for (Field *F : {(Field *) &E, (Field *) &H}) {
+    for (XYZTensor3D<double> *part : {&F->real, &F->imag}) {
+      for (double ****component : {&part->x, &part->y, &part->z}) {
+        free_cast_matlab_3D_array(*component, F->tot.k);
+        *component = nullptr;
+      }
+    }
+  }
+  for (string matrix :
+       {"Ex_out", "Ey_out", "Ez_out", "Hx_out", "Hy_out", "Hz_out"}) {
+    mxDestroyArray(output_arrays[matrix]);
+    output_arrays[matrix] = nullptr;
+  }
+  set_EH_cells(volume_cells);
+  create_EH_arrays();
+
+  // and copy in the phasors of each process, in the order that they were sent
+  const double *value = gathered.data();
+  for (int process = 0; process < partition.n_processes(); process++) {
+    CellBox block = volume_cells.intersection(partition.owned_by(process));
+    int n_i = max(block.upper.i - block.lower.i, 0);
+    for (Field *F : {(Field *) &E, (Field *) &H}) {
+      for (XYZTensor3D<double> *part : {&F->real, &F->imag}) {
+        for (double ***component : {part->x, part->y, part->z}) {
+          for (int k = block.lower.k; k < block.upper.k; k++) {
+            for (int j = block.lower.j; j < block.upper.j; j++, value += n_i) {
+              double *row = component[k - volume_cells.lower.k]
+                                     [j - volume_cells.lower.j];
+              copy(value, value + n_i,
+                   row + block.lower.i - volume_cells.lower.i);
+            }
+          }
+        }
+      }
+    }
   }
 }
 
@@ -336,6 +460,8 @@ void OutputMatrices::save_outputs(const string &output_file_name,
   // iterate through the matrices we want to save, setting names and placing
   // them into the matfile
   for (string matrix_to_write : output_matrices_requested) {
+    // the optional outputs that were not produced are not written
+    if (output_arrays[matrix_to_write] == nullptr) { continue; }
     // returns 0 if successful and non-zero if an error occurred
     int mpv_out = matPutVariable(output_file, matrix_to_write.c_str(),
                                  output_arrays[matrix_to_write]);
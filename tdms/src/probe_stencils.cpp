@@ -0,0 +1,129 @@
+#include "probe_stencils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+/** @brief The index, 0 to 2, of an axial direction */
+int index_of(AxialDirection d) {
+  switch (d) {
+    case AxialDirection::X:
+      return 0;
+    case AxialDirection::Y:
+      return 1;
+    case AxialDirection::Z:
+      return 2;
+    default:
+      throw runtime_error("Invalid axial direction selected for a probe");
+  }
+}
+
+}// namespace
+
+int ProbeStencils::add(SplitField &F, AxialDirection d,
+                       const InterpolationStencil &stencil) {
+  // {the component that holds the whole field in the interior, the other}
+  pair<SplitFieldComponent *, SplitFieldComponent *> pairs[3] = {
+          {&F.xy, &F.xz}, {&F.yx, &F.yz}, {&F.zx, &F.zy}};
+  auto [whole, part] = pairs[index_of(d)];
+
+  size_t first_whole = whole_.size(), first_part = part_.size();
+  for (const StencilPoint &point : stencil) {
+    const CellCoordinate &cell = point.cell;
+    // another process adds the cells that it owns
+    if (partition_ != nullptr &&
+        !partition_->owned().contains(cell.i, cell.j, cell.k)) {
+      continue;
+    }
+    // a component adds nothing where it is not stored
+    if (whole->has_elements()) {
+      ptrdiff_t index = whole->stored_index(cell.i, cell.j, cell.k);
+      if (index >= 0) { whole_.push_back({index, point.weight}); }
+    }
+    if (part->has_elements()) {
+      ptrdiff_t index = part->stored_index(cell.i, cell.j, cell.k);
+      if (index >= 0) { part_.push_back({index, point.weight}); }
+    }
+  }
+  auto by_index = [](const Term &a, const Term &b) {
+    return a.index < b.index;
+  };
+  sort(whole_.begin() + first_whole, whole_.end(), by_index);
+  sort(part_.begin() + first_part, part_.end(), by_index);
+
+  whole_start_.push_back(whole_.size());
+  part_start_.push_back(part_.size());
+  direction_.push_back(index_of(d));
+  values_.push_back(0.);
+  return n_probes() - 1;
+}
+
+void ProbeStencils::clear() {
+  direction_.clear();
+  whole_.clear();
+  whole_start_ = {0};
+  part_.clear();
+  part_start_ = {0};
+  values_.clear();
+}
+
+void ProbeStencils::evaluate(const SplitField &F) {
+  const field_t *whole[3] = {F.xy.stored_values(), F.yx.stored_values(),
+                             F.zx.stored_values()};
+  const field_t *part[3] = {F.xz.stored_values(), F.yz.stored_values(),
+                            F.zy.stored_values()};
+
+#pragma omp for schedule(static)
+  for (int p = 0; p < n_probes(); p++) {
+    const field_t *whole_values = whole[direction_[p]],
+                  *part_values = part[direction_[p]];
+    double value = 0.;
+    for (size_t t = whole_start_[p]; t < whole_start_[p + 1]; t++) {
+      value += whole_[t].weight * whole_values[whole_[t].index];
+    }
+    for (size_t t = part_start_[p]; t < part_start_[p + 1]; t++) {
+      value += part_[t].weight * part_values[part_[t].index];
+    }
+    values_[p] = value;
+  }
+  if (partition_ != nullptr && partition_->is_distributed()) {
+#pragma omp master
+    partition_->sum(values_.data(), n_probes());
+#pragma omp barrier
+  }
+}
+
+void add_centre_probes(ProbeStencils &E_probes, ProbeStencils &H_probes,
+                       ElectricSplitField &E, MagneticSplitField &H,
+                       Dimension dimension, const CellCoordinate &cell) {
+  switch (dimension) {
+    case Dimension::THREE:
+      for (AxialDirection d : {AxialDirection::X, AxialDirection::Y,
+                               AxialDirection::Z}) {
+        E_probes.add_interpolated(E, d, cell);
+        H_probes.add_interpolated(H, d, cell);
+      }
+      break;
+    case Dimension::TRANSVERSE_ELECTRIC:
+      E_probes.add_interpolated(E, AxialDirection::X, cell);
+      E_probes.add_interpolated(E, AxialDirection::Y, cell);
+      E_probes.add_zero(E);
+      H_probes.add_zero(H);
+      H_probes.add_zero(H);
+      H_probes.add_interpolated(H, AxialDirection::Z, cell);
+      break;
+    case Dimension::TRANSVERSE_MAGNETIC:
+      E_probes.add_zero(E);
+      E_probes.add_zero(E);
+      E_probes.add_interpolated(E, AxialDirection::Z, cell);
+      H_probes.add_interpolated(H, AxialDirection::X, cell);
+      H_probes.add_interpolated(H, AxialDirection::Y, cell);
+      H_probes.add_zero(H);
+      break;
+    default:
+      throw runtime_error("Dimension was not recognised!");
+  }
+}
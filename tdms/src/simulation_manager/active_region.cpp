@@ -0,0 +1,125 @@
+#include "simulation_manager/active_region.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <omp.h>
+
+using namespace std;
+
+namespace {
+
+/** @brief The components of a split field that are stored */
+vector<const SplitFieldComponent *> stored_components(const SplitField &field) {
+  vector<const SplitFieldComponent *> components;
+  for (const SplitFieldComponent *component :
+       {&field.xy, &field.xz, &field.yx, &field.yz, &field.zx, &field.zy}) {
+    if (component->has_elements()) { components.push_back(component); }
+  }
+  return components;
+}
+
+/** @brief The largest absolute value of a component of field, over the cells
+ * of this thread */
+double largest_component(const SplitField &field) {
+  const IJKDimensions &tot = field.tot;
+  double largest = 0.;
+  for (const SplitFieldComponent *component : stored_components(field)) {
+#pragma omp for nowait
+    for (int i = 0; i <= tot.i; i++) {
+      for (int j = 0; j <= tot.j; j++) {
+        for (int k = 0; k <= tot.k; k++) {
+          largest = max(largest, (double) fabs(component->value(i, j, k)));
+        }
+      }
+    }
+  }
+  return largest;
+}
+
+/**
+ * @brief The smallest box of the cells of this thread at which a component of
+ * field exceeds threshold in absolute value (empty if there are none)
+ */
+CellBox cells_above(const SplitField &field, double threshold) {
+  const IJKDimensions &tot = field.tot;
+  int lower_i = INT_MAX, lower_j = INT_MAX, lower_k = INT_MAX;
+  int upper_i = 0, upper_j = 0, upper_k = 0;
+  for (const SplitFieldComponent *component : stored_components(field)) {
+#pragma omp for nowait
+    for (int i = 0; i <= tot.i; i++) {
+      for (int j = 0; j <= tot.j; j++) {
+        for (int k = 0; k <= tot.k; k++) {
+          if (fabs(component->value(i, j, k)) <= threshold) { continue; }
+          lower_i = min(lower_i, i);
+          lower_j = min(lower_j, j);
+          lower_k = min(lower_k, k);
+          upper_i = max(upper_i, i + 1);
+          upper_j = max(upper_j, j + 1);
+          upper_k = max(upper_k, k + 1);
+        }
+      }
+    }
+  }
+  if (lower_i == INT_MAX) { return CellBox(); }
+  return {{lower_i, lower_j, lower_k}, {upper_i, upper_j, upper_k}};
+}
+
+}// namespace
+
+CellBox ActiveRegion::grown(const CellBox &box, int margin) const {
+  if (box.empty()) { return box; }
+  CellBox larger = box;
+  larger.lower += -margin;
+  larger.upper += margin;
+  return larger.intersection(grid_);
+}
+
+void ActiveRegion::set_grid(const IJKDimensions &IJK_tot) {
+  grid_ = {{0, 0, 0}, {IJK_tot.i + 1, IJK_tot.j + 1, IJK_tot.k + 1}};
+  box_ = grid_;
+  sources_ = CellBox();
+  tracking_ = false;
+}
+
+void ActiveRegion::track(const CellBox &sources, const SplitField &E,
+                         const SplitField &H) {
+  sources_ = sources.intersection(grid_);
+  // outside of a parallel region, every cell is this thread's
+  box_ = sources_.enclosing(cells_above(E, 0.)).enclosing(cells_above(H, 0.));
+  tracking_ = box_.n_cells() < grid_.n_cells();
+}
+
+void ActiveRegion::advance() {
+  if (!tracking_) { return; }
+  box_ = grown(box_, 1);
+  // once the fields can have reached every cell, the box stays the grid
+  tracking_ = box_.n_cells() < grid_.n_cells();
+}
+
+void ActiveRegion::shrink(const SplitField &E, const SplitField &H,
+                          double threshold) {
+#pragma omp single
+  {
+    largest_ = 0.;
+    above_ = CellBox();
+  }
+  // each thread scans its own cells, and the team combines the results
+  double largest = max(largest_component(E), largest_component(H));
+#pragma omp critical(active_region_shrink)
+  largest_ = max(largest_, largest);
+#pragma omp barrier
+  if (largest_ == 0.) { return; }
+
+  CellBox above = cells_above(E, threshold * largest_)
+                          .enclosing(cells_above(H, threshold * largest_));
+#pragma omp critical(active_region_shrink)
+  above_ = above_.enclosing(above);
+#pragma omp barrier
+#pragma omp single
+  {
+    box_ = grown(above_, 1).enclosing(sources_).intersection(box_);
+    tracking_ = box_.n_cells() < grid_.n_cells();
+  }
+}
@@ -0,0 +1,121 @@
+#include "simulation_manager/convergence_monitor.h"
+
+#include <algorithm>
+
+#include <omp.h>
+
+#include "globals.h"
+
+using namespace std;
+using tdms_math_constants::IMAGINARY_UNIT;
+
+namespace {
+
+/** @brief Zero the phasors of F, in the cells of this thread */
+void zero_phasors(Field &F) {
+#pragma omp for nowait
+  for (int k = 0; k < F.tot.k; k++) {
+    for (char c : {'x', 'y', 'z'}) {
+      for (int j = 0; j < F.tot.j; j++) {
+        for (int i = 0; i < F.tot.i; i++) {
+          F.real[c][k][j][i] = 0.;
+          F.imag[c][k][j][i] = 0.;
+        }
+      }
+    }
+  }
+}
+
+}// namespace
+
+ConvergenceMonitor::ConvergenceMonitor(ElectricField &previous,
+                                       ConvergenceSet set, int stride,
+                                       const GridPartition *partition)
+    : previous_(previous), set_(set), stride_(max(stride, 1)),
+      partition_(partition) {}
+
+void ConvergenceMonitor::compare_surface(const SurfacePhasors &surface) {
+  vector<complex<double>> amplitudes = surface.amplitudes();
+  // before the first period ends, the previous phasors are zero
+  previous_surface_.resize(amplitudes.size(), 0.);
+  for (size_t n = 0; n < amplitudes.size(); n++) {
+    max_abs_ = max(max_abs_, abs(amplitudes[n]));
+    max_abs_diff_ =
+            max(max_abs_diff_, abs(amplitudes[n] - previous_surface_[n]));
+  }
+  previous_surface_ = move(amplitudes);
+}
+
+double ConvergenceMonitor::difference(ElectricField &E,
+                                      const SurfacePhasors &surface) {
+  const IJKDimensions &tot = E.tot;
+#pragma omp single
+  {
+    max_abs_ = max_abs_diff_ = 0.;
+    if (set_ == ConvergenceSet::Surface) { compare_surface(surface); }
+  }
+
+  if (set_ == ConvergenceSet::Volume) {
+    // the largest values of the cells of this thread, then of all threads
+    double max_abs = 0., max_abs_diff = 0.;
+#pragma omp for nowait
+    for (int k = 0; k < tot.k; k += stride_) {
+      for (char c : {'x', 'y', 'z'}) {
+        for (int j = 0; j < tot.j; j += stride_) {
+          for (int i = 0; i < tot.i; i += stride_) {
+            complex<double> value = E.real[c][k][j][i] +
+                                    IMAGINARY_UNIT * E.imag[c][k][j][i],
+                            previous_value =
+                                    previous_.real[c][k][j][i] +
+                                    IMAGINARY_UNIT * previous_.imag[c][k][j][i];
+            max_abs = max(max_abs, abs(value));
+            max_abs_diff = max(max_abs_diff, abs(value - previous_value));
+          }
+        }
+      }
+    }
+#pragma omp critical(convergence_monitor)
+    {
+      max_abs_ = max(max_abs_, max_abs);
+      max_abs_diff_ = max(max_abs_diff_, max_abs_diff);
+    }
+  }
+#pragma omp barrier
+  // each process holds the phasors of its own cells
+  if (partition_ != nullptr && partition_->is_distributed()) {
+#pragma omp master
+    {
+      double largest[2] = {max_abs_, max_abs_diff_};
+      partition_->maximum(largest, 2);
+      max_abs_ = largest[0];
+      max_abs_diff_ = largest[1];
+    }
+#pragma omp barrier
+  }
+  return max_abs_diff_ / max_abs_;
+}
+
+void ConvergenceMonitor::start_next_period(ElectricField &E,
+                                           MagneticField &H) {
+#pragma omp single
+  {
+    previous_.swap_values(E);
+    swapped_ = !swapped_;
+  }
+  // E now holds the phasors of the period before last
+  zero_phasors(E);
+  zero_phasors(H);
+#pragma omp barrier
+}
+
+void ConvergenceMonitor::restore_previous(ElectricField &E) {
+  E.swap_values(previous_);
+  swapped_ = !swapped_;
+}
+
+void ConvergenceMonitor::release(ElectricField &E) {
+  if (!swapped_) { return; }
+  previous_.set_values_from(E);
+  E.swap_values(previous_);
+  swapped_ = false;
+}
@@ -0,0 +1,84 @@
+#include "simulation_manager/energy_decay.h"
+
+#include <algorithm>
+
+#include <omp.h>
+
+#include "globals.h"
+
+using namespace std;
+using tdms_phys_constants::EPSILON0, tdms_phys_constants::MU0;
+
+namespace {
+
+/** @brief The sum of the squares of field, over the cells of this thread in
+ * cells */
+double sum_of_squares(const SplitField &field, const CellBox &cells) {
+  double sum = 0.;
+#pragma omp for nowait
+  for (int i = cells.lower.i; i < cells.upper.i; i++) {
+    for (int j = cells.lower.j; j < cells.upper.j; j++) {
+      for (int k = cells.lower.k; k < cells.upper.k; k++) {
+        double x = field.x(i, j, k), y = field.y(i, j, k),
+               z = field.z(i, j, k);
+        sum += x * x + y * y + z * z;
+      }
+    }
+  }
+  return sum;
+}
+
+}// namespace
+
+void EnergyDecay::measure(const SplitField &E, const SplitField &H) {
+#pragma omp single
+  energy_ = 0.;
+  // each thread adds the energy of its own cells
+  CellBox cells = partition_ != nullptr
+                          ? partition_->owned()
+                          : CellBox{{0, 0, 0},
+                                    {E.tot.i + 1, E.tot.j + 1, E.tot.k + 1}};
+  double energy = EPSILON0 * sum_of_squares(E, cells) +
+                  MU0 * sum_of_squares(H, cells);
+#pragma omp atomic
+  energy_ += energy;
+#pragma omp barrier
+  // then each process adds the energy of its own cells
+#pragma omp master
+  {
+    if (partition_ != nullptr) { partition_->sum(&energy_, 1); }
+    peak_ = max(peak_, energy_);
+  }
+#pragma omp barrier
+}
+
+void EnergyDecay::set_incident_field(const IncidentField &Ei) {
+  int n_slices = max(Ei.x.get_n_layers(), Ei.y.get_n_layers());
+  vector<double> power(n_slices, 0.);
+  for (const Tensor3D<double> *component : {&Ei.x, &Ei.y}) {
+    for (int i = 0; i < component->get_n_rows(); i++) {
+      for (int j = 0; j < component->get_n_cols(); j++) {
+        for (int tind = 0; tind < component->get_n_layers(); tind++) {
+          double value = (*component)(i, j, tind);
+          power[tind] += value * value;
+        }
+      }
+    }
+  }
+
+  // the largest power of the slices that are still to be injected
+  remaining_incident_ = power;
+  for (int tind = n_slices - 2; tind >= 0; tind--) {
+    remaining_incident_[tind] =
+            max(remaining_incident_[tind], remaining_incident_[tind + 1]);
+  }
+  incident_peak_ = n_slices > 0 ? remaining_incident_[0] : 0.;
+}
+
+bool EnergyDecay::incident_field_has_decayed(int tind) const {
+  if (tind < 0) { tind = 0; }
+  if (incident_peak_ <= 0. || tind >= (int) remaining_incident_.size()) {
+    return true;
+  }
+  return remaining_incident_[tind] < threshold_ * incident_peak_;
+}
@@ -1,13 +1,14 @@
 #include "simulation_manager/simulation_manager.h"
 
-void SimulationManager::end_of_iteration_steps(double &time_of_last_log,
-                                               unsigned int tind,
-                                               ElectricField &E_copy) {
+void SimulationManager::end_of_iteration_steps(
+        double &time_of_last_log, unsigned int tind,
+        ConvergenceMonitor &convergence) {
   // If enough time has passed since the last write to the log
   if ((((double) time(NULL)) - time_of_last_log) > 1) {
-    // Compute and print max residual field
-    double maxfield = std::max(inputs.E_s.largest_field_value(),
-                               inputs.H_s.largest_field_value());
+    // Compute and print max residual field (of the cells of this process)
+    double maxfield =
+            std::max(inputs.E_s.largest_field_value(partition->owned()),
+                     inputs.H_s.largest_field_value(partition->owned()));
     spdlog::info("Iterating: tind = {0:d}, maxfield = {1:e}", tind, maxfield);
     // Update time of last log to now
     time_of_last_log = double(time(NULL));
@@ -26,7 +27,7 @@ void SimulationManager::end_of_iteration_steps(double &time_of_last_log,
     spdlog::info("Iteration limit reached (no convergence): setting output "
                  "fields to last "
                  "complete DFT");
-    outputs.E.set_values_from(E_copy);
+    convergence.restore_previous(outputs.E);
   }
 
   // Export the field if we are at a suitable iteration number
@@ -19,52 +19,70 @@ void SimulationManager::extract_phasor_norms(int frequency_index,
           1. / ((double) Nt);
 }
 
-bool SimulationManager::check_phasor_convergence(int &dft_counter,
-                                                 ElectricField &E_copy) {
+bool SimulationManager::check_phasor_convergence(
+        int &dft_counter, ConvergenceMonitor &convergence, LoopVariables &lv) {
   if ((dft_counter == inputs.Nsteps) &&
       (inputs.params.run_mode == RunMode::complete) &&
       (inputs.params.source_mode == SourceMode::steadystate) &&
       inputs.params.exphasorsvolume) {
+    // the phasors of the period must all be in the output
+    if (lv.E_phasors.is_enabled()) {
+      lv.E_phasors.flush(outputs.E);
+      lv.H_phasors.flush(outputs.H);
+    }
 
-    dft_counter = 0;
-
-    double tol = outputs.E.normalised_difference(E_copy);
+    // every thread has read dft_counter, as the comparison ends in a barrier
+    double tol = convergence.difference(outputs.E, outputs.surface_phasors);
     if (tol < TOL) { return true; }// required accuracy obtained
 
-    spdlog::debug("Phasor convergence: {} (actual) > {} (required)", tol, TOL);
-    E_copy.set_values_from(outputs.E);
-
-    outputs.E.zero();
-    outputs.H.zero();
-    spdlog::debug("Zeroed the phasors");
-
-    if (inputs.params.exphasorssurface) {
-      outputs.surface_phasors.zero_surface_EH();
-      spdlog::debug("Zeroed the surface components");
+#pragma omp single
+    {
+      dft_counter = 0;
+      spdlog::debug("Phasor convergence: {} (actual) > {} (required)", tol,
+                    TOL);
+    }
+    convergence.start_next_period(outputs.E, outputs.H);
+#pragma omp single
+    {
+      spdlog::debug("Zeroed the phasors");
+      if (inputs.params.exphasorssurface) {
+        outputs.surface_phasors.zero_surface_EH();
+        spdlog::debug("Zeroed the surface components");
+      }
     }
   }
   return false;
 }
 
-void SimulationManager::extract_phasors(int &dft_counter, unsigned int tind) {
+void SimulationManager::extract_phasors(int &dft_counter, unsigned int tind,
+                                        LoopVariables &lv) {
   // if we are not performing a complete run, these steps are skipped
   if (inputs.params.run_mode != RunMode::complete) { return; }
 
   // extract phasors if we are running a steady-state simulation
   if ((inputs.params.source_mode == SourceMode::steadystate) &&
       inputs.params.exphasorsvolume) {
-    outputs.E.set_phasors(inputs.E_s, dft_counter - 1, inputs.params.omega_an,
-                          inputs.params.dt, inputs.Nsteps);
-    outputs.H.set_phasors(inputs.H_s, dft_counter, inputs.params.omega_an,
-                          inputs.params.dt, inputs.Nsteps);
+    if (lv.E_phasors.is_enabled()) {
+      // the update kernels add the fields of this timestep as they advance
+      // them
+#pragma omp single
+      {
+        lv.E_phasors.set_phase_term(outputs.E, dft_counter - 1,
+                                    inputs.params.omega_an, inputs.params.dt,
+                                    inputs.Nsteps);
+        lv.H_phasors.set_phase_term(outputs.H, dft_counter,
+                                    inputs.params.omega_an, inputs.params.dt,
+                                    inputs.Nsteps);
+      }
+    } else {
+      extract_volume_phasors(dft_counter, tind, partition->owned());
+    }
     // if we are additionally extracting surface phasors
     if (inputs.params.exphasorssurface) {
-      for (unsigned int ifx = 0; ifx < inputs.f_ex_vec.size(); ifx++) {
-        outputs.surface_phasors.extractPhasorsSurface(
-                ifx, inputs.E_s, inputs.H_s, dft_counter,
-                inputs.f_ex_vec[ifx] * 2 * DCPI, inputs.Nsteps, inputs.params,
-                inputs.params.intphasorssurface);
-      }
+      outputs.surface_phasors.extractPhasorsSurface(
+              inputs.E_s, inputs.H_s, dft_counter, inputs.f_ex_vec,
+              inputs.Nsteps, inputs.params, inputs.params.intphasorssurface);
+#pragma omp single
       dft_counter++;
     }
   } else {
@@ -73,37 +91,72 @@ void SimulationManager::extract_phasors(int &dft_counter, unsigned int tind) {
     // Extract the phasors in the volume
     if (inputs.params.exphasorsvolume) {
       // compute volume phasors
+#pragma omp master
       if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
-      if ((tind - inputs.params.start_tind) % inputs.params.Np == 0) {
-        outputs.E.set_phasors(inputs.E_s, tind - 1, inputs.params.omega_an,
-                              inputs.params.dt, inputs.params.Npe);
-        outputs.H.set_phasors(inputs.H_s, tind, inputs.params.omega_an,
-                              inputs.params.dt, inputs.params.Npe);
-      }
+      extract_volume_phasors(dft_counter, tind, partition->owned());
+#pragma omp master
       if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
     }
     // Extract phasors on the user-defined surface
     if ((inputs.params.exphasorssurface) &&
         ((tind - inputs.params.start_tind) % inputs.params.Np == 0)) {
-      for (unsigned int ifx = 0; ifx < inputs.f_ex_vec.size(); ifx++) {
-        outputs.surface_phasors.extractPhasorsSurface(
-                ifx, inputs.E_s, inputs.H_s, tind,
-                inputs.f_ex_vec[ifx] * 2 * DCPI, inputs.params.Npe,
-                inputs.params, inputs.params.intphasorssurface);
-      }
+      outputs.surface_phasors.extractPhasorsSurface(
+              inputs.E_s, inputs.H_s, tind, inputs.f_ex_vec,
+              inputs.params.Npe, inputs.params,
+              inputs.params.intphasorssurface);
     }
     // Extract phasors at the user-defined vertices
     if (outputs.vertex_phasors.there_are_vertices_to_extract_at() &&
         ((tind - inputs.params.start_tind) % inputs.params.Np == 0)) {
-      for (unsigned int ifx = 0; ifx < inputs.f_ex_vec.size(); ifx++) {
-        outputs.vertex_phasors.extractPhasorsVertices(
-                ifx, inputs.E_s, inputs.H_s, tind,
-                inputs.f_ex_vec[ifx] * 2 * DCPI, inputs.params);
-      }
+      outputs.vertex_phasors.extractPhasorsVertices(
+              inputs.E_s, inputs.H_s, tind, inputs.f_ex_vec, inputs.params);
     }
   }
 }
 
+void SimulationManager::extract_volume_phasors(int dft_counter,
+                                               unsigned int tind,
+                                               const CellBox &cells) {
+  if (inputs.params.source_mode == SourceMode::steadystate) {
+    outputs.E.set_phasors(inputs.E_s, dft_counter - 1, inputs.params.omega_an,
+                          inputs.params.dt, inputs.Nsteps, cells);
+    outputs.H.set_phasors(inputs.H_s, dft_counter, inputs.params.omega_an,
+                          inputs.params.dt, inputs.Nsteps, cells);
+  } else if ((tind - inputs.params.start_tind) % inputs.params.Np == 0) {
+    outputs.E.set_phasors(inputs.E_s, tind - 1, inputs.params.omega_an,
+                          inputs.params.dt, inputs.params.Npe, cells);
+    outputs.H.set_phasors(inputs.H_s, tind, inputs.params.omega_an,
+                          inputs.params.dt, inputs.params.Npe, cells);
+    // and at every extraction frequency, if requested
+    if (outputs.volume_spectrum.is_enabled()) {
+      outputs.volume_spectrum.extract(inputs.E_s, inputs.H_s, tind, cells);
+    }
+  }
+}
+
+void SimulationManager::compile_probes() {
+  int n_probes = 0;
+  if (inputs.params.exphasorssurface) {
+    outputs.surface_phasors.compile_probes(
+            inputs.E_s, inputs.H_s, inputs.params.dimension,
+            inputs.params.intphasorssurface, partition.get());
+    n_probes += 6 * outputs.surface_phasors.get_n_surface_vertices();
+  }
+  if (outputs.vertex_phasors.there_are_vertices_to_extract_at()) {
+    outputs.vertex_phasors.compile_probes(inputs.E_s, inputs.H_s,
+                                          inputs.params.dimension,
+                                          partition.get());
+    n_probes += 6 * outputs.vertex_phasors.n_vertices();
+  }
+  if (outputs.fieldsample.all_vectors_are_non_empty()) {
+    outputs.fieldsample.compile_probes(inputs.E_s, inputs.params.pml,
+                                       partition.get());
+    n_probes += 3 * outputs.fieldsample.i.size() *
+                outputs.fieldsample.j.size() * outputs.fieldsample.k.size();
+  }
+  spdlog::info("Compiled the interpolation stencils of {} probes", n_probes);
+}
+
 void SimulationManager::new_acquisition_period(unsigned int tind) {
   // These steps are un-neccessary if we are NOT doing ANY of the following:
   if (!(inputs.params.exphasorssurface ||// extracting phasors on the
@@ -5,10 +5,14 @@
  */
 #include "simulation_manager/simulation_manager.h"
 
+#include <exception>
+#include <stdexcept>
+
 #include <omp.h>
 #include <spdlog/spdlog.h>
 
 #include "numerical_derivative.h"
+#include "simulation_manager/energy_decay.h"
 #include "simulation_manager/loop_variables.h"
 
 using namespace std;
@@ -20,27 +24,10 @@ void SimulationManager::execute() {
   // log the number of OMP threads being used
   spdlog::info("Using {} OMP threads", omp_get_max_threads());
 
-  // get the number of Yee cells in each axial direction
-  IJKDimensions IJK_tot = n_Yee_cells();
-  int I_tot = IJK_tot.i, J_tot = IJK_tot.j, K_tot = IJK_tot.k;
-
   // DECLARE VARIABLES SCOPED TO THIS FUNCTION ONLY
-  double rho;
-  double alpha_l, beta_l, gamma_l;//< alpha, beta, gamma parameters of the layer
-                                  // the local thread is examining
-  double kappa_l, sigma_l;//< kappa, sigma parameters of the layer the local
-                          // thread is examining
   double time_of_last_log_write;//< (Real) time since the last iteration log was
                                 // written to the screen
 
-  double Ca, Cb, Cc;// used by interpolation scheme
-  // the C and D vars for free space and pml
-  double Enp1, Jnp1;
-
-  int i, j, k;//< Loop variables
-  int n;      //< The thread number of the local OMP thread
-  int k_loc;  //< Local thread copy of the variable k
-
   int dft_counter = 0;//< Number of DFTs we have performed since last checking
                       // for phasor convergence
 
@@ -48,7 +35,132 @@ void SimulationManager::execute() {
 
   // variables used in the main loop that require linking/setup from the input
   // and output objects
-  LoopVariables loop_variables(inputs, outputs.get_E_dimensions());
+  LoopVariables loop_variables(inputs, outputs.get_E_dimensions(), *fft);
+
+  bool distributed = partition->is_distributed();
+  if (distributed) {
+    if (!supports_distributed()) {
+      throw runtime_error("The grid can only be distributed for simulations "
+                          "in 3D, without exdetintegral or the export of "
+                          "time-domain fields");
+    }
+    // the other kernels and extractions visit every cell of the grid
+    if (options.unsplit_interior || options.cache_blocking ||
+        options.fused_updates || options.fused_phasors ||
+        options.active_region) {
+      spdlog::warn("Unsplit interiors, cache blocking, fused updates and "
+                   "phasors, and the active region are not available when the "
+                   "grid is distributed; ignoring them");
+      options.unsplit_interior = options.cache_blocking = false;
+      options.fused_updates = options.fused_phasors = false;
+      options.active_region = false;
+    }
+    // the probes sum the cells of every process
+    options.compiled_probes = true;
+  }
+
+  if (options.unsplit_interior) {
+    if (supports_unsplit_interior()) {
+      unsplit_interior(loop_variables);
+    } else {
+      spdlog::warn("Unsplit interior fields are only available for FDTD "
+                   "simulations in 3D; keeping the fields split");
+    }
+  }
+  // the FDTD updates of a distributed grid apply the dispersive and conductive
+  // terms to the listed cells only
+  bool fdtd = solver_method == SolverMethod::FiniteDifference;
+  loop_variables.allocate_currents(inputs, fdtd, partition->owned(),
+                                   distributed && fdtd);
+  if (options.compiled_probes) { compile_probes(); }
+
+  bool shrink_active_region = false;
+  if (options.active_region) {
+    if (supports_active_region(loop_variables)) {
+      ActiveRegion &active = loop_variables.active_region;
+      active.track(pulsed_source_cells(), inputs.E_s, inputs.H_s);
+      shrink_active_region = options.active_region_threshold > 0.;
+      spdlog::info("Tracking the active region, initially {} of {} cells",
+                   active.box().n_cells(), active.grid().n_cells());
+      if (options.fused_updates) {
+        spdlog::info("The active region takes precedence over fused updates");
+        options.fused_updates = false;
+      }
+    } else {
+      spdlog::warn("Active-region tracking is only available for pulsed FDTD "
+                   "simulations of non-dispersive, non-conductive media in 3D "
+                   "or TE mode, with split fields; updating the whole grid "
+                   "instead");
+    }
+  }
+
+  EnergyDecay energy_decay;
+  if (options.energy_decay > 0.) {
+    if (inputs.params.source_mode == SourceMode::pulsed) {
+      energy_decay = EnergyDecay(options.energy_decay, partition.get());
+      // the broadband incident field is injected whatever the envelope
+      if (inputs.params.exi_present || inputs.params.eyi_present) {
+        energy_decay.set_incident_field(inputs.Ei);
+      }
+    } else {
+      spdlog::warn("Early termination on energy decay is only available for "
+                   "pulsed simulations; running all {} timesteps",
+                   inputs.params.Nt);
+    }
+  }
+
+  ConvergenceSet convergence_set = options.convergence_set;
+  if (convergence_set == ConvergenceSet::Surface &&
+      !inputs.params.exphasorssurface) {
+    spdlog::warn("No surface phasors are extracted; checking the convergence "
+                 "of the volume phasors instead");
+    convergence_set = ConvergenceSet::Volume;
+  }
+  ConvergenceMonitor convergence(loop_variables.E_at_previous_iteration,
+                                 convergence_set, options.convergence_stride,
+                                 partition.get());
+
+  // Select the update kernels specialised to the features of this simulation
+  UpdateKernel update_E = select_E_update_kernel(loop_variables);
+  UpdateKernel update_H = select_H_update_kernel();
+
+  if (options.fused_updates && !supports_fused_updates()) {
+    spdlog::warn("Fused updates are only available for FDTD simulations in 3D "
+                 "or TE mode; updating each split component separately");
+  }
+
+  int I_tot = n_Yee_cells().i;
+  bool cache_blocking = options.cache_blocking;
+  int slab_width = I_tot + 1;
+  if (cache_blocking && !supports_cache_blocking(loop_variables)) {
+    spdlog::warn("Cache blocking is only available for FDTD simulations of "
+                 "non-dispersive, non-conductive media in 3D or TE mode, with "
+                 "split fields; advancing the whole grid instead");
+    cache_blocking = false;
+  } else if (cache_blocking) {
+    slab_width = options.slab_width > 0
+                         ? min(options.slab_width, I_tot + 1)
+                         : cache_blocking_slab_width(options.tile_steps);
+    spdlog::info("Advancing the E and H fields in slabs of {} cells, by up to "
+                 "{} timesteps at a time",
+                 slab_width, options.tile_steps);
+  }
+  // shrinking the active region reads the fields of the whole grid
+  int max_tile_steps = shrink_active_region ? 1 : options.tile_steps;
+
+  if (options.fused_phasors) {
+    if (supports_fused_phasors() && !cache_blocking &&
+        !inputs.E_s.has_unsplit_interior()) {
+      loop_variables.E_phasors.allocate(outputs.E);
+      loop_variables.H_phasors.allocate(outputs.H);
+      spdlog::info("Accumulating the volume phasors in the update sweeps");
+    } else {
+      spdlog::warn("Fused phasors are only available for complete "
+                   "steady-state FDTD runs that extract the volume phasors, "
+                   "with fused updates; extracting the phasors in a sweep of "
+                   "their own");
+    }
+  }
 
   /*The times of the E and H fields at the point where update equations are
     applied. time_H is actually the time of the H field when the E field
@@ -73,7 +185,11 @@ void SimulationManager::execute() {
     fth using time_H we see that this indexing is correct, ie, time_E =
     (tind+1)*dt and time_H = (tind+1/2)*dt.
   */
-  double time_E, time_H;
+  bool decayed = false;//< Whether the pulse has left the grid
+  //! The number of timesteps after this one that update_EH_blocked has
+  //! already advanced the fields by
+  int tile_steps_left = 0;
+  exception_ptr loop_error;//< Raised by the serial steps of the main loop
 
   // fetch the current time for logging purposes
   time_of_last_log_write = (double) time(NULL);
@@ -81,2453 +197,179 @@ void SimulationManager::execute() {
 
   if (TIME_MAIN_LOOP) { timers.start_timer(TimersTrackingLoop::MAIN); }
 
-  for (unsigned int tind = inputs.params.start_tind; tind < inputs.params.Nt;
-       tind++) {
-    time_E = ((double) (tind + 1)) * inputs.params.dt;
-    time_H = time_E - inputs.params.dt / 2.;
-
-    // Check for phasor convergence, break if achieved
-    if (check_phasor_convergence(dft_counter,
-                                 loop_variables.E_at_previous_iteration)) {
-      break;
-    }
-
-    // Extract the volume, surface, and vertex phasors to the output
-    extract_phasors(dft_counter, tind);
-
-    // Extract the fields at the sample locations
-    if (outputs.fieldsample.all_vectors_are_non_empty()) {
-      outputs.fieldsample.extract(inputs.E_s, inputs.params.pml,
-                                  inputs.params.Nt);
-    }
-
-    // Compute the detector function
-    compute_detector_functions(tind, loop_variables);
-
-    // Update equations for the E field
-
-    /*There are two options for determining the update coefficients for the FDTD
-      cell:
-
-      1) If cell (i,j,k) is either free space or PML:
-
-      materials[k][j][i] will be set to 0. In this case the update parameter
-      used will be given by C.a.y[j], C.b.y[j] etc depending on which update
-      equation is being implemented.
-
-      2) if cell (i,j,k) is composed of a scattering type material then
-      materials[k][j][i] will be non-zero and will be an index into
-      Cmaterial.a.y and Cmaterial.b.y etc depending on which update equation is
-      being implemented.
-
-    */
-
-    int array_ind = 0;
-    if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
-    (void) n;// n is unused in FD derivatives – this silences the compiler
-             // warning
-
-#pragma omp parallel default(shared) private(                                  \
-        i, j, k, n, rho, k_loc, array_ind, Ca, Cb, Cc, alpha_l, beta_l,        \
-        gamma_l, kappa_l, sigma_l, Enp1, Jnp1)//,ca_vec,cb_vec,eh_vec)
-    {
-      n = omp_get_thread_num();
-      Enp1 = 0.0;
-      array_ind = 0;
-
-      if (inputs.params.dimension == THREE ||
-          inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
-        update_Exy(loop_variables);
-        update_Exz(loop_variables);
-        // E_s.yx updates
-        if (solver_method == SolverMethod::FiniteDifference) {
-          // FDTD, E_s.yx
-#pragma omp for
-          for (k = 0; k < (K_tot + 1); k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
-              for (i = 1; i < I_tot; i++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure) {
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-
-                // use the average of material parameters between nodes
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k][min(J_tot, j + 1)][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.x[array_ind];
-                    Cb = inputs.C.b.x[array_ind];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                    else
-                      Cc = 0;
-                  } else {
-                    Ca = inputs.Cmaterial.a.x[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.x[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.x[inputs.materials[k][j][i] - 1];
-                  }
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      Ca = Ca + inputs.C.a.x[array_ind];
-                      Cb = Cb + inputs.C.b.x[array_ind];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.x[array_ind];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a.x[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cb = Cb + inputs.Cmaterial.b.x[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cc = Cc + inputs.Cmaterial.c.x[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                    }
-
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-                } else {
-                  Ca = inputs.C.a.x[array_ind];
-                  Cb = inputs.C.b.x[array_ind];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                  else
-                    Cc = 0.;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.x[array_ind];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.x[array_ind];
-                  kappa_l = inputs.matched_layer.kappa.x[array_ind];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k][min(J_tot, j + 1)][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      alpha_l += inputs.alpha[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                      beta_l += inputs.beta[inputs.materials[k][min(J_tot,
-                                                                    j + 1)][i] -
-                                            1];
-                      gamma_l += inputs.gamma[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-
-
-                Enp1 = Ca * inputs.E_s.yx(i, j, k) +
-                       Cb * (inputs.H_s.zx(i - 1, j, k) +
-                             inputs.H_s.zy(i - 1, j, k) -
-                             inputs.H_s.zx(i, j, k) - inputs.H_s.zy(i, j, k));
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.yx(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dx *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.yx(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.yx(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dx *
-                          loop_variables.J_c.yx(i, j, k);
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.yx(i, j, k) +
-                         beta_l * loop_variables.J_nm1.yx(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.yx(i, j, k));
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.yx(i, j, k);
-                  loop_variables.E_nm1.yx(i, j, k) = inputs.E_s.yx(i, j, k);
-                  loop_variables.J_nm1.yx(i, j, k) =
-                          loop_variables.J_s.yx(i, j, k);
-                  loop_variables.J_s.yx(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.yx(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.yx(i, j, k));
-                }
-
-                inputs.E_s.yx(i, j, k) = Enp1;
-              }
-          // FDTD, E_s.yx
-        } else {
-#pragma omp for
-          for (k = 0; k < (K_tot + 1); k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound; j++) {
-              for (i = 1; i < I_tot; i++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure) {
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-
-                // use the average of material parameters between nodes
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k][min(J_tot, j + 1)][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.x[array_ind];
-                    Cb = inputs.C.b.x[array_ind];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                    else
-                      Cc = 0;
-                  } else {
-                    Ca = inputs.Cmaterial.a.x[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.x[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.x[inputs.materials[k][j][i] - 1];
-                  }
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      Ca = Ca + inputs.C.a.x[array_ind];
-                      Cb = Cb + inputs.C.b.x[array_ind];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.x[array_ind];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a.x[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cb = Cb + inputs.Cmaterial.b.x[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cc = Cc + inputs.Cmaterial.c.x[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                    }
-
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-                } else {
-                  Ca = inputs.C.a.x[array_ind];
-                  Cb = inputs.C.b.x[array_ind];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                  else
-                    Cc = 0.;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.x[array_ind];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.x[array_ind];
-                  kappa_l = inputs.matched_layer.kappa.x[array_ind];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k][min(J_tot, j + 1)][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      alpha_l += inputs.alpha[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                      beta_l += inputs.beta[inputs.materials[k][min(J_tot,
-                                                                    j + 1)][i] -
-                                            1];
-                      gamma_l += inputs.gamma[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-
-
-                // Enp1 = Ca*E_s.yx(i,j,k)+Cb*(H_s.zx[k][j][i-1] +
-                // H_s.zy[k][j][i-1] - H_s.zx(i,j,k) - H_s.zy(i,j,k));
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.yx(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dx *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.yx(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.yx(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dx *
-                          loop_variables.J_c.yx(i, j, k);
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.yx(i, j, k) +
-                         beta_l * loop_variables.J_nm1.yx(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.yx(i, j, k));
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.yx(i, j, k);
-                  loop_variables.E_nm1.yx(i, j, k) = inputs.E_s.yx(i, j, k);
-                  loop_variables.J_nm1.yx(i, j, k) =
-                          loop_variables.J_s.yx(i, j, k);
-                  loop_variables.J_s.yx(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.yx(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.yx(i, j, k));
-                }
-
-                eh_vec[n][i][0] =
-                        inputs.H_s.zx(i, j, k) + inputs.H_s.zy(i, j, k);
-                eh_vec[n][i][1] = 0.;
-                PSTD.ca(n, i - 1) = Ca;
-                PSTD.cb(n, i - 1) = Cb;
-              }
-              i = 0;
-              eh_vec[n][i][0] = inputs.H_s.zx(i, j, k) + inputs.H_s.zy(i, j, k);
-              eh_vec[n][i][1] = 0.;
-
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_ex, PSTD.N_ex,
-                               inputs.E_s.yx.plan_f[n],
-                               inputs.E_s.yx.plan_b[n]);
-
-              for (i = 1; i < I_tot; i++) {
-                inputs.E_s.yx(i, j, k) =
-                        PSTD.ca(n, i - 1) * inputs.E_s.yx(i, j, k) -
-                        PSTD.cb(n, i - 1) * eh_vec[n][i][0] /
-                                ((double) PSTD.N_ex);
-                // E_s.yx(i,j,k) = Enp1;
-              }
-            }
-          // PSTD, E_s.yx
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-        // E_s.yz updates
-        if (solver_method == SolverMethod::FiniteDifference) {
-// FDTD, E_s.yz
-#pragma omp for
-          for (k = 1; k < K_tot; k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
-              for (i = 0; i < (I_tot + 1); i++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k][min(J_tot, j + 1)][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.z[k_loc];
-                    Cb = inputs.C.b.z[k_loc];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.z[k_loc];
-                    else
-                      Cc = 0.;
-                  } else {
-                    Ca = inputs.Cmaterial.a.z[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.z[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.z[inputs.materials[k][j][i] - 1];
-                  }
-
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      Ca = Ca + inputs.C.a.z[k_loc];
-                      Cb = Cb + inputs.C.b.z[k_loc];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.z[k_loc];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a.z[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cb = Cb + inputs.Cmaterial.b.z[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cc = Cc + inputs.Cmaterial.c.z[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                    }
-
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-                } else {
-                  Ca = inputs.C.a.z[k_loc];
-                  Cb = inputs.C.b.z[k_loc];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.z[k_loc];
-                  else
-                    Cc = 0.;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.z[k_loc];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.z[k_loc];
-                  kappa_l = inputs.matched_layer.kappa.z[k_loc];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k][min(J_tot, j + 1)][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      alpha_l += inputs.alpha[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                      beta_l += inputs.beta[inputs.materials[k][min(J_tot,
-                                                                    j + 1)][i] -
-                                            1];
-                      gamma_l += inputs.gamma[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-                Enp1 = Ca * inputs.E_s.yz(i, j, k) +
-                       Cb * (inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k) -
-                             inputs.H_s.xy(i, j, k - 1) -
-                             inputs.H_s.xz(i, j, k - 1));
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.yz(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dz *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.yz(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.yz(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dz *
-                          loop_variables.J_c.yz(i, j, k);
-
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.yz(i, j, k) +
-                         beta_l * loop_variables.J_nm1.yz(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.yz(i, j, k));
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.yz(i, j, k);
-                  loop_variables.E_nm1.yz(i, j, k) = inputs.E_s.yz(i, j, k);
-                  loop_variables.J_nm1.yz(i, j, k) =
-                          loop_variables.J_s.yz(i, j, k);
-                  loop_variables.J_s.yz(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.yz(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.yz(i, j, k));
-                }
-
-                inputs.E_s.yz(i, j, k) = Enp1;
-              }
-          // FDTD, E_s.yz
-        } else {
-#pragma omp for
-          for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
-            for (i = 0; i < (I_tot + 1); i++) {
-              for (k = 1; k < K_tot; k++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k][min(J_tot, j + 1)][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.z[k_loc];
-                    Cb = inputs.C.b.z[k_loc];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.z[k_loc];
-                    else
-                      Cc = 0.;
-                  } else {
-                    Ca = inputs.Cmaterial.a.z[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.z[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.z[inputs.materials[k][j][i] - 1];
-                  }
-
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      Ca = Ca + inputs.C.a.z[k_loc];
-                      Cb = Cb + inputs.C.b.z[k_loc];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.z[k_loc];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a.z[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cb = Cb + inputs.Cmaterial.b.z[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                      Cc = Cc + inputs.Cmaterial.c.z[inputs.materials[k][min(
-                                                             J_tot, j + 1)][i] -
-                                                     1];
-                    }
-
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-                } else {
-                  Ca = inputs.C.a.z[k_loc];
-                  Cb = inputs.C.b.z[k_loc];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.z[k_loc];
-                  else
-                    Cc = 0.;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.z[k_loc];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.z[k_loc];
-                  kappa_l = inputs.matched_layer.kappa.z[k_loc];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k][min(J_tot, j + 1)][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k][min(J_tot, j + 1)][i]) {
-                      alpha_l += inputs.alpha[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                      beta_l += inputs.beta[inputs.materials[k][min(J_tot,
-                                                                    j + 1)][i] -
-                                            1];
-                      gamma_l += inputs.gamma[inputs.materials[k][min(
-                                                      J_tot, j + 1)][i] -
-                                              1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-                // Enp1 = Ca*E_s.yz(i,j,k)+Cb*(H_s.xy(i,j,k) +
-                // H_s.xz(i, j, k) - H_s.xy[k-1][j][i] - H_s.xz[k-1][j][i]);
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.yz(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dz *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.yz(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.yz(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dz *
-                          loop_variables.J_c.yz(i, j, k);
-
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.yz(i, j, k) +
-                         beta_l * loop_variables.J_nm1.yz(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.yz(i, j, k));
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.yz(i, j, k);
-                  loop_variables.E_nm1.yz(i, j, k) = inputs.E_s.yz(i, j, k);
-                  loop_variables.J_nm1.yz(i, j, k) =
-                          loop_variables.J_s.yz(i, j, k);
-                  loop_variables.J_s.yz(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.yz(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.yz(i, j, k));
-                }
-
-                eh_vec[n][k][0] =
-                        inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k);
-                eh_vec[n][k][1] = 0.;
-                PSTD.ca(n, k - 1) = Ca;
-                PSTD.cb(n, k - 1) = Cb;
-              }
-              k = 0;
-              eh_vec[n][k][0] = inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k);
-              eh_vec[n][k][1] = 0.;
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_ez, PSTD.N_ez,
-                               inputs.E_s.yz.plan_f[n],
-                               inputs.E_s.yz.plan_b[n]);
-
-
-              for (k = 1; k < K_tot; k++) {
-                inputs.E_s.yz(i, j, k) =
-                        PSTD.ca(n, k - 1) * inputs.E_s.yz(i, j, k) +
-                        PSTD.cb(n, k - 1) * eh_vec[n][k][0] /
-                                ((double) PSTD.N_ez);
-                // E_s.yz(i,j,k) = Enp1;
-              }
-            }
-          // PSTD, E_s.yz
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-      }  // if(params.dimension==THREE || params.dimension==TE)
-
-      if (inputs.params.dimension == THREE ||
-          inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
-        if (solver_method == SolverMethod::FiniteDifference) {
-#pragma omp for
-          // E_s.zx updates
-          for (k = 0; k < K_tot; k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++)
-              for (i = 1; i < I_tot; i++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-
-                // use the average of material parameters between nodes
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k + 1][j][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.x[array_ind];
-                    Cb = inputs.C.b.x[array_ind];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                    else
-                      Cc = 0.;
-                  } else {
-                    Ca = inputs.Cmaterial.a.x[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.x[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.x[inputs.materials[k][j][i] - 1];
-                  }
-
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k + 1][j][i]) {
-                      Ca = Ca + inputs.C.a.x[array_ind];
-                      Cb = Cb + inputs.C.b.x[array_ind];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.x[array_ind];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a
-                                        .x[inputs.materials[k + 1][j][i] - 1];
-                      Cb = Cb + inputs.Cmaterial.b
-                                        .x[inputs.materials[k + 1][j][i] - 1];
-                      Cc = Cc + inputs.Cmaterial.c
-                                        .x[inputs.materials[k + 1][j][i] - 1];
-                    }
-
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-                } else {
-                  Ca = inputs.C.a.x[array_ind];
-                  Cb = inputs.C.b.x[array_ind];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                  else
-                    Cc = 0.;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.x[array_ind];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.x[array_ind];
-                  kappa_l = inputs.matched_layer.kappa.x[array_ind];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k + 1][j][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k + 1][j][i]) {
-                      alpha_l +=
-                              inputs.alpha[inputs.materials[k + 1][j][i] - 1];
-                      beta_l += inputs.beta[inputs.materials[k + 1][j][i] - 1];
-                      gamma_l +=
-                              inputs.gamma[inputs.materials[k + 1][j][i] - 1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-                Enp1 = Ca * inputs.E_s.zx(i, j, k) +
-                       Cb * (inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k) -
-                             inputs.H_s.yx(i - 1, j, k) -
-                             inputs.H_s.yz(i - 1, j, k));
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.zx(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dx *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.zx(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.zx(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dx *
-                          loop_variables.J_c.zx(i, j, k);
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.zx(i, j, k) +
-                         beta_l * loop_variables.J_nm1.zx(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.zx(i, j, k));
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.zx(i, j, k);
-                  loop_variables.E_nm1.zx(i, j, k) = inputs.E_s.zx(i, j, k);
-                  loop_variables.J_nm1.zx(i, j, k) =
-                          loop_variables.J_s.zx(i, j, k);
-                  loop_variables.J_s.zx(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.zx(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.zx(i, j, k));
-                }
-
-                inputs.E_s.zx(i, j, k) = Enp1;
-              }
-          // FDTD, E_s.zx
-        } else {
-#pragma omp for
-          for (k = 0; k < K_tot; k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++) {
-              for (i = 1; i < I_tot; i++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-
-                // use the average of material parameters between nodes
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k + 1][j][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.x[array_ind];
-                    Cb = inputs.C.b.x[array_ind];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                    else
-                      Cc = 0.;
-                  } else {
-                    Ca = inputs.Cmaterial.a.x[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.x[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.x[inputs.materials[k][j][i] - 1];
-                  }
-
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k + 1][j][i]) {
-                      Ca = Ca + inputs.C.a.x[array_ind];
-                      Cb = Cb + inputs.C.b.x[array_ind];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.x[array_ind];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a
-                                        .x[inputs.materials[k + 1][j][i] - 1];
-                      Cb = Cb + inputs.Cmaterial.b
-                                        .x[inputs.materials[k + 1][j][i] - 1];
-                      Cc = Cc + inputs.Cmaterial.c
-                                        .x[inputs.materials[k + 1][j][i] - 1];
-                    }
-
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-                } else {
-                  Ca = inputs.C.a.x[array_ind];
-                  Cb = inputs.C.b.x[array_ind];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                  else
-                    Cc = 0.;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.x[array_ind];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.x[array_ind];
-                  kappa_l = inputs.matched_layer.kappa.x[array_ind];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k + 1][j][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k + 1][j][i]) {
-                      alpha_l +=
-                              inputs.alpha[inputs.materials[k + 1][j][i] - 1];
-                      beta_l += inputs.beta[inputs.materials[k + 1][j][i] - 1];
-                      gamma_l +=
-                              inputs.gamma[inputs.materials[k + 1][j][i] - 1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-                // Enp1 = Ca*E_s.zx(i,j,k)+Cb*(H_s.yx(i, j, k) +
-                // H_s.yz(i,j,k) - H_s.yx[k][j][i-1] - H_s.yz[k][j][i-1]);
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.zx(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dx *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.zx(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.zx(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dx *
-                          loop_variables.J_c.zx(i, j, k);
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.zx(i, j, k) +
-                         beta_l * loop_variables.J_nm1.zx(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.zx(i, j, k));
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.zx(i, j, k);
-                  loop_variables.E_nm1.zx(i, j, k) = inputs.E_s.zx(i, j, k);
-                  loop_variables.J_nm1.zx(i, j, k) =
-                          loop_variables.J_s.zx(i, j, k);
-                  loop_variables.J_s.zx(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.zx(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.zx(i, j, k));
-                }
-
-                eh_vec[n][i][0] =
-                        inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k);
-                eh_vec[n][i][1] = 0.;
-                PSTD.ca(n, i - 1) = Ca;
-                PSTD.cb(n, i - 1) = Cb;
-              }
-              i = 0;
-              eh_vec[n][i][0] = inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k);
-              eh_vec[n][i][1] = 0.;
-
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_ex, PSTD.N_ex,
-                               inputs.E_s.zx.plan_f[n],
-                               inputs.E_s.zx.plan_b[n]);
-
-              for (i = 1; i < I_tot; i++) {
-                inputs.E_s.zx(i, j, k) =
-                        PSTD.ca(n, i - 1) * inputs.E_s.zx(i, j, k) +
-                        PSTD.cb(n, i - 1) * eh_vec[n][i][0] /
-                                ((double) PSTD.N_ex);
-                // E_s.zx(i,j,k) = Enp1;
-              }
-            }
-          // PSTD, E_s.zx
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-      }  //(params.dimension==THREE || params.dimension==TE)
-      else {
-#pragma omp for
-        // E_s.zx updates
-        for (k = 0; k <= K_tot; k++)
-          for (j = 0; j < (J_tot + 1); j++)
-            for (i = 1; i < I_tot; i++) {
-              rho = 0.;
-              k_loc = k;
-              if (inputs.params.is_structure)
-                if (k > inputs.params.pml.Dzl &&
-                    k < (inputs.params.pml.Dzl +
-                         loop_variables.n_non_pml_cells_in_K)) {
-                  if ((k - inputs.structure(1, i)) <
-                              (loop_variables.n_non_pml_cells_in_K +
-                               inputs.params.pml.Dzl) &&
-                      (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                    k_loc = k - inputs.structure(1, i);
-                  else if ((k - inputs.structure(1, i)) >=
-                           (loop_variables.n_non_pml_cells_in_K +
-                            inputs.params.pml.Dzl))
-                    k_loc = inputs.params.pml.Dzl +
-                            loop_variables.n_non_pml_cells_in_K - 1;
-                  else
-                    k_loc = inputs.params.pml.Dzl + 1;
-                }
-              if (!inputs.params.is_multilayer) array_ind = i;
-              else
-                array_ind = (I_tot + 1) * k_loc + i;
-
-              // use the average of material parameters between nodes
-              if (!inputs.materials[k][j][i]) {
-                Ca = inputs.C.a.x[array_ind];
-                Cb = inputs.C.b.x[array_ind];
-                if (inputs.params.is_disp_ml) Cc = inputs.C.c.x[array_ind];
-                else
-                  Cc = 0.;
-                if (loop_variables.is_conductive) rho = inputs.rho_cond.x[i];
-              } else {
-                rho = 0.;
-                Ca = inputs.Cmaterial.a.x[inputs.materials[k][j][i] - 1];
-                Cb = inputs.Cmaterial.b.x[inputs.materials[k][j][i] - 1];
-                Cc = inputs.Cmaterial.c.x[inputs.materials[k][j][i] - 1];
-              }
-
-              alpha_l = 0.;
-              beta_l = 0.;
-              gamma_l = 0.;
-              kappa_l = 1.;
-              sigma_l = 0.;
-
-
-              if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                sigma_l = inputs.matched_layer.sigma.x[array_ind];
-                kappa_l = inputs.matched_layer.kappa.x[array_ind];
-                alpha_l = inputs.matched_layer.alpha[k_loc];
-                beta_l = inputs.matched_layer.beta[k_loc];
-                gamma_l = inputs.matched_layer.gamma[k_loc];
-
-                if (inputs.materials[k][j][i]) {
-                  alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                  beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                  gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-
-                } else {
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                }
-              }
-
-              Enp1 = Ca * inputs.E_s.zx(i, j, k) +
-                     Cb * (inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k) -
-                           inputs.H_s.yx(i - 1, j, k) -
-                           inputs.H_s.yz(i - 1, j, k));
-              if ((loop_variables.is_dispersive || inputs.params.is_disp_ml) &&
-                  gamma_l)
-                Enp1 += Cc * loop_variables.E_nm1.zx(i, j, k) -
-                        1. / 2. * Cb * inputs.params.delta.dx *
-                                ((1 + alpha_l) *
-                                         loop_variables.J_s.zx(i, j, k) +
-                                 beta_l * loop_variables.J_nm1.zx(i, j, k));
-              if (loop_variables.is_conductive && rho)
-                Enp1 += Cb * inputs.params.delta.dx *
-                        loop_variables.J_c.zx(i, j, k);
-
-              if ((loop_variables.is_dispersive || inputs.params.is_disp_ml) &&
-                  gamma_l) {
-                Jnp1 = alpha_l * loop_variables.J_s.zx(i, j, k) +
-                       beta_l * loop_variables.J_nm1.zx(i, j, k) +
-                       kappa_l * gamma_l / (2. * inputs.params.dt) *
-                               (Enp1 - loop_variables.E_nm1.zx(i, j, k));
-                Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.zx(i, j, k);
-                loop_variables.E_nm1.zx(i, j, k) = inputs.E_s.zx(i, j, k);
-                loop_variables.J_nm1.zx(i, j, k) =
-                        loop_variables.J_s.zx(i, j, k);
-                loop_variables.J_s.zx(i, j, k) = Jnp1;
-              }
-              if (loop_variables.is_conductive && rho) {
-                loop_variables.J_c.zx(i, j, k) -=
-                        rho * (Enp1 + inputs.E_s.zx(i, j, k));
-              }
-
-              inputs.E_s.zx(i, j, k) = Enp1;
-            }
+  /* A single team of threads persists for the whole of the main loop, rather
+    than one being forked and joined for each stage of each iteration. Every
+    thread runs every iteration: the field updates and phasor extractions are
+    shared between them, and the serial bookkeeping is run by one thread inside
+    an omp single, whose closing barrier publishes its results to the team. */
+#pragma omp parallel default(shared)
+  {
+    for (unsigned int tind = inputs.params.start_tind; tind < inputs.params.Nt;
+         tind++) {
+      double time_E = ((double) (tind + 1)) * inputs.params.dt;
+      double time_H = time_E - inputs.params.dt / 2.;
+
+      // Measure the field energy every so often, if we may stop once it has
+      // decayed. All the threads share the measurement.
+      bool measure_energy =
+              energy_decay.is_enabled() &&
+              (tind - inputs.params.start_tind) % EnergyDecay::CHECK_INTERVAL ==
+                      0;
+      if (measure_energy) { energy_decay.measure(inputs.E_s, inputs.H_s); }
+
+      // Check for phasor convergence or the decay of the pulse, break if
+      // either is achieved, and let the active region catch up with the fields
+      bool converged = check_phasor_convergence(dft_counter, convergence,
+                                                loop_variables);
+#pragma omp single
+      {
+        // The phasors and their normalisation factors are sums over the
+        // timesteps, to which the remaining timesteps would add nothing once
+        // neither the sources nor the fields have any power left
+        decayed = measure_energy && energy_decay.has_decayed() &&
+                  source_has_decayed(time_H, options.energy_decay) &&
+                  energy_decay.incident_field_has_decayed(tind);
+        if (decayed) {
+          spdlog::info("The field energy has decayed to {0:e} of its peak; "
+                       "stopping at tind = {1:d} of {2:d}",
+                       energy_decay.energy() / energy_decay.peak(), tind,
+                       inputs.params.Nt);
+        }
+        loop_variables.active_region.advance();
       }
-      if (inputs.params.dimension == THREE ||
-          inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
-        if (solver_method == SolverMethod::FiniteDifference) {
-          // FDTD, E_s.zy
-#pragma omp for
-          // E_s.zy updates
-          for (k = 0; k < K_tot; k++)
-            for (j = 1; j < J_tot; j++)
-              for (i = 0; i < (I_tot + 1); i++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = j;
-                else
-                  array_ind = (J_tot + 1) * k_loc + j;
-
-                // use the average of material parameters between nodes
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k + 1][j][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.y[array_ind];
-                    Cb = inputs.C.b.y[array_ind];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.y[array_ind];
-                    else
-                      Cc = 0.;
-                  } else {
-                    Ca = inputs.Cmaterial.a.y[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.y[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.y[inputs.materials[k][j][i] - 1];
-                  }
-
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k + 1][j][i]) {
-                      Ca = Ca + inputs.C.a.y[array_ind];
-                      Cb = Cb + inputs.C.b.y[array_ind];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.y[array_ind];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a
-                                        .y[inputs.materials[k + 1][j][i] - 1];
-                      Cb = Cb + inputs.Cmaterial.b
-                                        .y[inputs.materials[k + 1][j][i] - 1];
-                      Cc = Cc + inputs.Cmaterial.c
-                                        .y[inputs.materials[k + 1][j][i] - 1];
-                    }
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-
-                } else {
-                  Ca = inputs.C.a.y[array_ind];
-                  Cb = inputs.C.b.y[array_ind];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.y[array_ind];
-                  else
-                    Cc = 0;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.y[array_ind];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.y[array_ind];
-                  kappa_l = inputs.matched_layer.kappa.y[array_ind];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k + 1][j][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k + 1][j][i]) {
-                      alpha_l +=
-                              inputs.alpha[inputs.materials[k + 1][j][i] - 1];
-                      beta_l += inputs.beta[inputs.materials[k + 1][j][i] - 1];
-                      gamma_l +=
-                              inputs.gamma[inputs.materials[k + 1][j][i] - 1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-
-
-                Enp1 = Ca * inputs.E_s.zy(i, j, k) +
-                       Cb * (inputs.H_s.xy(i, j - 1, k) +
-                             inputs.H_s.xz(i, j - 1, k) -
-                             inputs.H_s.xy(i, j, k) - inputs.H_s.xz(i, j, k));
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.zy(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dy *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.zy(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.zy(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dy *
-                          loop_variables.J_c.zy(i, j, k);
-
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.zy(i, j, k) +
-                         beta_l * loop_variables.J_nm1.zy(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.zy(i, j, k));
-
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.zy(i, j, k);
-                  loop_variables.E_nm1.zy(i, j, k) = inputs.E_s.zy(i, j, k);
-                  loop_variables.J_nm1.zy(i, j, k) =
-                          loop_variables.J_s.zy(i, j, k);
-                  loop_variables.J_s.zy(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.zy(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.zy(i, j, k));
-                }
-                inputs.E_s.zy(i, j, k) = Enp1;
-              }
-          // FDTD, E_s.zy
-        } else {
-#pragma omp for
-          // E_s.zy updates
-          for (k = 0; k < K_tot; k++)
-            for (i = 0; i < (I_tot + 1); i++) {
-              for (j = 1; j < J_tot; j++) {
-                rho = 0.;
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = j;
-                else
-                  array_ind = (J_tot + 1) * k_loc + j;
-
-                // use the average of material parameters between nodes
-                if (inputs.materials[k][j][i] ||
-                    inputs.materials[k + 1][j][i]) {
-                  rho = 0.;
-                  if (!inputs.materials[k][j][i]) {
-                    Ca = inputs.C.a.y[array_ind];
-                    Cb = inputs.C.b.y[array_ind];
-                    if (inputs.params.is_disp_ml) Cc = inputs.C.c.y[array_ind];
-                    else
-                      Cc = 0.;
-                  } else {
-                    Ca = inputs.Cmaterial.a.y[inputs.materials[k][j][i] - 1];
-                    Cb = inputs.Cmaterial.b.y[inputs.materials[k][j][i] - 1];
-                    Cc = inputs.Cmaterial.c.y[inputs.materials[k][j][i] - 1];
-                  }
-
-                  if (inputs.params.interp_mat_props) {
-                    if (!inputs.materials[k + 1][j][i]) {
-                      Ca = Ca + inputs.C.a.y[array_ind];
-                      Cb = Cb + inputs.C.b.y[array_ind];
-                      if (inputs.params.is_disp_ml)
-                        Cc = Cc + inputs.C.c.y[array_ind];
-                    } else {
-                      Ca = Ca + inputs.Cmaterial.a
-                                        .y[inputs.materials[k + 1][j][i] - 1];
-                      Cb = Cb + inputs.Cmaterial.b
-                                        .y[inputs.materials[k + 1][j][i] - 1];
-                      Cc = Cc + inputs.Cmaterial.c
-                                        .y[inputs.materials[k + 1][j][i] - 1];
-                    }
-                    Ca = Ca / 2.;
-                    Cb = Cb / 2.;
-                    Cc = Cc / 2.;
-                  }
-
-                } else {
-                  Ca = inputs.C.a.y[array_ind];
-                  Cb = inputs.C.b.y[array_ind];
-                  if (inputs.params.is_disp_ml) Cc = inputs.C.c.y[array_ind];
-                  else
-                    Cc = 0;
-                  if (loop_variables.is_conductive)
-                    rho = inputs.rho_cond.y[array_ind];
-                }
-
-                alpha_l = 0.;
-                beta_l = 0.;
-                gamma_l = 0.;
-                kappa_l = 1.;
-                sigma_l = 0.;
-
-                if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                  sigma_l = inputs.matched_layer.sigma.y[array_ind];
-                  kappa_l = inputs.matched_layer.kappa.y[array_ind];
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                  if (inputs.materials[k][j][i] ||
-                      inputs.materials[k + 1][j][i]) {
-                    if (inputs.materials[k][j][i]) {
-                      alpha_l = inputs.alpha[inputs.materials[k][j][i] - 1];
-                      beta_l = inputs.beta[inputs.materials[k][j][i] - 1];
-                      gamma_l = inputs.gamma[inputs.materials[k][j][i] - 1];
-                    } else {
-                      alpha_l = inputs.matched_layer.alpha[k_loc];
-                      beta_l = inputs.matched_layer.beta[k_loc];
-                      gamma_l = inputs.matched_layer.gamma[k_loc];
-                    }
-
-                    if (inputs.materials[k + 1][j][i]) {
-                      alpha_l +=
-                              inputs.alpha[inputs.materials[k + 1][j][i] - 1];
-                      beta_l += inputs.beta[inputs.materials[k + 1][j][i] - 1];
-                      gamma_l +=
-                              inputs.gamma[inputs.materials[k + 1][j][i] - 1];
-                    } else {
-                      alpha_l += inputs.matched_layer.alpha[k_loc];
-                      beta_l += inputs.matched_layer.beta[k_loc];
-                      gamma_l += inputs.matched_layer.gamma[k_loc];
-                    }
-                    alpha_l = alpha_l / 2.;
-                    beta_l = beta_l / 2.;
-                    gamma_l = gamma_l / 2.;
-                  }
-                }
-
-
-                // Enp1 = Ca*E_s.zy(i,j,k)+Cb*(H_s.xy[k][j-1][i] +
-                // H_s.xz[k][j-1][i] - H_s.xy(i,j,k) - H_s.xz(i, j, k));
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l)
-                  Enp1 += Cc * loop_variables.E_nm1.zy(i, j, k) -
-                          1. / 2. * Cb * inputs.params.delta.dy *
-                                  ((1 + alpha_l) *
-                                           loop_variables.J_s.zy(i, j, k) +
-                                   beta_l * loop_variables.J_nm1.zy(i, j, k));
-                if (loop_variables.is_conductive && rho)
-                  Enp1 += Cb * inputs.params.delta.dy *
-                          loop_variables.J_c.zy(i, j, k);
+      if (converged || decayed) { break; }
 
-                if ((loop_variables.is_dispersive ||
-                     inputs.params.is_disp_ml) &&
-                    gamma_l) {
-                  Jnp1 = alpha_l * loop_variables.J_s.zy(i, j, k) +
-                         beta_l * loop_variables.J_nm1.zy(i, j, k) +
-                         kappa_l * gamma_l / (2. * inputs.params.dt) *
-                                 (Enp1 - loop_variables.E_nm1.zy(i, j, k));
+      // The fields of a timestep inside a tile have been advanced, and their
+      // phasors extracted, by the first timestep of the tile
+      bool in_tile = tile_steps_left > 0;
+      int tile_steps = 1;
 
-                  Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.zy(i, j, k);
-                  loop_variables.E_nm1.zy(i, j, k) = inputs.E_s.zy(i, j, k);
-                  loop_variables.J_nm1.zy(i, j, k) =
-                          loop_variables.J_s.zy(i, j, k);
-                  loop_variables.J_s.zy(i, j, k) = Jnp1;
-                }
-                if (loop_variables.is_conductive && rho) {
-                  loop_variables.J_c.zy(i, j, k) -=
-                          rho * (Enp1 + inputs.E_s.zy(i, j, k));
-                }
+      // Extract the volume, surface, and vertex phasors to the output
+      if (!in_tile) { extract_phasors(dft_counter, tind, loop_variables); }
 
-                eh_vec[n][j][0] =
-                        inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k);
-                eh_vec[n][j][1] = 0.;
-                PSTD.ca(n, j - 1) = Ca;
-                PSTD.cb(n, j - 1) = Cb;
-              }
-              if (J_tot > 1) {
-                j = 0;
-                eh_vec[n][j][0] =
-                        inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k);
-                eh_vec[n][j][1] = 0.;
-                first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_ey, PSTD.N_ey,
-                                 inputs.E_s.zy.plan_f[n],
-                                 inputs.E_s.zy.plan_b[n]);
-              }
-              for (j = 1; j < J_tot; j++) {
-                inputs.E_s.zy(i, j, k) =
-                        PSTD.ca(n, j - 1) * inputs.E_s.zy(i, j, k) -
-                        PSTD.cb(n, j - 1) * eh_vec[n][j][0] /
-                                ((double) PSTD.N_ey);
-                // E_s.zy(i,j,k) = Enp1;
-              }
-            }
-          // PSTD, E_s.zy
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-      }  //(params.dimension==THREE || params.dimension==TE)
-      else {
-#pragma omp for
-        for (k = 0; k <= K_tot; k++)
-          for (j = 1; j < J_tot; j++)
-            for (i = 0; i < (I_tot + 1); i++) {
-              rho = 0.;
-              k_loc = k;
-              if (inputs.params.is_structure)
-                if (k > inputs.params.pml.Dzl &&
-                    k < (inputs.params.pml.Dzl +
-                         loop_variables.n_non_pml_cells_in_K)) {
-                  if ((k - inputs.structure(1, i)) <
-                              (loop_variables.n_non_pml_cells_in_K +
-                               inputs.params.pml.Dzl) &&
-                      (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                    k_loc = k - inputs.structure(1, i);
-                  else if ((k - inputs.structure(1, i)) >=
-                           (loop_variables.n_non_pml_cells_in_K +
-                            inputs.params.pml.Dzl))
-                    k_loc = inputs.params.pml.Dzl +
-                            loop_variables.n_non_pml_cells_in_K - 1;
-                  else
-                    k_loc = inputs.params.pml.Dzl + 1;
-                }
-              if (!inputs.params.is_multilayer) array_ind = j;
-              else
-                array_ind = (J_tot + 1) * k_loc + j;
-
-              // use the average of material parameters between nodes
-              if (!inputs.materials[k][j][i]) {
-                Ca = inputs.C.a.y[array_ind];
-                Cb = inputs.C.b.y[array_ind];
-                if (inputs.params.is_disp_ml) Cc = inputs.C.c.y[array_ind];
-                else
-                  Cc = 0.;
-                if (loop_variables.is_conductive)
-                  rho = inputs.rho_cond.y[array_ind];
-              } else {
-                rho = 0.;
-                Ca = inputs.Cmaterial.a.y[inputs.materials[k][j][i] - 1];
-                Cb = inputs.Cmaterial.b.y[inputs.materials[k][j][i] - 1];
-                Cc = inputs.Cmaterial.c.y[inputs.materials[k][j][i] - 1];
-              }
-
-              alpha_l = 0.;
-              beta_l = 0.;
-              gamma_l = 0.;
-              kappa_l = 1.;
-              sigma_l = 0.;
-
-              if (loop_variables.is_dispersive || inputs.params.is_disp_ml) {
-                kappa_l = inputs.matched_layer.kappa.y[array_ind];
-                sigma_l = inputs.matched_layer.sigma.y[array_ind];
-                alpha_l = inputs.matched_layer.alpha[k_loc];
-                beta_l = inputs.matched_layer.beta[k_loc];
-                gamma_l = inputs.matched_layer.gamma[k_loc];
-
-                if (!inputs.materials[k][j][i]) {
-                  alpha_l = 0.;
-                  beta_l = 0.;
-                  gamma_l = 0.;
-                } else {
-                  alpha_l = inputs.matched_layer.alpha[k_loc];
-                  beta_l = inputs.matched_layer.beta[k_loc];
-                  gamma_l = inputs.matched_layer.gamma[k_loc];
-                }
-              }
-
-
-              Enp1 = Ca * inputs.E_s.zy(i, j, k) +
-                     Cb * (inputs.H_s.xy(i, j - 1, k) +
-                           inputs.H_s.xz(i, j - 1, k) - inputs.H_s.xy(i, j, k) -
-                           inputs.H_s.xz(i, j, k));
-              if ((loop_variables.is_dispersive || inputs.params.is_disp_ml) &&
-                  gamma_l)
-                Enp1 += Cc * loop_variables.E_nm1.zy(i, j, k) -
-                        1. / 2. * Cb * inputs.params.delta.dy *
-                                ((1 + alpha_l) *
-                                         loop_variables.J_s.zy(i, j, k) +
-                                 beta_l * loop_variables.J_nm1.zy(i, j, k));
-              if (loop_variables.is_conductive && rho)
-                Enp1 += Cb * inputs.params.delta.dy *
-                        loop_variables.J_c.zy(i, j, k);
-
-              if ((loop_variables.is_dispersive || inputs.params.is_disp_ml) &&
-                  gamma_l) {
-                Jnp1 = alpha_l * loop_variables.J_s.zy(i, j, k) +
-                       beta_l * loop_variables.J_nm1.zy(i, j, k) +
-                       kappa_l * gamma_l / (2. * inputs.params.dt) *
-                               (Enp1 - loop_variables.E_nm1.zy(i, j, k));
-
-                Jnp1 += sigma_l / EPSILON0 * gamma_l * inputs.E_s.zy(i, j, k);
-                loop_variables.E_nm1.zy(i, j, k) = inputs.E_s.zy(i, j, k);
-                loop_variables.J_nm1.zy(i, j, k) =
-                        loop_variables.J_s.zy(i, j, k);
-                loop_variables.J_s.zy(i, j, k) = Jnp1;
-              }
-              if (loop_variables.is_conductive && rho) {
-                loop_variables.J_c.zy(i, j, k) -=
-                        rho * (Enp1 + inputs.E_s.zy(i, j, k));
-              }
-
-              inputs.E_s.zy(i, j, k) = Enp1;
-            }
+      // Extract the fields at the sample locations
+      if (outputs.fieldsample.all_vectors_are_non_empty()) {
+        outputs.fieldsample.extract(inputs.E_s, inputs.params.pml,
+                                    inputs.params.Nt);
       }
-    }// end of parallel section
-    if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
-    /********************/
-
-    /* Update source terms for self consistency across scattered/total
-     * interface. E_s updates use time_H simulation time. */
-
-    if (inputs.params.source_mode == SourceMode::steadystate) {
-      // Steady-state source term updates
-      E_source_update_all_steadystate(time_H, loop_variables.is_conductive,
-                                      loop_variables.J_c, loop_variables.J_s);
-
-      // Common phase term in update equations
-      complex<double> common_phase =
-              exp(-IMAGINARY_UNIT *
-                  fmod(inputs.params.omega_an * time_H, 2. * DCPI));
-      // Common amplitude factor in update equations
-      double common_amplitude = linear_ramp(time_H);
-      // Update output H-field
-      outputs.H.ft = real(common_amplitude * common_phase);
-    } else if (inputs.params.source_mode == SourceMode::pulsed) {
-      // Pulsed source term updates
-      update_source_terms_pulsed(time_H, loop_variables.is_conductive,
-                                 loop_variables.J_c, loop_variables.J_s);
-
-      // Common amplitude factor in update equations
-      double common_amplitude =
-              exp(-1.0 * DCPI *
-                  pow((time_H - inputs.params.to_l +
-                       inputs.params.delta.dz / LIGHT_V / 2.) /
-                              inputs.params.hwhm,
-                      2));
-      // Common phase term in update equations
-      complex<double> common_phase =
-              -1.0 * IMAGINARY_UNIT *
-              exp(-IMAGINARY_UNIT *
-                  fmod(inputs.params.omega_an * (time_H - inputs.params.to_l),
-                       2. * DCPI));
-      // Update output H-field
-      outputs.H.ft = real(common_phase) * common_amplitude;
-    }
-
-    // end of source terms
-    if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
-
-    /********************/
-    // begin parallel
-#pragma omp parallel default(shared) private(                                  \
-        i, j, k, n, k_loc, array_ind)//,ca_vec,cb_vec,eh_vec)
-    {
-      n = omp_get_thread_num();
-
-      if (inputs.params.dimension == THREE ||
-          inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
-        if (solver_method == SolverMethod::FiniteDifference) {
-// FDTD, H_s.xz
-#pragma omp for
-          // H_s.xz updates
-          for (k = 0; k < K_tot; k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
-              for (i = 0; i < (I_tot + 1); i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-
-                if (!inputs.materials[k][j][i])
-                  inputs.H_s.xz(i, j, k) =
-                          inputs.D.a.z[k_loc] * inputs.H_s.xz(i, j, k) +
-                          inputs.D.b.z[k_loc] * (inputs.E_s.yx(i, j, k + 1) +
-                                                 inputs.E_s.yz(i, j, k + 1) -
-                                                 inputs.E_s.yx(i, j, k) -
-                                                 inputs.E_s.yz(i, j, k));
-                else
-                  inputs.H_s.xz(i, j, k) =
-                          inputs.Dmaterial.a.z[inputs.materials[k][j][i] - 1] *
-                                  inputs.H_s.xz(i, j, k) +
-                          inputs.Dmaterial.b.z[inputs.materials[k][j][i] - 1] *
-                                  (inputs.E_s.yx(i, j, k + 1) +
-                                   inputs.E_s.yz(i, j, k + 1) -
-                                   inputs.E_s.yx(i, j, k) -
-                                   inputs.E_s.yz(i, j, k));
-              }
-          // FDTD, H_s.xz
-        } else {
-#pragma omp for
-          // H_s.xz updates
-          for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
-            for (i = 0; i < (I_tot + 1); i++) {
-              for (k = 0; k < K_tot; k++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-
-                if (!inputs.materials[k][j][i]) {
-                  PSTD.ca(n, k) = inputs.D.a.z[k_loc];
-                  PSTD.cb(n, k) = inputs.D.b.z[k_loc];
-                } else {
-                  PSTD.ca(n, k) =
-                          inputs.Dmaterial.a.z[inputs.materials[k][j][i] - 1];
-                  PSTD.cb(n, k) =
-                          inputs.Dmaterial.b.z[inputs.materials[k][j][i] - 1];
-                  // H_s.xz(i, j, k) =
-                  // Dmaterial.Da.z[materials[k][j][i]-1]*H_s.xz(i, j,
-                  // k)+Dmaterial.Db.z[materials[k][j][i]-1]*(E_s.yx[k+1][j][i]
-                  // + E_s.yz[k+1][j][i] - E_s.yx(i,j,k) - E_s.yz(i,j,k));
-                }
-
-                eh_vec[n][k][0] =
-                        inputs.E_s.yx(i, j, k) + inputs.E_s.yz(i, j, k);
-                eh_vec[n][k][1] = 0.;
-              }
-              k = K_tot;
-              eh_vec[n][k][0] = inputs.E_s.yx(i, j, k) + inputs.E_s.yz(i, j, k);
-              eh_vec[n][k][1] = 0.;
-
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_hz, PSTD.N_hz,
-                               inputs.H_s.xz.plan_f[n],
-                               inputs.H_s.xz.plan_b[n]);
-
-              for (k = 0; k < K_tot; k++) {
-                inputs.H_s.xz(i, j, k) =
-                        PSTD.ca(n, k) * inputs.H_s.xz(i, j, k) +
-                        PSTD.cb(n, k) * eh_vec[n][k][0] / ((double) PSTD.N_hz);
-              }
-            }
-
-          // PSTD, H_s.xz
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-
-        if (solver_method == SolverMethod::FiniteDifference) {
-// FDTD, H_s.xy
-#pragma omp for
-          // H_s.xy updates
-          for (k = 0; k < K_tot; k++)
-            for (j = 0; j < J_tot; j++)
-              for (i = 0; i < (I_tot + 1); i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = j;
-                else
-                  array_ind = (J_tot + 1) * k_loc + j;
-                if (!inputs.materials[k][j][i])
-                  inputs.H_s.xy(i, j, k) =
-                          inputs.D.a.y[array_ind] * inputs.H_s.xy(i, j, k) +
-                          inputs.D.b.y[array_ind] *
-                                  (inputs.E_s.zy(i, j, k) +
-                                   inputs.E_s.zx(i, j, k) -
-                                   inputs.E_s.zy(i, j + 1, k) -
-                                   inputs.E_s.zx(i, j + 1, k));
-                else
-                  inputs.H_s.xy(i, j, k) =
-                          inputs.Dmaterial.a.y[inputs.materials[k][j][i] - 1] *
-                                  inputs.H_s.xy(i, j, k) +
-                          inputs.Dmaterial.b.y[inputs.materials[k][j][i] - 1] *
-                                  (inputs.E_s.zy(i, j, k) +
-                                   inputs.E_s.zx(i, j, k) -
-                                   inputs.E_s.zy(i, j + 1, k) -
-                                   inputs.E_s.zx(i, j + 1, k));
-              }
-          // FDTD, H_s.xy
-        } else {
-#pragma omp for
-          // H_s.xy updates
-          for (k = 0; k < K_tot; k++)
-            for (i = 0; i < (I_tot + 1); i++) {
-              for (j = 0; j < J_tot; j++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = j;
-                else
-                  array_ind = (J_tot + 1) * k_loc + j;
-                if (!inputs.materials[k][j][i]) {
-                  PSTD.ca(n, j) = inputs.D.a.y[array_ind];
-                  PSTD.cb(n, j) = inputs.D.b.y[array_ind];
-                } else {
-                  PSTD.ca(n, j) =
-                          inputs.Dmaterial.a.y[inputs.materials[k][j][i] - 1];
-                  PSTD.cb(n, j) =
-                          inputs.Dmaterial.b.y[inputs.materials[k][j][i] - 1];
-                  //		H_s.xy(i,j,k) =
-                  // Dmaterial.Da.y[materials[k][j][i]-1]*H_s.xy(i,j,k)+Dmaterial.Db.y[materials[k][j][i]-1]*(E_s.zy(i,j,k)
-                  //+ E_s.zx(i,j,k) - E_s.zy[k][j+1][i] - E_s.zx[k][j+1][i]);
-                }
 
-                eh_vec[n][j][0] =
-                        inputs.E_s.zy(i, j, k) + inputs.E_s.zx(i, j, k);
-                eh_vec[n][j][1] = 0.;
-              }
-              j = J_tot;
-              eh_vec[n][j][0] = inputs.E_s.zy(i, j, k) + inputs.E_s.zx(i, j, k);
-              eh_vec[n][j][1] = 0.;
-
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_hy, PSTD.N_hy,
-                               inputs.H_s.xy.plan_f[n],
-                               inputs.H_s.xy.plan_b[n]);
-
-              for (j = 0; j < J_tot; j++) {
-                inputs.H_s.xy(i, j, k) =
-                        PSTD.ca(n, j) * inputs.H_s.xy(i, j, k) -
-                        PSTD.cb(n, j) * eh_vec[n][j][0] / ((double) PSTD.N_hy);
-              }
-            }
-          // PSTD, H_s.xy
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-
-        if (solver_method == SolverMethod::FiniteDifference) {
-// FDTD, H_s.yx
-#pragma omp for
-          // H_s.yx updates
-          for (k = 0; k < K_tot; k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++)
-              for (i = 0; i < I_tot; i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-                if (!inputs.materials[k][j][i])
-                  inputs.H_s.yx(i, j, k) =
-                          inputs.D.a.x[array_ind] * inputs.H_s.yx(i, j, k) +
-                          inputs.D.b.x[array_ind] *
-                                  (inputs.E_s.zx(i + 1, j, k) +
-                                   inputs.E_s.zy(i + 1, j, k) -
-                                   inputs.E_s.zx(i, j, k) -
-                                   inputs.E_s.zy(i, j, k));
-                else {
-                  inputs.H_s.yx(i, j, k) =
-                          inputs.Dmaterial.a.x[inputs.materials[k][j][i] - 1] *
-                                  inputs.H_s.yx(i, j, k) +
-                          inputs.Dmaterial.b.x[inputs.materials[k][j][i] - 1] *
-                                  (inputs.E_s.zx(i + 1, j, k) +
-                                   inputs.E_s.zy(i + 1, j, k) -
-                                   inputs.E_s.zx(i, j, k) -
-                                   inputs.E_s.zy(i, j, k));
-                }
-              }
-          // FDTD, H_s.yx
-        } else {
-#pragma omp for
-          // H_s.yx updates
-          for (k = 0; k < K_tot; k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++) {
-              for (i = 0; i < I_tot; i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-                if (!inputs.materials[k][j][i]) {
-                  PSTD.ca(n, i) = inputs.D.a.x[array_ind];
-                  PSTD.cb(n, i) = inputs.D.b.x[array_ind];
-                } else {
-                  PSTD.ca(n, i) =
-                          inputs.Dmaterial.a.x[inputs.materials[k][j][i] - 1];
-                  PSTD.cb(n, i) =
-                          inputs.Dmaterial.b.x[inputs.materials[k][j][i] - 1];
-                  //	H_s.yx(i, j, k) =
-                  // Dmaterial.Da.x[materials[k][j][i]-1]*H_s.yx(i, j,
-                  // k)+Dmaterial.Db.x[materials[k][j][i]-1]*(E_s.zx[k][j][i+1]
-                  //+ E_s.zy[k][j][i+1] - E_s.zx(i,j,k) - E_s.zy(i,j,k));
-                }
-
-                eh_vec[n][i][0] =
-                        inputs.E_s.zx(i, j, k) + inputs.E_s.zy(i, j, k);
-                eh_vec[n][i][1] = 0.;
-              }
-              i = I_tot;
-              eh_vec[n][i][0] = inputs.E_s.zx(i, j, k) + inputs.E_s.zy(i, j, k);
-              eh_vec[n][i][1] = 0.;
-
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_hx, PSTD.N_hx,
-                               inputs.H_s.yx.plan_f[n],
-                               inputs.H_s.yx.plan_b[n]);
-
-              for (i = 0; i < I_tot; i++) {
-                inputs.H_s.yx(i, j, k) =
-                        PSTD.ca(n, i) * inputs.H_s.yx(i, j, k) +
-                        PSTD.cb(n, i) * eh_vec[n][i][0] / ((double) PSTD.N_hx);
-              }
-            }
-          // PSTD, H_s.yx
+      // Compute the detector function
+      compute_detector_functions(tind, loop_variables);
+
+      // Update equations for the E field
+
+      /*There are two options for determining the update coefficients for the
+        FDTD cell:
+
+        1) If cell (i,j,k) is either free space or PML:
+
+        materials(i, j, k) will be set to 0. In this case the update parameter
+        used will be given by C.a.y[j], C.b.y[j] etc depending on which update
+        equation is being implemented.
+
+        2) if cell (i,j,k) is composed of a scattering type material then
+        materials(i, j, k) will be non-zero and will be an index into
+        Cmaterial.a.y and Cmaterial.b.y etc depending on which update equation
+        is being implemented.
+
+        The coefficients of every cell are resolved once, before the main loop,
+        and are looked up from loop_variables.coefficients. The update loops
+        themselves are in execute_update_E_split.cpp and
+        execute_update_H_split.cpp.
+      */
+
+#pragma omp master
+      if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
+      if (!cache_blocking) {
+        (this->*update_E)(loop_variables);
+      } else if (!in_tile) {
+        // The E and H fields, and their source terms, are advanced together,
+        // by every timestep until the whole grid is next read
+        tile_steps = steps_in_tile(
+                tind,
+                loop_variables.active_region.is_tracking() ? 1
+                                                           : max_tile_steps,
+                energy_decay.is_enabled());
+        update_EH_blocked(loop_variables, tind, tile_steps, slab_width,
+                          dft_counter);
+      }
+      // The update kernels may not wait for each other
+#pragma omp barrier
+
+#pragma omp single
+      {
+        if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
+        /* Update source terms for self consistency across scattered/total
+         * interface. E_s updates use time_H simulation time. */
+        if (!cache_blocking) {
+          update_E_source_terms(time_H, loop_variables, 0, I_tot + 1);
         }
+        update_H_ft(time_H);
+        // end of source terms
+        if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
+      }
 
-        if (solver_method == SolverMethod::FiniteDifference) {
-// FDTD, H_s.yz
-#pragma omp for
-          // H_s.yz updates
-          for (k = 0; k < K_tot; k++) {
-            for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++)
-              for (i = 0; i < I_tot; i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.materials[k][j][i]) {
-                  inputs.H_s.yz(i, j, k) =
-                          inputs.D.a.z[k_loc] * inputs.H_s.yz(i, j, k) +
-                          inputs.D.b.z[k_loc] * (inputs.E_s.xy(i, j, k) +
-                                                 inputs.E_s.xz(i, j, k) -
-                                                 inputs.E_s.xy(i, j, k + 1) -
-                                                 inputs.E_s.xz(i, j, k + 1));
-                } else {
-                  inputs.H_s.yz(i, j, k) =
-                          inputs.Dmaterial.a.z[inputs.materials[k][j][i] - 1] *
-                                  inputs.H_s.yz(i, j, k) +
-                          inputs.Dmaterial.b.z[inputs.materials[k][j][i] - 1] *
-                                  (inputs.E_s.xy(i, j, k) +
-                                   inputs.E_s.xz(i, j, k) -
-                                   inputs.E_s.xy(i, j, k + 1) -
-                                   inputs.E_s.xz(i, j, k + 1));
-                }
-              }
-          }
-          // FDTD, H_s.yz
-        } else {
-          // #pragma omp for
-          // H_s.yz updates
-          for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++)
-#pragma omp for
-            for (i = 0; i < I_tot; i++) {
-              for (k = 0; k < K_tot; k++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.materials[k][j][i]) {
-                  PSTD.ca(n, k) = inputs.D.a.z[k_loc];
-                  PSTD.cb(n, k) = inputs.D.b.z[k_loc];
-                } else {
-                  PSTD.ca(n, k) =
-                          inputs.Dmaterial.a.z[inputs.materials[k][j][i] - 1];
-                  PSTD.cb(n, k) =
-                          inputs.Dmaterial.b.z[inputs.materials[k][j][i] - 1];
-                  // H_s.yz(i,j,k) =
-                  // Dmaterial.Da.z[materials[k][j][i]-1]*H_s.yz(i,j,k)+Dmaterial.Db.z[materials[k][j][i]-1]*(E_s.xy(i,j,k)
-                  // + E_s.xz(i, j, k) - E_s.xy[k+1][j][i] - E_s.xz[k+1][j][i]);
-                }
-
-                eh_vec[n][k][0] =
-                        inputs.E_s.xy(i, j, k) + inputs.E_s.xz(i, j, k);
-                eh_vec[n][k][1] = 0.;
-              }
-              k = K_tot;
-              eh_vec[n][k][0] = inputs.E_s.xy(i, j, k) + inputs.E_s.xz(i, j, k);
-              eh_vec[n][k][1] = 0.;
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_hz, PSTD.N_hz,
-                               inputs.H_s.yz.plan_f[n],
-                               inputs.H_s.yz.plan_b[n]);
-
-              for (k = 0; k < K_tot; k++) {
-                inputs.H_s.yz(i, j, k) =
-                        PSTD.ca(n, k) * inputs.H_s.yz(i, j, k) -
-                        PSTD.cb(n, k) * eh_vec[n][k][0] / ((double) PSTD.N_hz);
-              }
-            }
-          // PSTD, H_s.yz
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-      }  //(params.dimension==THREE || params.dimension==TE)
-      else {
-
-#pragma omp for
-        for (k = 0; k <= K_tot; k++)
-          for (j = 0; j < J_tot; j++)
-            for (i = 0; i < (I_tot + 1); i++)
-              if (!inputs.materials[k][j][i]) inputs.H_s.xz(i, j, k) = 0.;
-              else
-                inputs.H_s.xz(i, j, k) = 0.;
+      if (!cache_blocking) {
+        (this->*update_H)(loop_variables);
+#pragma omp barrier
+      }
 
-#pragma omp for
-        // H_s.xy update
-        for (k = 0; k <= K_tot; k++)
-          for (j = 0; j < J_tot; j++)
-            for (i = 0; i < (I_tot + 1); i++) {
-              k_loc = k;
-              if (inputs.params.is_structure)
-                if (k > inputs.params.pml.Dzl &&
-                    k < (inputs.params.pml.Dzl +
-                         loop_variables.n_non_pml_cells_in_K)) {
-                  if ((k - inputs.structure(1, i)) <
-                              (loop_variables.n_non_pml_cells_in_K +
-                               inputs.params.pml.Dzl) &&
-                      (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                    k_loc = k - inputs.structure(1, i);
-                  else if ((k - inputs.structure(1, i)) >=
-                           (loop_variables.n_non_pml_cells_in_K +
-                            inputs.params.pml.Dzl))
-                    k_loc = inputs.params.pml.Dzl +
-                            loop_variables.n_non_pml_cells_in_K - 1;
-                  else
-                    k_loc = inputs.params.pml.Dzl + 1;
-                }
-              if (!inputs.params.is_multilayer) array_ind = j;
-              else
-                array_ind = (J_tot + 1) * k_loc + j;
-              if (!inputs.materials[k][j][i])
-                inputs.H_s.xy(i, j, k) =
-                        inputs.D.a.y[array_ind] * inputs.H_s.xy(i, j, k) +
-                        inputs.D.b.y[array_ind] * (inputs.E_s.zy(i, j, k) +
-                                                   inputs.E_s.zx(i, j, k) -
-                                                   inputs.E_s.zy(i, j + 1, k) -
-                                                   inputs.E_s.zx(i, j + 1, k));
-              else
-                inputs.H_s.xy(i, j, k) =
-                        inputs.Dmaterial.a.y[inputs.materials[k][j][i] - 1] *
-                                inputs.H_s.xy(i, j, k) +
-                        inputs.Dmaterial.b.y[inputs.materials[k][j][i] - 1] *
-                                (inputs.E_s.zy(i, j, k) +
-                                 inputs.E_s.zx(i, j, k) -
-                                 inputs.E_s.zy(i, j + 1, k) -
-                                 inputs.E_s.zx(i, j + 1, k));
-            }
+      // The phasors that the update kernels have accumulated since the last
+      // check of their convergence join the output before it is finalised
+      if (tind + 1 == inputs.params.Nt &&
+          loop_variables.E_phasors.is_enabled()) {
+        loop_variables.E_phasors.flush(outputs.E);
+        loop_variables.H_phasors.flush(outputs.H);
+      }
 
-#pragma omp for
-        // H_s.yx update
-        for (k = 0; k <= K_tot; k++)
-          for (j = 0; j < (J_tot + 1); j++)
-            for (i = 0; i < I_tot; i++) {
-              k_loc = k;
-              if (inputs.params.is_structure)
-                if (k > inputs.params.pml.Dzl &&
-                    k < (inputs.params.pml.Dzl +
-                         loop_variables.n_non_pml_cells_in_K)) {
-                  if ((k - inputs.structure(1, i)) <
-                              (loop_variables.n_non_pml_cells_in_K +
-                               inputs.params.pml.Dzl) &&
-                      (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                    k_loc = k - inputs.structure(1, i);
-                  else if ((k - inputs.structure(1, i)) >=
-                           (loop_variables.n_non_pml_cells_in_K +
-                            inputs.params.pml.Dzl))
-                    k_loc = inputs.params.pml.Dzl +
-                            loop_variables.n_non_pml_cells_in_K - 1;
-                  else
-                    k_loc = inputs.params.pml.Dzl + 1;
-                }
-              if (!inputs.params.is_multilayer) array_ind = i;
-              else
-                array_ind = (I_tot + 1) * k_loc + i;
-              if (!inputs.materials[k][j][i])
-                inputs.H_s.yx(i, j, k) =
-                        inputs.D.a.x[array_ind] * inputs.H_s.yx(i, j, k) +
-                        inputs.D.b.x[array_ind] * (inputs.E_s.zx(i + 1, j, k) +
-                                                   inputs.E_s.zy(i + 1, j, k) -
-                                                   inputs.E_s.zx(i, j, k) -
-                                                   inputs.E_s.zy(i, j, k));
-              else
-                inputs.H_s.yx(i, j, k) =
-                        inputs.Dmaterial.a.x[inputs.materials[k][j][i] - 1] *
-                                inputs.H_s.yx(i, j, k) +
-                        inputs.Dmaterial.b.x[inputs.materials[k][j][i] - 1] *
-                                (inputs.E_s.zx(i + 1, j, k) +
-                                 inputs.E_s.zy(i + 1, j, k) -
-                                 inputs.E_s.zx(i, j, k) -
-                                 inputs.E_s.zy(i, j, k));
-            }
+#pragma omp single
+      {
+        try {
+          if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
 
-#pragma omp for
-        for (k = 0; k <= K_tot; k++) {
-          for (j = 0; j < (J_tot + 1); j++)
-            for (i = 0; i < I_tot; i++)
-              if (!inputs.materials[k][j][i]) inputs.H_s.yz(i, j, k) = 0.;
-              else
-                inputs.H_s.yz(i, j, k) = 0.;
+          /* Update source terms for self consistency across scattered/total
+           * interface - H updates (use time_E) */
+          if (!cache_blocking) {
+            update_H_source_terms(time_E, tind, 0, I_tot + 1);
+          }
+          update_E_ft(time_E);
+          if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
+
+          // If it is time for a new acquisition period, update the
+          // normalisation factors and extract phasors
+          new_acquisition_period(tind);
+          if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
+
+          // Perform setup for next iteration
+          end_of_iteration_steps(time_of_last_log_write, tind, convergence);
+          tile_steps_left = in_tile ? tile_steps_left - 1 : tile_steps - 1;
+        } catch (...) {
+          // an exception cannot leave the parallel region
+          loop_error = current_exception();
         }
       }
-
-      if (inputs.params.dimension == THREE ||
-          inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
-        if (solver_method == SolverMethod::FiniteDifference) {
-// FDTD, H_s.zy
-#pragma omp for
-          // H_s.zy update
-          for (k = 0; k < (K_tot + 1); k++)
-            for (j = 0; j < J_tot; j++)
-              for (i = 0; i < I_tot; i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = j;
-                else
-                  array_ind = (J_tot + 1) * k_loc + j;
-                if (!inputs.materials[k][j][i])
-                  inputs.H_s.zy(i, j, k) =
-                          inputs.D.a.y[array_ind] * inputs.H_s.zy(i, j, k) +
-                          inputs.D.b.y[array_ind] *
-                                  (inputs.E_s.xy(i, j + 1, k) +
-                                   inputs.E_s.xz(i, j + 1, k) -
-                                   inputs.E_s.xy(i, j, k) -
-                                   inputs.E_s.xz(i, j, k));
-                else
-                  inputs.H_s.zy(i, j, k) =
-                          inputs.Dmaterial.a.y[inputs.materials[k][j][i] - 1] *
-                                  inputs.H_s.zy(i, j, k) +
-                          inputs.Dmaterial.b.y[inputs.materials[k][j][i] - 1] *
-                                  (inputs.E_s.xy(i, j + 1, k) +
-                                   inputs.E_s.xz(i, j + 1, k) -
-                                   inputs.E_s.xy(i, j, k) -
-                                   inputs.E_s.xz(i, j, k));
-              }
-          // FDTD, H_s.zy
-        } else {
-#pragma omp for
-          // H_s.zy update
-          for (k = 0; k < (K_tot + 1); k++)
-            for (i = 0; i < I_tot; i++) {
-              for (j = 0; j < J_tot; j++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = j;
-                else
-                  array_ind = (J_tot + 1) * k_loc + j;
-                if (!inputs.materials[k][j][i]) {
-                  PSTD.ca(n, j) = inputs.D.a.y[array_ind];
-                  PSTD.cb(n, j) = inputs.D.b.y[array_ind];
-                } else {
-                  PSTD.ca(n, j) =
-                          inputs.Dmaterial.a.y[inputs.materials[k][j][i] - 1];
-                  PSTD.cb(n, j) =
-                          inputs.Dmaterial.b.y[inputs.materials[k][j][i] - 1];
-                  //	      H_s.zy(i,j,k) =
-                  // Dmaterial.Da.y[materials[k][j][i]-1]*H_s.zy(i,j,k)+Dmaterial.Db.y[materials[k][j][i]-1]*(E_s.xy[k][j+1][i]
-                  //+ E_s.xz[k][j+1][i] - E_s.xy(i,j,k) - E_s.xz(i, j, k));
-                }
-
-                eh_vec[n][j][0] =
-                        inputs.E_s.xy(i, j, k) + inputs.E_s.xz(i, j, k);
-                eh_vec[n][j][1] = 0.;
-              }
-              j = J_tot;
-              eh_vec[n][j][0] = inputs.E_s.xy(i, j, k) + inputs.E_s.xz(i, j, k);
-              eh_vec[n][j][1] = 0.;
-
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_hy, PSTD.N_hy,
-                               inputs.H_s.zy.plan_f[n],
-                               inputs.H_s.zy.plan_b[n]);
-
-              for (j = 0; j < J_tot; j++) {
-                inputs.H_s.zy(i, j, k) =
-                        PSTD.ca(n, j) * inputs.H_s.zy(i, j, k) +
-                        PSTD.cb(n, j) * eh_vec[n][j][0] / ((double) PSTD.N_hy);
-              }
-            }
-          // PSTD, H_s.zy
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-
-
-        if (solver_method == SolverMethod::FiniteDifference) {
-// FDTD, H_s.zx
-#pragma omp for
-          // H_s.zx update
-          for (k = 0; k < (K_tot + 1); k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
-              for (i = 0; i < I_tot; i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-                if (!inputs.materials[k][j][i])
-                  inputs.H_s.zx(i, j, k) =
-                          inputs.D.a.x[array_ind] * inputs.H_s.zx(i, j, k) +
-                          inputs.D.b.x[array_ind] *
-                                  (inputs.E_s.yx(i, j, k) +
-                                   inputs.E_s.yz(i, j, k) -
-                                   inputs.E_s.yx(i + 1, j, k) -
-                                   inputs.E_s.yz(i + 1, j, k));
-                else
-                  inputs.H_s.zx(i, j, k) =
-                          inputs.Dmaterial.a.x[inputs.materials[k][j][i] - 1] *
-                                  inputs.H_s.zx(i, j, k) +
-                          inputs.Dmaterial.b.x[inputs.materials[k][j][i] - 1] *
-                                  (inputs.E_s.yx(i, j, k) +
-                                   inputs.E_s.yz(i, j, k) -
-                                   inputs.E_s.yx(i + 1, j, k) -
-                                   inputs.E_s.yz(i + 1, j, k));
-              }
-          // FDTD, H_s.zx
-        } else {
-#pragma omp for
-          // H_s.zx update
-          for (k = 0; k < (K_tot + 1); k++)
-            for (j = 0; j < loop_variables.J_loop_upper_bound; j++) {
-              for (i = 0; i < I_tot; i++) {
-                k_loc = k;
-                if (inputs.params.is_structure)
-                  if (k > inputs.params.pml.Dzl &&
-                      k < (inputs.params.pml.Dzl +
-                           loop_variables.n_non_pml_cells_in_K)) {
-                    if ((k - inputs.structure(1, i)) <
-                                (loop_variables.n_non_pml_cells_in_K +
-                                 inputs.params.pml.Dzl) &&
-                        (k - inputs.structure(1, i)) > inputs.params.pml.Dzl)
-                      k_loc = k - inputs.structure(1, i);
-                    else if ((k - inputs.structure(1, i)) >=
-                             (loop_variables.n_non_pml_cells_in_K +
-                              inputs.params.pml.Dzl))
-                      k_loc = inputs.params.pml.Dzl +
-                              loop_variables.n_non_pml_cells_in_K - 1;
-                    else
-                      k_loc = inputs.params.pml.Dzl + 1;
-                  }
-                if (!inputs.params.is_multilayer) array_ind = i;
-                else
-                  array_ind = (I_tot + 1) * k_loc + i;
-                if (!inputs.materials[k][j][i]) {
-                  PSTD.ca(n, i) = inputs.D.a.x[array_ind];
-                  PSTD.cb(n, i) = inputs.D.b.x[array_ind];
-                } else {
-                  PSTD.ca(n, i) =
-                          inputs.Dmaterial.a.x[inputs.materials[k][j][i] - 1];
-                  PSTD.cb(n, i) =
-                          inputs.Dmaterial.b.x[inputs.materials[k][j][i] - 1];
-                }
-
-                eh_vec[n][i][0] =
-                        inputs.E_s.yx(i, j, k) + inputs.E_s.yz(i, j, k);
-                eh_vec[n][i][1] = 0.;
-              }
-              i = I_tot;
-              eh_vec[n][i][0] = inputs.E_s.yx(i, j, k) + inputs.E_s.yz(i, j, k);
-              eh_vec[n][i][1] = 0.;
-
-
-              first_derivative(eh_vec[n], eh_vec[n], PSTD.dk_hx, PSTD.N_hx,
-                               inputs.H_s.zx.plan_f[n],
-                               inputs.H_s.zx.plan_b[n]);
-
-              for (i = 0; i < I_tot; i++) {
-                inputs.H_s.zx(i, j, k) =
-                        PSTD.ca(n, i) * inputs.H_s.zx(i, j, k) -
-                        PSTD.cb(n, i) * eh_vec[n][i][0] / ((double) PSTD.N_hx);
-              }
-            }
-          // PSTD, H_s.zx
-        }// if (solver_method == DerivativeMethod::FiniteDifference) (else
-         // PseudoSpectral)
-      }  //(params.dimension==THREE || params.dimension==TE)
-    }    // end parallel
-    if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
-
-    /* Update source terms for self consistency across scattered/total interface
-     * - H updates (use time_E) */
-
-    if (inputs.params.source_mode == SourceMode::steadystate) {
-      // Steady-state source term updates
-      H_source_update_all_steadystate(time_E);
-
-      //! Common phase term in update equations
-      complex<double> common_phase =
-              exp(-IMAGINARY_UNIT *
-                  fmod(inputs.params.omega_an * time_E, 2. * DCPI));
-      //! Common amplitude term in update equations
-      double common_amplitude = linear_ramp(time_E);
-      // Update output field
-      outputs.E.ft = real(common_amplitude * common_phase);
-    } else if (inputs.params.source_mode == SourceMode::pulsed) {
-      // Pulsed source term updates
-      update_source_terms_pulsed(time_E, tind);
-
-      //! Common amplitude factor in update equations
-      double common_amplitude =
-              exp(-1. * DCPI *
-                  pow((time_E - inputs.params.to_l) / inputs.params.hwhm, 2.));
-      //! Common phase term in update equations
-      complex<double> common_phase =
-              -1. * IMAGINARY_UNIT *
-              exp(-1. * IMAGINARY_UNIT *
-                  fmod(inputs.params.omega_an * (time_E - inputs.params.to_l),
-                       2 * DCPI));
-      // Update output field
-      outputs.E.ft = common_amplitude * real(common_phase);
+      // Stop every thread if the bookkeeping failed
+      if (loop_error) { break; }
+
+      // Every so often, stop updating the cells that the pulse has left. All
+      // the threads share the scan of the fields.
+      if (shrink_active_region &&
+          (tind + 1) % ActiveRegion::SHRINK_INTERVAL == 0) {
+        loop_variables.active_region.shrink(inputs.E_s, inputs.H_s,
+                                            options.active_region_threshold);
+      }
     }
-    if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
-
-    // If it is time for a new acquisition period, update the normalisation
-    // factors and extract phasors
-    new_acquisition_period(tind);
-    if (TIME_EXEC) { timers.click_timer(TimersTrackingLoop::INTERNAL); }
-
-    // Perform setup for next iteration
-    end_of_iteration_steps(time_of_last_log_write, tind,
-                           loop_variables.E_at_previous_iteration);
   }
   // end of main iteration loop
+  if (loop_error) { rethrow_exception(loop_error); }
+  // the output phasors must be in the arrays of the output
+  convergence.release(outputs.E);
+  // each process has extracted the volume phasors of the cells that it owns,
+  // which the root process writes
+  if (distributed && inputs.params.run_mode == RunMode::complete &&
+      inputs.params.exphasorsvolume) {
+    outputs.gather_volume_phasors(*partition);
+  }
 
   if (TIME_MAIN_LOOP) {
     timers.end_timer(TimersTrackingLoop::MAIN);
@@ -2535,3 +377,79 @@ void SimulationManager::execute() {
                  timers.time_ellapsed_by(TimersTrackingLoop::MAIN));
   }
 }
+
+bool SimulationManager::supports_active_region(const LoopVariables &lv) const {
+  return inputs.params.source_mode == SourceMode::pulsed &&
+         supports_cache_blocking(lv);
+}
+
+bool SimulationManager::supports_distributed() const {
+  return inputs.params.dimension == Dimension::THREE &&
+         !inputs.params.exdetintegral && !inputs.params.has_tdfdir;
+}
+
+CellBox SimulationManager::pulsed_source_cells() {
+  IJKDimensions IJK_tot = n_Yee_cells();
+  int K0 = inputs.K0.index;
+  return {{0, 0, K0 - 1}, {IJK_tot.i + 1, IJK_tot.j + 1, K0 + 1}};
+}
+
+bool SimulationManager::source_has_decayed(double time,
+                                           double fraction) const {
+  double delay = (time - inputs.params.to_l) / inputs.params.hwhm;
+  // the power of the envelope exp(-pi delay^2) of update_E_ft and update_H_ft
+  return delay > 0. && exp(-2. * DCPI * delay * delay) < fraction;
+}
+
+void SimulationManager::update_H_ft(double time_H) {
+  if (inputs.params.source_mode == SourceMode::steadystate) {
+    // Common phase term in update equations
+    complex<double> common_phase = exp(
+            -IMAGINARY_UNIT * fmod(inputs.params.omega_an * time_H, 2. * DCPI));
+    // Common amplitude factor in update equations
+    double common_amplitude = linear_ramp(time_H);
+    // Update output H-field
+    outputs.H.ft = real(common_amplitude * common_phase);
+  } else if (inputs.params.source_mode == SourceMode::pulsed) {
+    // Common amplitude factor in update equations
+    double common_amplitude =
+            exp(-1.0 * DCPI *
+                pow((time_H - inputs.params.to_l +
+                     inputs.params.delta.dz / LIGHT_V / 2.) /
+                            inputs.params.hwhm,
+                    2));
+    // Common phase term in update equations
+    complex<double> common_phase =
+            -1.0 * IMAGINARY_UNIT *
+            exp(-IMAGINARY_UNIT *
+                fmod(inputs.params.omega_an * (time_H - inputs.params.to_l),
+                     2. * DCPI));
+    // Update output H-field
+    outputs.H.ft = real(common_phase) * common_amplitude;
+  }
+}
+
+void SimulationManager::update_E_ft(double time_E) {
+  if (inputs.params.source_mode == SourceMode::steadystate) {
+    //! Common phase term in update equations
+    complex<double> common_phase = exp(
+            -IMAGINARY_UNIT * fmod(inputs.params.omega_an * time_E, 2. * DCPI));
+    //! Common amplitude term in update equations
+    double common_amplitude = linear_ramp(time_E);
+    // Update output field
+    outputs.E.ft = real(common_amplitude * common_phase);
+  } else if (inputs.params.source_mode == SourceMode::pulsed) {
+    //! Common amplitude factor in update equations
+    double common_amplitude =
+            exp(-1. * DCPI *
+                pow((time_E - inputs.params.to_l) / inputs.params.hwhm, 2.));
+    //! Common phase term in update equations
+    complex<double> common_phase =
+            -1. * IMAGINARY_UNIT *
+            exp(-1. * IMAGINARY_UNIT *
+                fmod(inputs.params.omega_an * (time_E - inputs.params.to_l),
+                     2 * DCPI));
+    // Update output field
+    outputs.E.ft = common_amplitude * real(common_phase);
+  }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file execute_update_EH_blocked.cpp
+ * @brief Cache-blocked advancement of the E and H fields, see
+ * SimulationManager::update_EH_blocked.
+ */
+#include "simulation_manager/simulation_manager.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include <omp.h>
+#include <unistd.h>
+
+#include "simulation_manager/energy_decay.h"
+
+using namespace tdms_flags;
+using namespace std;
+
+void SimulationManager::update_E_source_terms(double time_H, LoopVariables &lv,
+                                              int i_begin, int i_end) {
+  if (inputs.params.source_mode == SourceMode::steadystate) {
+    // Steady-state source term updates
+    E_source_update_all_steadystate(time_H, lv, i_begin, i_end);
+  } else if (inputs.params.source_mode == SourceMode::pulsed) {
+    // Pulsed source term updates
+    update_source_terms_pulsed(time_H, lv, i_begin, i_end);
+  }
+}
+
+void SimulationManager::update_H_source_terms(double time_E, int tind,
+                                              int i_begin, int i_end) {
+  if (inputs.params.source_mode == SourceMode::steadystate) {
+    // Steady-state source term updates
+    H_source_update_all_steadystate(time_E, i_begin, i_end);
+  } else if (inputs.params.source_mode == SourceMode::pulsed) {
+    // Pulsed source term updates
+    update_source_terms_pulsed(time_E, tind, i_begin, i_end);
+  }
+}
+
+bool SimulationManager::supports_cache_blocking(const LoopVariables &lv) const {
+  return solver_method == SolverMethod::FiniteDifference &&
+         !(lv.is_dispersive || inputs.params.is_disp_ml) &&
+         !lv.is_conductive &&
+         inputs.params.dimension != Dimension::TRANSVERSE_MAGNETIC &&
+         !inputs.E_s.has_unsplit_interior();
+}
+
+int SimulationManager::cache_blocking_slab_width(int n_steps) {
+  IJKDimensions IJK_tot = n_Yee_cells();
+  // The six E and six H split components, and the three coefficient indices,
+  // of one plane of constant i
+  double plane_bytes = (12. * sizeof(field_t) + 3. * sizeof(uint32_t)) *
+                       (IJK_tot.j + 1) * (IJK_tot.k + 1);
+
+  double cache_bytes = 16. * 1024. * 1024.;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+  long l3_bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if (l3_bytes > 0) { cache_bytes = (double) l3_bytes; }
+#endif
+
+  // Both the slab being updated and the one before it should stay in cache,
+  // and each timestep of a tile shifts the slab by a plane
+  int width = (int) (cache_bytes / (2. * plane_bytes)) - n_steps;
+  return max(2, min(width, IJK_tot.i + 1));
+}
+
+int SimulationManager::steps_in_tile(unsigned int tind, int max_steps,
+                                     bool measures_energy) {
+  const SimulationParameters &params = inputs.params;
+  bool complete = params.run_mode == RunMode::complete;
+  bool pulsed = params.source_mode == SourceMode::pulsed;
+  // Whether the whole grid is read between timesteps t - 1 and t
+  auto grid_is_read_before = [&](unsigned int t) {
+    bool extraction = (t - params.start_tind) % params.Np == 0;
+    return (measures_energy &&
+            (t - params.start_tind) % EnergyDecay::CHECK_INTERVAL == 0) ||
+           outputs.fieldsample.all_vectors_are_non_empty() ||
+           (complete && params.exphasorssurface && (!pulsed || extraction)) ||
+           (complete && pulsed && extraction &&
+            (outputs.vertex_phasors.there_are_vertices_to_extract_at() ||
+             params.exdetintegral)) ||
+           (params.has_tdfdir && (t - 1) % params.Np == 0);
+  };
+
+  int n_steps = 1;
+  while (n_steps < max_steps && tind + n_steps < params.Nt &&
+         !grid_is_read_before(tind + n_steps)) {
+    n_steps++;
+  }
+  return n_steps;
+}
+
+void SimulationManager::update_EH_blocked(LoopVariables &lv, unsigned int tind,
+                                          int n_steps, int slab_width,
+                                          int dft_counter) {
+  int I_tot = n_Yee_cells().i;
+  const CellBox &active = lv.active_region.box();
+  // the cells of the active region with slab_begin <= i < slab_end
+  auto slab = [&](int slab_begin, int slab_end) {
+    CellBox cells = lv.active_region.grid();
+    cells.lower.i = slab_begin;
+    cells.upper.i = slab_end;
+    return cells.intersection(active);
+  };
+  bool extract_volume_phasors = inputs.params.run_mode == RunMode::complete &&
+                                inputs.params.exphasorsvolume;
+
+  for (int i_begin = 0; i_begin <= I_tot; i_begin += slab_width) {
+    int i_end = min(i_begin + slab_width, I_tot + 1);
+    // the final slab completes the grid
+    bool last = i_end == I_tot + 1;
+
+    for (int step = 0; step < n_steps; step++) {
+      unsigned int t = tind + step;
+      double time_E = ((double) (t + 1)) * inputs.params.dt;
+      double time_H = time_E - inputs.params.dt / 2.;
+
+      // E at i depends on H at i - 1, which the slab before has advanced by
+      // step timesteps only below i_begin - step
+      int E_begin = i_begin - step, E_end = last ? i_end : i_end - step;
+      // The first timestep is extracted from the whole grid before the tile;
+      // these cells have now reached the later ones
+      if (step > 0 && extract_volume_phasors) {
+        this->extract_volume_phasors(dft_counter, t, slab(E_begin, E_end));
+      }
+      update_E_split_vectorised(lv, slab(E_begin, E_end));
+#pragma omp barrier
+#pragma omp single
+      { update_E_source_terms(time_H, lv, E_begin, E_end); }
+
+      // H at i - 1 can now be advanced, since it depends on E at i
+      int H_begin = E_begin - 1, H_end = last ? i_end : E_end - 1;
+      update_H_split_vectorised(lv, slab(H_begin, H_end));
+#pragma omp barrier
+#pragma omp single
+      { update_H_source_terms(time_E, t, H_begin, H_end); }
+    }
+  }
+}
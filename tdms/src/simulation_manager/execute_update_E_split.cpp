@@ -0,0 +1,810 @@
+#include "simulation_manager/simulation_manager.h"
+
+#include <omp.h>
+
+#include "numerical_derivative.h"
+#include "stencil_kernels.h"
+
+using namespace tdms_flags;
+using namespace tdms_phys_constants;
+using namespace std;
+
+template<SolverMethod method, bool dispersive, bool conductive>
+void SimulationManager::update_Exy(LoopVariables &lv) {
+  // Fetch simulation dimensions for easy access
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+
+  if constexpr (method == SolverMethod::FiniteDifference) {
+#pragma omp for
+    for (int i = 0; i < I_tot; i++) {
+      for (int j = 1; j < J_tot; j++) {
+        for (int k = 0; k < (K_tot + 1); k++) {
+          const ECoefficients &c = lv.coefficients.Exy(i, j, k);
+
+          double Enp1, Jnp1;
+          Enp1 = c.Ca * inputs.E_s.xy(i, j, k) +
+                 c.Cb * (inputs.H_s.zy(i, j, k) + inputs.H_s.zx(i, j, k) -
+                         inputs.H_s.zy(i, j - 1, k) -
+                         inputs.H_s.zx(i, j - 1, k));
+          if (dispersive && c.gamma)
+            Enp1 += c.Cc * lv.E_nm1.xy(i, j, k) -
+                    1. / 2. * c.Cb * inputs.params.delta.dy *
+                            ((1 + c.alpha) * lv.J_s.xy(i, j, k) +
+                             c.beta * lv.J_nm1.xy(i, j, k));
+          if (conductive && c.rho)
+            Enp1 += c.Cb * inputs.params.delta.dy * lv.J_c.xy(i, j, k);
+          if (dispersive && c.gamma) {
+            Jnp1 = c.alpha * lv.J_s.xy(i, j, k) +
+                   c.beta * lv.J_nm1.xy(i, j, k) +
+                   c.kappa * c.gamma / (2. * inputs.params.dt) *
+                           (Enp1 - lv.E_nm1.xy(i, j, k));
+            Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.xy(i, j, k);
+
+            lv.E_nm1.xy(i, j, k) = inputs.E_s.xy(i, j, k);
+            lv.J_nm1.xy(i, j, k) = lv.J_s.xy(i, j, k);
+            lv.J_s.xy(i, j, k) = Jnp1;
+          }
+
+          if (conductive && c.rho) {
+            lv.J_c.xy(i, j, k) -= c.rho * (Enp1 + inputs.E_s.xy(i, j, k));
+          }
+
+          inputs.E_s.xy(i, j, k) = Enp1;
+        }
+      }
+    }
+  } else {// pseudo-spectral
+    auto sample = [&](int i, int k, int j) {
+      return inputs.H_s.zy(i, j, k) + inputs.H_s.zx(i, j, k);
+    };
+    auto update = [&](int i, int k, int j, double derivative) {
+      const ECoefficients &c = lv.coefficients.Exy(i, j, k);
+
+      double Enp1 = 0.0, Jnp1;
+      // Enp1 = Ca*E_s.xy(i,j,k)+Cb*(H_s.zy(i,j,k) + H_s.zx(i,j,k) -
+      // H_s.zy[k][j-1][i] - H_s.zx[k][j-1][i]);
+      if (dispersive && c.gamma)
+        Enp1 += c.Cc * lv.E_nm1.xy(i, j, k) -
+                1. / 2. * c.Cb * inputs.params.delta.dy *
+                        ((1 + c.alpha) * lv.J_s.xy(i, j, k) +
+                         c.beta * lv.J_nm1.xy(i, j, k));
+      if (conductive && c.rho)
+        Enp1 += c.Cb * inputs.params.delta.dy * lv.J_c.xy(i, j, k);
+      if (dispersive && c.gamma) {
+        Jnp1 = c.alpha * lv.J_s.xy(i, j, k) + c.beta * lv.J_nm1.xy(i, j, k) +
+               c.kappa * c.gamma / (2. * inputs.params.dt) *
+                       (Enp1 - lv.E_nm1.xy(i, j, k));
+        Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.xy(i, j, k);
+
+        lv.E_nm1.xy(i, j, k) = inputs.E_s.xy(i, j, k);
+        lv.J_nm1.xy(i, j, k) = lv.J_s.xy(i, j, k);
+        lv.J_s.xy(i, j, k) = Jnp1;
+      }
+
+      if (conductive && c.rho) {
+        lv.J_c.xy(i, j, k) -= c.rho * (Enp1 + inputs.E_s.xy(i, j, k));
+      }
+
+      inputs.E_s.xy(i, j, k) =
+              c.Ca * inputs.E_s.xy(i, j, k) + c.Cb * derivative;
+    };
+    PSTD.d_ey.differentiate_lines(
+            I_tot, K_tot + 1, 1, J_tot, sample, update,
+            [&](int i, int k, int n, double *weight) {
+              return PSTD.spectral.y(i, k, n, weight);
+            });
+  }
+}
+
+template<SolverMethod method, bool dispersive, bool conductive>
+void SimulationManager::update_Exz(LoopVariables &lv) {
+  // Fetch simulation dimensions for easy access
+  int I_tot = n_Yee_cells().i, K_tot = n_Yee_cells().k;
+
+  if constexpr (method == SolverMethod::FiniteDifference) {
+#pragma omp for
+    for (int i = 0; i < I_tot; i++) {
+      for (int j = 0; j < lv.J_loop_upper_bound_plus_1; j++) {
+        for (int k = 1; k < K_tot; k++) {
+          const ECoefficients &c = lv.coefficients.Exz(i, j, k);
+
+          double Enp1, Jnp1;
+          Enp1 = c.Ca * inputs.E_s.xz(i, j, k) +
+                 c.Cb * (inputs.H_s.yx(i, j, k - 1) +
+                         inputs.H_s.yz(i, j, k - 1) - inputs.H_s.yx(i, j, k) -
+                         inputs.H_s.yz(i, j, k));
+          if (dispersive && c.gamma)
+            Enp1 += c.Cc * lv.E_nm1.xz(i, j, k) -
+                    1. / 2. * c.Cb * inputs.params.delta.dz *
+                            ((1 + c.alpha) * lv.J_s.xz(i, j, k) +
+                             c.beta * lv.J_nm1.xz(i, j, k));
+          if (conductive && c.rho)
+            Enp1 += c.Cb * inputs.params.delta.dz * lv.J_c.xz(i, j, k);
+          if (dispersive && c.gamma) {
+            Jnp1 = c.alpha * lv.J_s.xz(i, j, k) +
+                   c.beta * lv.J_nm1.xz(i, j, k) +
+                   c.kappa * c.gamma / (2. * inputs.params.dt) *
+                           (Enp1 - lv.E_nm1.xz(i, j, k));
+            Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.xz(i, j, k);
+            lv.E_nm1.xz(i, j, k) = inputs.E_s.xz(i, j, k);
+            lv.J_nm1.xz(i, j, k) = lv.J_s.xz(i, j, k);
+            lv.J_s.xz(i, j, k) = Jnp1;
+          }
+
+          if (conductive && c.rho) {
+            lv.J_c.xz(i, j, k) -= c.rho * (Enp1 + inputs.E_s.xz(i, j, k));
+          }
+
+          inputs.E_s.xz(i, j, k) = Enp1;
+        }
+      }
+    }
+  } else {// psuedo-spectral
+    auto sample = [&](int j, int i, int k) {
+      return inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k);
+    };
+    auto update = [&](int j, int i, int k, double derivative) {
+      const ECoefficients &c = lv.coefficients.Exz(i, j, k);
+
+      double Enp1 = 0.0, Jnp1;
+      // Enp1 = Ca*E_s.xz(i,j,k)+Cb*(H_s.yx[k-1][j][i] + H_s.yz[k-1][j][i]
+      // - H_s.yx(i,j,k) - H_s.yz(i,j,k));
+      if (dispersive && c.gamma)
+        Enp1 += c.Cc * lv.E_nm1.xz(i, j, k) -
+                1. / 2. * c.Cb * inputs.params.delta.dz *
+                        ((1 + c.alpha) * lv.J_s.xz(i, j, k) +
+                         c.beta * lv.J_nm1.xz(i, j, k));
+      if (conductive && c.rho)
+        Enp1 += c.Cb * inputs.params.delta.dz * lv.J_c.xz(i, j, k);
+      if (dispersive && c.gamma) {
+        Jnp1 = c.alpha * lv.J_s.xz(i, j, k) + c.beta * lv.J_nm1.xz(i, j, k) +
+               c.kappa * c.gamma / (2. * inputs.params.dt) *
+                       (Enp1 - lv.E_nm1.xz(i, j, k));
+        Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.xz(i, j, k);
+        lv.E_nm1.xz(i, j, k) = inputs.E_s.xz(i, j, k);
+        lv.J_nm1.xz(i, j, k) = lv.J_s.xz(i, j, k);
+        lv.J_s.xz(i, j, k) = Jnp1;
+      }
+
+      if (conductive && c.rho) {
+        lv.J_c.xz(i, j, k) -= c.rho * (Enp1 + inputs.E_s.xz(i, j, k));
+      }
+
+      inputs.E_s.xz(i, j, k) =
+              c.Ca * inputs.E_s.xz(i, j, k) - c.Cb * derivative;
+    };
+    PSTD.d_ez.differentiate_lines(
+            lv.J_loop_upper_bound_plus_1, I_tot, 1, K_tot, sample, update,
+            [&](int j, int i, int n, double *weight) {
+              return PSTD.spectral.z(i, j, n, weight);
+            });
+  }
+}
+
+template<SolverMethod method, bool dispersive, bool conductive>
+void SimulationManager::update_E_split(LoopVariables &loop_variables) {
+  // Fetch simulation dimensions for easy access
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  int i, j, k;//< Loop variables
+  double Enp1 = 0.0, Jnp1;
+
+  if constexpr (method == SolverMethod::FiniteDifference && !dispersive &&
+                !conductive) {
+    if (inputs.params.dimension == THREE ||
+        inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
+      update_E_split_vectorised(loop_variables,
+                                loop_variables.active_region.box());
+      return;
+    }
+  }
+
+  if (inputs.params.dimension == THREE ||
+      inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
+    update_Exy<method, dispersive, conductive>(loop_variables);
+    update_Exz<method, dispersive, conductive>(loop_variables);
+    // E_s.yx updates
+    if constexpr (method == SolverMethod::FiniteDifference) {
+      // FDTD, E_s.yx
+#pragma omp for
+      for (i = 1; i < I_tot; i++)
+        for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
+          for (k = 0; k < (K_tot + 1); k++) {
+            const ECoefficients &c =
+                    loop_variables.coefficients.Eyx(i, j, k);
+            Enp1 = c.Ca * inputs.E_s.yx(i, j, k) +
+                   c.Cb * (inputs.H_s.zx(i - 1, j, k) +
+                           inputs.H_s.zy(i - 1, j, k) -
+                           inputs.H_s.zx(i, j, k) - inputs.H_s.zy(i, j, k));
+            if (dispersive && c.gamma)
+              Enp1 += c.Cc * loop_variables.E_nm1.yx(i, j, k) -
+                      1. / 2. * c.Cb * inputs.params.delta.dx *
+                              ((1 + c.alpha) * loop_variables.J_s.yx(i, j, k) +
+                               c.beta * loop_variables.J_nm1.yx(i, j, k));
+            if (conductive && c.rho)
+              Enp1 += c.Cb * inputs.params.delta.dx *
+                      loop_variables.J_c.yx(i, j, k);
+            if (dispersive && c.gamma) {
+              Jnp1 = c.alpha * loop_variables.J_s.yx(i, j, k) +
+                     c.beta * loop_variables.J_nm1.yx(i, j, k) +
+                     c.kappa * c.gamma / (2. * inputs.params.dt) *
+                             (Enp1 - loop_variables.E_nm1.yx(i, j, k));
+              Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.yx(i, j, k);
+              loop_variables.E_nm1.yx(i, j, k) = inputs.E_s.yx(i, j, k);
+              loop_variables.J_nm1.yx(i, j, k) = loop_variables.J_s.yx(i, j, k);
+              loop_variables.J_s.yx(i, j, k) = Jnp1;
+            }
+            if (conductive && c.rho) {
+              loop_variables.J_c.yx(i, j, k) -=
+                      c.rho * (Enp1 + inputs.E_s.yx(i, j, k));
+            }
+
+            inputs.E_s.yx(i, j, k) = Enp1;
+          }
+      // FDTD, E_s.yx
+    } else {
+      auto sample = [&](int j, int k, int i) {
+        return inputs.H_s.zx(i, j, k) + inputs.H_s.zy(i, j, k);
+      };
+      auto update = [&](int j, int k, int i, double derivative) {
+        const ECoefficients &c = loop_variables.coefficients.Eyx(i, j, k);
+        double Enp1 = 0.0, Jnp1;
+        // Enp1 = Ca*E_s.yx(i,j,k)+Cb*(H_s.zx[k][j][i-1] +
+        // H_s.zy[k][j][i-1] - H_s.zx(i,j,k) - H_s.zy(i,j,k));
+        if (dispersive && c.gamma)
+          Enp1 += c.Cc * loop_variables.E_nm1.yx(i, j, k) -
+                  1. / 2. * c.Cb * inputs.params.delta.dx *
+                          ((1 + c.alpha) * loop_variables.J_s.yx(i, j, k) +
+                           c.beta * loop_variables.J_nm1.yx(i, j, k));
+        if (conductive && c.rho)
+          Enp1 += c.Cb * inputs.params.delta.dx *
+                  loop_variables.J_c.yx(i, j, k);
+        if (dispersive && c.gamma) {
+          Jnp1 = c.alpha * loop_variables.J_s.yx(i, j, k) +
+                 c.beta * loop_variables.J_nm1.yx(i, j, k) +
+                 c.kappa * c.gamma / (2. * inputs.params.dt) *
+                         (Enp1 - loop_variables.E_nm1.yx(i, j, k));
+          Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.yx(i, j, k);
+          loop_variables.E_nm1.yx(i, j, k) = inputs.E_s.yx(i, j, k);
+          loop_variables.J_nm1.yx(i, j, k) = loop_variables.J_s.yx(i, j, k);
+          loop_variables.J_s.yx(i, j, k) = Jnp1;
+        }
+        if (conductive && c.rho) {
+          loop_variables.J_c.yx(i, j, k) -=
+                  c.rho * (Enp1 + inputs.E_s.yx(i, j, k));
+        }
+
+        inputs.E_s.yx(i, j, k) =
+                c.Ca * inputs.E_s.yx(i, j, k) - c.Cb * derivative;
+      };
+      PSTD.d_ex.differentiate_lines(
+              loop_variables.J_loop_upper_bound, K_tot + 1, 1, I_tot,
+              sample, update,
+              [&](int j, int k, int n, double *weight) {
+                return PSTD.spectral.x(j, k, n, weight);
+              });
+      // PSTD, E_s.yx
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+    // E_s.yz updates
+    if constexpr (method == SolverMethod::FiniteDifference) {
+// FDTD, E_s.yz
+#pragma omp for
+      for (i = 0; i < (I_tot + 1); i++)
+        for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
+          for (k = 1; k < K_tot; k++) {
+            const ECoefficients &c =
+                    loop_variables.coefficients.Eyz(i, j, k);
+            Enp1 = c.Ca * inputs.E_s.yz(i, j, k) +
+                   c.Cb * (inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k) -
+                           inputs.H_s.xy(i, j, k - 1) -
+                           inputs.H_s.xz(i, j, k - 1));
+            if (dispersive && c.gamma)
+              Enp1 += c.Cc * loop_variables.E_nm1.yz(i, j, k) -
+                      1. / 2. * c.Cb * inputs.params.delta.dz *
+                              ((1 + c.alpha) * loop_variables.J_s.yz(i, j, k) +
+                               c.beta * loop_variables.J_nm1.yz(i, j, k));
+            if (conductive && c.rho)
+              Enp1 += c.Cb * inputs.params.delta.dz *
+                      loop_variables.J_c.yz(i, j, k);
+
+            if (dispersive && c.gamma) {
+              Jnp1 = c.alpha * loop_variables.J_s.yz(i, j, k) +
+                     c.beta * loop_variables.J_nm1.yz(i, j, k) +
+                     c.kappa * c.gamma / (2. * inputs.params.dt) *
+                             (Enp1 - loop_variables.E_nm1.yz(i, j, k));
+              Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.yz(i, j, k);
+              loop_variables.E_nm1.yz(i, j, k) = inputs.E_s.yz(i, j, k);
+              loop_variables.J_nm1.yz(i, j, k) = loop_variables.J_s.yz(i, j, k);
+              loop_variables.J_s.yz(i, j, k) = Jnp1;
+            }
+            if (conductive && c.rho) {
+              loop_variables.J_c.yz(i, j, k) -=
+                      c.rho * (Enp1 + inputs.E_s.yz(i, j, k));
+            }
+
+            inputs.E_s.yz(i, j, k) = Enp1;
+          }
+      // FDTD, E_s.yz
+    } else {
+      auto sample = [&](int j, int i, int k) {
+        return inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k);
+      };
+      auto update = [&](int j, int i, int k, double derivative) {
+        const ECoefficients &c = loop_variables.coefficients.Eyz(i, j, k);
+        double Enp1 = 0.0, Jnp1;
+        // Enp1 = Ca*E_s.yz(i,j,k)+Cb*(H_s.xy(i,j,k) +
+        // H_s.xz(i, j, k) - H_s.xy[k-1][j][i] - H_s.xz[k-1][j][i]);
+        if (dispersive && c.gamma)
+          Enp1 += c.Cc * loop_variables.E_nm1.yz(i, j, k) -
+                  1. / 2. * c.Cb * inputs.params.delta.dz *
+                          ((1 + c.alpha) * loop_variables.J_s.yz(i, j, k) +
+                           c.beta * loop_variables.J_nm1.yz(i, j, k));
+        if (conductive && c.rho)
+          Enp1 += c.Cb * inputs.params.delta.dz *
+                  loop_variables.J_c.yz(i, j, k);
+
+        if (dispersive && c.gamma) {
+          Jnp1 = c.alpha * loop_variables.J_s.yz(i, j, k) +
+                 c.beta * loop_variables.J_nm1.yz(i, j, k) +
+                 c.kappa * c.gamma / (2. * inputs.params.dt) *
+                         (Enp1 - loop_variables.E_nm1.yz(i, j, k));
+          Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.yz(i, j, k);
+          loop_variables.E_nm1.yz(i, j, k) = inputs.E_s.yz(i, j, k);
+          loop_variables.J_nm1.yz(i, j, k) = loop_variables.J_s.yz(i, j, k);
+          loop_variables.J_s.yz(i, j, k) = Jnp1;
+        }
+        if (conductive && c.rho) {
+          loop_variables.J_c.yz(i, j, k) -=
+                  c.rho * (Enp1 + inputs.E_s.yz(i, j, k));
+        }
+
+        inputs.E_s.yz(i, j, k) =
+                c.Ca * inputs.E_s.yz(i, j, k) + c.Cb * derivative;
+      };
+      PSTD.d_ez.differentiate_lines(
+              loop_variables.J_loop_upper_bound, I_tot + 1, 1, K_tot,
+              sample, update,
+              [&](int j, int i, int n, double *weight) {
+                return PSTD.spectral.z(i, j, n, weight);
+              });
+      // PSTD, E_s.yz
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+  }  // if(params.dimension==THREE || params.dimension==TE)
+
+  if (inputs.params.dimension == THREE ||
+      inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
+    if constexpr (method == SolverMethod::FiniteDifference) {
+#pragma omp for
+      // E_s.zx updates
+      for (i = 1; i < I_tot; i++)
+        for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++)
+          for (k = 0; k < K_tot; k++) {
+            const ECoefficients &c =
+                    loop_variables.coefficients.Ezx(i, j, k);
+            Enp1 = c.Ca * inputs.E_s.zx(i, j, k) +
+                   c.Cb * (inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k) -
+                           inputs.H_s.yx(i - 1, j, k) -
+                           inputs.H_s.yz(i - 1, j, k));
+            if (dispersive && c.gamma)
+              Enp1 += c.Cc * loop_variables.E_nm1.zx(i, j, k) -
+                      1. / 2. * c.Cb * inputs.params.delta.dx *
+                              ((1 + c.alpha) * loop_variables.J_s.zx(i, j, k) +
+                               c.beta * loop_variables.J_nm1.zx(i, j, k));
+            if (conductive && c.rho)
+              Enp1 += c.Cb * inputs.params.delta.dx *
+                      loop_variables.J_c.zx(i, j, k);
+            if (dispersive && c.gamma) {
+              Jnp1 = c.alpha * loop_variables.J_s.zx(i, j, k) +
+                     c.beta * loop_variables.J_nm1.zx(i, j, k) +
+                     c.kappa * c.gamma / (2. * inputs.params.dt) *
+                             (Enp1 - loop_variables.E_nm1.zx(i, j, k));
+              Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.zx(i, j, k);
+              loop_variables.E_nm1.zx(i, j, k) = inputs.E_s.zx(i, j, k);
+              loop_variables.J_nm1.zx(i, j, k) = loop_variables.J_s.zx(i, j, k);
+              loop_variables.J_s.zx(i, j, k) = Jnp1;
+            }
+            if (conductive && c.rho) {
+              loop_variables.J_c.zx(i, j, k) -=
+                      c.rho * (Enp1 + inputs.E_s.zx(i, j, k));
+            }
+
+            inputs.E_s.zx(i, j, k) = Enp1;
+          }
+      // FDTD, E_s.zx
+    } else {
+      auto sample = [&](int j, int k, int i) {
+        return inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k);
+      };
+      auto update = [&](int j, int k, int i, double derivative) {
+        const ECoefficients &c = loop_variables.coefficients.Ezx(i, j, k);
+        double Enp1 = 0.0, Jnp1;
+        // Enp1 = Ca*E_s.zx(i,j,k)+Cb*(H_s.yx(i, j, k) +
+        // H_s.yz(i,j,k) - H_s.yx[k][j][i-1] - H_s.yz[k][j][i-1]);
+        if (dispersive && c.gamma)
+          Enp1 += c.Cc * loop_variables.E_nm1.zx(i, j, k) -
+                  1. / 2. * c.Cb * inputs.params.delta.dx *
+                          ((1 + c.alpha) * loop_variables.J_s.zx(i, j, k) +
+                           c.beta * loop_variables.J_nm1.zx(i, j, k));
+        if (conductive && c.rho)
+          Enp1 += c.Cb * inputs.params.delta.dx *
+                  loop_variables.J_c.zx(i, j, k);
+        if (dispersive && c.gamma) {
+          Jnp1 = c.alpha * loop_variables.J_s.zx(i, j, k) +
+                 c.beta * loop_variables.J_nm1.zx(i, j, k) +
+                 c.kappa * c.gamma / (2. * inputs.params.dt) *
+                         (Enp1 - loop_variables.E_nm1.zx(i, j, k));
+          Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.zx(i, j, k);
+          loop_variables.E_nm1.zx(i, j, k) = inputs.E_s.zx(i, j, k);
+          loop_variables.J_nm1.zx(i, j, k) = loop_variables.J_s.zx(i, j, k);
+          loop_variables.J_s.zx(i, j, k) = Jnp1;
+        }
+        if (conductive && c.rho) {
+          loop_variables.J_c.zx(i, j, k) -=
+                  c.rho * (Enp1 + inputs.E_s.zx(i, j, k));
+        }
+
+        inputs.E_s.zx(i, j, k) =
+                c.Ca * inputs.E_s.zx(i, j, k) + c.Cb * derivative;
+      };
+      PSTD.d_ex.differentiate_lines(
+              loop_variables.J_loop_upper_bound_plus_1, K_tot, 1, I_tot,
+              sample, update,
+              [&](int j, int k, int n, double *weight) {
+                return PSTD.spectral.x(j, k, n, weight);
+              });
+      // PSTD, E_s.zx
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+  }  //(params.dimension==THREE || params.dimension==TE)
+  else {
+#pragma omp for
+    // E_s.zx updates
+    for (i = 1; i < I_tot; i++)
+      for (j = 0; j < (J_tot + 1); j++)
+        for (k = 0; k <= K_tot; k++) {
+          const ECoefficients &c =
+                  loop_variables.coefficients.Ezx(i, j, k);
+          Enp1 = c.Ca * inputs.E_s.zx(i, j, k) +
+                 c.Cb * (inputs.H_s.yx(i, j, k) + inputs.H_s.yz(i, j, k) -
+                         inputs.H_s.yx(i - 1, j, k) -
+                         inputs.H_s.yz(i - 1, j, k));
+          if (dispersive && c.gamma)
+            Enp1 += c.Cc * loop_variables.E_nm1.zx(i, j, k) -
+                    1. / 2. * c.Cb * inputs.params.delta.dx *
+                            ((1 + c.alpha) * loop_variables.J_s.zx(i, j, k) +
+                             c.beta * loop_variables.J_nm1.zx(i, j, k));
+          if (conductive && c.rho)
+            Enp1 += c.Cb * inputs.params.delta.dx *
+                    loop_variables.J_c.zx(i, j, k);
+
+          if (dispersive && c.gamma) {
+            Jnp1 = c.alpha * loop_variables.J_s.zx(i, j, k) +
+                   c.beta * loop_variables.J_nm1.zx(i, j, k) +
+                   c.kappa * c.gamma / (2. * inputs.params.dt) *
+                           (Enp1 - loop_variables.E_nm1.zx(i, j, k));
+            Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.zx(i, j, k);
+            loop_variables.E_nm1.zx(i, j, k) = inputs.E_s.zx(i, j, k);
+            loop_variables.J_nm1.zx(i, j, k) = loop_variables.J_s.zx(i, j, k);
+            loop_variables.J_s.zx(i, j, k) = Jnp1;
+          }
+          if (conductive && c.rho) {
+            loop_variables.J_c.zx(i, j, k) -=
+                    c.rho * (Enp1 + inputs.E_s.zx(i, j, k));
+          }
+
+          inputs.E_s.zx(i, j, k) = Enp1;
+        }
+  }
+  if (inputs.params.dimension == THREE ||
+      inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
+    if constexpr (method == SolverMethod::FiniteDifference) {
+      // FDTD, E_s.zy
+#pragma omp for
+      // E_s.zy updates
+      for (i = 0; i < (I_tot + 1); i++)
+        for (j = 1; j < J_tot; j++)
+          for (k = 0; k < K_tot; k++) {
+            const ECoefficients &c =
+                    loop_variables.coefficients.Ezy(i, j, k);
+            Enp1 = c.Ca * inputs.E_s.zy(i, j, k) +
+                   c.Cb * (inputs.H_s.xy(i, j - 1, k) +
+                           inputs.H_s.xz(i, j - 1, k) -
+                           inputs.H_s.xy(i, j, k) - inputs.H_s.xz(i, j, k));
+            if (dispersive && c.gamma)
+              Enp1 += c.Cc * loop_variables.E_nm1.zy(i, j, k) -
+                      1. / 2. * c.Cb * inputs.params.delta.dy *
+                              ((1 + c.alpha) * loop_variables.J_s.zy(i, j, k) +
+                               c.beta * loop_variables.J_nm1.zy(i, j, k));
+            if (conductive && c.rho)
+              Enp1 += c.Cb * inputs.params.delta.dy *
+                      loop_variables.J_c.zy(i, j, k);
+
+            if (dispersive && c.gamma) {
+              Jnp1 = c.alpha * loop_variables.J_s.zy(i, j, k) +
+                     c.beta * loop_variables.J_nm1.zy(i, j, k) +
+                     c.kappa * c.gamma / (2. * inputs.params.dt) *
+                             (Enp1 - loop_variables.E_nm1.zy(i, j, k));
+
+              Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.zy(i, j, k);
+              loop_variables.E_nm1.zy(i, j, k) = inputs.E_s.zy(i, j, k);
+              loop_variables.J_nm1.zy(i, j, k) = loop_variables.J_s.zy(i, j, k);
+              loop_variables.J_s.zy(i, j, k) = Jnp1;
+            }
+            if (conductive && c.rho) {
+              loop_variables.J_c.zy(i, j, k) -=
+                      c.rho * (Enp1 + inputs.E_s.zy(i, j, k));
+            }
+            inputs.E_s.zy(i, j, k) = Enp1;
+          }
+      // FDTD, E_s.zy
+    } else {
+      auto sample = [&](int i, int k, int j) {
+        return inputs.H_s.xy(i, j, k) + inputs.H_s.xz(i, j, k);
+      };
+      auto update = [&](int i, int k, int j, double derivative) {
+        const ECoefficients &c = loop_variables.coefficients.Ezy(i, j, k);
+        double Enp1 = 0.0, Jnp1;
+        // Enp1 = Ca*E_s.zy(i,j,k)+Cb*(H_s.xy[k][j-1][i] +
+        // H_s.xz[k][j-1][i] - H_s.xy(i,j,k) - H_s.xz(i, j, k));
+        if (dispersive && c.gamma)
+          Enp1 += c.Cc * loop_variables.E_nm1.zy(i, j, k) -
+                  1. / 2. * c.Cb * inputs.params.delta.dy *
+                          ((1 + c.alpha) * loop_variables.J_s.zy(i, j, k) +
+                           c.beta * loop_variables.J_nm1.zy(i, j, k));
+        if (conductive && c.rho)
+          Enp1 += c.Cb * inputs.params.delta.dy *
+                  loop_variables.J_c.zy(i, j, k);
+
+        if (dispersive && c.gamma) {
+          Jnp1 = c.alpha * loop_variables.J_s.zy(i, j, k) +
+                 c.beta * loop_variables.J_nm1.zy(i, j, k) +
+                 c.kappa * c.gamma / (2. * inputs.params.dt) *
+                         (Enp1 - loop_variables.E_nm1.zy(i, j, k));
+
+          Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.zy(i, j, k);
+          loop_variables.E_nm1.zy(i, j, k) = inputs.E_s.zy(i, j, k);
+          loop_variables.J_nm1.zy(i, j, k) = loop_variables.J_s.zy(i, j, k);
+          loop_variables.J_s.zy(i, j, k) = Jnp1;
+        }
+        if (conductive && c.rho) {
+          loop_variables.J_c.zy(i, j, k) -=
+                  c.rho * (Enp1 + inputs.E_s.zy(i, j, k));
+        }
+
+        inputs.E_s.zy(i, j, k) =
+                c.Ca * inputs.E_s.zy(i, j, k) - c.Cb * derivative;
+      };
+      PSTD.d_ey.differentiate_lines(
+              I_tot + 1, K_tot, 1, J_tot, sample, update,
+              [&](int i, int k, int n, double *weight) {
+                return PSTD.spectral.y(i, k, n, weight);
+              });
+      // PSTD, E_s.zy
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+  }  //(params.dimension==THREE || params.dimension==TE)
+  else {
+#pragma omp for
+    for (i = 0; i < (I_tot + 1); i++)
+      for (j = 1; j < J_tot; j++)
+        for (k = 0; k <= K_tot; k++) {
+          const ECoefficients &c =
+                  loop_variables.coefficients.Ezy(i, j, k);
+          Enp1 = c.Ca * inputs.E_s.zy(i, j, k) +
+                 c.Cb * (inputs.H_s.xy(i, j - 1, k) +
+                         inputs.H_s.xz(i, j - 1, k) -
+                         inputs.H_s.xy(i, j, k) - inputs.H_s.xz(i, j, k));
+          if (dispersive && c.gamma)
+            Enp1 += c.Cc * loop_variables.E_nm1.zy(i, j, k) -
+                    1. / 2. * c.Cb * inputs.params.delta.dy *
+                            ((1 + c.alpha) * loop_variables.J_s.zy(i, j, k) +
+                             c.beta * loop_variables.J_nm1.zy(i, j, k));
+          if (conductive && c.rho)
+            Enp1 += c.Cb * inputs.params.delta.dy *
+                    loop_variables.J_c.zy(i, j, k);
+
+          if (dispersive && c.gamma) {
+            Jnp1 = c.alpha * loop_variables.J_s.zy(i, j, k) +
+                   c.beta * loop_variables.J_nm1.zy(i, j, k) +
+                   c.kappa * c.gamma / (2. * inputs.params.dt) *
+                           (Enp1 - loop_variables.E_nm1.zy(i, j, k));
+
+            Jnp1 += c.sigma / EPSILON0 * c.gamma * inputs.E_s.zy(i, j, k);
+            loop_variables.E_nm1.zy(i, j, k) = inputs.E_s.zy(i, j, k);
+            loop_variables.J_nm1.zy(i, j, k) = loop_variables.J_s.zy(i, j, k);
+            loop_variables.J_s.zy(i, j, k) = Jnp1;
+          }
+          if (conductive && c.rho) {
+            loop_variables.J_c.zy(i, j, k) -=
+                    c.rho * (Enp1 + inputs.E_s.zy(i, j, k));
+          }
+
+          inputs.E_s.zy(i, j, k) = Enp1;
+        }
+  }
+}
+
+void SimulationManager::update_E_split_vectorised(LoopVariables &loop_variables,
+                                                  const CellBox &cells) {
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  int J_upper = loop_variables.J_loop_upper_bound,
+      J_upper_plus_1 = loop_variables.J_loop_upper_bound_plus_1;
+  const UpdateCoefficientPlan &coefficients = loop_variables.coefficients;
+  ElectricSplitField &E_s = inputs.E_s;
+  MagneticSplitField &H_s = inputs.H_s;
+
+  // Ca and Cb of the cells in the row currently being updated
+  vector<double> a_row(K_tot + 1), b_row(K_tot + 1);
+  auto gather_row = [&](ECoefficientsAt component, int i, int j, int k_begin,
+                        int k_end) {
+    for (int k = k_begin; k < k_end; k++) {
+      const ECoefficients &c = (coefficients.*component)(i, j, k);
+      a_row[k] = c.Ca;
+      b_row[k] = c.Cb;
+    }
+  };
+  // Update the rows of the cells of a component that are also in cells, by
+  // update_row(i, j, k_begin, k_end)
+  auto update_rows = [&](const CellBox &component_cells, auto update_row) {
+    CellBox box = component_cells.intersection(cells);
+    if (box.empty()) { return; }
+#pragma omp for collapse(2) nowait
+    for (int i = box.lower.i; i < box.upper.i; i++) {
+      for (int j = box.lower.j; j < box.upper.j; j++) {
+        update_row(i, j, box.lower.k, box.upper.k);
+      }
+    }
+  };
+
+  // E_s.xy updates
+  update_rows({{0, 1, 0}, {I_tot, J_tot, K_tot + 1}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Exy, i, j, k, k_end);
+                curl_update_row(k_end - k, &E_s.xy(i, j, k), &a_row[k],
+                                &b_row[k], &H_s.zy(i, j, k), &H_s.zx(i, j, k),
+                                &H_s.zy(i, j - 1, k), &H_s.zx(i, j - 1, k));
+              });
+  // E_s.xz updates
+  update_rows({{0, 0, 1}, {I_tot, J_upper_plus_1, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Exz, i, j, k, k_end);
+                curl_update_row(k_end - k, &E_s.xz(i, j, k), &a_row[k],
+                                &b_row[k], &H_s.yx(i, j, k - 1),
+                                &H_s.yz(i, j, k - 1), &H_s.yx(i, j, k),
+                                &H_s.yz(i, j, k));
+              });
+  // E_s.yx updates
+  update_rows({{1, 0, 0}, {I_tot, J_upper, K_tot + 1}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Eyx, i, j, k, k_end);
+                curl_update_row(k_end - k, &E_s.yx(i, j, k), &a_row[k],
+                                &b_row[k], &H_s.zx(i - 1, j, k),
+                                &H_s.zy(i - 1, j, k), &H_s.zx(i, j, k),
+                                &H_s.zy(i, j, k));
+              });
+  // E_s.yz updates
+  update_rows({{0, 0, 1}, {I_tot + 1, J_upper, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Eyz, i, j, k, k_end);
+                curl_update_row(k_end - k, &E_s.yz(i, j, k), &a_row[k],
+                                &b_row[k], &H_s.xy(i, j, k), &H_s.xz(i, j, k),
+                                &H_s.xy(i, j, k - 1), &H_s.xz(i, j, k - 1));
+              });
+  // E_s.zx updates
+  update_rows({{1, 0, 0}, {I_tot, J_upper_plus_1, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Ezx, i, j, k, k_end);
+                curl_update_row(k_end - k, &E_s.zx(i, j, k), &a_row[k],
+                                &b_row[k], &H_s.yx(i, j, k), &H_s.yz(i, j, k),
+                                &H_s.yx(i - 1, j, k), &H_s.yz(i - 1, j, k));
+              });
+  // E_s.zy updates
+  update_rows({{0, 1, 0}, {I_tot + 1, J_tot, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Ezy, i, j, k, k_end);
+                curl_update_row(k_end - k, &E_s.zy(i, j, k), &a_row[k],
+                                &b_row[k], &H_s.xy(i, j - 1, k),
+                                &H_s.xz(i, j - 1, k), &H_s.xy(i, j, k),
+                                &H_s.xz(i, j, k));
+              });
+}
+
+void SimulationManager::update_E_split_distributed(LoopVariables &lv) {
+  // The E field reads the H field at i - 1 and j - 1, so only the rows on the
+  // low faces of the owned cells wait for the exchange
+  const CellBox &owned = partition->owned();
+#pragma omp master
+  partition->start_exchange(inputs.H_s, true);
+  CellBox interior = owned;
+  interior.lower.i++;
+  interior.lower.j++;
+  update_E_split_vectorised(lv, interior);
+
+#pragma omp master
+  partition->finish_exchange(inputs.H_s, true);
+#pragma omp barrier
+  CellBox low_i = owned, low_j = owned;
+  low_i.upper.i = owned.lower.i + 1;
+  low_j.lower.i = owned.lower.i + 1;
+  low_j.upper.j = owned.lower.j + 1;
+  update_E_split_vectorised(lv, low_i);
+  update_E_split_vectorised(lv, low_j);
+}
+
+template<SimulationManager::UpdateKernel base>
+void SimulationManager::update_E_sparse_currents(LoopVariables &lv) {
+  lv.currents.save_fields(inputs.E_s);
+  (this->*base)(lv);
+#pragma omp barrier
+  lv.currents.apply(inputs.E_s);
+}
+
+SimulationManager::UpdateKernel
+SimulationManager::select_E_update_kernel(const LoopVariables &lv) const {
+  bool dispersive = lv.is_dispersive || inputs.params.is_disp_ml;
+  bool conductive = lv.is_conductive;
+
+  // Indexed as [dispersive][conductive]
+  static const UpdateKernel fdtd_kernels[2][2] = {
+          {&SimulationManager::update_E_split<SolverMethod::FiniteDifference,
+                                              false, false>,
+           &SimulationManager::update_E_split<SolverMethod::FiniteDifference,
+                                              false, true>},
+          {&SimulationManager::update_E_split<SolverMethod::FiniteDifference,
+                                              true, false>,
+           &SimulationManager::update_E_split<SolverMethod::FiniteDifference,
+                                              true, true>}};
+  static const UpdateKernel fused_kernels[2][2] = {
+          {&SimulationManager::update_E_split_fused<false, false>,
+           &SimulationManager::update_E_split_fused<false, true>},
+          {&SimulationManager::update_E_split_fused<true, false>,
+           &SimulationManager::update_E_split_fused<true, true>}};
+  static const UpdateKernel unsplit_kernels[2][2] = {
+          {&SimulationManager::update_E_unsplit<false, false>,
+           &SimulationManager::update_E_unsplit<false, true>},
+          {&SimulationManager::update_E_unsplit<true, false>,
+           &SimulationManager::update_E_unsplit<true, true>}};
+  static const UpdateKernel pstd_kernels[2][2] = {
+          {&SimulationManager::update_E_split<SolverMethod::PseudoSpectral,
+                                              false, false>,
+           &SimulationManager::update_E_split<SolverMethod::PseudoSpectral,
+                                              false, true>},
+          {&SimulationManager::update_E_split<SolverMethod::PseudoSpectral,
+                                              true, false>,
+           &SimulationManager::update_E_split<SolverMethod::PseudoSpectral,
+                                              true, true>}};
+
+  // each process of a distributed grid updates the cells that it owns
+  bool distributed = partition->is_distributed() &&
+                     solver_method == SolverMethod::FiniteDifference;
+  if (lv.currents.is_active()) {
+    // the dispersive and conductive terms are applied by the wrapper
+    if (distributed) {
+      return &SimulationManager::update_E_sparse_currents<
+              &SimulationManager::update_E_split_distributed>;
+    }
+    if (inputs.E_s.has_unsplit_interior()) {
+      return &SimulationManager::update_E_sparse_currents<
+              &SimulationManager::update_E_unsplit<false, false>>;
+    }
+    if (options.fused_updates && supports_fused_updates()) {
+      return &SimulationManager::update_E_sparse_currents<
+              &SimulationManager::update_E_split_fused<false, false>>;
+    }
+    return &SimulationManager::update_E_sparse_currents<
+            &SimulationManager::update_E_split<SolverMethod::FiniteDifference,
+                                               false, false>>;
+  }
+  if (distributed) { return &SimulationManager::update_E_split_distributed; }
+  if (inputs.E_s.has_unsplit_interior()) {
+    return unsplit_kernels[dispersive][conductive];
+  }
+  if (options.fused_updates && supports_fused_updates()) {
+    return fused_kernels[dispersive][conductive];
+  }
+  if (solver_method == SolverMethod::FiniteDifference) {
+    return fdtd_kernels[dispersive][conductive];
+  }
+  return pstd_kernels[dispersive][conductive];
+}
@@ -0,0 +1,424 @@
+/**
+ * @file execute_update_H_split.cpp
+ * @brief Update equations of the magnetic split-field components.
+ */
+#include "simulation_manager/simulation_manager.h"
+
+#include <omp.h>
+
+#include "numerical_derivative.h"
+#include "stencil_kernels.h"
+
+using namespace tdms_flags;
+using namespace std;
+
+template<SolverMethod method>
+void SimulationManager::update_H_split(LoopVariables &loop_variables) {
+  // Fetch simulation dimensions for easy access
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  int i, j, k;//< Loop variables
+
+  if constexpr (method == SolverMethod::FiniteDifference) {
+    if (inputs.params.dimension == THREE ||
+        inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
+      update_H_split_vectorised(loop_variables,
+                                loop_variables.active_region.box());
+      return;
+    }
+  }
+
+  if (inputs.params.dimension == THREE ||
+      inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
+    if constexpr (method == SolverMethod::FiniteDifference) {
+// FDTD, H_s.xz
+#pragma omp for
+      // H_s.xz updates
+      for (i = 0; i < (I_tot + 1); i++)
+        for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
+          for (k = 0; k < K_tot; k++) {
+            const HCoefficients &d =
+                    loop_variables.coefficients.Hxz(i, j, k);
+            inputs.H_s.xz(i, j, k) =
+                    d.Da * inputs.H_s.xz(i, j, k) +
+                    d.Db * (inputs.E_s.yx(i, j, k + 1) +
+                            inputs.E_s.yz(i, j, k + 1) -
+                            inputs.E_s.yx(i, j, k) -
+                            inputs.E_s.yz(i, j, k));
+          }
+      // FDTD, H_s.xz
+    } else {
+      auto sample = [&](int j, int i, int k) {
+        return inputs.E_s.yx(i, j, k) + inputs.E_s.yz(i, j, k);
+      };
+      auto update = [&](int j, int i, int k, double derivative) {
+        const HCoefficients &d = loop_variables.coefficients.Hxz(i, j, k);
+        inputs.H_s.xz(i, j, k) =
+                d.Da * inputs.H_s.xz(i, j, k) + d.Db * derivative;
+      };
+      PSTD.d_hz.differentiate_lines(
+              loop_variables.J_loop_upper_bound, I_tot + 1, 0, K_tot,
+              sample, update,
+              [&](int j, int i, int n, double *weight) {
+                return PSTD.spectral.z(i, j, n, weight);
+              });
+      // PSTD, H_s.xz
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+
+    if constexpr (method == SolverMethod::FiniteDifference) {
+// FDTD, H_s.xy
+#pragma omp for
+      // H_s.xy updates
+      for (i = 0; i < (I_tot + 1); i++)
+        for (j = 0; j < J_tot; j++)
+          for (k = 0; k < K_tot; k++) {
+            const HCoefficients &d =
+                    loop_variables.coefficients.Hxy(i, j, k);
+            inputs.H_s.xy(i, j, k) =
+                    d.Da * inputs.H_s.xy(i, j, k) +
+                    d.Db *
+                            (inputs.E_s.zy(i, j, k) +
+                             inputs.E_s.zx(i, j, k) -
+                             inputs.E_s.zy(i, j + 1, k) -
+                             inputs.E_s.zx(i, j + 1, k));
+          }
+      // FDTD, H_s.xy
+    } else {
+      auto sample = [&](int i, int k, int j) {
+        return inputs.E_s.zy(i, j, k) + inputs.E_s.zx(i, j, k);
+      };
+      auto update = [&](int i, int k, int j, double derivative) {
+        const HCoefficients &d = loop_variables.coefficients.Hxy(i, j, k);
+        inputs.H_s.xy(i, j, k) =
+                d.Da * inputs.H_s.xy(i, j, k) - d.Db * derivative;
+      };
+      PSTD.d_hy.differentiate_lines(
+              I_tot + 1, K_tot, 0, J_tot, sample, update,
+              [&](int i, int k, int n, double *weight) {
+                return PSTD.spectral.y(i, k, n, weight);
+              });
+      // PSTD, H_s.xy
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+
+    if constexpr (method == SolverMethod::FiniteDifference) {
+// FDTD, H_s.yx
+#pragma omp for
+      // H_s.yx updates
+      for (i = 0; i < I_tot; i++)
+        for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++)
+          for (k = 0; k < K_tot; k++) {
+            const HCoefficients &d =
+                    loop_variables.coefficients.Hyx(i, j, k);
+            inputs.H_s.yx(i, j, k) =
+                    d.Da * inputs.H_s.yx(i, j, k) +
+                    d.Db *
+                            (inputs.E_s.zx(i + 1, j, k) +
+                             inputs.E_s.zy(i + 1, j, k) -
+                             inputs.E_s.zx(i, j, k) -
+                             inputs.E_s.zy(i, j, k));
+          }
+      // FDTD, H_s.yx
+    } else {
+      auto sample = [&](int j, int k, int i) {
+        return inputs.E_s.zx(i, j, k) + inputs.E_s.zy(i, j, k);
+      };
+      auto update = [&](int j, int k, int i, double derivative) {
+        const HCoefficients &d = loop_variables.coefficients.Hyx(i, j, k);
+        inputs.H_s.yx(i, j, k) =
+                d.Da * inputs.H_s.yx(i, j, k) + d.Db * derivative;
+      };
+      PSTD.d_hx.differentiate_lines(
+              loop_variables.J_loop_upper_bound_plus_1, K_tot, 0, I_tot,
+              sample, update,
+              [&](int j, int k, int n, double *weight) {
+                return PSTD.spectral.x(j, k, n, weight);
+              });
+      // PSTD, H_s.yx
+    }
+
+    if constexpr (method == SolverMethod::FiniteDifference) {
+// FDTD, H_s.yz
+#pragma omp for
+      // H_s.yz updates
+      for (i = 0; i < I_tot; i++) {
+        for (j = 0; j < loop_variables.J_loop_upper_bound_plus_1; j++)
+          for (k = 0; k < K_tot; k++) {
+            const HCoefficients &d =
+                    loop_variables.coefficients.Hyz(i, j, k);
+            inputs.H_s.yz(i, j, k) =
+                    d.Da * inputs.H_s.yz(i, j, k) +
+                    d.Db * (inputs.E_s.xy(i, j, k) +
+                            inputs.E_s.xz(i, j, k) -
+                            inputs.E_s.xy(i, j, k + 1) -
+                            inputs.E_s.xz(i, j, k + 1));
+          }
+      }
+      // FDTD, H_s.yz
+    } else {
+      auto sample = [&](int j, int i, int k) {
+        return inputs.E_s.xy(i, j, k) + inputs.E_s.xz(i, j, k);
+      };
+      auto update = [&](int j, int i, int k, double derivative) {
+        const HCoefficients &d = loop_variables.coefficients.Hyz(i, j, k);
+        inputs.H_s.yz(i, j, k) =
+                d.Da * inputs.H_s.yz(i, j, k) - d.Db * derivative;
+      };
+      PSTD.d_hz.differentiate_lines(
+              loop_variables.J_loop_upper_bound_plus_1, I_tot, 0, K_tot,
+              sample, update,
+              [&](int j, int i, int n, double *weight) {
+                return PSTD.spectral.z(i, j, n, weight);
+              });
+      // PSTD, H_s.yz
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+  }  //(params.dimension==THREE || params.dimension==TE)
+  else {
+
+#pragma omp for
+    for (i = 0; i < (I_tot + 1); i++)
+      for (j = 0; j < J_tot; j++)
+        for (k = 0; k <= K_tot; k++)
+          inputs.H_s.xz(i, j, k) = 0.;
+
+#pragma omp for
+    // H_s.xy update
+    for (i = 0; i < (I_tot + 1); i++)
+      for (j = 0; j < J_tot; j++)
+        for (k = 0; k <= K_tot; k++) {
+          const HCoefficients &d =
+                  loop_variables.coefficients.Hxy(i, j, k);
+          inputs.H_s.xy(i, j, k) =
+                  d.Da * inputs.H_s.xy(i, j, k) +
+                  d.Db * (inputs.E_s.zy(i, j, k) +
+                          inputs.E_s.zx(i, j, k) -
+                          inputs.E_s.zy(i, j + 1, k) -
+                          inputs.E_s.zx(i, j + 1, k));
+        }
+
+#pragma omp for
+    // H_s.yx update
+    for (i = 0; i < I_tot; i++)
+      for (j = 0; j < (J_tot + 1); j++)
+        for (k = 0; k <= K_tot; k++) {
+          const HCoefficients &d =
+                  loop_variables.coefficients.Hyx(i, j, k);
+          inputs.H_s.yx(i, j, k) =
+                  d.Da * inputs.H_s.yx(i, j, k) +
+                  d.Db * (inputs.E_s.zx(i + 1, j, k) +
+                          inputs.E_s.zy(i + 1, j, k) -
+                          inputs.E_s.zx(i, j, k) -
+                          inputs.E_s.zy(i, j, k));
+        }
+
+#pragma omp for
+    for (i = 0; i < I_tot; i++) {
+      for (j = 0; j < (J_tot + 1); j++)
+        for (k = 0; k <= K_tot; k++)
+          inputs.H_s.yz(i, j, k) = 0.;
+    }
+  }
+
+  if (inputs.params.dimension == THREE ||
+      inputs.params.dimension == Dimension::TRANSVERSE_ELECTRIC) {
+    if constexpr (method == SolverMethod::FiniteDifference) {
+// FDTD, H_s.zy
+#pragma omp for
+      // H_s.zy update
+      for (i = 0; i < I_tot; i++)
+        for (j = 0; j < J_tot; j++)
+          for (k = 0; k < (K_tot + 1); k++) {
+            const HCoefficients &d =
+                    loop_variables.coefficients.Hzy(i, j, k);
+            inputs.H_s.zy(i, j, k) =
+                    d.Da * inputs.H_s.zy(i, j, k) +
+                    d.Db *
+                            (inputs.E_s.xy(i, j + 1, k) +
+                             inputs.E_s.xz(i, j + 1, k) -
+                             inputs.E_s.xy(i, j, k) -
+                             inputs.E_s.xz(i, j, k));
+          }
+      // FDTD, H_s.zy
+    } else {
+      auto sample = [&](int i, int k, int j) {
+        return inputs.E_s.xy(i, j, k) + inputs.E_s.xz(i, j, k);
+      };
+      auto update = [&](int i, int k, int j, double derivative) {
+        const HCoefficients &d = loop_variables.coefficients.Hzy(i, j, k);
+        inputs.H_s.zy(i, j, k) =
+                d.Da * inputs.H_s.zy(i, j, k) + d.Db * derivative;
+      };
+      PSTD.d_hy.differentiate_lines(
+              I_tot, K_tot + 1, 0, J_tot, sample, update,
+              [&](int i, int k, int n, double *weight) {
+                return PSTD.spectral.y(i, k, n, weight);
+              });
+      // PSTD, H_s.zy
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+
+
+    if constexpr (method == SolverMethod::FiniteDifference) {
+// FDTD, H_s.zx
+#pragma omp for
+      // H_s.zx update
+      for (i = 0; i < I_tot; i++)
+        for (j = 0; j < loop_variables.J_loop_upper_bound; j++)
+          for (k = 0; k < (K_tot + 1); k++) {
+            const HCoefficients &d =
+                    loop_variables.coefficients.Hzx(i, j, k);
+            inputs.H_s.zx(i, j, k) =
+                    d.Da * inputs.H_s.zx(i, j, k) +
+                    d.Db *
+                            (inputs.E_s.yx(i, j, k) +
+                             inputs.E_s.yz(i, j, k) -
+                             inputs.E_s.yx(i + 1, j, k) -
+                             inputs.E_s.yz(i + 1, j, k));
+          }
+      // FDTD, H_s.zx
+    } else {
+      auto sample = [&](int j, int k, int i) {
+        return inputs.E_s.yx(i, j, k) + inputs.E_s.yz(i, j, k);
+      };
+      auto update = [&](int j, int k, int i, double derivative) {
+        const HCoefficients &d = loop_variables.coefficients.Hzx(i, j, k);
+        inputs.H_s.zx(i, j, k) =
+                d.Da * inputs.H_s.zx(i, j, k) - d.Db * derivative;
+      };
+      PSTD.d_hx.differentiate_lines(
+              loop_variables.J_loop_upper_bound, K_tot + 1, 0, I_tot,
+              sample, update,
+              [&](int j, int k, int n, double *weight) {
+                return PSTD.spectral.x(j, k, n, weight);
+              });
+      // PSTD, H_s.zx
+    }// if (solver_method == DerivativeMethod::FiniteDifference) (else
+     // PseudoSpectral)
+  }  //(params.dimension==THREE || params.dimension==TE)
+}
+
+void SimulationManager::update_H_split_vectorised(LoopVariables &loop_variables,
+                                                  const CellBox &cells) {
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  int J_upper = loop_variables.J_loop_upper_bound,
+      J_upper_plus_1 = loop_variables.J_loop_upper_bound_plus_1;
+  const UpdateCoefficientPlan &coefficients = loop_variables.coefficients;
+  ElectricSplitField &E_s = inputs.E_s;
+  MagneticSplitField &H_s = inputs.H_s;
+
+  // Da and Db of the cells in the row currently being updated
+  vector<double> a_row(K_tot + 1), b_row(K_tot + 1);
+  auto gather_row = [&](HCoefficientsAt component, int i, int j, int k_begin,
+                        int k_end) {
+    for (int k = k_begin; k < k_end; k++) {
+      const HCoefficients &d = (coefficients.*component)(i, j, k);
+      a_row[k] = d.Da;
+      b_row[k] = d.Db;
+    }
+  };
+  // Update the rows of the cells of a component that are also in cells, by
+  // update_row(i, j, k_begin, k_end)
+  auto update_rows = [&](const CellBox &component_cells, auto update_row) {
+    CellBox box = component_cells.intersection(cells);
+    if (box.empty()) { return; }
+#pragma omp for collapse(2) nowait
+    for (int i = box.lower.i; i < box.upper.i; i++) {
+      for (int j = box.lower.j; j < box.upper.j; j++) {
+        update_row(i, j, box.lower.k, box.upper.k);
+      }
+    }
+  };
+
+  // H_s.xz updates
+  update_rows({{0, 0, 0}, {I_tot + 1, J_upper, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Hxz, i, j, k, k_end);
+                curl_update_row(k_end - k, &H_s.xz(i, j, k), &a_row[k],
+                                &b_row[k], &E_s.yx(i, j, k + 1),
+                                &E_s.yz(i, j, k + 1), &E_s.yx(i, j, k),
+                                &E_s.yz(i, j, k));
+              });
+  // H_s.xy updates
+  update_rows({{0, 0, 0}, {I_tot + 1, J_tot, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Hxy, i, j, k, k_end);
+                curl_update_row(k_end - k, &H_s.xy(i, j, k), &a_row[k],
+                                &b_row[k], &E_s.zy(i, j, k), &E_s.zx(i, j, k),
+                                &E_s.zy(i, j + 1, k), &E_s.zx(i, j + 1, k));
+              });
+  // H_s.yx updates
+  update_rows({{0, 0, 0}, {I_tot, J_upper_plus_1, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Hyx, i, j, k, k_end);
+                curl_update_row(k_end - k, &H_s.yx(i, j, k), &a_row[k],
+                                &b_row[k], &E_s.zx(i + 1, j, k),
+                                &E_s.zy(i + 1, j, k), &E_s.zx(i, j, k),
+                                &E_s.zy(i, j, k));
+              });
+  // H_s.yz updates
+  update_rows({{0, 0, 0}, {I_tot, J_upper_plus_1, K_tot}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Hyz, i, j, k, k_end);
+                curl_update_row(k_end - k, &H_s.yz(i, j, k), &a_row[k],
+                                &b_row[k], &E_s.xy(i, j, k), &E_s.xz(i, j, k),
+                                &E_s.xy(i, j, k + 1), &E_s.xz(i, j, k + 1));
+              });
+  // H_s.zy updates
+  update_rows({{0, 0, 0}, {I_tot, J_tot, K_tot + 1}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Hzy, i, j, k, k_end);
+                curl_update_row(k_end - k, &H_s.zy(i, j, k), &a_row[k],
+                                &b_row[k], &E_s.xy(i, j + 1, k),
+                                &E_s.xz(i, j + 1, k), &E_s.xy(i, j, k),
+                                &E_s.xz(i, j, k));
+              });
+  // H_s.zx updates
+  update_rows({{0, 0, 0}, {I_tot, J_upper, K_tot + 1}},
+              [&](int i, int j, int k, int k_end) {
+                gather_row(&UpdateCoefficientPlan::Hzx, i, j, k, k_end);
+                curl_update_row(k_end - k, &H_s.zx(i, j, k), &a_row[k],
+                                &b_row[k], &E_s.yx(i, j, k), &E_s.yz(i, j, k),
+                                &E_s.yx(i + 1, j, k), &E_s.yz(i + 1, j, k));
+              });
+}
+
+void SimulationManager::update_H_split_distributed(LoopVariables &lv) {
+  // The H field reads the E field at i + 1 and j + 1, so only the rows on the
+  // high faces of the owned cells wait for the exchange
+  const CellBox &owned = partition->owned();
+#pragma omp master
+  partition->start_exchange(inputs.E_s, false);
+  CellBox interior = owned;
+  interior.upper.i--;
+  interior.upper.j--;
+  update_H_split_vectorised(lv, interior);
+
+#pragma omp master
+  partition->finish_exchange(inputs.E_s, false);
+#pragma omp barrier
+  CellBox high_i = owned, high_j = owned;
+  high_i.lower.i = owned.upper.i - 1;
+  high_j.upper.i = owned.upper.i - 1;
+  high_j.lower.j = owned.upper.j - 1;
+  update_H_split_vectorised(lv, high_i);
+  update_H_split_vectorised(lv, high_j);
+}
+
+SimulationManager::UpdateKernel
+SimulationManager::select_H_update_kernel() const {
+  if (partition->is_distributed() &&
+      solver_method == SolverMethod::FiniteDifference) {
+    return &SimulationManager::update_H_split_distributed;
+  }
+  if (inputs.H_s.has_unsplit_interior()) {
+    return &SimulationManager::update_H_unsplit;
+  }
+  if (options.fused_updates && supports_fused_updates()) {
+    return &SimulationManager::update_H_split_fused;
+  }
+  if (solver_method == SolverMethod::FiniteDifference) {
+    return &SimulationManager::update_H_split<SolverMethod::FiniteDifference>;
+  }
+  return &SimulationManager::update_H_split<SolverMethod::PseudoSpectral>;
+}
@@ -0,0 +1,512 @@
+/**
+ * @file execute_update_fused.cpp
+ * @brief Single-pass FDTD updates of all the split-field components, see
+ * SimulationManager::update_E_split_fused, and of fields that are stored
+ * unsplit in the interior, see SimulationManager::update_E_unsplit.
+ */
+#include "simulation_manager/simulation_manager.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+using namespace tdms_flags;
+using namespace tdms_phys_constants;
+using namespace std;
+
+namespace {
+
+/**
+ * @brief An element of a split component, which is PML-only or stored over the
+ * whole grid.
+ */
+template<bool pml_only>
+inline field_t &element_of(SplitFieldComponent &component, int i, int j,
+                           int k) {
+  if constexpr (pml_only) {
+    return component.at(i, j, k);
+  } else {
+    return component(i, j, k);
+  }
+}
+
+/**
+ * @brief The FDTD update of one split E-field component at one Yee cell,
+ * including its dispersive and conductive terms.
+ *
+ * The arithmetic is that of the component-by-component loops in
+ * update_E_split, so that both engines produce identical fields.
+ *
+ * @tparam pml_only Whether the component (and its auxiliary fields) is stored
+ * PML-only
+ * @param component The split component being updated
+ * @param c The coefficients of the component at this cell
+ * @param drive The product of Cb and the finite difference of the H field
+ * driving the component
+ * @param delta The grid spacing in the direction of the difference
+ */
+template<bool dispersive, bool conductive, bool pml_only = false>
+inline void update_E_cell(SplitComponent component, const ECoefficients &c,
+                          double drive, double delta, double dt,
+                          ElectricSplitField &E_s, LoopVariables &lv, int i,
+                          int j, int k) {
+  auto at = [&](SplitField &F) -> field_t & {
+    return element_of<pml_only>(F.*component, i, j, k);
+  };
+  field_t &E = at(E_s);
+
+  double Enp1 = c.Ca * E + drive;
+  if (dispersive && c.gamma)
+    Enp1 += c.Cc * at(lv.E_nm1) -
+            1. / 2. * c.Cb * delta *
+                    ((1 + c.alpha) * at(lv.J_s) + c.beta * at(lv.J_nm1));
+  if (conductive && c.rho) Enp1 += c.Cb * delta * at(lv.J_c);
+  if (dispersive && c.gamma) {
+    double Jnp1 = c.alpha * at(lv.J_s) + c.beta * at(lv.J_nm1) +
+                  c.kappa * c.gamma / (2. * dt) * (Enp1 - at(lv.E_nm1));
+    Jnp1 += c.sigma / EPSILON0 * c.gamma * E;
+
+    at(lv.E_nm1) = E;
+    at(lv.J_nm1) = at(lv.J_s);
+    at(lv.J_s) = Jnp1;
+  }
+  if (conductive && c.rho) { at(lv.J_c) -= c.rho * (Enp1 + E); }
+
+  E = Enp1;
+}
+
+}// namespace
+
+bool SimulationManager::supports_fused_updates() const {
+  return solver_method == SolverMethod::FiniteDifference &&
+         inputs.params.dimension != Dimension::TRANSVERSE_MAGNETIC;
+}
+
+bool SimulationManager::supports_fused_phasors() const {
+  return supports_fused_updates() &&
+         inputs.params.run_mode == RunMode::complete &&
+         inputs.params.source_mode == SourceMode::steadystate &&
+         inputs.params.exphasorsvolume;
+}
+
+template<bool dispersive, bool conductive>
+void SimulationManager::update_E_split_fused(LoopVariables &lv) {
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  const UpdateCoefficientPlan &coefficients = lv.coefficients;
+  ElectricSplitField &E_s = inputs.E_s;
+  MagneticSplitField &H_s = inputs.H_s;
+  double dt = inputs.params.dt;
+  double dx = inputs.params.delta.dx, dy = inputs.params.delta.dy,
+         dz = inputs.params.delta.dz;
+
+#pragma omp for collapse(2)
+  for (int i = 0; i < (I_tot + 1); i++) {
+    for (int j = 0; j < (J_tot + 1); j++) {
+      // The cells of this row that each component is updated over
+      bool xy = i < I_tot && j >= 1 && j < J_tot;
+      bool xz = i < I_tot && j < lv.J_loop_upper_bound_plus_1;
+      bool yx = i >= 1 && i < I_tot && j < lv.J_loop_upper_bound;
+      bool yz = j < lv.J_loop_upper_bound;
+      bool zx = i >= 1 && i < I_tot && j < lv.J_loop_upper_bound_plus_1;
+      bool zy = j >= 1 && j < J_tot;
+      bool phasors = lv.E_phasors.accumulates(i, j);
+
+      for (int k = 0; k < (K_tot + 1); k++) {
+        bool k_interior = k >= 1 && k < K_tot;
+
+        // The phasors of this timestep are of the field before the update
+        if (phasors) {
+          lv.E_phasors.add(i, j, k, E_s.x(i, j, k), E_s.y(i, j, k),
+                           E_s.z(i, j, k));
+        }
+
+        if (xy || (xz && k_interior)) {
+          const CellCoefficients &c = coefficients.x(i, j, k);
+          if (xy) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::xy, c.E[0],
+                    c.E[0].Cb * (H_s.zy(i, j, k) + H_s.zx(i, j, k) -
+                                 H_s.zy(i, j - 1, k) - H_s.zx(i, j - 1, k)),
+                    dy, dt, E_s, lv, i, j, k);
+          }
+          if (xz && k_interior) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::xz, c.E[1],
+                    c.E[1].Cb * (H_s.yx(i, j, k - 1) + H_s.yz(i, j, k - 1) -
+                                 H_s.yx(i, j, k) - H_s.yz(i, j, k)),
+                    dz, dt, E_s, lv, i, j, k);
+          }
+        }
+
+        if (yx || (yz && k_interior)) {
+          const CellCoefficients &c = coefficients.y(i, j, k);
+          if (yx) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::yx, c.E[0],
+                    c.E[0].Cb * (H_s.zx(i - 1, j, k) + H_s.zy(i - 1, j, k) -
+                                 H_s.zx(i, j, k) - H_s.zy(i, j, k)),
+                    dx, dt, E_s, lv, i, j, k);
+          }
+          if (yz && k_interior) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::yz, c.E[1],
+                    c.E[1].Cb * (H_s.xy(i, j, k) + H_s.xz(i, j, k) -
+                                 H_s.xy(i, j, k - 1) - H_s.xz(i, j, k - 1)),
+                    dz, dt, E_s, lv, i, j, k);
+          }
+        }
+
+        if ((zx || zy) && k < K_tot) {
+          const CellCoefficients &c = coefficients.z(i, j, k);
+          if (zx) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::zx, c.E[0],
+                    c.E[0].Cb * (H_s.yx(i, j, k) + H_s.yz(i, j, k) -
+                                 H_s.yx(i - 1, j, k) - H_s.yz(i - 1, j, k)),
+                    dx, dt, E_s, lv, i, j, k);
+          }
+          if (zy) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::zy, c.E[1],
+                    c.E[1].Cb * (H_s.xy(i, j - 1, k) + H_s.xz(i, j - 1, k) -
+                                 H_s.xy(i, j, k) - H_s.xz(i, j, k)),
+                    dy, dt, E_s, lv, i, j, k);
+          }
+        }
+      }
+    }
+  }
+}
+
+void SimulationManager::update_H_split_fused(LoopVariables &lv) {
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  const UpdateCoefficientPlan &coefficients = lv.coefficients;
+  ElectricSplitField &E_s = inputs.E_s;
+  MagneticSplitField &H_s = inputs.H_s;
+
+#pragma omp for collapse(2)
+  for (int i = 0; i < (I_tot + 1); i++) {
+    for (int j = 0; j < (J_tot + 1); j++) {
+      // The cells of this row that each component is updated over
+      bool xz = j < lv.J_loop_upper_bound;
+      bool xy = j < J_tot;
+      bool yx = i < I_tot && j < lv.J_loop_upper_bound_plus_1;
+      bool yz = yx;
+      bool zy = i < I_tot && j < J_tot;
+      bool zx = i < I_tot && j < lv.J_loop_upper_bound;
+      bool phasors = lv.H_phasors.accumulates(i, j);
+
+      for (int k = 0; k < (K_tot + 1); k++) {
+        if (phasors) {
+          lv.H_phasors.add(i, j, k, H_s.x(i, j, k), H_s.y(i, j, k),
+                           H_s.z(i, j, k));
+        }
+
+        if ((xz || xy) && k < K_tot) {
+          const CellCoefficients &c = coefficients.x(i, j, k);
+          if (xz) {
+            H_s.xz(i, j, k) = c.H[1].Da * H_s.xz(i, j, k) +
+                              c.H[1].Db * (E_s.yx(i, j, k + 1) +
+                                           E_s.yz(i, j, k + 1) -
+                                           E_s.yx(i, j, k) - E_s.yz(i, j, k));
+          }
+          if (xy) {
+            H_s.xy(i, j, k) = c.H[0].Da * H_s.xy(i, j, k) +
+                              c.H[0].Db * (E_s.zy(i, j, k) + E_s.zx(i, j, k) -
+                                           E_s.zy(i, j + 1, k) -
+                                           E_s.zx(i, j + 1, k));
+          }
+        }
+
+        if ((yx || yz) && k < K_tot) {
+          const CellCoefficients &c = coefficients.y(i, j, k);
+          if (yx) {
+            H_s.yx(i, j, k) = c.H[0].Da * H_s.yx(i, j, k) +
+                              c.H[0].Db * (E_s.zx(i + 1, j, k) +
+                                           E_s.zy(i + 1, j, k) -
+                                           E_s.zx(i, j, k) - E_s.zy(i, j, k));
+          }
+          if (yz) {
+            H_s.yz(i, j, k) = c.H[1].Da * H_s.yz(i, j, k) +
+                              c.H[1].Db * (E_s.xy(i, j, k) + E_s.xz(i, j, k) -
+                                           E_s.xy(i, j, k + 1) -
+                                           E_s.xz(i, j, k + 1));
+          }
+        }
+
+        if (zy || zx) {
+          const CellCoefficients &c = coefficients.z(i, j, k);
+          if (zy) {
+            H_s.zy(i, j, k) = c.H[1].Da * H_s.zy(i, j, k) +
+                              c.H[1].Db * (E_s.xy(i, j + 1, k) +
+                                           E_s.xz(i, j + 1, k) -
+                                           E_s.xy(i, j, k) - E_s.xz(i, j, k));
+          }
+          if (zx) {
+            H_s.zx(i, j, k) = c.H[0].Da * H_s.zx(i, j, k) +
+                              c.H[0].Db * (E_s.yx(i, j, k) + E_s.yz(i, j, k) -
+                                           E_s.yx(i + 1, j, k) -
+                                           E_s.yz(i + 1, j, k));
+          }
+        }
+      }
+    }
+  }
+}
+
+bool SimulationManager::supports_unsplit_interior() const {
+  return solver_method == SolverMethod::FiniteDifference &&
+         inputs.params.dimension == Dimension::THREE;
+}
+
+bool SimulationManager::unsplit_interior(LoopVariables &lv) {
+  IJKDimensions IJK_tot = n_Yee_cells();
+  const auto &pml = inputs.params.pml;
+
+  // The cells outside the PML, excluding the boundary of the grid
+  CellBox interior;
+  interior.lower = {max(1, pml.Dxl + 1), max(1, pml.Dyl + 1),
+                    max(1, pml.Dzl + 1)};
+  interior.upper = {IJK_tot.i - max(1, pml.Dxu), IJK_tot.j - max(1, pml.Dyu),
+                    IJK_tot.k - max(1, pml.Dzu)};
+  bool with_currents =
+          lv.is_dispersive || inputs.params.is_disp_ml || lv.is_conductive;
+  if (interior.empty()) {
+    spdlog::warn("There are no cells outside the PML; keeping the fields "
+                 "split throughout the grid");
+  } else if (!lv.coefficients.is_isotropic_in(interior, inputs.params.delta,
+                                              with_currents)) {
+    spdlog::warn("The split components have different update coefficients "
+                 "outside the PML; keeping the fields split throughout the "
+                 "grid");
+    interior = CellBox();
+  }
+  if (interior.empty()) {
+    inputs.E_s.allocate();
+    inputs.H_s.allocate();
+    return false;
+  }
+
+  inputs.E_s.allocate_unsplit(interior);
+  inputs.H_s.allocate_unsplit(interior);
+  spdlog::info("Storing the fields unsplit in {} of {} cells",
+               interior.n_cells(),
+               (long long) (IJK_tot.i + 1) * (IJK_tot.j + 1) * (IJK_tot.k + 1));
+  return true;
+}
+
+template<bool dispersive, bool conductive>
+void SimulationManager::update_E_unsplit(LoopVariables &lv) {
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  const UpdateCoefficientPlan &coefficients = lv.coefficients;
+  ElectricSplitField &E_s = inputs.E_s;
+  MagneticSplitField &H_s = inputs.H_s;
+  const CellBox &box = E_s.unsplit_cells();
+  double dt = inputs.params.dt;
+  double dx = inputs.params.delta.dx, dy = inputs.params.delta.dy,
+         dz = inputs.params.delta.dz;
+
+#pragma omp for collapse(2)
+  for (int i = 0; i < (I_tot + 1); i++) {
+    for (int j = 0; j < (J_tot + 1); j++) {
+      // The cells of this row that each component is updated over
+      bool xy = i < I_tot && j >= 1 && j < J_tot;
+      bool xz = i < I_tot && j < lv.J_loop_upper_bound_plus_1;
+      bool yx = i >= 1 && i < I_tot && j < lv.J_loop_upper_bound;
+      bool yz = j < lv.J_loop_upper_bound;
+      bool zx = i >= 1 && i < I_tot && j < lv.J_loop_upper_bound_plus_1;
+      bool zy = j >= 1 && j < J_tot;
+      bool row_unsplit = box.contains(i, j);
+
+      for (int k = 0; k < (K_tot + 1); k++) {
+        bool k_interior = k >= 1 && k < K_tot;
+        // Every component is updated in the unsplit cells, and the xy, yx, and
+        // zx components hold the whole field
+        bool unsplit = row_unsplit && k >= box.lower.k && k < box.upper.k;
+
+        if (xy || (xz && k_interior)) {
+          const CellCoefficients &c = coefficients.x(i, j, k);
+          double curl_y = 0., curl_z = 0.;
+          if (xy) { curl_y = H_s.z(i, j, k) - H_s.z(i, j - 1, k); }
+          if (xz && k_interior) {
+            curl_z = H_s.y(i, j, k - 1) - H_s.y(i, j, k);
+          }
+          if (unsplit) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::xy, c.E[0],
+                    c.E[0].Cb * curl_y + c.E[1].Cb * curl_z, dy, dt, E_s, lv,
+                    i, j, k);
+          } else {
+            if (xy) {
+              update_E_cell<dispersive, conductive>(
+                      &SplitField::xy, c.E[0], c.E[0].Cb * curl_y, dy, dt, E_s,
+                      lv, i, j, k);
+            }
+            if (xz && k_interior) {
+              update_E_cell<dispersive, conductive, true>(
+                      &SplitField::xz, c.E[1], c.E[1].Cb * curl_z, dz, dt, E_s,
+                      lv, i, j, k);
+            }
+          }
+        }
+
+        if (yx || (yz && k_interior)) {
+          const CellCoefficients &c = coefficients.y(i, j, k);
+          double curl_x = 0., curl_z = 0.;
+          if (yx) { curl_x = H_s.z(i - 1, j, k) - H_s.z(i, j, k); }
+          if (yz && k_interior) {
+            curl_z = H_s.x(i, j, k) - H_s.x(i, j, k - 1);
+          }
+          if (unsplit) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::yx, c.E[0],
+                    c.E[0].Cb * curl_x + c.E[1].Cb * curl_z, dx, dt, E_s, lv,
+                    i, j, k);
+          } else {
+            if (yx) {
+              update_E_cell<dispersive, conductive>(
+                      &SplitField::yx, c.E[0], c.E[0].Cb * curl_x, dx, dt, E_s,
+                      lv, i, j, k);
+            }
+            if (yz && k_interior) {
+              update_E_cell<dispersive, conductive, true>(
+                      &SplitField::yz, c.E[1], c.E[1].Cb * curl_z, dz, dt, E_s,
+                      lv, i, j, k);
+            }
+          }
+        }
+
+        if ((zx || zy) && k < K_tot) {
+          const CellCoefficients &c = coefficients.z(i, j, k);
+          double curl_x = 0., curl_y = 0.;
+          if (zx) { curl_x = H_s.y(i, j, k) - H_s.y(i - 1, j, k); }
+          if (zy) { curl_y = H_s.x(i, j - 1, k) - H_s.x(i, j, k); }
+          if (unsplit) {
+            update_E_cell<dispersive, conductive>(
+                    &SplitField::zx, c.E[0],
+                    c.E[0].Cb * curl_x + c.E[1].Cb * curl_y, dx, dt, E_s, lv,
+                    i, j, k);
+          } else {
+            if (zx) {
+              update_E_cell<dispersive, conductive>(
+                      &SplitField::zx, c.E[0], c.E[0].Cb * curl_x, dx, dt, E_s,
+                      lv, i, j, k);
+            }
+            if (zy) {
+              update_E_cell<dispersive, conductive, true>(
+                      &SplitField::zy, c.E[1], c.E[1].Cb * curl_y, dy, dt, E_s,
+                      lv, i, j, k);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+void SimulationManager::update_H_unsplit(LoopVariables &lv) {
+  int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j, K_tot = n_Yee_cells().k;
+  const UpdateCoefficientPlan &coefficients = lv.coefficients;
+  ElectricSplitField &E_s = inputs.E_s;
+  MagneticSplitField &H_s = inputs.H_s;
+  const CellBox &box = H_s.unsplit_cells();
+
+#pragma omp for collapse(2)
+  for (int i = 0; i < (I_tot + 1); i++) {
+    for (int j = 0; j < (J_tot + 1); j++) {
+      // The cells of this row that each component is updated over
+      bool xz = j < lv.J_loop_upper_bound;
+      bool xy = j < J_tot;
+      bool yx = i < I_tot && j < lv.J_loop_upper_bound_plus_1;
+      bool yz = yx;
+      bool zy = i < I_tot && j < J_tot;
+      bool zx = i < I_tot && j < lv.J_loop_upper_bound;
+      bool row_unsplit = box.contains(i, j);
+
+      for (int k = 0; k < (K_tot + 1); k++) {
+        bool unsplit = row_unsplit && k >= box.lower.k && k < box.upper.k;
+
+        if ((xz || xy) && k < K_tot) {
+          const CellCoefficients &c = coefficients.x(i, j, k);
+          if (unsplit) {
+            H_s.xy(i, j, k) =
+                    c.H[0].Da * H_s.xy(i, j, k) +
+                    c.H[0].Db * (E_s.z(i, j, k) - E_s.z(i, j + 1, k)) +
+                    c.H[1].Db * (E_s.y(i, j, k + 1) - E_s.y(i, j, k));
+          } else {
+            if (xz) {
+              H_s.xz.at(i, j, k) =
+                      c.H[1].Da * H_s.xz.at(i, j, k) +
+                      c.H[1].Db * (E_s.y(i, j, k + 1) - E_s.y(i, j, k));
+            }
+            if (xy) {
+              H_s.xy(i, j, k) =
+                      c.H[0].Da * H_s.xy(i, j, k) +
+                      c.H[0].Db * (E_s.z(i, j, k) - E_s.z(i, j + 1, k));
+            }
+          }
+        }
+
+        if ((yx || yz) && k < K_tot) {
+          const CellCoefficients &c = coefficients.y(i, j, k);
+          if (unsplit) {
+            H_s.yx(i, j, k) =
+                    c.H[0].Da * H_s.yx(i, j, k) +
+                    c.H[0].Db * (E_s.z(i + 1, j, k) - E_s.z(i, j, k)) +
+                    c.H[1].Db * (E_s.x(i, j, k) - E_s.x(i, j, k + 1));
+          } else {
+            if (yx) {
+              H_s.yx(i, j, k) =
+                      c.H[0].Da * H_s.yx(i, j, k) +
+                      c.H[0].Db * (E_s.z(i + 1, j, k) - E_s.z(i, j, k));
+            }
+            if (yz) {
+              H_s.yz.at(i, j, k) =
+                      c.H[1].Da * H_s.yz.at(i, j, k) +
+                      c.H[1].Db * (E_s.x(i, j, k) - E_s.x(i, j, k + 1));
+            }
+          }
+        }
+
+        if (zy || zx) {
+          const CellCoefficients &c = coefficients.z(i, j, k);
+          if (unsplit) {
+            H_s.zx(i, j, k) =
+                    c.H[0].Da * H_s.zx(i, j, k) +
+                    c.H[0].Db * (E_s.y(i, j, k) - E_s.y(i + 1, j, k)) +
+                    c.H[1].Db * (E_s.x(i, j + 1, k) - E_s.x(i, j, k));
+          } else {
+            if (zy) {
+              H_s.zy.at(i, j, k) =
+                      c.H[1].Da * H_s.zy.at(i, j, k) +
+                      c.H[1].Db * (E_s.x(i, j + 1, k) - E_s.x(i, j, k));
+            }
+            if (zx) {
+              H_s.zx(i, j, k) =
+                      c.H[0].Da * H_s.zx(i, j, k) +
+                      c.H[0].Db * (E_s.y(i, j, k) - E_s.y(i + 1, j, k));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template void
+SimulationManager::update_E_split_fused<false, false>(LoopVariables &);
+template void
+SimulationManager::update_E_split_fused<false, true>(LoopVariables &);
+template void
+SimulationManager::update_E_split_fused<true, false>(LoopVariables &);
+template void
+SimulationManager::update_E_split_fused<true, true>(LoopVariables &);
+
+template void
+SimulationManager::update_E_unsplit<false, false>(LoopVariables &);
+template void
+SimulationManager::update_E_unsplit<false, true>(LoopVariables &);
+template void
+SimulationManager::update_E_unsplit<true, false>(LoopVariables &);
+template void
+SimulationManager::update_E_unsplit<true, true>(LoopVariables &);
@@ -8,10 +8,12 @@ using namespace tdms_phys_constants;
 using namespace std;
 
 LoopVariables::LoopVariables(const ObjectsFromInfile &data,
-                             IJKDimensions E_field_dims) {
+                             IJKDimensions E_field_dims,
+                             const FFTBackend &fft) {
   // deduce the number of non-pml cells in the z-direction, for efficiency
   n_non_pml_cells_in_K =
           data.IJK_tot.k - data.params.pml.Dxl - data.params.pml.Dxu;
+  active_region.set_grid(data.IJK_tot);
 
   // deduce refractive index, and print to log
   refind = sqrt(
@@ -23,8 +25,8 @@ LoopVariables::LoopVariables(const ObjectsFromInfile &data,
   if (data.params.exdetintegral) {
     int n0 = data.IJK_tot.i - data.params.pml.Dxl - data.params.pml.Dxu;
     int n1 = data.IJK_tot.j - data.params.pml.Dyl - data.params.pml.Dyu;
-    Ex_t.initialise(n1, n0);
-    Ey_t.initialise(n1, n0);
+    Ex_t.initialise(n1, n0, fft);
+    Ey_t.initialise(n1, n0, fft);
   }
 
   // We need to test for convergence under the following conditions. As such, we
@@ -75,6 +77,11 @@ LoopVariables::LoopVariables(const ObjectsFromInfile &data,
   // attempt to optimise the iteration loops, if we can
   optimise_loop_J_range(data);
 
+  // resolve the update coefficients of each Yee cell once, rather than at
+  // every iteration
+  coefficients = UpdateCoefficientPlan(data, is_dispersive, is_conductive,
+                                       n_non_pml_cells_in_K);
+
   // set Nsteps
 }
 
@@ -82,40 +89,84 @@ void LoopVariables::setup_dispersive_properties(const ObjectsFromInfile &data) {
   IJKDimensions IJK = data.IJK_tot;
   // determine whether or not we have a dispersive medium
   is_dispersive =
-          is_dispersive_medium(data.materials, IJK, data.gamma, data.params.dt);
+          is_dispersive_medium(data.max_material, data.gamma, data.params.dt);
   // work out if we have conductive background: background is conductive if at
   // least one entry exceeds 1e-15
   is_conductive = !(data.rho_cond.all_elements_less_than(1e-15));
 
-  // prepare additional field variables for dispersive media
+  // prepare additional field variables for dispersive media, which are
+  // allocated by allocate_currents
   E_nm1 = ElectricSplitField(IJK.i, IJK.j, IJK.k);
   J_nm1 = CurrentDensitySplitField(IJK.i, IJK.j, IJK.k);
+  J_s = CurrentDensitySplitField(IJK.i, IJK.j, IJK.k);
   J_c = CurrentDensitySplitField(IJK.i, IJK.j, IJK.k);
+}
+
+void LoopVariables::allocate_currents(const ObjectsFromInfile &data,
+                                      bool allow_sparse, const CellBox &cells,
+                                      bool require_sparse) {
+  bool dispersive = is_dispersive || data.params.is_disp_ml;
+  if (!dispersive && !is_conductive) { return; }
+
+  if (allow_sparse || require_sparse) {
+    currents.build(coefficients, data.E_s, cells, J_loop_upper_bound,
+                   J_loop_upper_bound_plus_1, data.params.delta,
+                   data.params.dt, dispersive, is_conductive);
+    size_t dense_bytes = 6 * sizeof(field_t) * (dispersive ? 3 : 0) +
+                         6 * sizeof(field_t) * (is_conductive ? 1 : 0);
+    dense_bytes *= (size_t) data.E_s.stored_cells().n_cells();
+    if (require_sparse || currents.n_bytes() < dense_bytes) {
+      spdlog::info("Storing the dispersive and conductive currents in {} "
+                   "cells ({:.1f} MB rather than {:.1f} MB)",
+                   currents.n_cells(), currents.n_bytes() / 1e6,
+                   dense_bytes / 1e6);
+      return;
+    }
+    currents.clear();
+  }
+
   // if we have a dispersive material we will need to write to the additional
-  // fields, so assign the memory to them and zero the entries
-  if (is_dispersive || data.params.is_disp_ml) {
-    E_nm1.allocate_and_zero();
-    J_nm1.allocate_and_zero();
-    J_s.allocate_and_zero();
+  // fields, and if we have a conductive material we will also need the
+  // conductivity/current-density of each cell. Assign the memory to them and
+  // zero the entries, in the cells that the E field stores: the auxiliary
+  // fields follow the storage of the E field.
+  vector<SplitField *> fields;
+  if (dispersive) { fields = {&E_nm1, &J_nm1, &J_s}; }
+  if (is_conductive) { fields.push_back(&J_c); }
+  for (SplitField *field : fields) {
+    if (data.E_s.has_unsplit_interior()) {
+      field->allocate_unsplit(data.E_s.unsplit_cells());
+    } else {
+      field->allocate(data.E_s.stored_cells());
+      field->zero();
+    }
   }
-  // if we have a conductive material we will also need the
-  // conductivity/current-density of each cell
-  if (is_conductive) { J_c.allocate_and_zero(); }
 }
 
-bool LoopVariables::is_dispersive_medium(uint8_t ***materials,
-                                         const IJKDimensions &IJK_tot,
+void LoopVariables::add_to_J_c(SplitComponent component,
+                               const CellCoordinate &cell, double value) {
+  if (!currents.is_active()) {
+    J_c.element(J_c.*component, cell) += value;
+  } else if (double *J = currents.J_c(component, cell)) {
+    *J += value;
+  }
+}
+
+void LoopVariables::add_to_J_s(SplitComponent component,
+                               const CellCoordinate &cell, double value) {
+  if (!currents.is_active()) {
+    J_s.element(J_s.*component, cell) += value;
+  } else if (double *J = currents.J_s(component, cell)) {
+    *J += value;
+  }
+}
+
+bool LoopVariables::is_dispersive_medium(int max_material,
                                          double *attenuation_constants,
                                          double dt, double non_zero_tol) {
-  int max_mat = 0;
-  // determine the number of entries in gamma, by examining the materials array
-  for (int k = 0; k < (IJK_tot.k + 1); k++)
-    for (int j = 0; j < (IJK_tot.j + 1); j++)
-      for (int i = 0; i < (IJK_tot.i + 1); i++) {
-        if (materials[k][j][i] > max_mat) max_mat = materials[k][j][i];
-      }
-  // now see if there are any non-zero attenuation constants
-  for (int i = 0; i < max_mat; i++) {
+  // the materials index gamma from 1, so it has max_material entries: see if
+  // there are any non-zero attenuation constants
+  for (int i = 0; i < max_material; i++) {
     if (fabs(attenuation_constants[i] / dt) > non_zero_tol) { return true; }
   }
   return false;
@@ -10,6 +10,27 @@
 using tdms_math_constants::DCPI;
 using namespace tdms_flags;
 
+namespace {
+
+/*! The dataset of the file that holds the materials of the cells of the grid */
+const std::string MATERIALS_DATASET = "fdtdgrid/materials";
+
+/** @brief The largest material of the cells that materials stores */
+int largest_material(const Tensor3D<uint8_t> &materials) {
+  CellBox cells = materials.stored_cells();
+  int largest = 0;
+  for (int k = cells.lower.k; k < cells.upper.k; k++) {
+    for (int j = cells.lower.j; j < cells.upper.j; j++) {
+      for (int i = cells.lower.i; i < cells.upper.i; i++) {
+        largest = std::max(largest, (int) materials(i, j, k));
+      }
+    }
+  }
+  return largest;
+}
+
+}// namespace
+
 IndependentObjectsFromInfile::IndependentObjectsFromInfile(
         InputMatrices matrices_from_input_file, const InputFlags &in_flags)
     :// initialisation list - members whose classes have no default constructors
@@ -49,8 +70,25 @@ IndependentObjectsFromInfile::IndependentObjectsFromInfile(
   // unpack the parameters for this simulation
   params.unpack_from_input_matrices(matrices_from_input_file);
 
-  // get the fdtd grid
-  init_grid_arrays(matrices_from_input_file["fdtdgrid"], E_s, H_s, materials);
+  // get the fdtd grid, or only its dimensions if its materials are to be read
+  // a block at a time
+  grid_filename_ = matrices_from_input_file.grid_filename;
+  if (matrices_from_input_file["fdtdgrid"] != nullptr) {
+    init_grid_arrays(matrices_from_input_file["fdtdgrid"], E_s, H_s,
+                     materials);
+    max_material = largest_material(materials);
+  } else {
+    // MATLAB stores the materials with their dimensions reversed
+    H5Dimension dims = HDF5Reader(grid_filename_).shape_of(MATERIALS_DATASET);
+    if (dims.size() != 2 && dims.size() != 3) {
+      throw std::runtime_error(
+              "field matrix materials should be 2- or 3-dimensional");
+    }
+    int n_layers = dims.size() == 3 ? (int) dims[0] : 0;
+    E_s.tot.i = H_s.tot.i = (int) dims[dims.size() - 1] - 1;
+    E_s.tot.j = H_s.tot.j = (int) dims[dims.size() - 2] - 1;
+    E_s.tot.k = H_s.tot.k = n_layers - 1;
+  }
   // set the {IJK}_tot variables using the split-field information we just
   // unpacked
   IJK_tot = E_s.tot;
@@ -170,12 +208,35 @@ IndependentObjectsFromInfile::IndependentObjectsFromInfile(
   }
 }
 
-IndependentObjectsFromInfile::~IndependentObjectsFromInfile() {
-  if (params.dimension == THREE) {
-    free_cast_matlab_3D_array(materials, E_s.tot.k + 1);
-  } else {
-    free_cast_matlab_3D_array(materials, 0);
+void IndependentObjectsFromInfile::read_materials(const CellBox &cells) {
+  HDF5Reader grid_file(grid_filename_);
+  H5Dimension dims = grid_file.shape_of(MATERIALS_DATASET);
+  int n_k = cells.upper.k - cells.lower.k, n_j = cells.upper.j - cells.lower.j,
+      n_i = cells.upper.i - cells.lower.i;
+  std::vector<hsize_t> offset = {(hsize_t) cells.lower.j,
+                                 (hsize_t) cells.lower.i},
+                       count = {(hsize_t) n_j, (hsize_t) n_i};
+  // as in init_grid_arrays, the materials may be 2-dimensional
+  if (dims.size() == 3) {
+    offset.insert(offset.begin(), (hsize_t) cells.lower.k);
+    count.insert(count.begin(), (hsize_t) n_k);
+  }
+  spdlog::info("Reading the materials of cells [{}, {}) x [{}, {}) x [{}, {})",
+               cells.lower.i, cells.upper.i, cells.lower.j, cells.upper.j,
+               cells.lower.k, cells.upper.k);
+
+  std::vector<uint8_t> block(n_i * n_j * n_k);
+  grid_file.read_block(MATERIALS_DATASET, offset, count, block.data());
+  materials.allocate(cells);
+  for (int k = 0; k < n_k; k++) {
+    for (int j = 0; j < n_j; j++) {
+      for (int i = 0; i < n_i; i++) {
+        materials(cells.lower.i + i, cells.lower.j + j, cells.lower.k + k) =
+                block[i + n_i * (j + n_j * k)];
+      }
+    }
   }
+  max_material = largest_material(materials);
 }
 
 ObjectsFromInfile::ObjectsFromInfile(InputMatrices matrices_from_input_file,
@@ -0,0 +1,47 @@
+#include "simulation_manager/phasor_accumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "globals.h"
+
+using namespace std;
+using tdms_math_constants::IMAGINARY_UNIT;
+
+void PhasorAccumulator::allocate(const Field &F) {
+  box_ = {{F.il, F.jl, F.kl}, {F.iu + 1, F.ju + 1, F.ku + 1}};
+  int n_i = box_.upper.i - box_.lower.i, n_j = box_.upper.j - box_.lower.j,
+      n_k = box_.upper.k - box_.lower.k;
+  for (int c = 0; c < 3; c++) {
+    real_[c].allocate(n_k, n_j, n_i);
+    imag_[c].allocate(n_k, n_j, n_i);
+  }
+  enabled_ = true;
+}
+
+void PhasorAccumulator::set_phase_term(Field &F, int n, double omega,
+                                       double dt, int Nt) {
+  phase_term_ = exp(F.phase(n, omega, dt) * IMAGINARY_UNIT) / ((double) Nt);
+}
+
+void PhasorAccumulator::flush(Field &F) {
+  int n_i = box_.upper.i - box_.lower.i, n_j = box_.upper.j - box_.lower.j,
+      n_k = box_.upper.k - box_.lower.k;
+  double ***F_real[3] = {F.real.x, F.real.y, F.real.z};
+  double ***F_imag[3] = {F.imag.x, F.imag.y, F.imag.z};
+
+  // As in Field::set_phasors, the cells are visited in tiles of PHASOR_TILE
+  // k-layers, so that both layouts are walked in short contiguous runs
+  const int tile = Field::PHASOR_TILE;
+#pragma omp for collapse(2)
+  for (int k_tile = 0; k_tile < n_k; k_tile += tile)
+    for (int dj = 0; dj < n_j; dj++)
+      for (int di = 0; di < n_i; di++)
+        for (int dk = k_tile; dk < min(k_tile + tile, n_k); dk++)
+          for (int c = 0; c < 3; c++) {
+            F_real[c][dk][dj][di] += real_[c](di, dj, dk);
+            F_imag[c][dk][dj][di] += imag_[c](di, dj, dk);
+            real_[c](di, dj, dk) = 0.;
+            imag_[c](di, dj, dk) = 0.;
+          }
+}
@@ -1,48 +1,196 @@
 #include "simulation_manager/pstd_variables.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <numeric>
+
 #include <omp.h>
+#include <spdlog/spdlog.h>
+
+#include "globals.h"
+
+using namespace std;
+using tdms_math_constants::DCPI;
+
+namespace {
+
+/**
+ * @brief The weight of the spectral derivative at a sample distance cells from
+ * an interface: 0 within overlap cells, rising smoothly to 1 over the next
+ * overlap cells
+ */
+double spectral_weight(int distance, int overlap) {
+  if (distance <= overlap) { return 0.; }
+  if (distance > 2 * overlap) { return 1.; }
+  double s = sin(0.5 * DCPI * (distance - overlap) / (overlap + 1.));
+  return s * s;
+}
+
+}// namespace
 
-#include "numerical_derivative.h"
-
-void PSTDVariables::set_using_dimensions(const IJKDimensions &IJK_tot) {
-  int max_IJK = IJK_tot.max(), n_threads = omp_get_max_threads();
-
-  ca.allocate(n_threads, max_IJK + 1);
-  cb.allocate(n_threads, max_IJK + 1);
-
-  // deduce the number of coefficients in the derivative-shift operator
-  N_ex = IJK_tot.i;
-  N_ey = IJK_tot.j;
-  N_ez = IJK_tot.k;
-  N_hx = IJK_tot.i + 1;
-  N_hy = IJK_tot.j + 1;
-  N_hz = IJK_tot.k + 1;
-
-  // flag allocation of memory
-  variables_allocated = true;
-  // allocate suitable memory for the derivative-shift operator coefficients
-  dk_ex = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * (N_ex));
-  dk_ey = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * (N_ey));
-  dk_ez = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * (N_ez));
-  dk_hx = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * (N_hx));
-  dk_hy = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * (N_hy));
-  dk_hz = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * (N_hz));
-
-  // initialise the derivative-shift operators for each field component
-  init_diff_shift_op(-0.5, dk_ex, N_ex);
-  init_diff_shift_op(-0.5, dk_ey, N_ey);
-  init_diff_shift_op(-0.5, dk_ez, N_ez);
-  init_diff_shift_op(0.5, dk_hx, N_hx);
-  init_diff_shift_op(0.5, dk_hy, N_hy);
-  init_diff_shift_op(0.5, dk_hz, N_hz);
+void SpectralLines::classify(const Tensor3D<uint8_t> &materials,
+                             const IJKDimensions &IJK_tot, int overlap,
+                             const GridPartition *partition) {
+  overlap_ = overlap;
+  int n_i = IJK_tot.i + 1, n_j = IJK_tot.j + 1, n_k = IJK_tot.k + 1;
+
+  // the interfaces between the cells whose materials are stored, as (a, b, c)
+  // of each line along x, y, and z
+  vector<int> found[3];
+  CellBox cells = materials.stored_cells();
+  for (int i = cells.lower.i; i < cells.upper.i; i++) {
+    for (int j = cells.lower.j; j < cells.upper.j; j++) {
+      for (int k = cells.lower.k; k < cells.upper.k; k++) {
+        uint8_t material = materials(i, j, k);
+        if (i + 1 < cells.upper.i && materials(i + 1, j, k) != material) {
+          found[0].insert(found[0].end(), {j, k, i});
+        }
+        if (j + 1 < cells.upper.j && materials(i, j + 1, k) != material) {
+          found[1].insert(found[1].end(), {i, k, j});
+        }
+        if (k + 1 < cells.upper.k && materials(i, j, k + 1) != material) {
+          found[2].insert(found[2].end(), {i, j, k});
+        }
+      }
+    }
+  }
+
+  Interfaces *lines[3] = {&x_, &y_, &z_};
+  int n_a[3] = {n_j, n_i, n_i}, n_b[3] = {n_k, n_k, n_j},
+      length[3] = {n_i, n_j, n_k};
+  double n_samples = 0., n_spectral = 0.;
+  for (int d = 0; d < 3; d++) {
+    // a process of a distributed grid finds the interfaces in its cells, and
+    // those of its halo again
+    if (partition != nullptr && partition->is_distributed()) {
+      found[d] = partition->gather_to_all(found[d]);
+    }
+    vector<array<int, 3>> interfaces(found[d].size() / 3);
+    for (size_t n = 0; n < interfaces.size(); n++) {
+      interfaces[n] = {found[d][3 * n], found[d][3 * n + 1],
+                       found[d][3 * n + 2]};
+    }
+    sort(interfaces.begin(), interfaces.end());
+    interfaces.erase(unique(interfaces.begin(), interfaces.end()),
+                     interfaces.end());
+
+    Interfaces &along = *lines[d];
+    along.n_b = n_b[d];
+    along.at.clear();
+    along.first.clear();
+    if (!interfaces.empty()) {
+      along.first.assign((size_t) n_a[d] * n_b[d] + 1, 0);
+      for (const array<int, 3> &interface : interfaces) {
+        along.first[(size_t) interface[0] * n_b[d] + interface[1] + 1]++;
+        along.at.push_back(interface[2]);
+      }
+      partial_sum(along.first.begin(), along.first.end(), along.first.begin());
+    }
+
+    // the samples of the lines that are only differentiated spectrally
+    n_samples += (double) n_a[d] * n_b[d] * length[d];
+    n_spectral += (double) n_a[d] * n_b[d] * length[d];
+    vector<double> weight(length[d]);
+    for (size_t line = 0; line + 1 < along.first.size(); line++) {
+      if (along.first[line] == along.first[line + 1]) { continue; }
+      weights(along, (int) line / n_b[d], (int) line % n_b[d], length[d],
+              weight.data());
+      n_spectral -= (double) count_if(weight.begin(), weight.end(),
+                                      [](double w) { return w < 1.; });
+    }
+  }
+  spectral_fraction_ = n_spectral / n_samples;
 }
 
-PSTDVariables::~PSTDVariables() {
-  if (variables_allocated) {
-    fftw_free(dk_ey);
-    fftw_free(dk_ez);
-    fftw_free(dk_hx);
-    fftw_free(dk_hy);
-    fftw_free(dk_hz);
+bool SpectralLines::weights(const Interfaces &lines, int a, int b, int n,
+                            double *weight) const {
+  if (lines.first.empty()) { return false; }
+  size_t line = (size_t) a * lines.n_b + b;
+  int begin = lines.first[line], end = lines.first[line + 1];
+  if (begin == end) { return false; }
+
+  // the weight falls with the distance from the nearest interface, which is
+  // 0 at the samples on either side of it
+  fill_n(weight, n, 1.);
+  for (int m = begin; m < end; m++) {
+    int c = lines.at[m];
+    int first = max(0, c - 2 * overlap_),
+        last = min(n - 1, c + 1 + 2 * overlap_);
+    for (int x = first; x <= last; x++) {
+      int distance = x <= c ? c - x : x - c - 1;
+      weight[x] = min(weight[x], spectral_weight(distance, overlap_));
+    }
+  }
+  return true;
+}
+
+void PSTDDerivative::initialise(AxialDirection direction, double delta,
+                                int n_threads,
+                                shared_ptr<const BatchedRealFFT> transform,
+                                const GridPartition *partition) {
+  direction_ = direction;
+  length_ = transform->N;
+  if (partition == nullptr || !partition->is_distributed()) {
+    serial_.initialise(delta, n_threads, move(transform));
+    distributed_ = nullptr;
+    return;
+  }
+  distributed_ = partition->make_derivative(direction, delta, move(transform));
+  owned_ = partition->owned();
+  samples_.assign(owned_.n_cells(), 0.);
+  derivative_.assign(owned_.n_cells(), 0.);
+}
+
+void PSTDVariables::set_using_dimensions(const IJKDimensions &IJK_tot,
+                                         const FFTBackend &fft,
+                                         const string &wisdom_file,
+                                         const GridPartition *partition) {
+  int n_threads = omp_get_max_threads();
+
+  // plans found by earlier runs are reused rather than measured again. Only
+  // the root process of a distributed run reads (and writes) the file, and
+  // passes the plans on to the others.
+  bool is_root = partition == nullptr || partition->is_root();
+  if (!wisdom_file.empty()) {
+    string wisdom;
+    if (is_root && fft.import_wisdom(wisdom_file)) {
+      spdlog::info("Imported {} wisdom from {}", fft.name(), wisdom_file);
+      wisdom = fft.export_wisdom_to_string();
+    } else if (is_root) {
+      spdlog::info("No {} wisdom imported from {}", fft.name(), wisdom_file);
+    }
+    if (partition != nullptr) { partition->broadcast_from_root(wisdom); }
+    if (!is_root && !wisdom.empty()) { fft.import_wisdom_from_string(wisdom); }
+  }
+
+  map<int, shared_ptr<const BatchedRealFFT>> plans;
+  auto plans_of_length = [&](int N) {
+    shared_ptr<const BatchedRealFFT> &found = plans[N];
+    if (found == nullptr) { found = fft.plan_batched_real(N, 16); }
+    return found;
+  };
+
+  // the E-field components are shifted back by half a cell, the H-field
+  // components forward
+  d_ex.initialise(AxialDirection::X, -0.5, n_threads,
+                  plans_of_length(IJK_tot.i), partition);
+  d_ey.initialise(AxialDirection::Y, -0.5, n_threads,
+                  plans_of_length(IJK_tot.j), partition);
+  d_ez.initialise(AxialDirection::Z, -0.5, n_threads,
+                  plans_of_length(IJK_tot.k), partition);
+  d_hx.initialise(AxialDirection::X, 0.5, n_threads,
+                  plans_of_length(IJK_tot.i + 1), partition);
+  d_hy.initialise(AxialDirection::Y, 0.5, n_threads,
+                  plans_of_length(IJK_tot.j + 1), partition);
+  d_hz.initialise(AxialDirection::Z, 0.5, n_threads,
+                  plans_of_length(IJK_tot.k + 1), partition);
+  spdlog::debug("Created {} plans for {} distinct lengths", fft.name(),
+                plans.size());
+
+  if (!wisdom_file.empty() && is_root && !fft.export_wisdom(wisdom_file)) {
+    spdlog::warn("Could not export {} wisdom to {}", fft.name(), wisdom_file);
   }
 }
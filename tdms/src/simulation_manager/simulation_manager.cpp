@@ -9,22 +9,63 @@ using namespace std;
 using namespace tdms_flags;
 
 SimulationManager::SimulationManager(InputMatrices in_matrices,
-                                     const InputFlags &in_flags)
+                                     const InputFlags &in_flags,
+                                     const SolverOptions &options)
     : solver_method(static_cast<SolverMethod>(in_flags["use_pstd"])),
       i_method(static_cast<InterpolationMethod>(in_flags["use_bli"])),
-      inputs(in_matrices, in_flags) {
+      options(options), inputs(in_matrices, in_flags) {
   // read number of Yee cells
   IJKDimensions IJK_tot = n_Yee_cells();
 
+  fft = make_fft_backend(options.fft_library, options.fftw_planning,
+                         omp_get_max_threads());
+  spdlog::info("Using the {} FFT backend", fft->name());
+
+  // the cells of the grid that this process updates
+  partition = make_grid_partition(options.distributed, IJK_tot);
+  // each process stores the cells that it owns, and the halo of the cells of
+  // its neighbours that the FDTD updates read. The PSTD derivatives transpose
+  // the owned cells into whole lines, so store no halo.
+  CellBox stored = partition->with_halo(
+          solver_method == SolverMethod::FiniteDifference ? 1 : 0);
+  if (!inputs.materials.has_elements()) {
+    // the materials were not read with the other inputs: read those of the
+    // stored cells, and of their neighbours above, which set the update
+    // coefficients of the faces between them
+    CellBox above = {stored.lower,
+                     {stored.upper.i + 1, stored.upper.j + 1, stored.upper.k}};
+    inputs.read_materials(above.intersection(partition->grid()));
+    double max_material = inputs.max_material;
+    partition->maximum(&max_material, 1);
+    inputs.max_material = (int) max_material;
+  }
+  if (partition->is_distributed()) {
+    const CellBox &owned = partition->owned();
+    spdlog::info("Distributed the grid over {} processes; the root process "
+                 "owns cells [{}, {}) x [{}, {}) of {} x {}",
+                 partition->n_processes(), owned.lower.i, owned.upper.i,
+                 owned.lower.j, owned.upper.j, IJK_tot.i + 1, IJK_tot.j + 1);
+    inputs.E_s.allocate(stored);
+    inputs.H_s.allocate(stored);
+  } else if (!(options.unsplit_interior && supports_unsplit_interior())) {
+    // the fields start at zero. Fields that may be stored unsplit in the
+    // interior are allocated by execute(), once it has resolved the update
+    // coefficients that decide whether they can be.
+    inputs.E_s.allocate();
+    inputs.H_s.allocate();
+  }
+
   // setup PSTD variables, and any dependencies there might be
   if (solver_method == SolverMethod::PseudoSpectral) {
-    int max_IJK = IJK_tot.max(), n_threads = omp_get_max_threads();
-
-    PSTD.set_using_dimensions(IJK_tot);
-
-    eh_vec.allocate(n_threads, max_IJK + 1);
-    inputs.E_s.initialise_fftw_plan(n_threads, eh_vec);
-    inputs.H_s.initialise_fftw_plan(n_threads, eh_vec);
+    PSTD.set_using_dimensions(IJK_tot, *fft, options.fftw_wisdom,
+                              partition.get());
+    if (options.hybrid_pstd) {
+      PSTD.spectral.classify(inputs.materials, IJK_tot, options.hybrid_overlap,
+                             partition.get());
+      spdlog::info("Hybrid PSTD/FDTD: {:.1f}% of the samples are "
+                   "differentiated purely spectrally",
+                   100. * PSTD.spectral.spectral_fraction());
+    }
   }
 
   // initialise the {E,H}_norm variables to an array of zeros
@@ -50,7 +91,10 @@ void SimulationManager::prepare_output(const mxArray *fieldsample,
     and also to handle the case of when there is no PML in place more
     appropriatley*/
   outputs.setup_EH_and_gridlabels(inputs.params, inputs.input_grid_labels,
-                                  i_method);
+                                  i_method, partition.get());
+  if (options.volume_spectrum) {
+    outputs.setup_volume_spectrum(inputs.params, inputs.f_ex_vec);
+  }
   // Setup the ID output
   bool need_Id_memory = (inputs.params.exdetintegral &&
                          inputs.params.run_mode == RunMode::complete);
@@ -72,6 +116,11 @@ void SimulationManager::post_loop_processing() {
       outputs.H.normalise_volume();
     }
 
+    // normalise the volume phasors at each frequency, if we extracted them
+    if (outputs.volume_spectrum.is_enabled()) {
+      outputs.volume_spectrum.normalise(E_norm, H_norm);
+    }
+
     // normalise the phasors on the surface, if we extracted there
     if (inputs.params.run_mode == RunMode::complete &&
         inputs.params.exphasorssurface) {
@@ -114,10 +163,14 @@ void SimulationManager::post_loop_processing() {
       }
   }
 
-  // Write the maximum absolute value of residual field in the grid
-  double maxfield = max(inputs.E_s.largest_field_value(),
-                        inputs.H_s.largest_field_value());
+  // Write the maximum absolute value of residual field in the grid, whose
+  // cells may be distributed over the processes
+  double maxfield = max(inputs.E_s.largest_field_value(partition->owned()),
+                        inputs.H_s.largest_field_value(partition->owned()));
+  partition->maximum(&maxfield, 1);
   outputs.set_maxresfield(maxfield, false);
+  // the root process, which holds the outputs of every process, writes them
+  if (!partition->is_root()) { return; }
 
   // setup interpolated field outputs and labels (if necessary)
   outputs.setup_interpolation_outputs(inputs.params);
@@ -151,6 +204,7 @@ void SimulationManager::post_loop_processing() {
   }
   // assign to the output
   outputs.assign_surface_phasor_outputs(!extracting_phasors, mx_surface_facets);
+  outputs.assign_volume_spectrum_outputs();
   // it is safe to reassign the mx_surface_facets pointer here, since
   // outputs.surface_phasors now tracks the memory
   mx_surface_facets = nullptr;
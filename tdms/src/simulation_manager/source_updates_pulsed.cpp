@@ -7,8 +7,7 @@ using namespace tdms_phys_constants;
 using tdms_math_constants::DCPI, tdms_math_constants::IMAGINARY_UNIT;
 
 void SimulationManager::update_source_terms_pulsed(
-        double time_H, bool is_conductive, CurrentDensitySplitField &J_c,
-        CurrentDensitySplitField &J_s) {
+        double time_H, LoopVariables &lv, int i_begin, int i_end) {
   /* Exit now if Ksource is empty, to avoid seg-faults. There are no update
    * terms that do not involve Ksource for the E-field, so if Ksource is empty
    * all our updates amount to adding/subtracting 0 from something. */
@@ -16,6 +15,12 @@ void SimulationManager::update_source_terms_pulsed(
 
   //! Simulation dimensions
   int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j;
+  //! The cells that this process updates: every cell, unless the grid is
+  //! distributed
+  const CellBox &owned = partition->owned();
+  i_begin = max(i_begin, owned.lower.i);
+  i_end = min(i_end, owned.upper.i);
+  int j_begin = owned.lower.j, j_end = owned.upper.j;
   //! The material constant that appears in the update equation
   double c_constant = inputs.C.b.z[inputs.K0.index];
   //! Conductive aux of the cell being updated
@@ -46,61 +51,68 @@ void SimulationManager::update_source_terms_pulsed(
 
   if (J_tot == 0) {
     int j = 0;
-    for (int i = 0; i < I_tot + 1; i++) {
+    for (int i = max(0, i_begin); i < min(I_tot + 1, i_end); i++) {
       s_index = {2, i - inputs.I0.index, j};
       cell_to_update = {i, j, inputs.K0.index};
 
       split_field_update =
               common_amplitude * real(inputs.Ksource[s_index] * common_phase);
 
-      inputs.E_s.yz[cell_to_update] -= split_field_update;
-      if (is_conductive) {
-        J_c.yz[cell_to_update] += conductive_aux * split_field_update;
+      inputs.E_s.element(inputs.E_s.yz, cell_to_update) -= split_field_update;
+      if (lv.is_conductive) {
+        lv.add_to_J_c(&SplitField::yz, cell_to_update,
+                      conductive_aux * split_field_update);
       }
       if (inputs.params.is_disp_ml) {
-        J_s.yz[cell_to_update] -= dispersion_factor * split_field_update;
+        lv.add_to_J_s(&SplitField::yz, cell_to_update,
+                      -dispersion_factor * split_field_update);
       }
     }
   } else {
-    for (int j = 0; j < J_tot; j++) {
-      for (int i = 0; i < I_tot + 1; i++) {
+    for (int j = j_begin; j < min(J_tot, j_end); j++) {
+      for (int i = max(0, i_begin); i < min(I_tot + 1, i_end); i++) {
         s_index = {2, i - inputs.I0.index, j - inputs.J0.index};
         cell_to_update = {i, j, inputs.K0.index};
 
         split_field_update =
                 common_amplitude * real(inputs.Ksource[s_index] * common_phase);
 
-        inputs.E_s.yz[cell_to_update] -= split_field_update;
-        if (is_conductive) {
-          J_c.yz[cell_to_update] += conductive_aux * split_field_update;
+        inputs.E_s.element(inputs.E_s.yz, cell_to_update) -= split_field_update;
+        if (lv.is_conductive) {
+          lv.add_to_J_c(&SplitField::yz, cell_to_update,
+                        conductive_aux * split_field_update);
         }
         if (inputs.params.is_disp_ml) {
-          J_s.yz[cell_to_update] -= dispersion_factor * split_field_update;
+          lv.add_to_J_s(&SplitField::yz, cell_to_update,
+                        -dispersion_factor * split_field_update);
         }
       }
     }
   }
 
-  for (int j = 0; j < J_tot + 1; j++) {
-    for (int i = 0; i < I_tot; i++) {
+  for (int j = j_begin; j < min(J_tot + 1, j_end); j++) {
+    for (int i = max(0, i_begin); i < min(I_tot, i_end); i++) {
       s_index = {3, i - inputs.I0.index, j - inputs.J0.index};
       cell_to_update = {i, j, inputs.K0.index};
 
       split_field_update =
               common_amplitude * real(inputs.Ksource[s_index] * common_phase);
 
-      inputs.E_s.xz[cell_to_update] += split_field_update;
-      if (is_conductive) {
-        J_c.xz[cell_to_update] -= conductive_aux * split_field_update;
+      inputs.E_s.element(inputs.E_s.xz, cell_to_update) += split_field_update;
+      if (lv.is_conductive) {
+        lv.add_to_J_c(&SplitField::xz, cell_to_update,
+                      -conductive_aux * split_field_update);
       }
       if (inputs.params.is_disp_ml) {
-        J_s.xz[cell_to_update] += dispersion_factor * split_field_update;
+        lv.add_to_J_s(&SplitField::xz, cell_to_update,
+                      dispersion_factor * split_field_update);
       }
     }
   }
 }
 
-void SimulationManager::update_source_terms_pulsed(double time_E, int tind) {
+void SimulationManager::update_source_terms_pulsed(double time_E, int tind,
+                                                   int i_begin, int i_end) {
   /* Unlike the E-field, the H-field updates involve terms that do not depend on
    * Ksource (namely when exi and eyi are present). As such, there will
    * be work to do even if Ksource is empty, so we mitagate this by using the
@@ -108,6 +120,11 @@ void SimulationManager::update_source_terms_pulsed(double time_E, int tind) {
 
   //! Simulation dimensions
   int I_tot = n_Yee_cells().i, J_tot = n_Yee_cells().j;
+  //! The cells that this process updates
+  const CellBox &owned = partition->owned();
+  i_begin = max(i_begin, owned.lower.i);
+  i_end = min(i_end, owned.upper.i);
+  int j_begin = owned.lower.j, j_end = owned.upper.j;
   //! The material constant that appears in the update equation
   double d_constant = inputs.D.b.z[inputs.K0.index - 1];
   //! Common amplitude factor in update equations
@@ -129,56 +146,62 @@ void SimulationManager::update_source_terms_pulsed(double time_E, int tind) {
 
   if (J_tot == 0) {
     int j = 0;
-    for (int i = 0; i < I_tot + 1; i++) {
+    for (int i = i_begin; i < min(I_tot + 1, i_end); i++) {
       s_index = {1, i - inputs.I0.index, j};
       source_value = inputs.Ksource.value_or_zero_if_empty(s_index);
       cell_to_update = {i, j, inputs.K0.index - 1};
 
       // Update magnetic split field
-      inputs.H_s.xz[cell_to_update] -=
+      inputs.H_s.element(inputs.H_s.xz, cell_to_update) -=
               d_constant * common_amplitude * real(source_value * common_phase);
       // Update broadband source term
       if (inputs.params.eyi_present) {
-        inputs.H_s.xz[cell_to_update] -= d_constant * inputs.Ei.y(i, j, tind);
+        inputs.H_s.element(inputs.H_s.xz, cell_to_update) -=
+                d_constant * inputs.Ei.y(i, j, tind);
       }
     }
-    for (int i = 0; i < I_tot; i++) {
+    for (int i = i_begin; i < min(I_tot, i_end); i++) {
       s_index = {0, i - inputs.I0.index, j};
       source_value = inputs.Ksource.value_or_zero_if_empty(s_index);
       cell_to_update = {i, j, inputs.K0.index - 1};
 
       // Update magnetic split field
-      inputs.H_s.yz[cell_to_update] +=
+      inputs.H_s.element(inputs.H_s.yz, cell_to_update) +=
               d_constant * common_amplitude * real(source_value * common_phase);
       // Update broadband source term
       if (inputs.params.exi_present) {
-        inputs.H_s.yz[cell_to_update] += d_constant * inputs.Ei.x(i, j, tind);
+        inputs.H_s.element(inputs.H_s.yz, cell_to_update) +=
+                d_constant * inputs.Ei.x(i, j, tind);
       }
     }
   } else {
-    for (int j = 0; j < J_tot; j++) {
-      for (int i = 0; i < I_tot + 1; i++) {
+    for (int j = j_begin; j < min(J_tot, j_end); j++) {
+      for (int i = i_begin; i < min(I_tot + 1, i_end); i++) {
         s_index = {1, i - inputs.I0.index, j - inputs.J0.index};
         source_value = inputs.Ksource.value_or_zero_if_empty(s_index);
         cell_to_update = {i, j, inputs.K0.index - 1};
 
-        inputs.H_s.xz[cell_to_update] -= d_constant * common_amplitude *
-                                         real(source_value * common_phase);
+        inputs.H_s.element(inputs.H_s.xz, cell_to_update) -=
+                d_constant * common_amplitude *
+                        real(source_value * common_phase);
         if (inputs.params.eyi_present) {
-          inputs.H_s.xz[cell_to_update] -= d_constant * inputs.Ei.y(i, j, tind);
+          inputs.H_s.element(inputs.H_s.xz, cell_to_update) -=
+                  d_constant * inputs.Ei.y(i, j, tind);
         }
       }
     }
-    for (int j = 0; j < J_tot + 1; j++) {
-      for (int i = 0; i < I_tot; i++) {
+    for (int j = j_begin; j < min(J_tot + 1, j_end); j++) {
+      for (int i = i_begin; i < min(I_tot, i_end); i++) {
         s_index = {0, i - inputs.I0.index, j - inputs.J0.index};
         source_value = inputs.Ksource.value_or_zero_if_empty(s_index);
         cell_to_update = {i, j, inputs.K0.index - 1};
 
-        inputs.H_s.yz[cell_to_update] += d_constant * common_amplitude *
-                                         real(source_value * common_phase);
+        inputs.H_s.element(inputs.H_s.yz, cell_to_update) +=
+                d_constant * common_amplitude *
+                        real(source_value * common_phase);
         if (inputs.params.exi_present) {
-          inputs.H_s.yz[cell_to_update] += d_constant * inputs.Ei.x(i, j, tind);
+          inputs.H_s.element(inputs.H_s.yz, cell_to_update) +=
+                  d_constant * inputs.Ei.x(i, j, tind);
         }
       }
     }
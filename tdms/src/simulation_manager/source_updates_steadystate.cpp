@@ -8,23 +8,22 @@ using namespace tdms_phys_constants;
 using tdms_math_constants::DCPI, tdms_math_constants::IMAGINARY_UNIT;
 
 void SimulationManager::E_source_update_all_steadystate(
-        double time_H, bool is_conductive, CurrentDensitySplitField &J_c,
-        CurrentDensitySplitField &J_s) {
-  E_Isource_update_steadystate(time_H, is_conductive, J_c, J_s);
-  E_Jsource_update_steadystate(time_H, is_conductive, J_c, J_s);
-  E_Ksource_update_steadystate(time_H, is_conductive, J_c, J_s);
+        double time_H, LoopVariables &lv, int i_begin, int i_end) {
+  E_Isource_update_steadystate(time_H, lv, i_begin, i_end);
+  E_Jsource_update_steadystate(time_H, lv, i_begin, i_end);
+  E_Ksource_update_steadystate(time_H, lv, i_begin, i_end);
 }
 
 void SimulationManager::E_Isource_update_steadystate(
-        double time_H, bool is_conductive, CurrentDensitySplitField &J_c,
-        CurrentDensitySplitField &J_s) {
+        double time_H, LoopVariables &lv, int i_begin, int i_end) {
   // Only run update equations is source data was provided
   if (inputs.Isource.is_empty()) { return; }
 
   int array_ind;
 
   // Update across I0, provided a source term is here
-  if (inputs.I0.apply) {
+  if (inputs.I0.apply && inputs.I0.index >= i_begin &&
+      inputs.I0.index < i_end) {
     for (int k = (inputs.K0.index); k <= (inputs.K1.index); k++) {
       for (int j = (inputs.J0.index); j <= (inputs.J1.index); j++) {
         if (!inputs.params.is_multilayer) {
@@ -35,18 +34,19 @@ void SimulationManager::E_Isource_update_steadystate(
         if (k < (inputs.K1.index) ||
             inputs.params.dimension == Dimension::TRANSVERSE_MAGNETIC) {
           E_source_update_steadystate(time_H, AxialDirection::X, true, true,
-                                      is_conductive, j, k, array_ind, J_c, J_s);
+                                      j, k, array_ind, lv);
         }
         if (j < (inputs.J1.index)) {
           E_source_update_steadystate(time_H, AxialDirection::X, false, true,
-                                      is_conductive, j, k, array_ind, J_c, J_s);
+                                      j, k, array_ind, lv);
         }
       }
     }
   }
 
   // Update across I1, provided a source term is here
-  if (inputs.I1.apply) {
+  if (inputs.I1.apply && inputs.I1.index >= i_begin &&
+      inputs.I1.index < i_end) {
     for (int k = (inputs.K0.index); k <= (inputs.K1.index); k++) {
       for (int j = (inputs.J0.index); j <= (inputs.J1.index); j++) {
         if (!inputs.params.is_multilayer) {
@@ -57,11 +57,11 @@ void SimulationManager::E_Isource_update_steadystate(
         if (k < (inputs.K1.index) ||
             inputs.params.dimension == Dimension::TRANSVERSE_MAGNETIC) {
           E_source_update_steadystate(time_H, AxialDirection::X, true, false,
-                                      is_conductive, j, k, array_ind, J_c, J_s);
+                                      j, k, array_ind, lv);
         }
         if (j < (inputs.J1.index)) {
           E_source_update_steadystate(time_H, AxialDirection::X, false, false,
-                                      is_conductive, j, k, array_ind, J_c, J_s);
+                                      j, k, array_ind, lv);
         }
       }
     }
@@ -69,8 +69,7 @@ void SimulationManager::E_Isource_update_steadystate(
 }
 
 void SimulationManager::E_Jsource_update_steadystate(
-        double time_H, bool is_conductive, CurrentDensitySplitField &J_c,
-        CurrentDensitySplitField &J_s) {
+        double time_H, LoopVariables &lv, int i_begin, int i_end) {
   // Only run update equations is source data was provided
   if (inputs.Jsource.is_empty()) { return; }
 
@@ -79,7 +78,8 @@ void SimulationManager::E_Jsource_update_steadystate(
   // Update across J0, provided a source term is there
   if (inputs.J0.apply) {
     for (int k = inputs.K0.index; k <= inputs.K1.index; k++) {
-      for (int i = inputs.I0.index; i < inputs.I1.index; i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index, i_end); i++) {
         if (!inputs.params.is_multilayer) {
           array_ind = inputs.J0.index;
         } else {
@@ -88,11 +88,11 @@ void SimulationManager::E_Jsource_update_steadystate(
         if (k < (inputs.K1.index) ||
             inputs.params.dimension == Dimension::TRANSVERSE_MAGNETIC) {
           E_source_update_steadystate(time_H, AxialDirection::Y, true, true,
-                                      is_conductive, i, k, array_ind, J_c, J_s);
+                                      i, k, array_ind, lv);
         }
         if (i < inputs.I1.index) {
           E_source_update_steadystate(time_H, AxialDirection::Y, false, true,
-                                      is_conductive, i, k, array_ind, J_c, J_s);
+                                      i, k, array_ind, lv);
         }
       }
     }
@@ -101,7 +101,8 @@ void SimulationManager::E_Jsource_update_steadystate(
   // Update across J1, provided a source term is there
   if (inputs.J1.apply) {
     for (int k = inputs.K0.index; k <= inputs.K1.index; k++) {
-      for (int i = inputs.I0.index; i <= inputs.I1.index; i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index + 1, i_end); i++) {
         if (!inputs.params.is_multilayer) {
           array_ind = inputs.J1.index;
         } else {
@@ -110,11 +111,11 @@ void SimulationManager::E_Jsource_update_steadystate(
         if (k < (inputs.K1.index) ||
             inputs.params.dimension == Dimension::TRANSVERSE_MAGNETIC) {
           E_source_update_steadystate(time_H, AxialDirection::Y, true, false,
-                                      is_conductive, i, k, array_ind, J_c, J_s);
+                                      i, k, array_ind, lv);
         }
         if (i < (inputs.I1.index)) {
           E_source_update_steadystate(time_H, AxialDirection::Y, false, false,
-                                      is_conductive, i, k, array_ind, J_c, J_s);
+                                      i, k, array_ind, lv);
         }
       }
     }
@@ -122,24 +123,22 @@ void SimulationManager::E_Jsource_update_steadystate(
 }
 
 void SimulationManager::E_Ksource_update_steadystate(
-        double time_H, bool is_conductive, CurrentDensitySplitField &J_c,
-        CurrentDensitySplitField &J_s) {
+        double time_H, LoopVariables &lv, int i_begin, int i_end) {
   // Only run update equations is source data was provided
   if (inputs.Ksource.is_empty()) { return; }
 
   // Update across K0, provided a source term is there
   if (inputs.K0.apply) {
     for (int j = inputs.J0.index; j <= inputs.J1.index; j++) {
-      for (int i = inputs.I0.index; i <= inputs.I1.index; i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index + 1, i_end); i++) {
         if (j < (inputs.J1.index)) {
           E_source_update_steadystate(time_H, AxialDirection::Z, true, true,
-                                      is_conductive, i, j, inputs.K0.index, J_c,
-                                      J_s);
+                                      i, j, inputs.K0.index, lv);
         }
         if (i < (inputs.I1.index)) {
           E_source_update_steadystate(time_H, AxialDirection::Z, false, true,
-                                      is_conductive, i, j, inputs.K0.index, J_c,
-                                      J_s);
+                                      i, j, inputs.K0.index, lv);
         }
       }
     }
@@ -148,16 +147,15 @@ void SimulationManager::E_Ksource_update_steadystate(
   // Update across K1, provided a source term is there
   if (inputs.K1.apply) {
     for (int j = inputs.J0.index; j <= inputs.J1.index; j++) {
-      for (int i = inputs.I0.index; i <= inputs.I1.index; i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index + 1, i_end); i++) {
         if (j < (inputs.J1.index)) {
           E_source_update_steadystate(time_H, AxialDirection::Z, true, false,
-                                      is_conductive, i, j, inputs.K1.index, J_c,
-                                      J_s);
+                                      i, j, inputs.K1.index, lv);
         }
         if (i < (inputs.I1.index)) {
           E_source_update_steadystate(time_H, AxialDirection::Z, false, false,
-                                      is_conductive, i, j, inputs.K1.index, J_c,
-                                      J_s);
+                                      i, j, inputs.K1.index, lv);
         }
       }
     }
@@ -166,8 +164,7 @@ void SimulationManager::E_Ksource_update_steadystate(
 
 void SimulationManager::E_source_update_steadystate(
         double time_H, AxialDirection parallel, bool C_axis, bool zero_plane,
-        bool is_conductive, int cell_b, int cell_c, int array_ind,
-        CurrentDensitySplitField &J_c, CurrentDensitySplitField &J_s) {
+        int cell_b, int cell_c, int array_ind, LoopVariables &lv) {
   // Common phase and amplitude terms to apply in all computations
   complex<double> common_phase = exp(
           -IMAGINARY_UNIT * fmod(inputs.params.omega_an * time_H, 2. * DCPI));
@@ -203,10 +200,8 @@ void SimulationManager::E_source_update_steadystate(
    * E_s sign, [1] = J_c sign, [2] = J_s sign */
   double update_sign[3] = {1., 1., 1.};
 
-  SplitFieldComponent
-          *E_s_component,//< The E_s component that should be updated
-          *J_c_component,//< The J_c component that should be updated
-          *J_s_component;//< The J_s component that should be updated
+  /*! The split component (of E_s, J_c, and J_s) that should be updated */
+  SplitComponent component;
 
   // If we are currently updating along the C-axis, the split_field_ID is one
   // less than if we are updating along the B-axis
@@ -244,9 +239,7 @@ void SimulationManager::E_source_update_steadystate(
         update_sign[2] = -1.;
       }
 
-      E_s_component = (C_axis) ? &inputs.E_s.zx : &inputs.E_s.yx;
-      J_c_component = (C_axis) ? &J_c.zx : &J_c.yx;
-      J_s_component = (C_axis) ? &J_s.zx : &J_s.yx;
+      component = (C_axis) ? &SplitField::zx : &SplitField::yx;
       break;
     case AxialDirection::Y:
       // Dealing with Jsource. i = cell_b, k = cell_c
@@ -271,9 +264,7 @@ void SimulationManager::E_source_update_steadystate(
       }
       if (C_axis) { update_sign[2] = -1.; }
 
-      E_s_component = (C_axis) ? &inputs.E_s.zy : &inputs.E_s.xy;
-      J_c_component = (C_axis) ? &J_c.zy : &J_c.xy;
-      J_s_component = (C_axis) ? &J_s.zy : &J_s.xy;
+      component = (C_axis) ? &SplitField::zy : &SplitField::xy;
       break;
     case AxialDirection::Z:
       // Dealing with Ksource. i = cell_b, j = cell_c
@@ -296,43 +287,54 @@ void SimulationManager::E_source_update_steadystate(
         update_sign[2] = -1.;
       }
 
-      E_s_component = (C_axis) ? &inputs.E_s.yz : &inputs.E_s.xz;
-      J_c_component = (C_axis) ? &J_c.yz : &J_c.xz;
-      J_s_component = (C_axis) ? &J_s.yz : &J_s.xz;
+      component = (C_axis) ? &SplitField::yz : &SplitField::xz;
       break;
   }
 
+  // each process of a distributed grid updates the cells that it owns
+  if (!partition->owned().contains(cell_to_update.i, cell_to_update.j,
+                                   cell_to_update.k)) {
+    return;
+  }
+
   // we can now compute the field update values
   double E_split_update =
           c_constant * real(common_amplitude * common_phase * source_value);
 
-  // update the relevant split-field component
-  (*E_s_component)[cell_to_update] += update_sign[0] * E_split_update;
+  // update the relevant split-field component (or the component that stores
+  // it, when the interior of the grid is unsplit)
+  inputs.E_s.element(inputs.E_s.*component, cell_to_update) +=
+          update_sign[0] * E_split_update;
   // update the current density in a conductive medium
-  if (is_conductive) {
-    (*J_c_component)[cell_to_update] +=
-            update_sign[1] * conductive_aux * E_split_update;
+  if (lv.is_conductive) {
+    lv.add_to_J_c(component, cell_to_update,
+                  update_sign[1] * conductive_aux * E_split_update);
   }
   // update the current density in a dispersive medium
   if (inputs.params.is_disp_ml) {
-    (*J_s_component)[cell_to_update] += update_sign[2] * kappa * gamma /
-                                        (2 * inputs.params.dt) * E_split_update;
+    lv.add_to_J_s(component, cell_to_update,
+                  update_sign[2] * kappa * gamma / (2 * inputs.params.dt) *
+                          E_split_update);
   }
 }
 
-void SimulationManager::H_source_update_all_steadystate(double time_E) {
-  H_Isource_update_steadystate(time_E);
-  H_Jsource_update_steadystate(time_E);
-  H_Ksource_update_steadystate(time_E);
+void SimulationManager::H_source_update_all_steadystate(double time_E,
+                                                        int i_begin,
+                                                        int i_end) {
+  H_Isource_update_steadystate(time_E, i_begin, i_end);
+  H_Jsource_update_steadystate(time_E, i_begin, i_end);
+  H_Ksource_update_steadystate(time_E, i_begin, i_end);
 }
 
-void SimulationManager::H_Isource_update_steadystate(double time_E) {
+void SimulationManager::H_Isource_update_steadystate(double time_E,
+                                                     int i_begin, int i_end) {
   if (inputs.Isource.is_empty()) { return; }
   int array_ind;
 
   // Update across I0
   array_ind = inputs.I0.index - 1;
-  if (inputs.I0.apply) {
+  if (inputs.I0.apply && inputs.I0.index - 1 >= i_begin &&
+      inputs.I0.index - 1 < i_end) {
     for (int k = inputs.K0.index; k <= inputs.K1.index; k++) {
       for (int j = inputs.J0.index; j <= inputs.J1.index; j++) {
         if (inputs.params.is_multilayer) {
@@ -353,7 +355,8 @@ void SimulationManager::H_Isource_update_steadystate(double time_E) {
   }
   // Update across I1
   array_ind = inputs.I1.index;
-  if (inputs.I1.apply) {
+  if (inputs.I1.apply && inputs.I1.index >= i_begin &&
+      inputs.I1.index < i_end) {
     for (int k = inputs.K0.index; k <= inputs.K1.index; k++) {
       for (int j = inputs.J0.index; j <= inputs.J1.index; j++) {
         if (inputs.params.is_multilayer) {
@@ -374,7 +377,8 @@ void SimulationManager::H_Isource_update_steadystate(double time_E) {
   }
 }
 
-void SimulationManager::H_Jsource_update_steadystate(double time_E) {
+void SimulationManager::H_Jsource_update_steadystate(double time_E,
+                                                     int i_begin, int i_end) {
   if (inputs.Jsource.is_empty()) { return; }
   int array_ind;
 
@@ -382,7 +386,8 @@ void SimulationManager::H_Jsource_update_steadystate(double time_E) {
   array_ind = inputs.J0.index;
   if (inputs.J0.apply) {
     for (int k = inputs.K0.index; k <= inputs.K1.index; k++) {
-      for (int i = inputs.I0.index; i <= inputs.I1.index; i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index + 1, i_end); i++) {
         if (inputs.params.is_multilayer) {
           array_ind = (n_Yee_cells().j + 1) * k + inputs.J0.index;
         }
@@ -403,7 +408,8 @@ void SimulationManager::H_Jsource_update_steadystate(double time_E) {
   array_ind = inputs.J1.index;
   if (inputs.J1.apply) {
     for (int k = inputs.K0.index; k <= inputs.K1.index; k++) {
-      for (int i = inputs.I0.index; i <= inputs.I1.index; i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index + 1, i_end); i++) {
         if (inputs.params.is_multilayer) {
           array_ind = (n_Yee_cells().j + 1) * k + inputs.J1.index;
         }
@@ -422,13 +428,15 @@ void SimulationManager::H_Jsource_update_steadystate(double time_E) {
   }
 }
 
-void SimulationManager::H_Ksource_update_steadystate(double time_E) {
+void SimulationManager::H_Ksource_update_steadystate(double time_E,
+                                                     int i_begin, int i_end) {
   if (inputs.Ksource.is_empty()) { return; }
 
   // Perform across K0
   if (inputs.K0.apply) {
     for (int j = (inputs.J0.index); j <= (inputs.J1.index); j++) {
-      for (int i = (inputs.I0.index); i <= (inputs.I1.index); i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index + 1, i_end); i++) {
         // Perform across K0
         if (i < inputs.I1.index) {
           H_source_update_steadystate(time_E, AxialDirection::Z, false, true,
@@ -444,7 +452,8 @@ void SimulationManager::H_Ksource_update_steadystate(double time_E) {
   // Perform across K1
   if (inputs.K1.apply) {
     for (int j = (inputs.J0.index); j <= (inputs.J1.index); j++) {
-      for (int i = (inputs.I0.index); i <= (inputs.I1.index); i++) {
+      for (int i = max(inputs.I0.index, i_begin);
+           i < min(inputs.I1.index + 1, i_end); i++) {
         if (i < inputs.I1.index) {
           H_source_update_steadystate(time_E, AxialDirection::Z, false, false,
                                       inputs.K1.index, i, j);
@@ -539,7 +548,12 @@ void SimulationManager::H_source_update_steadystate(
       break;
   }
 
-  (*H_s_component)[cell_to_update] +=
+  // each process of a distributed grid updates the cells that it owns
+  if (!partition->owned().contains(cell_to_update.i, cell_to_update.j,
+                                   cell_to_update.k)) {
+    return;
+  }
+  inputs.H_s.element(*H_s_component, cell_to_update) +=
           update_sign * d_constant *
           real(common_amplitude * common_phase * source_value);
 }
@@ -0,0 +1,222 @@
+#include "simulation_manager/sparse_currents.h"
+
+#include <algorithm>
+
+#include <omp.h>
+
+#include "globals.h"
+
+using namespace std;
+using namespace tdms_phys_constants;
+
+namespace {
+
+/*! The split components, in the order of SparseCurrents::components_ */
+const SplitComponent COMPONENTS[6] = {&SplitField::xy, &SplitField::xz,
+                                      &SplitField::yx, &SplitField::yz,
+                                      &SplitField::zx, &SplitField::zy};
+/*! The coefficients of each of the COMPONENTS */
+const ECoefficientsAt COEFFICIENTS[6] = {
+        &UpdateCoefficientPlan::Exy, &UpdateCoefficientPlan::Exz,
+        &UpdateCoefficientPlan::Eyx, &UpdateCoefficientPlan::Eyz,
+        &UpdateCoefficientPlan::Ezx, &UpdateCoefficientPlan::Ezy};
+
+/**
+ * @brief Whether the m-th of the COMPONENTS is updated at cell (i, j, k) by
+ * the FDTD update loops, see LoopVariables::optimise_loop_J_range
+ */
+bool is_updated(int m, int i, int j, int k, const IJKDimensions &tot,
+                int J_upper, int J_upper_plus_1) {
+  switch (m) {
+    case 0:// xy
+      return i < tot.i && j >= 1 && j < tot.j;
+    case 1:// xz
+      return i < tot.i && j < J_upper_plus_1 && k >= 1 && k < tot.k;
+    case 2:// yx
+      return i >= 1 && i < tot.i && j < J_upper;
+    case 3:// yz
+      return j < J_upper && k >= 1 && k < tot.k;
+    case 4:// zx
+      return i >= 1 && i < tot.i && j < J_upper_plus_1 && k < tot.k;
+    default:// zy
+      return j >= 1 && j < tot.j && k < tot.k;
+  }
+}
+
+bool lexicographic_less(const CellCoordinate &a, const CellCoordinate &b) {
+  if (a.i != b.i) { return a.i < b.i; }
+  if (a.j != b.j) { return a.j < b.j; }
+  return a.k < b.k;
+}
+
+}// namespace
+
+int SparseCurrents::index_of(SplitComponent component) {
+  return (int) (std::find(begin(COMPONENTS), end(COMPONENTS), component) -
+                begin(COMPONENTS));
+}
+
+void SparseCurrents::build(const UpdateCoefficientPlan &coefficients,
+                           const ElectricSplitField &E_s,
+                           const CellBox &cells, int J_loop_upper_bound,
+                           int J_loop_upper_bound_plus_1,
+                           const YeeCellDimensions &delta, double dt,
+                           bool dispersive, bool conductive) {
+  IJKDimensions tot = E_s.tot;
+  CellBox box = cells.intersection(
+          {{0, 0, 0}, {tot.i + 1, tot.j + 1, tot.k + 1}});
+  // The spacing of the finite difference driving each of the COMPONENTS
+  double deltas[6] = {delta.dy, delta.dz, delta.dx,
+                      delta.dz, delta.dx, delta.dy};
+  int max_threads = omp_get_max_threads();
+
+  for (int m = 0; m < 6; m++) {
+    const SplitFieldComponent &component = E_s.*COMPONENTS[m];
+    ComponentCells &listed = components_[m];
+    vector<vector<CellCoordinate>> thread_cells(max_threads);
+    vector<vector<const ECoefficients *>> thread_coefficients(max_threads);
+
+#pragma omp parallel default(shared)
+    {
+      int n = omp_get_thread_num();
+#pragma omp for schedule(static)
+      for (int i = box.lower.i; i < box.upper.i; i++) {
+        for (int j = box.lower.j; j < box.upper.j; j++) {
+          for (int k = box.lower.k; k < box.upper.k; k++) {
+            if (!is_updated(m, i, j, k, tot, J_loop_upper_bound,
+                            J_loop_upper_bound_plus_1) ||
+                !component.stores(i, j, k)) {
+              continue;
+            }
+            const ECoefficients &c = (coefficients.*COEFFICIENTS[m])(i, j, k);
+            if ((dispersive && c.gamma) || (conductive && c.rho)) {
+              thread_cells[n].push_back({i, j, k});
+              thread_coefficients[n].push_back(&c);
+            }
+          }
+        }
+      }
+    }
+
+    // The static schedule assigns increasing i to increasing threads, so the
+    // concatenated cells are in order
+    listed = ComponentCells();
+    for (int n = 0; n < max_threads; n++) {
+      listed.cells.insert(listed.cells.end(), thread_cells[n].begin(),
+                          thread_cells[n].end());
+      listed.coefficients.insert(listed.coefficients.end(),
+                                 thread_coefficients[n].begin(),
+                                 thread_coefficients[n].end());
+    }
+    size_t n_cells = listed.cells.size();
+    listed.E_n.assign(n_cells, 0.);
+    if (dispersive) {
+      listed.E_nm1.assign(n_cells, 0.);
+      listed.J_s.assign(n_cells, 0.);
+      listed.J_nm1.assign(n_cells, 0.);
+    }
+    if (conductive) { listed.J_c.assign(n_cells, 0.); }
+    listed.delta = deltas[m];
+  }
+
+  active_ = true;
+  dispersive_ = dispersive;
+  conductive_ = conductive;
+  dt_ = dt;
+  unsplit_ = E_s.unsplit_cells();
+}
+
+void SparseCurrents::clear() {
+  for (ComponentCells &listed : components_) { listed = ComponentCells(); }
+  active_ = false;
+}
+
+size_t SparseCurrents::n_cells() const {
+  size_t n = 0;
+  for (const ComponentCells &listed : components_) { n += listed.cells.size(); }
+  return n;
+}
+
+size_t SparseCurrents::n_bytes() const {
+  size_t n = 0;
+  for (const ComponentCells &listed : components_) {
+    n += listed.cells.size() *
+                 (sizeof(CellCoordinate) + sizeof(const ECoefficients *)) +
+         (listed.E_n.size() + listed.E_nm1.size() + listed.J_s.size() +
+          listed.J_nm1.size() + listed.J_c.size()) *
+                 sizeof(double);
+  }
+  return n;
+}
+
+void SparseCurrents::save_fields(const ElectricSplitField &E_s) {
+  for (int m = 0; m < 6; m++) {
+    const SplitFieldComponent &component = E_s.*COMPONENTS[m];
+    ComponentCells &listed = components_[m];
+    int n_cells = (int) listed.cells.size();
+
+#pragma omp for schedule(static) nowait
+    for (int n = 0; n < n_cells; n++) {
+      const CellCoordinate &cell = listed.cells[n];
+      listed.E_n[n] = component.value(cell.i, cell.j, cell.k);
+    }
+  }
+#pragma omp barrier
+}
+
+void SparseCurrents::apply(ElectricSplitField &E_s) {
+  for (int m = 0; m < 6; m++) {
+    SplitFieldComponent &component = E_s.*COMPONENTS[m];
+    ComponentCells &listed = components_[m];
+    int n_cells = (int) listed.cells.size();
+    double delta = listed.delta;
+
+#pragma omp for schedule(static) nowait
+    for (int n = 0; n < n_cells; n++) {
+      const ECoefficients &c = *listed.coefficients[n];
+      field_t &E = component.at(listed.cells[n]);
+      double E_n = listed.E_n[n];
+
+      double Enp1 = E;
+      if (dispersive_ && c.gamma)
+        Enp1 += c.Cc * listed.E_nm1[n] -
+                1. / 2. * c.Cb * delta *
+                        ((1 + c.alpha) * listed.J_s[n] +
+                         c.beta * listed.J_nm1[n]);
+      if (conductive_ && c.rho) Enp1 += c.Cb * delta * listed.J_c[n];
+      if (dispersive_ && c.gamma) {
+        double Jnp1 = c.alpha * listed.J_s[n] + c.beta * listed.J_nm1[n] +
+                      c.kappa * c.gamma / (2. * dt_) *
+                              (Enp1 - listed.E_nm1[n]);
+        Jnp1 += c.sigma / EPSILON0 * c.gamma * E_n;
+
+        listed.E_nm1[n] = E_n;
+        listed.J_nm1[n] = listed.J_s[n];
+        listed.J_s[n] = Jnp1;
+      }
+      if (conductive_ && c.rho) { listed.J_c[n] -= c.rho * (Enp1 + E_n); }
+
+      E = Enp1;
+    }
+  }
+#pragma omp barrier
+}
+
+double *SparseCurrents::find(vector<double> ComponentCells::*field,
+                             SplitComponent component,
+                             const CellCoordinate &cell) {
+  int m = index_of(component);
+  // the xz, yz, and zy components follow the component holding the field
+  if (m % 2 == 1 && unsplit_.contains(cell.i, cell.j, cell.k)) { m--; }
+
+  ComponentCells &listed = components_[m];
+  auto found = lower_bound(listed.cells.begin(), listed.cells.end(), cell,
+                           lexicographic_less);
+  if (found == listed.cells.end() || lexicographic_less(cell, *found)) {
+    return nullptr;
+  }
+  vector<double> &values = listed.*field;
+  // the field is empty if its terms are absent from the simulation
+  if (values.empty()) { return nullptr; }
+  return &values[found - listed.cells.begin()];
+}
@@ -0,0 +1,327 @@
+#include "simulation_manager/update_coefficients.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <spdlog/spdlog.h>
+
+using namespace std;
+
+namespace {
+
+/** @brief Const access to one of the x, y, z members of an XYZVector */
+const vector<double> &component(const XYZVector &v, AxialDirection axis) {
+  switch (axis) {
+    case AxialDirection::X:
+      return v.x;
+    case AxialDirection::Y:
+      return v.y;
+    default:
+      return v.z;
+  }
+}
+
+/**
+ * @brief Resolves the update coefficients at individual Yee cells, following
+ * the rules the update equations have always applied.
+ */
+class CoefficientResolver {
+private:
+  const ObjectsFromInfile &data;
+  bool dispersive;//< Whether the dispersive terms enter the update equations
+  bool is_conductive;
+  int n_non_pml_cells_in_K;
+
+public:
+  CoefficientResolver(const ObjectsFromInfile &data, bool dispersive,
+                      bool is_conductive, int n_non_pml_cells_in_K)
+      : data(data), dispersive(dispersive), is_conductive(is_conductive),
+        n_non_pml_cells_in_K(n_non_pml_cells_in_K) {}
+
+  /** @brief The layer (k_loc) that Yee cell (i, ., k) draws its coefficients
+   * from, once the offset of the grating structure has been applied. */
+  int layer_index(int i, int k) const {
+    const int Dzl = data.params.pml.Dzl;
+    if (!data.params.is_structure || k <= Dzl ||
+        k >= (Dzl + n_non_pml_cells_in_K)) {
+      return k;
+    }
+    int shifted_k = k - data.structure(1, i);
+    if (shifted_k < (n_non_pml_cells_in_K + Dzl) && shifted_k > Dzl) {
+      return shifted_k;
+    } else if (shifted_k >= (n_non_pml_cells_in_K + Dzl)) {
+      return Dzl + n_non_pml_cells_in_K - 1;
+    } else {
+      return Dzl + 1;
+    }
+  }
+
+  /** @brief Index into the background coefficient arrays along axis */
+  int coefficient_index(AxialDirection axis, int i, int j, int k_loc) const {
+    switch (axis) {
+      case AxialDirection::X:
+        return data.params.is_multilayer ? (data.IJK_tot.i + 1) * k_loc + i
+                                         : i;
+      case AxialDirection::Y:
+        return data.params.is_multilayer ? (data.IJK_tot.j + 1) * k_loc + j
+                                         : j;
+      default:
+        return k_loc;
+    }
+  }
+
+  /**
+   * @brief E-field coefficients for a component whose update straddles the
+   * material of the cell and that of its neighbour.
+   *
+   * @param axis Axis of the C coefficients used by the update
+   * @param index Index into the background coefficient arrays
+   * @param k_loc Layer index of the cell
+   * @param material,neighbour Materials of the cell and its neighbour
+   */
+  ECoefficients interface_E(AxialDirection axis, int index, int k_loc,
+                            uint8_t material, uint8_t neighbour) const {
+    const vector<double> &Ca = component(data.C.a, axis),
+                         &Cb = component(data.C.b, axis),
+                         &Cc = component(data.C.c, axis);
+    const vector<double> &Ca_mat = component(data.Cmaterial.a, axis),
+                         &Cb_mat = component(data.Cmaterial.b, axis),
+                         &Cc_mat = component(data.Cmaterial.c, axis);
+    const DispersiveMultiLayer &ml = data.matched_layer;
+    ECoefficients c;
+
+    // use the average of material parameters between nodes
+    if (material || neighbour) {
+      if (!material) {
+        c.Ca = Ca[index];
+        c.Cb = Cb[index];
+        c.Cc = data.params.is_disp_ml ? Cc[index] : 0.;
+      } else {
+        c.Ca = Ca_mat[material - 1];
+        c.Cb = Cb_mat[material - 1];
+        c.Cc = Cc_mat[material - 1];
+      }
+      if (data.params.interp_mat_props) {
+        if (!neighbour) {
+          c.Ca = c.Ca + Ca[index];
+          c.Cb = c.Cb + Cb[index];
+          if (data.params.is_disp_ml) c.Cc = c.Cc + Cc[index];
+        } else {
+          c.Ca = c.Ca + Ca_mat[neighbour - 1];
+          c.Cb = c.Cb + Cb_mat[neighbour - 1];
+          c.Cc = c.Cc + Cc_mat[neighbour - 1];
+        }
+        c.Ca = c.Ca / 2.;
+        c.Cb = c.Cb / 2.;
+        c.Cc = c.Cc / 2.;
+      }
+    } else {
+      c.Ca = Ca[index];
+      c.Cb = Cb[index];
+      c.Cc = data.params.is_disp_ml ? Cc[index] : 0.;
+      if (is_conductive) c.rho = component(data.rho_cond, axis)[index];
+    }
+
+    if (dispersive) {
+      c.sigma = component(ml.sigma, axis)[index];
+      c.kappa = component(ml.kappa, axis)[index];
+      c.alpha = ml.alpha[k_loc];
+      c.beta = ml.beta[k_loc];
+      c.gamma = ml.gamma[k_loc];
+      if (material || neighbour) {
+        if (material) {
+          c.alpha = data.alpha[material - 1];
+          c.beta = data.beta[material - 1];
+          c.gamma = data.gamma[material - 1];
+        }
+        if (neighbour) {
+          c.alpha += data.alpha[neighbour - 1];
+          c.beta += data.beta[neighbour - 1];
+          c.gamma += data.gamma[neighbour - 1];
+        } else {
+          c.alpha += ml.alpha[k_loc];
+          c.beta += ml.beta[k_loc];
+          c.gamma += ml.gamma[k_loc];
+        }
+        c.alpha = c.alpha / 2.;
+        c.beta = c.beta / 2.;
+        c.gamma = c.gamma / 2.;
+      }
+    }
+    return c;
+  }
+
+  /**
+   * @brief E-field coefficients for the Ez components of a TM simulation,
+   * which take the material of the cell alone.
+   *
+   * @param axis Axis of the C coefficients used by the update
+   * @param index Index into the background coefficient arrays
+   * @param rho_index Index into the background conductivity
+   * @param k_loc Layer index of the cell
+   * @param material Material of the cell
+   * @param material_dispersion If true, material cells take the dispersion
+   * parameters of their material and background cells those of the matched
+   * layer. If false, material cells take those of the matched layer and
+   * background cells have no dispersion (Ezy).
+   */
+  ECoefficients cell_E(AxialDirection axis, int index, int rho_index,
+                       int k_loc, uint8_t material,
+                       bool material_dispersion) const {
+    const DispersiveMultiLayer &ml = data.matched_layer;
+    ECoefficients c;
+
+    if (!material) {
+      c.Ca = component(data.C.a, axis)[index];
+      c.Cb = component(data.C.b, axis)[index];
+      c.Cc = data.params.is_disp_ml ? component(data.C.c, axis)[index] : 0.;
+      if (is_conductive) c.rho = component(data.rho_cond, axis)[rho_index];
+    } else {
+      c.Ca = component(data.Cmaterial.a, axis)[material - 1];
+      c.Cb = component(data.Cmaterial.b, axis)[material - 1];
+      c.Cc = component(data.Cmaterial.c, axis)[material - 1];
+    }
+
+    if (dispersive) {
+      c.sigma = component(ml.sigma, axis)[index];
+      c.kappa = component(ml.kappa, axis)[index];
+      if (material_dispersion && material) {
+        c.alpha = data.alpha[material - 1];
+        c.beta = data.beta[material - 1];
+        c.gamma = data.gamma[material - 1];
+      } else if (material_dispersion || material) {
+        c.alpha = ml.alpha[k_loc];
+        c.beta = ml.beta[k_loc];
+        c.gamma = ml.gamma[k_loc];
+      }
+    }
+    return c;
+  }
+
+  /** @brief H-field coefficients, which take the material of the cell alone */
+  HCoefficients cell_H(AxialDirection axis, int index,
+                       uint8_t material) const {
+    HCoefficients d;
+    if (!material) {
+      d.Da = component(data.D.a, axis)[index];
+      d.Db = component(data.D.b, axis)[index];
+    } else {
+      d.Da = component(data.Dmaterial.a, axis)[material - 1];
+      d.Db = component(data.Dmaterial.b, axis)[material - 1];
+    }
+    return d;
+  }
+};
+
+/** @brief Whether a and b agree to within a relative tolerance */
+bool nearly_equal(double a, double b) {
+  return fabs(a - b) <= 1e-12 * max(fabs(a), fabs(b));
+}
+
+/**
+ * @brief Whether both split components of a field direction have the same
+ * coefficients at a cell
+ *
+ * @param delta_0,delta_1 The grid spacings of the finite differences driving
+ * the first and second components
+ */
+bool is_isotropic(const CellCoefficients &c, double delta_0, double delta_1,
+                  bool with_currents) {
+  const ECoefficients &a = c.E[0], &b = c.E[1];
+  bool same = a.Ca == b.Ca && a.Cc == b.Cc && a.rho == b.rho &&
+              a.alpha == b.alpha && a.beta == b.beta && a.gamma == b.gamma &&
+              a.kappa == b.kappa && a.sigma == b.sigma &&
+              c.H[0].Da == c.H[1].Da;
+  return same &&
+         (!with_currents || nearly_equal(a.Cb * delta_0, b.Cb * delta_1));
+}
+
+}// namespace
+
+UpdateCoefficientPlan::UpdateCoefficientPlan(const ObjectsFromInfile &data,
+                                             bool is_dispersive,
+                                             bool is_conductive,
+                                             int n_non_pml_cells_in_K) {
+  const AxialDirection x = AxialDirection::X, y = AxialDirection::Y,
+                       z = AxialDirection::Z;
+  int I_tot = data.IJK_tot.i, J_tot = data.IJK_tot.j, K_tot = data.IJK_tot.k;
+  bool is_TM = data.params.dimension == Dimension::TRANSVERSE_MAGNETIC;
+  const Tensor3D<uint8_t> &materials = data.materials;
+  CoefficientResolver resolve(data, is_dispersive || data.params.is_disp_ml,
+                              is_conductive, n_non_pml_cells_in_K);
+  // the cells of the grid, or those that this process of a distributed grid
+  // stores, whose materials have been read with those of their neighbours
+  // above
+  CellBox cells = data.E_s.stored_cells();
+
+  // Ex and Hx: {xy, xz}, averaged with the neighbour in the i-direction
+  x_.build(cells, [&](int i, int j, int k) {
+    int k_loc = resolve.layer_index(i, k);
+    int index = resolve.coefficient_index(y, i, j, k_loc);
+    uint8_t material = materials(i, j, k),
+            neighbour = materials(min(I_tot, i + 1), j, k);
+    CellCoefficients cell;
+    cell.E[0] = resolve.interface_E(y, index, k_loc, material, neighbour);
+    cell.E[1] = resolve.interface_E(z, k_loc, k_loc, material, neighbour);
+    cell.H[0] = resolve.cell_H(y, index, material);
+    cell.H[1] = resolve.cell_H(z, k_loc, material);
+    return cell;
+  });
+
+  // Ey and Hy: {yx, yz}, averaged with the neighbour in the j-direction
+  y_.build(cells, [&](int i, int j, int k) {
+    int k_loc = resolve.layer_index(i, k);
+    int index = resolve.coefficient_index(x, i, j, k_loc);
+    uint8_t material = materials(i, j, k),
+            neighbour = materials(i, min(J_tot, j + 1), k);
+    CellCoefficients cell;
+    cell.E[0] = resolve.interface_E(x, index, k_loc, material, neighbour);
+    cell.E[1] = resolve.interface_E(z, k_loc, k_loc, material, neighbour);
+    cell.H[0] = resolve.cell_H(x, index, material);
+    cell.H[1] = resolve.cell_H(z, k_loc, material);
+    return cell;
+  });
+
+  // Ez and Hz: {zx, zy}, averaged with the neighbour in the k-direction unless
+  // this is a TM simulation
+  z_.build(cells, [&](int i, int j, int k) {
+    int k_loc = resolve.layer_index(i, k);
+    int index_x = resolve.coefficient_index(x, i, j, k_loc),
+        index_y = resolve.coefficient_index(y, i, j, k_loc);
+    uint8_t material = materials(i, j, k),
+            neighbour = materials(i, j, min(K_tot, k + 1));
+    CellCoefficients cell;
+    if (is_TM) {
+      cell.E[0] = resolve.cell_E(x, index_x, i, k_loc, material, true);
+      cell.E[1] = resolve.cell_E(y, index_y, index_y, k_loc, material, false);
+    } else {
+      cell.E[0] = resolve.interface_E(x, index_x, k_loc, material, neighbour);
+      cell.E[1] = resolve.interface_E(y, index_y, k_loc, material, neighbour);
+    }
+    cell.H[0] = resolve.cell_H(x, index_x, material);
+    cell.H[1] = resolve.cell_H(y, index_y, material);
+    return cell;
+  });
+
+  spdlog::info("Update coefficient plan has {} distinct records", n_records());
+}
+
+bool UpdateCoefficientPlan::is_isotropic_in(const CellBox &box,
+                                            const YeeCellDimensions &delta,
+                                            bool with_currents) const {
+  bool isotropic = true;
+#pragma omp parallel for reduction(&& : isotropic)
+  for (int i = box.lower.i; i < box.upper.i; i++) {
+    for (int j = box.lower.j; j < box.upper.j; j++) {
+      for (int k = box.lower.k; k < box.upper.k; k++) {
+        isotropic = isotropic &&
+                    is_isotropic(x(i, j, k), delta.dy, delta.dz,
+                                 with_currents) &&
+                    is_isotropic(y(i, j, k), delta.dx, delta.dz,
+                                 with_currents) &&
+                    is_isotropic(z(i, j, k), delta.dx, delta.dy, with_currents);
+      }
+    }
+  }
+  return isotropic;
+}
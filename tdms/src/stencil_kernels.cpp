@@ -0,0 +1,196 @@
+/**
+ * @file stencil_kernels.cpp
+ * @brief Implementations of the vectorised finite-difference kernels.
+ *
+ * This file is compiled with floating-point contraction disabled, so that none
+ * of the implementations fuse the multiplications and additions into FMA
+ * instructions (which would round differently to the scalar update).
+ */
+#include "stencil_kernels.h"
+
+#include <spdlog/spdlog.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TDMS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template<typename T>
+void curl_update_row_scalar(int n, T *field, const double *a, const double *b,
+                            const T *plus_1, const T *plus_2, const T *minus_1,
+                            const T *minus_2) {
+  for (int k = 0; k < n; k++) {
+    field[k] = a[k] * field[k] +
+               b[k] * (plus_1[k] + plus_2[k] - minus_1[k] - minus_2[k]);
+  }
+}
+
+#ifdef TDMS_X86_SIMD
+__attribute__((target("avx2"))) void
+curl_update_row_avx2(int n, double *field, const double *a, const double *b,
+                     const double *plus_1, const double *plus_2,
+                     const double *minus_1, const double *minus_2) {
+  int k = 0;
+  for (; k + 4 <= n; k += 4) {
+    __m256d curl = _mm256_add_pd(_mm256_loadu_pd(plus_1 + k),
+                                 _mm256_loadu_pd(plus_2 + k));
+    curl = _mm256_sub_pd(curl, _mm256_loadu_pd(minus_1 + k));
+    curl = _mm256_sub_pd(curl, _mm256_loadu_pd(minus_2 + k));
+    __m256d updated =
+            _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(a + k),
+                                        _mm256_loadu_pd(field + k)),
+                          _mm256_mul_pd(_mm256_loadu_pd(b + k), curl));
+    _mm256_storeu_pd(field + k, updated);
+  }
+  curl_update_row_scalar(n - k, field + k, a + k, b + k, plus_1 + k,
+                         plus_2 + k, minus_1 + k, minus_2 + k);
+}
+
+__attribute__((target("avx2"))) void
+curl_update_row_avx2(int n, float *field, const double *a, const double *b,
+                     const float *plus_1, const float *plus_2,
+                     const float *minus_1, const float *minus_2) {
+  int k = 0;
+  for (; k + 4 <= n; k += 4) {
+    __m128 curl =
+            _mm_add_ps(_mm_loadu_ps(plus_1 + k), _mm_loadu_ps(plus_2 + k));
+    curl = _mm_sub_ps(curl, _mm_loadu_ps(minus_1 + k));
+    curl = _mm_sub_ps(curl, _mm_loadu_ps(minus_2 + k));
+    __m256d updated = _mm256_add_pd(
+            _mm256_mul_pd(_mm256_loadu_pd(a + k),
+                          _mm256_cvtps_pd(_mm_loadu_ps(field + k))),
+            _mm256_mul_pd(_mm256_loadu_pd(b + k), _mm256_cvtps_pd(curl)));
+    _mm_storeu_ps(field + k, _mm256_cvtpd_ps(updated));
+  }
+  curl_update_row_scalar(n - k, field + k, a + k, b + k, plus_1 + k,
+                         plus_2 + k, minus_1 + k, minus_2 + k);
+}
+
+__attribute__((target("avx512f"))) void
+curl_update_row_avx512(int n, double *field, const double *a, const double *b,
+                       const double *plus_1, const double *plus_2,
+                       const double *minus_1, const double *minus_2) {
+  int k = 0;
+  for (; k + 8 <= n; k += 8) {
+    __m512d curl = _mm512_add_pd(_mm512_loadu_pd(plus_1 + k),
+                                 _mm512_loadu_pd(plus_2 + k));
+    curl = _mm512_sub_pd(curl, _mm512_loadu_pd(minus_1 + k));
+    curl = _mm512_sub_pd(curl, _mm512_loadu_pd(minus_2 + k));
+    __m512d updated =
+            _mm512_add_pd(_mm512_mul_pd(_mm512_loadu_pd(a + k),
+                                        _mm512_loadu_pd(field + k)),
+                          _mm512_mul_pd(_mm512_loadu_pd(b + k), curl));
+    _mm512_storeu_pd(field + k, updated);
+  }
+  // the remainder is handled with a mask, rather than by the scalar kernel
+  if (k < n) {
+    __mmask8 mask = (__mmask8) ((1u << (n - k)) - 1u);
+    __m512d curl = _mm512_add_pd(_mm512_maskz_loadu_pd(mask, plus_1 + k),
+                                 _mm512_maskz_loadu_pd(mask, plus_2 + k));
+    curl = _mm512_sub_pd(curl, _mm512_maskz_loadu_pd(mask, minus_1 + k));
+    curl = _mm512_sub_pd(curl, _mm512_maskz_loadu_pd(mask, minus_2 + k));
+    __m512d updated = _mm512_add_pd(
+            _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a + k),
+                          _mm512_maskz_loadu_pd(mask, field + k)),
+            _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, b + k), curl));
+    _mm512_mask_storeu_pd(field + k, mask, updated);
+  }
+}
+
+__attribute__((target("avx512f"))) void
+curl_update_row_avx512(int n, float *field, const double *a, const double *b,
+                       const float *plus_1, const float *plus_2,
+                       const float *minus_1, const float *minus_2) {
+  // Eight elements at a time: the fields occupy the lower half of a 512-bit
+  // register, and are widened to fill a whole register of doubles
+  for (int k = 0; k < n; k += 8) {
+    int remaining = n - k < 8 ? n - k : 8;
+    __mmask8 mask = (__mmask8) ((1u << remaining) - 1u);
+    __m512 curl = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, plus_1 + k),
+                                _mm512_maskz_loadu_ps(mask, plus_2 + k));
+    curl = _mm512_sub_ps(curl, _mm512_maskz_loadu_ps(mask, minus_1 + k));
+    curl = _mm512_sub_ps(curl, _mm512_maskz_loadu_ps(mask, minus_2 + k));
+    __m256 old_field =
+            _mm512_castps512_ps256(_mm512_maskz_loadu_ps(mask, field + k));
+    __m512d updated = _mm512_add_pd(
+            _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a + k),
+                          _mm512_cvtps_pd(old_field)),
+            _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, b + k),
+                          _mm512_cvtps_pd(_mm512_castps512_ps256(curl))));
+    _mm512_mask_storeu_ps(field + k, mask,
+                          _mm512_castps256_ps512(_mm512_cvtpd_ps(updated)));
+  }
+}
+#endif
+
+}// namespace
+
+SimdLevel select_simd_level(bool cpu_has_avx2, bool cpu_has_avx512f) {
+#ifdef TDMS_X86_SIMD
+  if (cpu_has_avx512f) { return SimdLevel::AVX512; }
+  if (cpu_has_avx2) { return SimdLevel::AVX2; }
+#endif
+  return SimdLevel::SCALAR;
+}
+
+SimdLevel detected_simd_level() {
+#ifdef TDMS_X86_SIMD
+  __builtin_cpu_init();
+  return select_simd_level(__builtin_cpu_supports("avx2"),
+                           __builtin_cpu_supports("avx512f"));
+#else
+  return select_simd_level(false, false);
+#endif
+}
+
+std::string to_string(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::AVX512:
+      return "AVX-512";
+    case SimdLevel::AVX2:
+      return "AVX2";
+    default:
+      return "scalar";
+  }
+}
+
+template<typename T>
+CurlUpdateRow<T> curl_update_row_kernel(SimdLevel level) {
+#ifdef TDMS_X86_SIMD
+  switch (level) {
+    case SimdLevel::AVX512:
+      return curl_update_row_avx512;
+    case SimdLevel::AVX2:
+      return curl_update_row_avx2;
+    default:
+      break;
+  }
+#endif
+  return curl_update_row_scalar<T>;
+}
+
+template<typename T>
+void curl_update_row(int n, T *field, const double *a, const double *b,
+                     const T *plus_1, const T *plus_2, const T *minus_1,
+                     const T *minus_2) {
+  static const CurlUpdateRow<T> kernel = [] {
+    SimdLevel level = detected_simd_level();
+    spdlog::info("Using {} finite-difference stencil kernels",
+                 to_string(level));
+    return curl_update_row_kernel<T>(level);
+  }();
+  kernel(n, field, a, b, plus_1, plus_2, minus_1, minus_2);
+}
+
+template CurlUpdateRow<double> curl_update_row_kernel<double>(SimdLevel);
+template CurlUpdateRow<float> curl_update_row_kernel<float>(SimdLevel);
+template void curl_update_row<double>(int, double *, const double *,
+                                      const double *, const double *,
+                                      const double *, const double *,
+                                      const double *);
+template void curl_update_row<float>(int, float *, const double *,
+                                     const double *, const float *,
+                                     const float *, const float *,
+                                     const float *);
@@ -39,6 +39,19 @@ void SurfacePhasors::set_from_matlab_array(mxArray *mx_surface_vertices,
                                      dims[0], dims[1], dims[2]);
 }
 
+vector<complex<double>> SurfacePhasors::amplitudes() const {
+  vector<complex<double>> values;
+  values.reserve(f_ex_vector_size * 6 * n_surface_vertices);
+  for (int k = 0; k < f_ex_vector_size; k++) {
+    for (int j = 0; j < 6; j++) {
+      for (int i = 0; i < n_surface_vertices; i++) {
+        values.emplace_back(surface_EHr[k][j][i], surface_EHi[k][j][i]);
+      }
+    }
+  }
+  return values;
+}
+
 void SurfacePhasors::normalise_surface(int frequency_index,
                                        complex<double> Enorm,
                                        complex<double> Hnorm) {
@@ -71,14 +84,56 @@ void SurfacePhasors::normalise_surface(int frequency_index,
   }
 }
 
+FullFieldSnapshot SurfacePhasors::fields_at(int vertex_index,
+                                             ElectricSplitField &E,
+                                             MagneticSplitField &H,
+                                             Dimension dimension,
+                                             bool interpolate) {
+  CellCoordinate current_cell{surface_vertices[0][vertex_index],
+                              surface_vertices[1][vertex_index],
+                              surface_vertices[2][vertex_index]};
+  FullFieldSnapshot F;
+  if (!interpolate) {
+    F.Ex = E.x(current_cell);
+    F.Ey = E.y(current_cell);
+    F.Ez = E.z(current_cell);
+    F.Hx = H.x(current_cell);
+    F.Hy = H.y(current_cell);
+    F.Hz = H.z(current_cell);
+    return F;
+  }
+  switch (dimension) {
+    case Dimension::THREE:
+      F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      break;
+    case Dimension::TRANSVERSE_ELECTRIC:
+      F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      break;
+    case Dimension::TRANSVERSE_MAGNETIC:
+      F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      break;
+    default:
+      throw runtime_error("Dimension was not recognised!");
+      break;
+  }
+  return F;
+}
+
 void SurfacePhasors::extractPhasorsSurface(int frequency_index,
                                            ElectricSplitField &E,
                                            MagneticSplitField &H, int n,
                                            double omega, int Nt,
                                            SimulationParameters &params,
                                            bool interpolate) {
-  int vindex;
-  FullFieldSnapshot F;
   complex<double> phaseTermE, phaseTermH, cphaseTermE, cphaseTermH;
 
   phaseTermE = fmod(omega * ((double) n) * params.dt, 2 * DCPI);
@@ -87,7 +142,6 @@ void SurfacePhasors::extractPhasorsSurface(int frequency_index,
   cphaseTermH = exp(phaseTermH * IMAGINARY_UNIT) * 1. / ((double) Nt);
   cphaseTermE = exp(phaseTermE * IMAGINARY_UNIT) * 1. / ((double) Nt);
 
-  // loop over every vertex in the list
   /* Loop over every vertex in the surface.
 
   Since the value of the phasors at each vertex is entirely determined from the
@@ -95,65 +149,93 @@ void SurfacePhasors::extractPhasorsSurface(int frequency_index,
   the computation of the phasors is independent of one another. Ergo, we use a
   parallel loop.
   */
-#pragma omp parallel default(shared) private(F, phaseTermE, phaseTermH, vindex)
-  {
+#pragma omp for
+  for (int vindex = 0; vindex < n_surface_vertices; vindex++) {
+    FullFieldSnapshot F =
+            fields_at(vindex, E, H, params.dimension, interpolate);
+    // multiply by phase factors
+    F.multiply_E_by(cphaseTermE);
+    F.multiply_H_by(cphaseTermH);
+
+    // update the master arrays
+    update_surface_EH(frequency_index, vindex, F);
+  }
+}
+
+void SurfacePhasors::compile_probes(ElectricSplitField &E,
+                                    MagneticSplitField &H,
+                                    Dimension dimension, bool interpolate,
+                                    const GridPartition *partition) {
+  E_probes.clear();
+  H_probes.clear();
+  E_probes.distribute(partition);
+  H_probes.distribute(partition);
+  for (int vindex = 0; vindex < n_surface_vertices; vindex++) {
+    CellCoordinate cell{surface_vertices[0][vindex],
+                        surface_vertices[1][vindex],
+                        surface_vertices[2][vindex]};
     if (interpolate) {
+      add_centre_probes(E_probes, H_probes, E, H, dimension, cell);
+    } else {
+      for (AxialDirection d : {AxialDirection::X, AxialDirection::Y,
+                               AxialDirection::Z}) {
+        E_probes.add_value(E, d, cell);
+        H_probes.add_value(H, d, cell);
+      }
+    }
+  }
+}
+
+void SurfacePhasors::extractPhasorsSurface(ElectricSplitField &E,
+                                           MagneticSplitField &H, int n,
+                                           const vector<double> &frequencies,
+                                           int Nt,
+                                           SimulationParameters &params,
+                                           bool interpolate) {
+  // The phase terms of every frequency, computed by each thread so that no
+  // synchronisation is needed before the vertices are shared out
+  int n_frequencies = frequencies.size();
+  vector<complex<double>> cphaseTermE(n_frequencies),
+          cphaseTermH(n_frequencies);
+  for (int ifx = 0; ifx < n_frequencies; ifx++) {
+    double omega = frequencies[ifx] * 2 * DCPI;
+    double phaseTermE = fmod(omega * ((double) n) * params.dt, 2 * DCPI);
+    double phaseTermH = fmod(omega * ((double) n + 0.5) * params.dt, 2 * DCPI);
+    cphaseTermE[ifx] = exp(phaseTermE * IMAGINARY_UNIT) * 1. / ((double) Nt);
+    cphaseTermH[ifx] = exp(phaseTermH * IMAGINARY_UNIT) * 1. / ((double) Nt);
+  }
+
+  bool compiled = !E_probes.empty();
+  if (compiled) {
+    E_probes.evaluate(E);
+    H_probes.evaluate(H);
+  }
+
 #pragma omp for
-      for (vindex = 0; vindex < n_surface_vertices; vindex++) {
-        CellCoordinate current_cell{surface_vertices[0][vindex],
-                                    surface_vertices[1][vindex],
-                                    surface_vertices[2][vindex]};
-        switch (params.dimension) {
-          case Dimension::THREE:
-            F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
-            F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-            F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-            F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
-            F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-            F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-            break;
-          case Dimension::TRANSVERSE_ELECTRIC:
-            F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
-            F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-            F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-            break;
-          case Dimension::TRANSVERSE_MAGNETIC:
-            F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-            F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
-            F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-            break;
-          default:
-            throw runtime_error("Dimension was not recognised!");
-            break;
-        }
-        // multiply by phase factors
-        F.multiply_E_by(cphaseTermE);
-        F.multiply_H_by(cphaseTermH);
-
-        // update the master arrays
-        update_surface_EH(frequency_index, vindex, F);
+  for (int vindex = 0; vindex < n_surface_vertices; vindex++) {
+    complex<double> fields[6];
+    if (compiled) {
+      for (int component = 0; component < 3; component++) {
+        fields[component] = E_probes.value(3 * vindex + component);
+        fields[component + 3] = H_probes.value(3 * vindex + component);
       }
     } else {
-#pragma omp for
-      for (vindex = 0; vindex < n_surface_vertices; vindex++) {
-        CellCoordinate current_cell{surface_vertices[0][vindex],
-                                    surface_vertices[1][vindex],
-                                    surface_vertices[2][vindex]};
-
-        F.Ex = E.xy[current_cell] + E.xz[current_cell];
-        F.Ey = E.yx[current_cell] + E.yz[current_cell];
-        F.Ez = E.zx[current_cell] + E.zy[current_cell];
-        F.Hx = H.xy[current_cell] + H.xz[current_cell];
-        F.Hy = H.yx[current_cell] + H.yz[current_cell];
-        F.Hz = H.zx[current_cell] + H.zy[current_cell];
-        // multiply by phase factors
-        F.multiply_E_by(cphaseTermE);
-        F.multiply_H_by(cphaseTermH);
-
-        // update the master arrays
-        update_surface_EH(frequency_index, vindex, F);
+      FullFieldSnapshot F =
+              fields_at(vindex, E, H, params.dimension, interpolate);
+      for (int component = 0; component < 6; component++) {
+        fields[component] = F[component];
       }
-    }// end parallel region
+    }
+
+    for (int ifx = 0; ifx < n_frequencies; ifx++) {
+      for (int component = 0; component < 6; component++) {
+        const complex<double> &phase_term =
+                component < 3 ? cphaseTermE[ifx] : cphaseTermH[ifx];
+        complex<double> phasor = fields[component] * phase_term;
+        surface_EHr[ifx][component][vindex] += phasor.real();
+        surface_EHi[ifx][component][vindex] += phasor.imag();
+      }
+    }
   }
 }
 
@@ -82,13 +82,44 @@ void VertexPhasors::setup_complex_amplitude_arrays(int n_frequencies) {
   }
 }
 
+FullFieldSnapshot VertexPhasors::fields_at(int vertex_index,
+                                            ElectricSplitField &E,
+                                            MagneticSplitField &H,
+                                            Dimension dimension) {
+  CellCoordinate current_cell = vertices.index_in_row(vertex_index);
+  FullFieldSnapshot F;
+
+  switch (dimension) {
+    case Dimension::THREE:
+      F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      break;
+    case Dimension::TRANSVERSE_ELECTRIC:
+      F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      break;
+    case Dimension::TRANSVERSE_MAGNETIC:
+      F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
+      F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
+      F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
+      break;
+    default:
+      throw runtime_error("Dimension was not recognised!");
+      break;
+  }
+  return F;
+}
+
 void VertexPhasors::extractPhasorsVertices(int frequency_index,
                                            ElectricSplitField &E,
                                            MagneticSplitField &H, int n,
                                            double omega,
                                            SimulationParameters &params) {
-  int vindex;
-  FullFieldSnapshot F;
   complex<double> phaseTermE, phaseTermH, cphaseTermE, cphaseTermH;
 
   phaseTermE = fmod(omega * ((double) n) * params.dt, 2 * DCPI);
@@ -104,43 +135,98 @@ void VertexPhasors::extractPhasorsVertices(int frequency_index,
   the computation of the phasors is independent of one another. Ergo, we use a
   parallel loop.
   */
-#pragma omp parallel default(shared) private(F, vindex)
-  {
 #pragma omp for
-    for (vindex = 0; vindex < n_vertices(); vindex++) {// loop over every vertex
-      CellCoordinate current_cell = vertices.index_in_row(vindex);
-
-      switch (params.dimension) {
-        case Dimension::THREE:
-          F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
-          F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-          F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-          F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
-          F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-          F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-          break;
-        case Dimension::TRANSVERSE_ELECTRIC:
-          F.Ex = E.interpolate_to_centre_of(AxialDirection::X, current_cell);
-          F.Ey = E.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-          F.Hz = H.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-          break;
-        case Dimension::TRANSVERSE_MAGNETIC:
-          F.Ez = E.interpolate_to_centre_of(AxialDirection::Z, current_cell);
-          F.Hx = H.interpolate_to_centre_of(AxialDirection::X, current_cell);
-          F.Hy = H.interpolate_to_centre_of(AxialDirection::Y, current_cell);
-          break;
-        default:
-          throw runtime_error("Dimension was not recognised!");
-          break;
+  // loop over every vertex
+  for (int vindex = 0; vindex < n_vertices(); vindex++) {
+    FullFieldSnapshot F = fields_at(vindex, E, H, params.dimension);
+    // multiply by phasor factors
+    F.multiply_E_by(cphaseTermE);
+    F.multiply_H_by(cphaseTermH);
+
+    // update the master arrays
+    update_vertex_camplitudes(frequency_index, vindex, F);
+  }
+}
+
+void VertexPhasors::compile_probes(ElectricSplitField &E,
+                                   MagneticSplitField &H,
+                                   Dimension dimension,
+                                   const GridPartition *partition) {
+  E_probes.clear();
+  H_probes.clear();
+  E_probes.distribute(partition);
+  H_probes.distribute(partition);
+  for (int vindex = 0; vindex < n_vertices(); vindex++) {
+    add_centre_probes(E_probes, H_probes, E, H, dimension,
+                      vertices.index_in_row(vindex));
+  }
+}
+
+void VertexPhasors::extractPhasorsVertices(ElectricSplitField &E,
+                                           MagneticSplitField &H, int n,
+                                           const vector<double> &frequencies,
+                                           SimulationParameters &params) {
+  // The phase terms of every frequency, computed by each thread so that no
+  // synchronisation is needed before the vertices are shared out
+  int n_frequencies = frequencies.size();
+  vector<complex<double>> cphaseTermE(n_frequencies),
+          cphaseTermH(n_frequencies);
+  for (int ifx = 0; ifx < n_frequencies; ifx++) {
+    double omega = frequencies[ifx] * 2 * DCPI;
+    double phaseTermE = fmod(omega * ((double) n) * params.dt, 2 * DCPI);
+    double phaseTermH = fmod(omega * ((double) n + 0.5) * params.dt, 2 * DCPI);
+    cphaseTermE[ifx] =
+            exp(phaseTermE * IMAGINARY_UNIT) * 1. / ((double) params.Npe);
+    cphaseTermH[ifx] =
+            exp(phaseTermH * IMAGINARY_UNIT) * 1. / ((double) params.Npe);
+  }
+
+  // The position in camplitudes{R,I} of each requested component, and its
+  // index in a FullFieldSnapshot
+  vector<int> camplitude_index, snapshot_index;
+  for (int component_id = FieldComponents::Ex;
+       component_id <= FieldComponents::Hz; component_id++) {
+    int idx = tdms_vector_utils::index(components, component_id);
+    if (idx >= 0) {
+      camplitude_index.push_back(idx);
+      snapshot_index.push_back(component_id - 1);
+    }
+  }
+  int n_requested = camplitude_index.size();
+
+  bool compiled = !E_probes.empty();
+  if (compiled) {
+    E_probes.evaluate(E);
+    H_probes.evaluate(H);
+  }
+
+#pragma omp for
+  for (int vindex = 0; vindex < n_vertices(); vindex++) {
+    complex<double> fields[6];
+    if (compiled) {
+      for (int c = 0; c < n_requested; c++) {
+        int component = snapshot_index[c];
+        fields[c] = component < 3
+                            ? E_probes.value(3 * vindex + component)
+                            : H_probes.value(3 * vindex + component - 3);
+      }
+    } else {
+      FullFieldSnapshot F = fields_at(vindex, E, H, params.dimension);
+      for (int c = 0; c < n_requested; c++) {
+        fields[c] = F[snapshot_index[c]];
       }
-      // multiply by phasor factors
-      F.multiply_E_by(cphaseTermE);
-      F.multiply_H_by(cphaseTermH);
+    }
 
-      // update the master arrays
-      update_vertex_camplitudes(frequency_index, vindex, F);
+    for (int ifx = 0; ifx < n_frequencies; ifx++) {
+      for (int c = 0; c < n_requested; c++) {
+        const complex<double> &phase_term =
+                snapshot_index[c] < 3 ? cphaseTermE[ifx] : cphaseTermH[ifx];
+        complex<double> phasor = fields[c] * phase_term;
+        camplitudesR[ifx][camplitude_index[c]][vindex] += phasor.real();
+        camplitudesI[ifx][camplitude_index[c]][vindex] += phasor.imag();
+      }
     }
-  }// end parallel region
+  }
 }
 
 void VertexPhasors::update_vertex_camplitudes(int frequency_index,
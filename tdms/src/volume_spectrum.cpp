@@ -0,0 +1,173 @@
+#include "volume_spectrum.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "globals.h"
+
+using namespace std;
+using tdms_math_constants::DCPI, tdms_math_constants::IMAGINARY_UNIT;
+
+void VolumeSpectrum::allocate(const Field &F, const vector<double> &frequencies,
+                              double dt, int interval, int Nt) {
+  omega_.clear();
+  for (double f : frequencies) { omega_.push_back(2. * DCPI * f); }
+  dt_ = dt;
+  interval_ = interval;
+  Nt_ = Nt;
+  box_ = {{F.il, F.jl, F.kl}, {F.iu + 1, F.ju + 1, F.ku + 1}};
+
+  int n_f = n_frequencies();
+  E_phase_.assign(n_f, 0.);
+  rotation_.resize(n_f);
+  half_step_.resize(n_f);
+  for (int f = 0; f < n_f; f++) {
+    rotation_[f] = exp(omega_[f] * interval_ * dt_ * IMAGINARY_UNIT);
+    half_step_[f] = exp(omega_[f] * dt_ / 2. * IMAGINARY_UNIT);
+  }
+  for (int field = 0; field < 2; field++) {
+    phase_real_[field].assign(n_f, 0.);
+    phase_imag_[field].assign(n_f, 0.);
+  }
+  last_tind_ = -1;
+  n_rotations_ = 0;
+
+  size_t n_phasors = (size_t) box_.n_cells() * n_f;
+  for (int c = 0; c < 6; c++) {
+    real_[c].assign(n_phasors, 0.);
+    imag_[c].assign(n_phasors, 0.);
+  }
+}
+
+void VolumeSpectrum::set_phase_terms(int tind) {
+  // the phases of consecutive extractions differ by a fixed rotation, which
+  // is rounded at each step, so every so often they are recomputed
+  bool rotate =
+          tind == last_tind_ + interval_ && n_rotations_ < RESEED_INTERVAL;
+  for (int f = 0; f < n_frequencies(); f++) {
+    if (rotate) {
+      E_phase_[f] *= rotation_[f];
+    } else {
+      E_phase_[f] = exp(fmod(omega_[f] * tind * dt_, 2 * DCPI) *
+                        IMAGINARY_UNIT) /
+                    ((double) Nt_);
+    }
+    complex<double> H_phase = E_phase_[f] * half_step_[f];
+    phase_real_[0][f] = E_phase_[f].real();
+    phase_imag_[0][f] = E_phase_[f].imag();
+    phase_real_[1][f] = H_phase.real();
+    phase_imag_[1][f] = H_phase.imag();
+  }
+  n_rotations_ = rotate ? n_rotations_ + 1 : 0;
+  last_tind_ = tind;
+}
+
+void VolumeSpectrum::extract(const ElectricSplitField &E,
+                             const MagneticSplitField &H, int tind) {
+  extract(E, H, tind, box_);
+}
+
+void VolumeSpectrum::extract(const ElectricSplitField &E,
+                             const MagneticSplitField &H, int tind,
+                             const CellBox &cells) {
+#pragma omp single
+  set_phase_terms(tind);
+
+  CellBox box = box_.intersection(cells);
+  int n_f = n_frequencies();
+#pragma omp for collapse(2)
+  for (int i = box.lower.i; i < box.upper.i; i++) {
+    for (int j = box.lower.j; j < box.upper.j; j++) {
+      for (int k = box.lower.k; k < box.upper.k; k++) {
+        double fields[6] = {E.x(i, j, k), E.y(i, j, k), E.z(i, j, k),
+                            H.x(i, j, k), H.y(i, j, k), H.z(i, j, k)};
+        size_t cell = index_of(i, j, k);
+        for (int c = 0; c < 6; c++) {
+          const double *phase_real = phase_real_[c / 3].data(),
+                       *phase_imag = phase_imag_[c / 3].data();
+          double *real = real_[c].data() + cell, *imag = imag_[c].data() + cell;
+          double value = fields[c];
+#pragma omp simd
+          for (int f = 0; f < n_f; f++) {
+            real[f] += value * phase_real[f];
+            imag[f] += value * phase_imag[f];
+          }
+        }
+      }
+    }
+  }
+}
+
+void VolumeSpectrum::gather_to_root(const GridPartition &partition,
+                                    const CellBox &cells) {
+  vector<double> phasors;
+  for (int c = 0; c < 6; c++) {
+    phasors.insert(phasors.end(), real_[c].begin(), real_[c].end());
+    phasors.insert(phasors.end(), imag_[c].begin(), imag_[c].end());
+  }
+  vector<double> gathered = partition.gather_to_root(phasors);
+  if (!partition.is_root()) { return; }
+
+  box_ = cells;
+  size_t n_phasors = (size_t) box_.n_cells() * n_frequencies();
+  for (int c = 0; c < 6; c++) {
+    real_[c].assign(n_phasors, 0.);
+    imag_[c].assign(n_phasors, 0.);
+  }
+  // the phasors of a row of cells along k are contiguous, in the storage of
+  // each process as in the whole
+  const double *value = gathered.data();
+  for (int process = 0; process < partition.n_processes(); process++) {
+    CellBox block = cells.intersection(partition.owned_by(process));
+    if (block.empty()) { continue; }
+    size_t n_row = (size_t) (block.upper.k - block.lower.k) * n_frequencies();
+    for (int c = 0; c < 6; c++) {
+      for (vector<double> *part : {&real_[c], &imag_[c]}) {
+        for (int i = block.lower.i; i < block.upper.i; i++) {
+          for (int j = block.lower.j; j < block.upper.j; j++, value += n_row) {
+            copy(value, value + n_row,
+                 part->data() + index_of(i, j, block.lower.k));
+          }
+        }
+      }
+    }
+  }
+}
+
+void VolumeSpectrum::normalise(const vector<complex<double>> &E_norm,
+                               const vector<complex<double>> &H_norm) {
+  int n_f = n_frequencies();
+  size_t n_cells = box_.n_cells();
+  for (int c = 0; c < 6; c++) {
+    const vector<complex<double>> &norm = c < 3 ? E_norm : H_norm;
+#pragma omp parallel for
+    for (long long cell = 0; cell < (long long) n_cells; cell++) {
+      for (int f = 0; f < n_f; f++) {
+        size_t index = cell * n_f + f;
+        complex<double> value =
+                complex<double>(real_[c][index], imag_[c][index]) / norm[f];
+        real_[c][index] = value.real();
+        imag_[c][index] = value.imag();
+      }
+    }
+  }
+}
+
+void VolumeSpectrum::copy_to(int component, double *real, double *imag) const {
+  int n_i = box_.upper.i - box_.lower.i, n_j = box_.upper.j - box_.lower.j,
+      n_k = box_.upper.k - box_.lower.k, n_f = n_frequencies();
+  for (int f = 0; f < n_f; f++) {
+    for (int k = 0; k < n_k; k++) {
+      for (int j = 0; j < n_j; j++) {
+        for (int i = 0; i < n_i; i++) {
+          size_t out = (((size_t) f * n_k + k) * n_j + j) * n_i + i;
+          size_t index = index_of(box_.lower.i + i, box_.lower.j + j,
+                                  box_.lower.k + k) +
+                         f;
+          real[out] = real_[component][index];
+          imag[out] = imag_[component][index];
+        }
+      }
+    }
+  }
+}
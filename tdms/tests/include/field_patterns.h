@@ -0,0 +1,79 @@
+/**
+ * @file field_patterns.h
+ * @brief Patterns to fill fields with in unit tests
+ */
+#pragma once
+
+#include "field.h"
+
+namespace tdms_tests {
+
+/**
+ * @brief The value of the test pattern of a component at cell (i, j, k).
+ *
+ * Each component has a different pattern, which varies along every axis and
+ * is well away from zero (on grids of up to 20 cells a side), so that values
+ * interpolated from it can be compared relatively.
+ *
+ * @param c Index of the component
+ * @param i,j,k Cell
+ */
+inline double pattern_value(int c, int i, int j, int k) {
+  return 10. + c + 0.3 * i - 0.2 * j + 0.1 * (c % 3) * k + 0.01 * i * j * k;
+}
+
+/**
+ * @brief Set every stored split component of F to the pattern, multiplied by
+ * scale. The components xy to zy are patterns first_component to
+ * first_component + 5.
+ */
+inline void set_pattern(SplitField &F, double scale = 1.,
+                        int first_component = 0) {
+  SplitFieldComponent *components[6] = {&F.xy, &F.xz, &F.yx,
+                                        &F.yz, &F.zx, &F.zy};
+  for (int c = 0; c < 6; c++) {
+    SplitFieldComponent &component = *components[c];
+    if (!component.has_elements()) { continue; }
+    int pattern = first_component + c;
+    for (int i = 0; i <= F.tot.i; i++) {
+      for (int j = 0; j <= F.tot.j; j++) {
+        for (int k = 0; k <= F.tot.k; k++) {
+          if (!component.stores(i, j, k)) { continue; }
+          component.at(i, j, k) =
+                  (field_t) (scale * pattern_value(pattern, i, j, k));
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Set the split fields E and H to the pattern, multiplied by scale,
+ * with a different pattern for each of their twelve components
+ */
+inline void set_pattern(ElectricSplitField &E, MagneticSplitField &H,
+                        double scale = 1.) {
+  set_pattern(E, scale, 0);
+  set_pattern(H, scale, 6);
+}
+
+/**
+ * @brief Set the phasors of F to the pattern, multiplied by scale. The real
+ * parts of x, y, z are patterns 0 to 2, and the imaginary parts 3 to 5.
+ */
+inline void set_pattern(Field &F, double scale = 1.) {
+  const char directions[3] = {'x', 'y', 'z'};
+  for (int c = 0; c < 3; c++) {
+    double ***real = F.real[directions[c]], ***imag = F.imag[directions[c]];
+    for (int k = 0; k < F.tot.k; k++) {
+      for (int j = 0; j < F.tot.j; j++) {
+        for (int i = 0; i < F.tot.i; i++) {
+          real[k][j][i] = scale * pattern_value(c, i, j, k);
+          imag[k][j][i] = scale * pattern_value(c + 3, i, j, k);
+        }
+      }
+    }
+  }
+}
+
+}// namespace tdms_tests
@@ -0,0 +1,342 @@
+/**
+ * @file small_simulation.h
+ * @brief The inputs of a small simulation, which unit tests can run a
+ * SimulationManager on.
+ *
+ * The input file of TDMS holds MATLAB arrays, which are read by the MATLAB
+ * API, and the material constants, interfaces, and frequencies, which are read
+ * by HDF5Reader. The inputs are built the same way: the MATLAB arrays in
+ * memory, and the rest in an HDF5 file in a temporary directory.
+ */
+#pragma once
+
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <H5Cpp.h>
+
+#include "cell_coordinate.h"
+#include "globals.h"
+#include "input_matrices.h"
+#include "input_output_names.h"
+#include "mat_io.h"
+#include "unit_test_utils.h"
+
+namespace tdms_tests {
+
+/** @brief The features of a SmallSimulation */
+struct SmallSimulationSetup {
+  /*! The number of Yee cells, (I_tot, J_tot, K_tot) */
+  IJKDimensions n_cells = {14, 12, 10};
+  /*! The thickness, in cells, of the PML on every face of the grid */
+  int pml = 2;
+  /*! The number of timesteps (a whole number of the 24 in three periods of
+   * the steady-state source) */
+  int Nt = 24;
+  /*! Whether the scatterer is dispersive */
+  bool dispersive = false;
+  /*! Whether the background is conductive */
+  bool conductive = false;
+  /*! Whether fdtdgrid is left unloaded, so that the materials are read from
+   * the HDF5 file a block at a time */
+  bool grid_in_file = false;
+};
+
+/**
+ * @brief A steady-state simulation of a box-shaped scatterer in a small grid,
+ * lit by sources on the I0 and K0 planes of the total-field region, that
+ * extracts the volume phasors.
+ *
+ * The coefficients vary across the PML, so that each split component of a
+ * cell there is updated differently, and are isotropic outside it. The grid
+ * spacing and timestep are 1, and the source has a period of 8 timesteps.
+ */
+class SmallSimulation {
+private:
+  /*! Directory of the HDF5 file */
+  std::filesystem::path directory_;
+  /*! The MATLAB arrays, and the name of the HDF5 file */
+  InputMatrices matrices_;
+  /*! The MATLAB arrays that matrices_ points to, which we own */
+  std::vector<mxArray *> arrays_;
+
+  SmallSimulationSetup setup_;
+  /*! The interfaces of the total-field region, {I0, I1, J0, J1, K0, K1} */
+  int interface_[6];
+  /*! The cells of the scatterer */
+  CellBox scatterer_;
+
+  /** @brief Own array, and make it the input of the given name */
+  void set(const std::string &name, mxArray *array) {
+    arrays_.push_back(array);
+    matrices_.set_matrix_pointer(name, array);
+  }
+
+  /** @brief A 1-by-n row vector of values */
+  static mxArray *row(const std::vector<double> &values) {
+    mxArray *array = mxCreateDoubleMatrix(1, values.size(), mxREAL);
+    std::copy(values.begin(), values.end(), mxGetPr(array));
+    return array;
+  }
+
+  /** @brief An empty 0-by-0 array */
+  static mxArray *empty() { return mxCreateDoubleMatrix(0, 0, mxREAL); }
+
+  /** @brief A struct whose fields are the given arrays */
+  static mxArray *
+  structure(const std::vector<std::pair<const char *, mxArray *>> &fields) {
+    std::vector<const char *> names;
+    for (const auto &field : fields) { names.push_back(field.first); }
+    mxArray *array =
+            mxCreateStructMatrix(1, 1, (int) names.size(), names.data());
+    for (const auto &field : fields) {
+      mxSetField(array, 0, field.first, field.second);
+    }
+    return array;
+  }
+
+  /** @brief A complex 8-by-n1-by-n2 source, which varies over its plane */
+  static mxArray *source(int n1, int n2) {
+    int dims[3] = {8, n1, n2};
+    mxArray *array = mxCreateNumericArray(3, (const mwSize *) dims,
+                                          mxDOUBLE_CLASS, mxCOMPLEX);
+    double *real = mxGetPr(array), *imag = mxGetPi(array);
+    for (int n = 0; n < 8 * n1 * n2; n++) {
+      real[n] = std::sin(0.3 * n + 0.1);
+      imag[n] = std::cos(0.7 * n + 0.2);
+    }
+    return array;
+  }
+
+  /** @brief Write a vector of values to a dataset of group */
+  static void write(H5::Group &group, const std::string &name,
+                    const std::vector<double> &values) {
+    hsize_t length = values.size();
+    H5::DataSpace space(1, &length);
+    H5::DataSet dataset =
+            group.createDataSet(name, H5::PredType::NATIVE_DOUBLE, space);
+    dataset.write(values.data(), H5::PredType::NATIVE_DOUBLE);
+  }
+
+  /** @brief Whether cell i of an axis of n cells is in the PML */
+  bool in_pml(int i, int n) const {
+    return i < setup_.pml || i > n - setup_.pml;
+  }
+
+  /**
+   * @brief The background coefficients along an axis of n cells: interior
+   * is used outside the PML, and values that vary from cell to cell inside
+   */
+  std::vector<double> along_axis(int n, double interior) const {
+    std::vector<double> values(n + 1, interior);
+    for (int i = 0; i <= n; i++) {
+      if (in_pml(i, n)) { values[i] = interior * (0.8 + 0.03 * (i % 4)); }
+    }
+    return values;
+  }
+
+  /** @brief Write the contents of the input file that HDF5Reader reads */
+  void write_input_file() {
+    const IJKDimensions &n = setup_.n_cells;
+    H5::H5File file(matrices_.input_filename, H5F_ACC_TRUNC);
+    H5::Group root = file.openGroup("/");
+
+    // background coefficients, which differ between the components in the PML
+    // only, so that the fields may be stored unsplit outside it
+    H5::Group C = file.createGroup("C");
+    write(C, "Cax", along_axis(n.i, 1.));
+    write(C, "Cay", along_axis(n.j, 1.));
+    write(C, "Caz", along_axis(n.k, 1.));
+    write(C, "Cbx", along_axis(n.i, 0.4));
+    write(C, "Cby", along_axis(n.j, 0.4));
+    write(C, "Cbz", along_axis(n.k, 0.4));
+    H5::Group D = file.createGroup("D");
+    write(D, "Dax", along_axis(n.i, 1.));
+    write(D, "Day", along_axis(n.j, 1.));
+    write(D, "Daz", along_axis(n.k, 1.));
+    write(D, "Dbx", along_axis(n.i, 0.4));
+    write(D, "Dby", along_axis(n.j, 0.4));
+    write(D, "Dbz", along_axis(n.k, 0.4));
+
+    // the coefficients of the scatterer, material 1
+    double Cc = setup_.dispersive ? 0.05 : 0.;
+    H5::Group Cmaterial = file.createGroup("Cmaterial");
+    for (const char *axis : {"x", "y", "z"}) {
+      write(Cmaterial, std::string("Ca") + axis, {0.7});
+      write(Cmaterial, std::string("Cb") + axis, {0.25});
+      write(Cmaterial, std::string("Cc") + axis, {Cc});
+    }
+    H5::Group Dmaterial = file.createGroup("Dmaterial");
+    for (const char *axis : {"x", "y", "z"}) {
+      write(Dmaterial, std::string("Da") + axis, {1.});
+      write(Dmaterial, std::string("Db") + axis, {0.3});
+    }
+
+    // the interfaces of the total-field region, indexed from 1, and whether
+    // a source is applied there
+    H5::Group interface = file.createGroup("interface");
+    const char *planes[6] = {"I0", "I1", "J0", "J1", "K0", "K1"};
+    for (int p = 0; p < 6; p++) {
+      bool apply = p == 0 || p == 4;
+      write(interface, planes[p], {interface_[p] + 1., apply ? 1. : 0.});
+    }
+
+    // the background is not dispersive, and may be conductive
+    H5::Group dispersive_aux = file.createGroup("dispersive_aux");
+    write(dispersive_aux, "alpha", std::vector<double>(n.k + 1, 0.));
+    write(dispersive_aux, "beta", std::vector<double>(n.k + 1, 0.));
+    write(dispersive_aux, "gamma", std::vector<double>(n.k + 1, 0.));
+    write(dispersive_aux, "kappa_x", std::vector<double>(n.i + 1, 1.));
+    write(dispersive_aux, "kappa_y", std::vector<double>(n.j + 1, 1.));
+    write(dispersive_aux, "kappa_z", std::vector<double>(n.k + 1, 1.));
+    write(dispersive_aux, "sigma_x", std::vector<double>(n.i + 1, 0.));
+    write(dispersive_aux, "sigma_y", std::vector<double>(n.j + 1, 0.));
+    write(dispersive_aux, "sigma_z", std::vector<double>(n.k + 1, 0.));
+    double rho = setup_.conductive ? 0.01 : 0.;
+    H5::Group conductive_aux = file.createGroup("conductive_aux");
+    write(conductive_aux, "rho_x", std::vector<double>(n.i + 1, rho));
+    write(conductive_aux, "rho_y", std::vector<double>(n.j + 1, rho));
+    write(conductive_aux, "rho_z", std::vector<double>(n.k + 1, rho));
+
+    // the phasors are extracted at the frequency of the source
+    write(root, "f_ex_vec", {1. / 8.});
+
+    // the materials of fdtdgrid, with their dimensions reversed as MATLAB
+    // stores them
+    hsize_t dims[3] = {(hsize_t) n.k + 1, (hsize_t) n.j + 1,
+                       (hsize_t) n.i + 1};
+    std::vector<uint8_t> materials(dims[0] * dims[1] * dims[2]);
+    for (int k = 0; k <= n.k; k++) {
+      for (int j = 0; j <= n.j; j++) {
+        for (int i = 0; i <= n.i; i++) {
+          materials[i + dims[2] * (j + dims[1] * k)] =
+                  scatterer_.contains(i, j, k) ? 1 : 0;
+        }
+      }
+    }
+    H5::Group fdtdgrid = file.createGroup("fdtdgrid");
+    H5::DataSet dataset = fdtdgrid.createDataSet(
+            "materials", H5::PredType::NATIVE_UINT8, H5::DataSpace(3, dims));
+    dataset.write(materials.data(), H5::PredType::NATIVE_UINT8);
+  }
+
+  /** @brief The grid, which holds the materials of the cells */
+  mxArray *fdtdgrid() const {
+    const IJKDimensions &n = setup_.n_cells;
+    int dims[3] = {n.i + 1, n.j + 1, n.k + 1};
+    const char *names[1] = {"materials"};
+    mxArray *grid = mxCreateStructMatrix(1, 1, 1, names);
+    mxArray *materials = mxCreateNumericArray(3, (const mwSize *) dims,
+                                              mxUINT8_CLASS, mxREAL);
+    auto *material = (uint8_t *) mxGetData(materials);
+    for (int k = 0; k <= n.k; k++) {
+      for (int j = 0; j <= n.j; j++) {
+        for (int i = 0; i <= n.i; i++) {
+          material[i + dims[0] * (j + dims[1] * k)] =
+                  scatterer_.contains(i, j, k) ? 1 : 0;
+        }
+      }
+    }
+    mxSetField(grid, 0, names[0], materials);
+    return grid;
+  }
+
+  /** @brief Create the MATLAB arrays of the input */
+  void set_matrices() {
+    const IJKDimensions &n = setup_.n_cells;
+    // the inputs that are read from the HDF5 file are left empty
+    for (const std::string &name :
+         tdms_matrix_names::matrixnames_input_with_grid) {
+      set(name, empty());
+    }
+
+    if (setup_.grid_in_file) {
+      matrices_.set_matrix_pointer("fdtdgrid", nullptr);
+    } else {
+      set("fdtdgrid", fdtdgrid());
+    }
+    set("delta", structure({{"x", row({1.})}, {"y", row({1.})},
+                            {"z", row({1.})}}));
+    set("freespace", structure({{"Cbx", row({0.4})}}));
+    double gamma = setup_.dispersive ? 0.05 : 0.;
+    set("disp_params", structure({{"alpha", row({0.2})},
+                                  {"beta", row({0.1})},
+                                  {"gamma", row({gamma})}}));
+    std::vector<double> x(n.i + 1), y(n.j + 1), z(n.k + 1);
+    for (int i = 0; i <= n.i; i++) { x[i] = i; }
+    for (int j = 0; j <= n.j; j++) { y[j] = j; }
+    for (int k = 0; k <= n.k; k++) { z[k] = k; }
+    set("grid_labels", structure({{"x_grid_labels", row(x)},
+                                  {"y_grid_labels", row(y)},
+                                  {"z_grid_labels", row(z)}}));
+    set("tdfield", structure({{"exi", empty()}, {"eyi", empty()}}));
+
+    set("omega_an", mxCreateDoubleScalar(2. * DCPI / 8.));
+    set("to_l", mxCreateDoubleScalar(8.));
+    set("hwhm", mxCreateDoubleScalar(4.));
+    for (const char *name : {"Dxl", "Dxu", "Dyl", "Dyu", "Dzl", "Dzu"}) {
+      set(name, mxCreateDoubleScalar(setup_.pml));
+    }
+    set("Nt", mxCreateDoubleScalar(setup_.Nt));
+    set("dt", mxCreateDoubleScalar(1.));
+    set("tind", mxCreateDoubleScalar(0.));
+    set("sourcemode", mxCreateString("steadystate"));
+    set("runmode", mxCreateString("complete"));
+    set("exphasorsvolume", mxCreateDoubleScalar(1.));
+    set("exphasorssurface", mxCreateDoubleScalar(0.));
+    set("intphasorssurface", mxCreateDoubleScalar(0.));
+    set("intmatprops", mxCreateDoubleScalar(1.));
+    set("phasorinc", row({1., 1., 1.}));
+    set("dimension", mxCreateString("3"));
+    set("exdetintegral", mxCreateDoubleScalar(0.));
+    set("tdfdir", mxCreateString(""));
+
+    // sources on the I0 and K0 planes
+    int n_i = interface_[1] - interface_[0] + 1,
+        n_j = interface_[3] - interface_[2] + 1,
+        n_k = interface_[5] - interface_[4] + 1;
+    set("Isource", source(n_j, n_k));
+    set("Ksource", source(n_i, n_j));
+
+    set("fieldsample", structure({{"i", empty()},
+                                  {"j", empty()},
+                                  {"k", empty()},
+                                  {"n", empty()}}));
+    set("campssample",
+        structure({{"vertices", empty()}, {"components", empty()}}));
+  }
+
+public:
+  explicit SmallSimulation(const SmallSimulationSetup &setup = {})
+      : setup_(setup) {
+    const IJKDimensions &n = setup_.n_cells;
+    int p = setup_.pml;
+    // the total-field region lies a cell inside the PML
+    interface_[0] = p + 1, interface_[1] = n.i - p - 1;
+    interface_[2] = p + 1, interface_[3] = n.j - p - 1;
+    interface_[4] = p + 1, interface_[5] = n.k - p - 1;
+    // the scatterer lies in the middle of the grid
+    scatterer_ = {{n.i / 2 - 1, n.j / 2 - 1, n.k / 2 - 1},
+                  {n.i / 2 + 2, n.j / 2 + 1, n.k / 2 + 1}};
+
+    directory_ = create_tmp_dir();
+    matrices_.input_filename = (directory_ / "small_simulation.mat").string();
+    matrices_.grid_filename = matrices_.input_filename;
+    write_input_file();
+    set_matrices();
+  }
+  SmallSimulation(const SmallSimulation &) = delete;
+  SmallSimulation &operator=(const SmallSimulation &) = delete;
+
+  ~SmallSimulation() {
+    for (mxArray *array : arrays_) { mxDestroyArray(array); }
+    std::filesystem::remove_all(directory_);
+  }
+
+  /** @brief The inputs, to construct a SimulationManager from */
+  const InputMatrices &matrices() const { return matrices_; }
+};
+
+}// namespace tdms_tests
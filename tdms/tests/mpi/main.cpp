@@ -0,0 +1,15 @@
+/**
+ * @file main.cpp
+ * @brief Runs the tests of the distributed solver on each MPI rank.
+ */
+#include <catch2/catch_session.hpp>
+#include <mpi.h>
+
+int main(int argc, char *argv[]) {
+  // as in TDMS itself, the ranks communicate from the master thread only
+  int thread_support;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
+  int result = Catch::Session().run(argc, argv);
+  MPI_Finalize();
+  return result;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file test_DistributedFDTD.cpp
+ * @brief Tests of the FDTD update of a grid distributed over MPI ranks in
+ * blocks, each stored with a halo that is exchanged between the updates,
+ * against the update of the whole grid on one rank.
+ */
+#include "distributed/distributed_fdtd.h"
+
+#include <cmath>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <mpi.h>
+
+#include "distributed/mpi_grid_partition.h"
+#include "simulation_manager/update_coefficients.h"
+
+using Catch::Approx;
+
+namespace {
+
+const IJKDimensions N_CELLS = {7, 6, 5};
+const int N_STEPS = 4;
+/*! Tolerance of comparisons of the fields, which may be single precision */
+const double FIELD_TOL = 1e-5;
+
+const SplitComponent COMPONENTS[6] = {&SplitField::xy, &SplitField::xz,
+                                      &SplitField::yx, &SplitField::yz,
+                                      &SplitField::zx, &SplitField::zy};
+
+/**
+ * @brief Coefficients of the components in direction (0, 1, 2 for x, y, z)
+ * that vary over the grid, and between the split components
+ */
+CellCoefficients medium(int direction, int i, int j, int k) {
+  CellCoefficients cell;
+  for (int split = 0; split < 2; split++) {
+    double variation = 0.01 * ((i + 2 * j + 3 * k + direction) % 5);
+    cell.E[split].Ca = 0.9 + variation;
+    cell.E[split].Cb = 0.3 + 0.05 * split;
+    cell.H[split].Da = 0.95 - variation;
+    cell.H[split].Db = 0.25 + 0.05 * direction;
+  }
+  return cell;
+}
+
+/** @brief The initial value of the m-th split component of a field */
+double initial(int m, bool electric, int i, int j, int k) {
+  return std::sin(0.7 * i + 1.1 * j + 1.3 * k + m + (electric ? 0. : 0.5));
+}
+
+/**
+ * @brief The update of one split component over the whole grid,
+ *
+ *   field = a * field + b * ((curl_1 + curl_2 at plus) - (curl_1 + curl_2 at
+ *   minus)),
+ *
+ * as performed by the update loops of SimulationManager.
+ */
+struct Stencil {
+  int m;             //< Index of the updated component in COMPONENTS
+  int curl_1, curl_2;//< Indices of the components of the other field
+  CellBox cells;     //< The cells that are updated
+  ijk plus, minus;   //< The offsets of the terms of the curl
+};
+
+// clang-format off
+const int N_I = N_CELLS.i, N_J = N_CELLS.j, N_K = N_CELLS.k;
+const Stencil E_STENCILS[6] = {
+  {0, 5, 4, {{0, 1, 0}, {N_I, N_J, N_K + 1}}, {0, 0, 0}, {0, -1, 0}},
+  {1, 2, 3, {{0, 0, 1}, {N_I, N_J + 1, N_K}}, {0, 0, -1}, {0, 0, 0}},
+  {2, 4, 5, {{1, 0, 0}, {N_I, N_J, N_K + 1}}, {-1, 0, 0}, {0, 0, 0}},
+  {3, 0, 1, {{0, 0, 1}, {N_I + 1, N_J, N_K}}, {0, 0, 0}, {0, 0, -1}},
+  {4, 2, 3, {{1, 0, 0}, {N_I, N_J + 1, N_K}}, {0, 0, 0}, {-1, 0, 0}},
+  {5, 0, 1, {{0, 1, 0}, {N_I + 1, N_J, N_K}}, {0, -1, 0}, {0, 0, 0}}};
+const Stencil H_STENCILS[6] = {
+  {1, 2, 3, {{0, 0, 0}, {N_I + 1, N_J, N_K}}, {0, 0, 1}, {0, 0, 0}},
+  {0, 5, 4, {{0, 0, 0}, {N_I + 1, N_J, N_K}}, {0, 0, 0}, {0, 1, 0}},
+  {2, 4, 5, {{0, 0, 0}, {N_I, N_J + 1, N_K}}, {1, 0, 0}, {0, 0, 0}},
+  {3, 0, 1, {{0, 0, 0}, {N_I, N_J + 1, N_K}}, {0, 0, 0}, {0, 0, 1}},
+  {5, 0, 1, {{0, 0, 0}, {N_I, N_J, N_K + 1}}, {0, 1, 0}, {0, 0, 0}},
+  {4, 2, 3, {{0, 0, 0}, {N_I, N_J, N_K + 1}}, {0, 0, 0}, {1, 0, 0}}};
+// clang-format on
+
+/**
+ * @brief Update field from the other field curl, in the cells of the stencil
+ * that are also in cells
+ */
+void update(SplitField &field, SplitField &curl, const Stencil &stencil,
+            bool electric, const CellBox &cells) {
+  SplitFieldComponent &f = field.*COMPONENTS[stencil.m],
+                      &c_1 = curl.*COMPONENTS[stencil.curl_1],
+                      &c_2 = curl.*COMPONENTS[stencil.curl_2];
+  const ijk &p = stencil.plus, &q = stencil.minus;
+  CellBox box = stencil.cells.intersection(cells);
+  for (int i = box.lower.i; i < box.upper.i; i++) {
+    for (int j = box.lower.j; j < box.upper.j; j++) {
+      for (int k = box.lower.k; k < box.upper.k; k++) {
+        CellCoefficients c = medium(stencil.m / 2, i, j, k);
+        double a = electric ? c.E[stencil.m % 2].Ca : c.H[stencil.m % 2].Da,
+               b = electric ? c.E[stencil.m % 2].Cb : c.H[stencil.m % 2].Db;
+        field_t difference = c_1(i + p.i, j + p.j, k + p.k) +
+                             c_2(i + p.i, j + p.j, k + p.k) -
+                             c_1(i + q.i, j + q.j, k + q.k) -
+                             c_2(i + q.i, j + q.j, k + q.k);
+        f(i, j, k) = (field_t) (a * f(i, j, k) + b * difference);
+      }
+    }
+  }
+}
+
+/** @brief Set the split components of E_s and H_s to their initial values */
+void initialise(ElectricSplitField &E_s, MagneticSplitField &H_s) {
+  E_s.allocate();
+  H_s.allocate();
+  for (int m = 0; m < 6; m++) {
+    for (int i = 0; i <= N_I; i++) {
+      for (int j = 0; j <= N_J; j++) {
+        for (int k = 0; k <= N_K; k++) {
+          (E_s.*COMPONENTS[m])(i, j, k) = (field_t) initial(m, true, i, j, k);
+          (H_s.*COMPONENTS[m])(i, j, k) = (field_t) initial(m, false, i, j, k);
+        }
+      }
+    }
+  }
+}
+
+}// namespace
+
+TEST_CASE("DistributedFDTD: matches the update of the whole grid") {
+  MPIGridPartition partition(N_CELLS, MPI_COMM_WORLD);
+  const CellBox &owned = partition.owned();
+
+  // the whole grid, on every rank
+  ElectricSplitField E_s(N_I, N_J, N_K);
+  MagneticSplitField H_s(N_I, N_J, N_K);
+  initialise(E_s, H_s);
+  // and the cells of this rank, with their halo
+  ElectricSplitField E_block(N_I, N_J, N_K);
+  MagneticSplitField H_block(N_I, N_J, N_K);
+  initialise(E_block, H_block);
+  CellBox stored = partition.with_halo(1);
+  E_block.restrict_to(stored);
+  H_block.restrict_to(stored);
+  REQUIRE(E_block.stored_cells().n_cells() == stored.n_cells());
+  REQUIRE(H_block.xy.stored_cells().lower.i == stored.lower.i);
+
+  // the rows that read the halo are updated once it has arrived, as
+  // SimulationManager::update_E_split_distributed does
+  CellBox E_interior = owned, H_interior = owned;
+  E_interior.lower.i++;
+  E_interior.lower.j++;
+  H_interior.upper.i--;
+  H_interior.upper.j--;
+  for (int n = 0; n < N_STEPS; n++) {
+    for (const Stencil &stencil : E_STENCILS) {
+      update(E_s, H_s, stencil, true, E_s.stored_cells());
+    }
+    for (const Stencil &stencil : H_STENCILS) {
+      update(H_s, E_s, stencil, false, H_s.stored_cells());
+    }
+
+    partition.start_exchange(H_block, true);
+    for (const Stencil &stencil : E_STENCILS) {
+      update(E_block, H_block, stencil, true, E_interior);
+    }
+    partition.finish_exchange(H_block, true);
+    for (const Stencil &stencil : E_STENCILS) {
+      CellBox low_i = owned, low_j = owned;
+      low_i.upper.i = owned.lower.i + 1;
+      low_j.lower.i = owned.lower.i + 1;
+      low_j.upper.j = owned.lower.j + 1;
+      update(E_block, H_block, stencil, true, low_i);
+      update(E_block, H_block, stencil, true, low_j);
+    }
+
+    partition.start_exchange(E_block, false);
+    for (const Stencil &stencil : H_STENCILS) {
+      update(H_block, E_block, stencil, false, H_interior);
+    }
+    partition.finish_exchange(E_block, false);
+    for (const Stencil &stencil : H_STENCILS) {
+      CellBox high_i = owned, high_j = owned;
+      high_i.lower.i = owned.upper.i - 1;
+      high_j.upper.i = owned.upper.i - 1;
+      high_j.lower.j = owned.upper.j - 1;
+      update(H_block, E_block, stencil, false, high_i);
+      update(H_block, E_block, stencil, false, high_j);
+    }
+  }
+
+  for (int m = 0; m < 6; m++) {
+    for (int i = owned.lower.i; i < owned.upper.i; i++) {
+      for (int j = owned.lower.j; j < owned.upper.j; j++) {
+        for (int k = owned.lower.k; k < owned.upper.k; k++) {
+          REQUIRE((E_block.*COMPONENTS[m])(i, j, k) ==
+                  Approx((E_s.*COMPONENTS[m])(i, j, k)).margin(FIELD_TOL));
+          REQUIRE((H_block.*COMPONENTS[m])(i, j, k) ==
+                  Approx((H_s.*COMPONENTS[m])(i, j, k)).margin(FIELD_TOL));
+        }
+      }
+    }
+  }
+}
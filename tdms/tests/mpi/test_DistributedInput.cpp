@@ -0,0 +1,136 @@
+/**
+ * @file test_DistributedInput.cpp
+ * @brief Tests that each rank of a distributed grid reads the materials of its
+ * own block of the grid only, and that a simulation run from those matches
+ * one run from the whole grid.
+ */
+#include "simulation_manager/simulation_manager.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <catch2/catch_test_macros.hpp>
+#include <mpi.h>
+#include <spdlog/spdlog.h>
+
+#include "distributed/mpi_grid_partition.h"
+#include "small_simulation.h"
+
+using tdms_tests::SmallSimulation;
+using tdms_tests::SmallSimulationSetup;
+
+namespace {
+
+/**
+ * @brief The largest absolute value of the x, y, and z-directed fields, the
+ * sums of their split components, over the cells
+ */
+template<typename SplitFieldType>
+double largest(const SplitFieldType &F, const CellBox &cells) {
+  double value = 0.;
+  for (int i = cells.lower.i; i < cells.upper.i; i++) {
+    for (int j = cells.lower.j; j < cells.upper.j; j++) {
+      for (int k = cells.lower.k; k < cells.upper.k; k++) {
+        value = std::max({value, (double) std::abs(F.x(i, j, k)),
+                          (double) std::abs(F.y(i, j, k)),
+                          (double) std::abs(F.z(i, j, k))});
+      }
+    }
+  }
+  return value;
+}
+
+/** @brief The largest difference between two fields over the cells */
+template<typename SplitFieldType>
+double largest_difference(const SplitFieldType &a, const SplitFieldType &b,
+                          const CellBox &cells) {
+  double value = 0.;
+  for (int i = cells.lower.i; i < cells.upper.i; i++) {
+    for (int j = cells.lower.j; j < cells.upper.j; j++) {
+      for (int k = cells.lower.k; k < cells.upper.k; k++) {
+        value = std::max({value, (double) std::abs(a.x(i, j, k) - b.x(i, j, k)),
+                          (double) std::abs(a.y(i, j, k) - b.y(i, j, k)),
+                          (double) std::abs(a.z(i, j, k) - b.z(i, j, k))});
+      }
+    }
+  }
+  return value;
+}
+
+}// namespace
+
+TEST_CASE("DistributedInput: each rank reads the materials of its block") {
+  spdlog::set_level(spdlog::level::off);
+  SmallSimulationSetup setup;
+  setup.grid_in_file = true;
+  SmallSimulation simulation(setup);
+
+  ObjectsFromInfile inputs(simulation.matrices(), InputFlags());
+  // only the dimensions of the grid are known until the block is read
+  REQUIRE(!inputs.materials.has_elements());
+  REQUIRE(inputs.IJK_tot.i == setup.n_cells.i);
+  REQUIRE(inputs.IJK_tot.j == setup.n_cells.j);
+  REQUIRE(inputs.IJK_tot.k == setup.n_cells.k);
+
+  MPIGridPartition partition(inputs.IJK_tot, MPI_COMM_WORLD);
+  CellBox block = partition.with_halo(1);
+  inputs.read_materials(block);
+  CellBox stored = inputs.materials.stored_cells();
+  REQUIRE(stored.n_cells() == block.n_cells());
+  REQUIRE(stored.lower.i == block.lower.i);
+  REQUIRE(stored.lower.j == block.lower.j);
+
+  // the scatterer spans the middle of the grid, as SmallSimulation places it
+  const IJKDimensions &n = setup.n_cells;
+  CellBox scatterer = {{n.i / 2 - 1, n.j / 2 - 1, n.k / 2 - 1},
+                       {n.i / 2 + 2, n.j / 2 + 1, n.k / 2 + 1}};
+  int n_wrong = 0;
+  for (int k = block.lower.k; k < block.upper.k; k++) {
+    for (int j = block.lower.j; j < block.upper.j; j++) {
+      for (int i = block.lower.i; i < block.upper.i; i++) {
+        int expected = scatterer.contains(i, j, k) ? 1 : 0;
+        if (inputs.materials(i, j, k) != expected) { n_wrong++; }
+      }
+    }
+  }
+  REQUIRE(n_wrong == 0);
+}
+
+/**
+ * @brief Test that a distributed simulation, each of whose ranks reads the
+ * materials of its block from the grid file, advances the fields of its cells
+ * as one whose ranks each load the whole grid does.
+ */
+TEST_CASE("DistributedInput: reading the blocks matches loading the grid") {
+  spdlog::set_level(spdlog::level::off);
+  SmallSimulationSetup setup;
+  setup.dispersive = true;
+  setup.grid_in_file = true;
+  SmallSimulation read_simulation(setup);
+  setup.grid_in_file = false;
+  SmallSimulation loaded_simulation(setup);
+
+  SolverOptions options;
+  options.distributed = true;
+  SimulationManager read(read_simulation.matrices(), InputFlags(), options);
+  read.execute();
+  SimulationManager loaded(loaded_simulation.matrices(), InputFlags(), options);
+  loaded.execute();
+
+  // the cells of this rank, as both simulations partition the grid
+  CellBox owned =
+          MPIGridPartition(loaded.n_Yee_cells(), MPI_COMM_WORLD).owned();
+  REQUIRE(read.E_field().stored_cells().n_cells() ==
+          loaded.E_field().stored_cells().n_cells());
+  double E_largest = largest(loaded.E_field(), owned),
+         H_largest = largest(loaded.H_field(), owned);
+  // the source reaches the fields of some rank
+  double any_field = E_largest;
+  MPI_Allreduce(MPI_IN_PLACE, &any_field, 1, MPI_DOUBLE, MPI_MAX,
+                MPI_COMM_WORLD);
+  REQUIRE(any_field > 0.);
+  REQUIRE(largest_difference(loaded.E_field(), read.E_field(), owned) <=
+          1e-6 * E_largest);
+  REQUIRE(largest_difference(loaded.H_field(), read.H_field(), owned) <=
+          1e-6 * H_largest);
+}
@@ -0,0 +1,210 @@
+/**
+ * @file test_GridPartition.cpp
+ * @brief Tests of the partition of the grid over MPI ranks: the reductions,
+ * broadcasts and gathers of MPIGridPartition, and the PSTD derivatives of the
+ * distributed grid as the update loops call them.
+ */
+#include "distributed/mpi_grid_partition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <mpi.h>
+#include <omp.h>
+
+#include "simulation_manager/pstd_variables.h"
+
+using Catch::Approx;
+using std::vector;
+
+namespace {
+
+const IJKDimensions IJK_TOT = {8, 7, 6};
+
+/**
+ * @brief The cell (i, j, k) of sample x of line (outer, inner) of the update
+ * loops, along direction
+ */
+ijk cell_of(AxialDirection direction, int outer, int inner, int x) {
+  switch (direction) {
+    case AxialDirection::X:
+      return {x, outer, inner};
+    case AxialDirection::Y:
+      return {outer, x, inner};
+    default:
+      return {inner, outer, x};
+  }
+}
+
+}// namespace
+
+TEST_CASE("MPIGridPartition: owned cells") {
+  MPIGridPartition partition(IJK_TOT, MPI_COMM_WORLD);
+  int n_ranks;
+  MPI_Comm_size(MPI_COMM_WORLD, &n_ranks);
+  REQUIRE(partition.n_processes() == n_ranks);
+
+  // the cells of the ranks tile the grid, in whole rows along k
+  const CellBox &owned = partition.owned();
+  REQUIRE(owned.lower.k == 0);
+  REQUIRE(owned.upper.k == IJK_TOT.k + 1);
+  double n_cells = (double) owned.n_cells();
+  partition.sum(&n_cells, 1);
+  REQUIRE(n_cells == (double) partition.grid().n_cells());
+}
+
+TEST_CASE("MPIGridPartition: reductions and broadcasts") {
+  MPIGridPartition partition(IJK_TOT, MPI_COMM_WORLD);
+  int rank, n_ranks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &n_ranks);
+
+  double values[2] = {1., (double) rank};
+  partition.sum(values, 2);
+  REQUIRE(values[0] == n_ranks);
+  REQUIRE(values[1] == n_ranks * (n_ranks - 1) / 2.);
+  double largest = rank;
+  partition.maximum(&largest, 1);
+  REQUIRE(largest == n_ranks - 1);
+
+  std::string wisdom = partition.is_root() ? "the plans of the root" : "";
+  partition.broadcast_from_root(wisdom);
+  REQUIRE(wisdom == "the plans of the root");
+}
+
+TEST_CASE("MPIGridPartition: gathers") {
+  MPIGridPartition partition(IJK_TOT, MPI_COMM_WORLD);
+  int rank, n_ranks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &n_ranks);
+
+  // every rank knows the cells of the others
+  const CellBox &owned = partition.owned();
+  CellBox mine = partition.owned_by(rank);
+  REQUIRE(mine.lower.i == owned.lower.i);
+  REQUIRE(mine.upper.j == owned.upper.j);
+  CellBox halo = partition.with_halo(1);
+  REQUIRE(halo.lower.i == std::max(owned.lower.i - 1, 0));
+  REQUIRE(halo.upper.j == std::min(owned.upper.j + 1, IJK_TOT.j + 1));
+  REQUIRE(halo.upper.k == owned.upper.k);
+
+  // the values of the ranks are concatenated in order on every rank
+  vector<int> indices(rank + 1, rank);
+  vector<int> all_indices = partition.gather_to_all(indices);
+  REQUIRE(all_indices.size() == (size_t) (n_ranks * (n_ranks + 1) / 2));
+  size_t n = 0;
+  for (int r = 0; r < n_ranks; r++) {
+    for (int m = 0; m <= r; m++) { REQUIRE(all_indices[n++] == r); }
+  }
+
+  // and on the root only
+  vector<double> values(rank + 1, (double) rank);
+  vector<double> gathered = partition.gather_to_root(values);
+  if (!partition.is_root()) {
+    REQUIRE(gathered.empty());
+    return;
+  }
+  REQUIRE(gathered.size() == (size_t) (n_ranks * (n_ranks + 1) / 2));
+  n = 0;
+  for (int r = 0; r < n_ranks; r++) {
+    for (int m = 0; m <= r; m++) { REQUIRE(gathered[n++] == r); }
+  }
+}
+
+TEST_CASE("PSTDDerivative: the distributed grid as a single process") {
+  MPIGridPartition partition(IJK_TOT, MPI_COMM_WORLD);
+  if (!partition.is_distributed()) { return; }
+  const CellBox &owned = partition.owned();
+  BuiltinFFTBackend fft;
+  int n_threads = omp_get_max_threads();
+  size_t n_cells = (size_t) partition.grid().n_cells();
+  auto index = [&](const ijk &cell) {
+    return ((size_t) cell.i * (IJK_TOT.j + 1) + cell.j) * (IJK_TOT.k + 1) +
+           cell.k;
+  };
+  // not band-limited, so that the finite-difference lines differ
+  auto field = [](const ijk &cell) {
+    return std::sin(0.7 * cell.i + 0.3 * cell.j * cell.j) +
+           0.1 * cell.k * cell.k;
+  };
+
+  // the lines of the E updates, which are of N = {IJK}_tot samples updated
+  // from x = 1, and of the H updates, of N + 1 samples updated up to x = N - 1
+  for (AxialDirection direction :
+       {AxialDirection::X, AxialDirection::Y, AxialDirection::Z}) {
+    int n_along = direction == AxialDirection::X
+                          ? IJK_TOT.i
+                          : (direction == AxialDirection::Y ? IJK_TOT.j
+                                                            : IJK_TOT.k);
+    int n_outer = direction == AxialDirection::Y ? IJK_TOT.i : IJK_TOT.j + 1,
+        n_inner = direction == AxialDirection::Z ? IJK_TOT.i : IJK_TOT.k;
+    for (bool E : {true, false}) {
+      int N = E ? n_along : n_along + 1, begin = E ? 1 : 0, end = n_along;
+      double delta = E ? -0.5 : 0.5;
+      auto transform = fft.plan_batched_real(N, 4);
+      PSTDDerivative serial, distributed;
+      serial.initialise(direction, delta, n_threads, transform);
+      distributed.initialise(direction, delta, n_threads, transform,
+                             &partition);
+      REQUIRE(distributed.length() == N);
+
+      vector<double> expected(n_cells, 0.), derivative(n_cells, 0.);
+      auto sample = [&](int outer, int inner, int x) {
+        return field(cell_of(direction, outer, inner, x));
+      };
+      // every third line is differentiated by finite differences at its
+      // middle samples, which blend into the spectral derivative either side
+      auto blend = [](int outer, int inner, int n, double *weight) {
+        if ((outer + inner) % 3 != 0) { return false; }
+        for (int x = 0; x < n; x++) {
+          weight[x] = std::min(1., std::abs(x - n / 2) / 3.);
+        }
+        return true;
+      };
+      // a process stores only the cells that it owns
+      int n_not_owned = 0;
+      auto owned_sample = [&](int outer, int inner, int x) {
+        ijk cell = cell_of(direction, outer, inner, x);
+        if (!owned.contains(cell.i, cell.j, cell.k)) {
+#pragma omp atomic
+          n_not_owned++;
+        }
+        return field(cell);
+      };
+#pragma omp parallel
+      {
+        serial.differentiate_lines(
+                n_outer, n_inner, begin, end, sample,
+                [&](int outer, int inner, int x, double d) {
+                  expected[index(cell_of(direction, outer, inner, x))] = d;
+                },
+                blend);
+        distributed.differentiate_lines(
+                n_outer, n_inner, begin, end, owned_sample,
+                [&](int outer, int inner, int x, double d) {
+                  ijk cell = cell_of(direction, outer, inner, x);
+                  if (!owned.contains(cell.i, cell.j, cell.k)) {
+#pragma omp atomic
+                    n_not_owned++;
+                  }
+                  derivative[index(cell)] = d;
+                },
+                blend);
+      }
+      REQUIRE(n_not_owned == 0);
+
+      for (int i = owned.lower.i; i < owned.upper.i; i++) {
+        for (int j = owned.lower.j; j < owned.upper.j; j++) {
+          for (int k = owned.lower.k; k < owned.upper.k; k++) {
+            size_t n = index({i, j, k});
+            REQUIRE(derivative[n] == Approx(expected[n]).margin(1e-12));
+          }
+        }
+      }
+    }
+  }
+}
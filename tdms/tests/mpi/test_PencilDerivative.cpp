@@ -0,0 +1,140 @@
+/**
+ * @file test_PencilDerivative.cpp
+ * @brief Tests of the pencil decomposition of a grid over MPI ranks, and of
+ * the PSTD derivatives of the distributed grid.
+ */
+#include "distributed/pencil_derivative.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <mpi.h>
+
+using Catch::Approx;
+using std::vector;
+
+namespace {
+
+/*! The grid is of different, even and odd, lengths in each direction */
+const IJKDimensions N_SAMPLES = {9, 8, 7};
+
+/**
+ * @brief A function, periodic over the grid and band-limited below the Nyquist
+ * frequency of each direction, at sample (i, j, k)
+ */
+double sample(double i, double j, double k) {
+  double x = 2. * M_PI * i / N_SAMPLES.i, y = 2. * M_PI * j / N_SAMPLES.j,
+         z = 2. * M_PI * k / N_SAMPLES.k;
+  return std::cos(2. * x) * std::sin(y + 0.3) + std::cos(x - 2. * z) +
+         0.5 * std::sin(3. * y) * std::cos(z);
+}
+
+/**
+ * @brief The derivative of sample with respect to the index in a direction, at
+ * (i, j, k) shifted by delta in that direction. The PSTD derivatives of a
+ * band-limited function are exact.
+ */
+double derivative_of_sample(AxialDirection direction, double delta, int i,
+                            int j, int k) {
+  double x = 2. * M_PI * i / N_SAMPLES.i, y = 2. * M_PI * j / N_SAMPLES.j,
+         z = 2. * M_PI * k / N_SAMPLES.k;
+  switch (direction) {
+    case AxialDirection::X:
+      x += 2. * M_PI * delta / N_SAMPLES.i;
+      return 2. * M_PI / N_SAMPLES.i *
+             (-2. * std::sin(2. * x) * std::sin(y + 0.3) -
+              std::sin(x - 2. * z));
+    case AxialDirection::Y:
+      y += 2. * M_PI * delta / N_SAMPLES.j;
+      return 2. * M_PI / N_SAMPLES.j *
+             (std::cos(2. * x) * std::cos(y + 0.3) +
+              1.5 * std::cos(3. * y) * std::cos(z));
+    default:
+      z += 2. * M_PI * delta / N_SAMPLES.k;
+      return 2. * M_PI / N_SAMPLES.k *
+             (2. * std::sin(x - 2. * z) -
+              0.5 * std::sin(3. * y) * std::sin(z));
+  }
+}
+
+/** @brief The samples of a block of the grid, in (i, j, k) order */
+vector<double> samples_of(const CellBox &block) {
+  vector<double> samples;
+  for (int i = block.lower.i; i < block.upper.i; i++) {
+    for (int j = block.lower.j; j < block.upper.j; j++) {
+      for (int k = block.lower.k; k < block.upper.k; k++) {
+        samples.push_back(sample(i, j, k));
+      }
+    }
+  }
+  return samples;
+}
+
+}// namespace
+
+TEST_CASE("PencilDecomposition: blocks and transposes") {
+  PencilDecomposition decomposition(N_SAMPLES, MPI_COMM_WORLD);
+  int n_ranks;
+  MPI_Comm_size(MPI_COMM_WORLD, &n_ranks);
+  REQUIRE(decomposition.n_ranks(0) * decomposition.n_ranks(1) == n_ranks);
+
+  // the pencils of the ranks in each direction tile the grid
+  for (AxialDirection direction :
+       {AxialDirection::X, AxialDirection::Y, AxialDirection::Z}) {
+    long long n_samples = 0;
+    for (int p1 = 0; p1 < decomposition.n_ranks(0); p1++) {
+      for (int p2 = 0; p2 < decomposition.n_ranks(1); p2++) {
+        n_samples += decomposition.pencil(direction, p1, p2).n_cells();
+      }
+    }
+    REQUIRE(n_samples == (long long) N_SAMPLES.i * N_SAMPLES.j * N_SAMPLES.k);
+  }
+
+  // the transposes move each sample to its rank in the new pencils
+  vector<double> z_pencil = samples_of(decomposition.pencil(AxialDirection::Z));
+  vector<double> y_pencil, x_pencil, back;
+  decomposition.transpose(z_pencil, AxialDirection::Z, y_pencil,
+                          AxialDirection::Y);
+  REQUIRE(y_pencil == samples_of(decomposition.pencil(AxialDirection::Y)));
+  decomposition.transpose(y_pencil, AxialDirection::Y, x_pencil,
+                          AxialDirection::X);
+  REQUIRE(x_pencil == samples_of(decomposition.pencil(AxialDirection::X)));
+  decomposition.transpose(x_pencil, AxialDirection::X, y_pencil,
+                          AxialDirection::Y);
+  decomposition.transpose(y_pencil, AxialDirection::Y, back,
+                          AxialDirection::Z);
+  REQUIRE(back == z_pencil);
+
+  REQUIRE_THROWS_AS(decomposition.transpose(z_pencil, AxialDirection::Z,
+                                            x_pencil, AxialDirection::X),
+                    std::runtime_error);
+}
+
+TEST_CASE("PencilDerivative: exact for a band-limited function") {
+  PencilDecomposition decomposition(N_SAMPLES, MPI_COMM_WORLD);
+  CellBox mine = decomposition.pencil(AxialDirection::Z);
+  vector<double> samples = samples_of(mine), derivative;
+
+  for (AxialDirection direction :
+       {AxialDirection::X, AxialDirection::Y, AxialDirection::Z}) {
+    for (double delta : {-0.5, 0.5}) {
+      PencilDerivative distributed(decomposition, direction, delta);
+      distributed.differentiate(samples, derivative);
+      REQUIRE(derivative.size() == samples.size());
+
+      size_t n = 0;
+      for (int i = mine.lower.i; i < mine.upper.i; i++) {
+        for (int j = mine.lower.j; j < mine.upper.j; j++) {
+          for (int k = mine.lower.k; k < mine.upper.k; k++, n++) {
+            REQUIRE(derivative[n] ==
+                    Approx(derivative_of_sample(direction, delta, i, j, k))
+                            .margin(1e-12));
+          }
+        }
+      }
+    }
+  }
+}
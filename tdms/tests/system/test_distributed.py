@@ -0,0 +1,82 @@
+"""Runs the example_fdtd system test on a grid distributed over MPI processes.
+
+Runs a tdms executable built with -DTDMS_MPI=ON on 2 and 4 processes, with
+--distributed, and compares the output to the (single process) reference data.
+The path to the executable is read from the TDMS_MPI_EXECUTABLE environment
+variable, and the MPI launcher from TDMS_MPIEXEC (default mpiexec); the test is
+skipped if the executable is not set.
+"""
+import os
+import shlex
+from subprocess import PIPE, Popen
+
+import pytest
+from pytest_check import check
+from read_config import YAMLTestConfig
+from test_system import TEST_URLS, ZIP_DESTINATION
+from utils import (
+    HDF5File,
+    download_data,
+    relative_mean_squared_difference,
+    work_in_zipped_dir,
+)
+
+MPI_EXECUTABLE = os.environ.get("TDMS_MPI_EXECUTABLE")
+MPIEXEC = shlex.split(os.environ.get("TDMS_MPIEXEC", "mpiexec"))
+
+# Largest relative mean squared difference to the reference that is accepted,
+# in any output: the distributed grid is updated by the same arithmetic, so
+# only the order of the reductions differs
+DISTRIBUTED_RTOL = 1e-10
+
+
+def workflow(n_processes: int) -> None:
+    """Runs each system test in this zip file on n_processes processes, and
+    reports the relative mean squared difference of each output to the
+    reference."""
+    config_for_tests = YAMLTestConfig()
+
+    for system_test in config_for_tests.run_list:
+        p = Popen(
+            [
+                *MPIEXEC,
+                "-n",
+                str(n_processes),
+                MPI_EXECUTABLE,
+                "--distributed",
+                *system_test.create_tdms_call_options(),
+            ],
+            stdout=PIPE,
+        )
+        p.communicate()
+        assert p.returncode == 0, f"{system_test.run_id}: tdms failed"
+        reference_file = HDF5File(system_test.get_reference_file_name())
+        output_file = HDF5File(system_test.get_output_file_name())
+
+        for key, reference in reference_file.items():
+            with check:
+                assert key in output_file, f"{system_test.run_id}: {key} missing"
+                r_ms_diff = relative_mean_squared_difference(
+                    output_file[key], reference
+                )
+                print(f"{system_test.run_id} -> {key}: relative MSD = {r_ms_diff:.3e}")
+                assert (
+                    r_ms_diff <= DISTRIBUTED_RTOL
+                ), f"{system_test.run_id} -> {key}: relative MSD = {r_ms_diff:.3e}"
+    return
+
+
+@pytest.mark.skipif(
+    MPI_EXECUTABLE is None,
+    reason="TDMS_MPI_EXECUTABLE is not set",
+)
+@pytest.mark.parametrize("n_processes", [2, 4])
+def test_distributed_grid(n_processes: int) -> None:
+    """Compares the output of the example_fdtd system test, run on n_processes
+    processes, to the reference data."""
+    zip_path = ZIP_DESTINATION / "arc_example_fdtd.zip"
+    if not zip_path.exists():
+        download_data(TEST_URLS["example_fdtd"], to=zip_path)
+
+    work_in_zipped_dir(zip_path)(workflow)(n_processes)
+    return
@@ -0,0 +1,69 @@
+"""Quantifies the error of storing the fields in single precision.
+
+Runs the example_fdtd system test with a tdms executable built with
+-DSINGLE_PRECISION_FIELDS=ON, and compares the output to the (double
+precision) reference data. The path to the executable is read from the
+TDMS_SINGLE_PRECISION_EXECUTABLE environment variable; the test is skipped if
+it is not set.
+"""
+import os
+
+import pytest
+from pytest_check import check
+from read_config import YAMLTestConfig
+from test_system import TEST_URLS, ZIP_DESTINATION
+from utils import (
+    HDF5File,
+    download_data,
+    relative_mean_squared_difference,
+    run_tdms,
+    work_in_zipped_dir,
+)
+
+SINGLE_PRECISION_EXECUTABLE = os.environ.get("TDMS_SINGLE_PRECISION_EXECUTABLE")
+
+# Largest relative mean squared difference to the double precision reference
+# that is accepted, in any output
+SINGLE_PRECISION_RTOL = 1e-6
+
+
+def workflow(executable: str) -> None:
+    """Runs each system test in this zip file with the given executable, and
+    reports the relative mean squared difference of each output to the
+    reference."""
+    config_for_tests = YAMLTestConfig()
+
+    for system_test in config_for_tests.run_list:
+        run_tdms(*system_test.create_tdms_call_options(), executable=executable)
+        reference_file = HDF5File(system_test.get_reference_file_name())
+        output_file = HDF5File(system_test.get_output_file_name())
+
+        for key, reference in reference_file.items():
+            with check:
+                assert key in output_file, f"{system_test.run_id}: {key} missing"
+                r_ms_diff = relative_mean_squared_difference(
+                    output_file[key], reference
+                )
+                print(f"{system_test.run_id} -> {key}: relative MSD = {r_ms_diff:.3e}")
+                assert (
+                    r_ms_diff <= SINGLE_PRECISION_RTOL
+                ), f"{system_test.run_id} -> {key}: relative MSD = {r_ms_diff:.3e}"
+    return
+
+
+@pytest.mark.skipif(
+    SINGLE_PRECISION_EXECUTABLE is None,
+    reason="TDMS_SINGLE_PRECISION_EXECUTABLE is not set",
+)
+def test_single_precision_fields() -> None:
+    """Compares the single precision output of the example_fdtd system test to
+    the double precision reference data."""
+    version = run_tdms("--version", executable=SINGLE_PRECISION_EXECUTABLE)
+    assert "Field precision: single" in version.stdout
+
+    zip_path = ZIP_DESTINATION / "arc_example_fdtd.zip"
+    if not zip_path.exists():
+        download_data(TEST_URLS["example_fdtd"], to=zip_path)
+
+    work_in_zipped_dir(zip_path)(workflow)(SINGLE_PRECISION_EXECUTABLE)
+    return
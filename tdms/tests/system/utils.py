@@ -167,19 +167,21 @@ class Result:
     stdout: str
 
 
-def run_tdms(*args) -> Result:
+def run_tdms(*args, executable: Union[str, None] = None) -> Result:
     """
     Run the tdms executable. Requires a tdms executable within the working
-    directory or $PATH.
+    directory or $PATH, unless the path to an executable is given.
     """
 
-    if executable_path is None:
+    if executable is None:
+        executable = executable_path
+    if executable is None:
         raise AssertionError(
             "Failed to run tdms. Not found in either current "
             "working directory or $PATH"
         )
 
-    p = Popen([executable_path, *args], stdout=PIPE)
+    p = Popen([executable, *args], stdout=PIPE)
     stdout, _ = p.communicate()
 
     return Result(p.returncode, stdout.decode())
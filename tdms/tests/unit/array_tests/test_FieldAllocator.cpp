@@ -0,0 +1,60 @@
+/**
+ * @file test_FieldAllocator.cpp
+ * @brief Tests the storage of Tensor3Ds that use the FieldAllocator, with and
+ * without padded rows.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+#include "arrays/field_allocator.h"
+#include "arrays/tensor3d.h"
+
+using namespace std;
+
+namespace {
+
+bool is_aligned(const void *p, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+}// namespace
+
+TEST_CASE("FieldAllocator: aligned, zeroed, and padded storage") {
+  const int n_layers = 13, n_cols = 5, n_rows = 7;
+  Tensor3D<double, FieldAllocator<double>> tensor;
+
+  SECTION("Unpadded") {
+    tensor.allocate(n_layers, n_cols, n_rows);
+    REQUIRE(tensor.layer_stride() == n_layers);
+    REQUIRE(is_aligned(&tensor(0, 0, 0), FIELD_ALIGNMENT));
+  }
+  SECTION("Padded") {
+    tensor.set_layer_padding(true);
+    tensor.allocate(n_layers, n_cols, n_rows);
+    // 13 doubles occupy two 64-byte blocks
+    REQUIRE(tensor.layer_stride() == 16);
+    bool rows_aligned = true;
+    for (int i = 0; i < n_rows; i++) {
+      for (int j = 0; j < n_cols; j++) {
+        rows_aligned =
+                rows_aligned && is_aligned(&tensor(i, j, 0), FIELD_ALIGNMENT);
+      }
+    }
+    REQUIRE(rows_aligned);
+  }
+
+  // allocation zeroes the elements, and the (i, j, k) are all distinct
+  bool all_zero = true;
+  for (int i = 0; i < n_rows; i++) {
+    for (int j = 0; j < n_cols; j++) {
+      for (int k = 0; k < n_layers; k++) {
+        all_zero = all_zero && tensor(i, j, k) == 0.;
+        tensor(i, j, k) = 1.;
+      }
+    }
+  }
+  REQUIRE(all_zero);
+  // the padding (if any) is untouched, so does not contribute to the norm
+  REQUIRE(tensor.frobenius() * tensor.frobenius() ==
+          (double) (n_layers * n_cols * n_rows));
+}
@@ -117,3 +117,57 @@ TEST_CASE("MagneticField: angular norm addition") {
   H.add_to_angular_norm(N, N_T, params);
   REQUIRE(is_close(H.angular_norm, expected));
 }
+
+TEST_CASE("ElectricField: set_phasors") {
+
+  double OMEGA = 0.7;
+  double DT = 0.1;
+  int N = 3;
+  int N_T = 5;
+
+  // a split field larger than the phasors, and with more k-layers than a tile
+  const int I_tot = 6, J_tot = 4, K_tot = 37;
+  ElectricSplitField F(I_tot, J_tot, K_tot);
+  F.allocate_and_zero();
+  for (int i = 0; i <= I_tot; i++) {
+    for (int j = 0; j <= J_tot; j++) {
+      for (int k = 0; k <= K_tot; k++) {
+        F.xy(i, j, k) = i + 0.5;
+        F.xz(i, j, k) = 0.5;
+        F.yx(i, j, k) = j - k;
+        F.zy(i, j, k) = 0.01 * i * j * k;
+      }
+    }
+  }
+
+  ElectricField E(I_tot - 1, J_tot - 1, K_tot - 3);
+  E.il = 1, E.iu = I_tot - 1;
+  E.jl = 1, E.ju = J_tot - 1;
+  E.kl = 2, E.ku = K_tot - 2;
+  E.allocate_and_zero();
+  E.set_phasors(F, N, OMEGA, DT, N_T);
+  E.set_phasors(F, N, OMEGA, DT, N_T);
+
+  // each call adds the field times e^(iω(n+1)dt) / N_t
+  auto phase_term =
+          exp(OMEGA * ((double) N + 1) * DT * IMAGINARY_UNIT) / ((double) N_T);
+  bool all_close = true;
+  for (int k = E.kl; k <= E.ku; k++) {
+    for (int j = E.jl; j <= E.ju; j++) {
+      for (int i = E.il; i <= E.iu; i++) {
+        int di = i - E.il, dj = j - E.jl, dk = k - E.kl;
+        complex<double> x = E.real.x[dk][dj][di] +
+                            IMAGINARY_UNIT * E.imag.x[dk][dj][di],
+                        y = E.real.y[dk][dj][di] +
+                            IMAGINARY_UNIT * E.imag.y[dk][dj][di],
+                        z = E.real.z[dk][dj][di] +
+                            IMAGINARY_UNIT * E.imag.z[dk][dj][di];
+        all_close = all_close &&
+                    is_close(x, 2. * F.x(i, j, k) * phase_term) &&
+                    is_close(y, 2. * F.y(i, j, k) * phase_term) &&
+                    is_close(z, 2. * F.z(i, j, k) * phase_term);
+      }
+    }
+  }
+  REQUIRE(all_close);
+}
@@ -42,3 +42,72 @@ TEST_CASE("SplitField: allocate without initialising") {
   auto field = ElectricSplitField();
   REQUIRE(!field.xy.has_elements());
 }
+
+TEST_CASE("SplitField: unsplit interior") {
+  ElectricSplitField field(4, 3, 5);
+  field.allocate_and_zero();
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 4; j++) {
+      for (int k = 0; k < 6; k++) {
+        field.xy(i, j, k) = i;
+        field.xz(i, j, k) = j;
+        field.yx(i, j, k) = k;
+        field.yz(i, j, k) = 1.;
+        field.zx(i, j, k) = 2.;
+        field.zy(i, j, k) = i + j + k;
+      }
+    }
+  }
+
+  CellBox interior = {{1, 1, 1}, {4, 3, 5}};
+  field.unsplit_interior(interior);
+  REQUIRE(field.has_unsplit_interior());
+  REQUIRE(field.xz.is_pml_only());
+  REQUIRE(!field.xy.is_pml_only());
+
+  // the sums of the split components are unchanged
+  bool sums_kept = true;
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 4; j++) {
+      for (int k = 0; k < 6; k++) {
+        sums_kept = sums_kept && field.x(i, j, k) == i + j &&
+                    field.y(i, j, k) == k + 1 &&
+                    field.z(i, j, k) == i + j + k + 2;
+      }
+    }
+  }
+  REQUIRE(sums_kept);
+
+  // contributions to omitted components go to the component holding the field
+  CellCoordinate inside = {2, 2, 2}, outside = {0, 2, 2};
+  field.element(field.xz, inside) += 10.;
+  field.element(field.xz, outside) += 10.;
+  REQUIRE(field.xy(2, 2, 2) == 14.);
+  REQUIRE(field.xz.value(0, 2, 2) == 12.);
+  REQUIRE(field.x(inside) == 14.);
+}
+
+TEST_CASE("SplitField: allocate unsplit") {
+  ElectricSplitField field(4, 3, 5);
+  CellBox interior = {{1, 1, 1}, {4, 3, 5}};
+  field.allocate_unsplit(interior);
+  REQUIRE(field.has_unsplit_interior());
+  REQUIRE(field.unsplit_cells().n_cells() == interior.n_cells());
+  for (SplitFieldComponent *part : {&field.xz, &field.yz, &field.zy}) {
+    REQUIRE(part->is_pml_only());
+    REQUIRE(!part->stores(2, 2, 2));
+    REQUIRE(part->stores(0, 2, 2));
+  }
+  for (SplitFieldComponent *whole : {&field.xy, &field.yx, &field.zx}) {
+    REQUIRE(!whole->is_pml_only());
+    REQUIRE(whole->stored_cells().n_cells() == 5 * 4 * 6);
+  }
+
+  // the field starts at zero, and contributions to omitted components go to
+  // the component holding the field
+  REQUIRE(field.largest_field_value() == 0.);
+  field.element(field.yz, {2, 2, 2}) += 3.;
+  field.element(field.yz, {0, 2, 2}) += 5.;
+  REQUIRE(field.yx(2, 2, 2) == 3.);
+  REQUIRE(field.y(0, 2, 2) == 5.);
+}
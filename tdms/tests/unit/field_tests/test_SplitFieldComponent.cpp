@@ -24,3 +24,75 @@ TEST_CASE("SplitFieldComponent: set component") {
   tmp(0, 1, 0) = 1.0;
   REQUIRE(is_close(tmp(0, 1, 0), 1.0));
 }
+
+TEST_CASE("SplitFieldComponent: store PML-only") {
+  // (n_layers, n_cols, n_rows) = (6, 5, 4), indexed as (i, j, k)
+  SplitFieldComponent component;
+  component.allocate(6, 5, 4);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 5; j++) {
+      for (int k = 0; k < 6; k++) { component(i, j, k) = 100 * i + 10 * j + k; }
+    }
+  }
+  REQUIRE(!component.is_pml_only());
+
+  CellBox interior = {{1, 1, 2}, {3, 4, 5}};
+  component.store_pml_only(interior);
+  REQUIRE(component.is_pml_only());
+
+  // stored cells keep their values, and omitted cells read as zero
+  bool values_kept = true;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 5; j++) {
+      for (int k = 0; k < 6; k++) {
+        bool omitted = interior.contains(i, j, k);
+        values_kept = values_kept && component.stores(i, j, k) == !omitted &&
+                      component.value(i, j, k) ==
+                              (omitted ? 0. : 100 * i + 10 * j + k);
+      }
+    }
+  }
+  REQUIRE(values_kept);
+
+  // the stored cells are distinct
+  component.at(3, 4, 5) = -1.;
+  component.at(1, 1, 5) = -2.;
+  REQUIRE(component.value(3, 4, 5) == -1.);
+  REQUIRE(component.value(1, 1, 5) == -2.);
+  REQUIRE(component.value(1, 1, 1) == 111.);
+
+  component.zero();
+  REQUIRE(component.value(1, 1, 5) == 0.);
+}
+
+TEST_CASE("SplitFieldComponent: allocate PML-only") {
+  // (n_layers, n_cols, n_rows) = (6, 5, 4), indexed as (i, j, k)
+  SplitFieldComponent component;
+  CellBox interior = {{1, 1, 2}, {3, 4, 5}};
+  component.allocate_pml_only(6, 5, 4, interior);
+  REQUIRE(component.is_pml_only());
+  REQUIRE(component.stored_cells().n_cells() == 6 * 5 * 4);
+
+  // only the cells outside the interior are stored, and they start at zero
+  bool layout_kept = true;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 5; j++) {
+      for (int k = 0; k < 6; k++) {
+        bool omitted = interior.contains(i, j, k);
+        layout_kept = layout_kept && component.stores(i, j, k) == !omitted &&
+                      component.value(i, j, k) == 0.;
+        if (!omitted) { component.at(i, j, k) = 100 * i + 10 * j + k; }
+      }
+    }
+  }
+  REQUIRE(layout_kept);
+  REQUIRE(component.value(3, 4, 5) == 345.);
+  REQUIRE(component.value(1, 1, 5) == 115.);
+  REQUIRE(component.value(1, 1, 1) == 111.);
+  REQUIRE(component.value(2, 2, 3) == 0.);
+
+  // an interior outside the grid omits nothing
+  component.allocate_pml_only(6, 5, 4, {{4, 0, 0}, {6, 5, 6}});
+  REQUIRE(!component.is_pml_only());
+  REQUIRE(component(3, 4, 5) == 0.);
+}
@@ -6,10 +6,13 @@
  */
 #include "hdf5_io/hdf5_reader.h"
 
+#include <filesystem>
 #include <stdint.h>
 #include <string>
 #include <vector>
 
+#include <H5Cpp.h>
+
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 
@@ -131,3 +134,43 @@ TEST_CASE("HDF5Reader::read() [std::vector]") {
   }
   REQUIRE(entries_read_correctly);
 }
+
+/** @brief Test that read_block() reads only the requested block of a dataset,
+ * in the order of the dataset */
+TEST_CASE("HDF5Reader::read_block()") {
+  auto tmp = tdms_tests::create_tmp_dir();
+  string filename = (tmp / "blocks.h5").string();
+
+  // a 4 x 5 x 6 dataset of uint8s, whose value encodes its index
+  hsize_t dims[3] = {4, 5, 6};
+  {
+    vector<uint8_t> values(4 * 5 * 6);
+    for (int n = 0; n < 4 * 5 * 6; n++) { values[n] = (uint8_t) n; }
+    H5::H5File file(filename, H5F_ACC_TRUNC);
+    H5::Group group = file.createGroup("grid");
+    H5::DataSet dataset = group.createDataSet(
+            "values", H5::PredType::NATIVE_UINT8, H5::DataSpace(3, dims));
+    dataset.write(values.data(), H5::PredType::NATIVE_UINT8);
+  }
+
+  HDF5Reader reader(filename);
+  vector<uint8_t> block(2 * 3 * 2, 0);
+  reader.read_block("grid/values", {1, 2, 3}, {2, 3, 2}, block.data());
+  bool entries_read_correctly = true;
+  for (int a = 0; a < 2; a++) {
+    for (int b = 0; b < 3; b++) {
+      for (int c = 0; c < 2; c++) {
+        int index = ((1 + a) * 5 + (2 + b)) * 6 + (3 + c);
+        entries_read_correctly = entries_read_correctly &&
+                                 block[(a * 3 + b) * 2 + c] == index;
+      }
+    }
+  }
+  REQUIRE(entries_read_correctly);
+
+  // the block must have as many dimensions as the dataset
+  REQUIRE_THROWS_AS(reader.read_block("grid/values", {0, 0}, {1, 1},
+                                      block.data()),
+                    std::runtime_error);
+  std::filesystem::remove_all(tmp);
+}
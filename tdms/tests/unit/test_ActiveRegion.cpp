@@ -0,0 +1,118 @@
+/**
+ * @file test_ActiveRegion.cpp
+ * @brief Tests of the tracking of the cells that the fields of a pulsed
+ * simulation can have reached.
+ */
+#include "simulation_manager/active_region.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+const IJKDimensions IJK_tot = {6, 5, 20};
+
+/** @brief Whether two boxes have the same bounds */
+bool same_box(const CellBox &a, const CellBox &b) {
+  return a.lower.i == b.lower.i && a.lower.j == b.lower.j &&
+         a.lower.k == b.lower.k && a.upper.i == b.upper.i &&
+         a.upper.j == b.upper.j && a.upper.k == b.upper.k;
+}
+
+}// namespace
+
+TEST_CASE("ActiveRegion: growth from the sources") {
+  SPDLOG_INFO("===== Testing ActiveRegion =====");
+  ElectricSplitField E(IJK_tot.i, IJK_tot.j, IJK_tot.k);
+  MagneticSplitField H(IJK_tot.i, IJK_tot.j, IJK_tot.k);
+  E.allocate_and_zero();
+  H.allocate_and_zero();
+
+  ActiveRegion region;
+  region.set_grid(IJK_tot);
+  // until tracked, the whole grid is updated
+  REQUIRE(!region.is_tracking());
+  REQUIRE(same_box(region.box(), region.grid()));
+  REQUIRE(region.grid().n_cells() == 7 * 6 * 21);
+
+  // a source plane across the grid, as the pulsed source at K0 = 3
+  CellBox sources = {{0, 0, 2}, {IJK_tot.i + 1, IJK_tot.j + 1, 4}};
+
+  SECTION("Zero initial fields") {
+    region.track(sources, E, H);
+    REQUIRE(region.is_tracking());
+    REQUIRE(same_box(region.box(), sources));
+
+    // one cell further in each direction per timestep, within the grid
+    region.advance();
+    REQUIRE(same_box(region.box(),
+                     {{0, 0, 1}, {IJK_tot.i + 1, IJK_tot.j + 1, 5}}));
+    for (int n = 0; n < 30; n++) { region.advance(); }
+    REQUIRE(same_box(region.box(), region.grid()));
+    REQUIRE(!region.is_tracking());
+  }
+
+  SECTION("Non-zero initial field") {
+    H.zx(2, 3, 15) = 1.;
+    region.track(sources, E, H);
+    REQUIRE(same_box(region.box(),
+                     {{0, 0, 2}, {IJK_tot.i + 1, IJK_tot.j + 1, 16}}));
+  }
+
+  SECTION("Shrinking to the fields above a threshold") {
+    region.track(sources, E, H);
+    for (int n = 0; n < 14; n++) { region.advance(); }
+    REQUIRE(region.box().upper.k == 18);
+
+    // the pulse has moved on to k = 12, leaving a small tail behind
+    E.xy(3, 2, 12) = 1.;
+    E.yz(1, 1, 7) = 1e-6;
+    region.shrink(E, H, 1e-3);
+    // the cells around the pulse, and those of the source, which may inject
+    // more of it
+    REQUIRE(same_box(region.box(),
+                     {{0, 0, 2}, {IJK_tot.i + 1, IJK_tot.j + 1, 14}}));
+    REQUIRE(region.is_tracking());
+
+    // the box never grows by shrinking
+    H.xz(4, 4, 19) = 2.;
+    region.shrink(E, H, 1e-3);
+    REQUIRE(region.box().upper.k == 14);
+  }
+}
+
+TEST_CASE("ActiveRegion: shrinking shared between a team of threads") {
+  ElectricSplitField E(IJK_tot.i, IJK_tot.j, IJK_tot.k);
+  MagneticSplitField H(IJK_tot.i, IJK_tot.j, IJK_tot.k);
+  E.allocate_and_zero();
+  H.allocate_and_zero();
+
+  ActiveRegion region;
+  region.set_grid(IJK_tot);
+  region.track({{0, 0, 2}, {IJK_tot.i + 1, IJK_tot.j + 1, 4}}, E, H);
+  for (int n = 0; n < 14; n++) { region.advance(); }
+  ActiveRegion serial = region;
+
+  E.xy(3, 2, 12) = 1.;
+  E.yz(1, 1, 7) = 1e-6;
+  H.zx(5, 0, 9) = -0.5;
+  serial.shrink(E, H, 1e-3);
+  // every thread of the team calls shrink, as in the main loop
+#pragma omp parallel num_threads(4)
+  region.shrink(E, H, 1e-3);
+  REQUIRE(same_box(region.box(), serial.box()));
+  REQUIRE(same_box(region.box(),
+                   {{0, 0, 2}, {IJK_tot.i + 1, IJK_tot.j + 1, 14}}));
+}
+
+TEST_CASE("CellBox: intersection and enclosing box") {
+  CellBox a = {{0, 1, 2}, {4, 5, 6}}, b = {{2, 0, 3}, {7, 3, 4}};
+  REQUIRE(same_box(a.intersection(b), {{2, 1, 3}, {4, 3, 4}}));
+  REQUIRE(same_box(a.enclosing(b), {{0, 0, 2}, {7, 5, 6}}));
+
+  CellBox disjoint = {{5, 5, 5}, {6, 6, 6}};
+  REQUIRE(a.intersection(disjoint).empty());
+  // an empty box adds no cells to the enclosing box
+  REQUIRE(same_box(a.enclosing(CellBox()), a));
+  REQUIRE(same_box(CellBox().enclosing(a), a));
+}
@@ -0,0 +1,87 @@
+/**
+ * @file test_ConvergenceMonitor.cpp
+ * @brief Tests of the convergence check of steady-state simulations.
+ */
+#include "simulation_manager/convergence_monitor.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <omp.h>
+#include <spdlog/spdlog.h>
+
+#include "field_patterns.h"
+
+using Catch::Approx;
+using tdms_tests::pattern_value, tdms_tests::set_pattern;
+
+namespace {
+
+const int I_tot = 6, J_tot = 5, K_tot = 7;
+
+}// namespace
+
+TEST_CASE("ConvergenceMonitor") {
+  SPDLOG_INFO("===== Testing ConvergenceMonitor =====");
+  ElectricField E(I_tot, J_tot, K_tot), previous(I_tot, J_tot, K_tot);
+  MagneticField H(I_tot, J_tot, K_tot);
+  E.allocate_and_zero();
+  previous.allocate_and_zero();
+  H.allocate_and_zero();
+  SurfacePhasors surface;
+  double **const E_real_x = E.real.x[0];
+
+  ConvergenceMonitor convergence(previous);
+  set_pattern(E, 1.);
+  H.real.x[1][1][1] = 3.;
+  // the first period is compared to zero phasors
+  REQUIRE(convergence.difference(E, surface) == Approx(1.));
+
+  convergence.start_next_period(E, H);
+  REQUIRE(E.real.x[2][3][4] == 0.);
+  REQUIRE(H.real.x[1][1][1] == 0.);
+
+  // the same comparison as that of the fields themselves
+  set_pattern(E, 1. + 1e-3);
+  E.imag.z[3][2][1] += 0.5;
+  double expected = E.normalised_difference(previous);
+  REQUIRE(convergence.difference(E, surface) == Approx(expected));
+
+  SECTION("Measured by a team of threads") {
+    double on_team[4];
+#pragma omp parallel num_threads(4)
+    {
+      double difference = convergence.difference(E, surface);
+      on_team[omp_get_thread_num() % 4] = difference;
+    }
+    for (int n = 0; n < omp_get_max_threads() && n < 4; n++) {
+      REQUIRE(on_team[n] == Approx(expected));
+    }
+  }
+
+  SECTION("Sampled cells") {
+    // the largest difference is at a cell that is not sampled, and the others
+    // change by the same fraction
+    ConvergenceMonitor sampled(previous, ConvergenceSet::Volume, 2);
+    REQUIRE(sampled.difference(E, surface) == Approx(1e-3 / (1. + 1e-3)));
+    REQUIRE(sampled.difference(E, surface) < expected);
+  }
+
+  SECTION("Restoring the last complete phasors") {
+    convergence.restore_previous(E);
+    REQUIRE(E.real.x[2][3][4] == Approx(pattern_value(0, 4, 3, 2)));
+
+    // the output keeps its own arrays
+    convergence.release(E);
+    REQUIRE(E.real.x[0] == E_real_x);
+    REQUIRE(E.real.x[2][3][4] == Approx(pattern_value(0, 4, 3, 2)));
+  }
+
+  SECTION("Releasing the arrays of the output") {
+    convergence.release(E);
+    REQUIRE(E.real.x[0] == E_real_x);
+    REQUIRE(E.real.x[2][3][4] ==
+            Approx(pattern_value(0, 4, 3, 2) * (1. + 1e-3)));
+    REQUIRE(E.imag.z[3][2][1] ==
+            Approx(pattern_value(5, 1, 2, 3) * (1. + 1e-3) + 0.5));
+  }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file test_EnergyDecay.cpp
+ * @brief Tests of the monitoring of the field energy of pulsed simulations.
+ */
+#include "simulation_manager/energy_decay.h"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <omp.h>
+#include <spdlog/spdlog.h>
+
+#include "globals.h"
+
+using Catch::Approx;
+using tdms_phys_constants::EPSILON0, tdms_phys_constants::MU0;
+
+TEST_CASE("EnergyDecay") {
+  SPDLOG_INFO("===== Testing EnergyDecay =====");
+  ElectricSplitField E(8, 6, 10);
+  MagneticSplitField H(8, 6, 10);
+  E.allocate_and_zero();
+  H.allocate_and_zero();
+
+  SECTION("Disabled") {
+    EnergyDecay energy;
+    REQUIRE(!energy.is_enabled());
+    energy.measure(E, H);
+    REQUIRE(!energy.has_decayed());
+  }
+
+  SECTION("Decay relative to the peak") {
+    EnergyDecay energy(1e-4);
+    REQUIRE(energy.is_enabled());
+    // no field has entered the grid yet
+    energy.measure(E, H);
+    REQUIRE(energy.energy() == 0.);
+    REQUIRE(!energy.has_decayed());
+
+    // the split components of a direction add up to the field
+    E.xy(1, 2, 3) = 1.;
+    E.xz(1, 2, 3) = 2.;
+    H.zy(7, 0, 9) = 1.;
+    energy.measure(E, H);
+    REQUIRE(energy.energy() == Approx(9. * EPSILON0 + MU0));
+    REQUIRE(energy.peak() == energy.energy());
+    REQUIRE(!energy.has_decayed());
+
+    // the energy is dominated by H, in SI units
+    H.zy(7, 0, 9) = 0.1;
+    E.xz(1, 2, 3) = -1.;
+    energy.measure(E, H);
+    REQUIRE(energy.peak() == Approx(9. * EPSILON0 + MU0));
+    REQUIRE(!energy.has_decayed());
+
+    H.zy(7, 0, 9) = 0.;
+    energy.measure(E, H);
+    REQUIRE(energy.energy() == 0.);
+    REQUIRE(energy.has_decayed());
+  }
+
+  SECTION("Broadband incident field") {
+    EnergyDecay energy(1e-2);
+    // no incident field, so it never holds the simulation back
+    REQUIRE(energy.incident_field_has_decayed(0));
+
+    // an x-component over a 3 x 2 source plane, for 20 timesteps: a pulse at
+    // timestep 4, and a weaker one at timestep 12
+    IncidentField Ei;
+    Ei.x.allocate(20, 2, 3);
+    Ei.x.zero();
+    Ei.x(1, 0, 4) = 10.;
+    Ei.x(2, 1, 4) = 10.;
+    Ei.x(0, 1, 12) = 2.;
+    Ei.x(0, 0, 16) = 1e-3;
+    energy.set_incident_field(Ei);
+
+    REQUIRE(!energy.incident_field_has_decayed(0));
+    REQUIRE(!energy.incident_field_has_decayed(5));
+    // the second pulse has 4 / 200 of the peak power, still to be injected
+    REQUIRE(!energy.incident_field_has_decayed(12));
+    REQUIRE(energy.incident_field_has_decayed(13));
+    REQUIRE(energy.incident_field_has_decayed(19));
+    // beyond the last time slice, nothing more is injected
+    REQUIRE(energy.incident_field_has_decayed(20));
+  }
+
+  SECTION("Measured by a team of threads") {
+    for (int i = 0; i <= 8; i++) {
+      for (int k = 0; k <= 10; k++) { E.yx(i, 3, k) = 1.; }
+    }
+    EnergyDecay energy(0.5);
+#pragma omp parallel num_threads(4)
+    { energy.measure(E, H); }
+    REQUIRE(energy.energy() == Approx(9. * 11. * EPSILON0));
+  }
+}
@@ -0,0 +1,215 @@
+/**
+ * @file test_FFTBackend.cpp
+ * @brief Tests of the transforms of the FFT backends, against the discrete
+ * Fourier transform evaluated directly, and of the sharing and saving of their
+ * plans.
+ */
+#include "fft_backend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/spdlog.h>
+
+#include "globals.h"
+#include "simulation_manager/pstd_variables.h"
+#include "unit_test_utils.h"
+
+using Catch::Approx;
+using std::complex;
+using std::vector;
+using tdms_math_constants::DCPI;
+
+namespace {
+
+const double TOL = 1e-9;
+
+/** @brief The forward DFT of data, evaluated directly */
+vector<complex<double>> dft(const vector<complex<double>> &data) {
+  int N = (int) data.size();
+  vector<complex<double>> transform(N, 0.);
+  for (int k = 0; k < N; k++) {
+    for (int n = 0; n < N; n++) {
+      transform[k] += data[n] * std::polar(1., -2. * DCPI * k * n / N);
+    }
+  }
+  return transform;
+}
+
+/** @brief A real sample that varies irregularly with x and the line b */
+double sample(int x, int b) { return std::sin(1.3 * x + 0.7 * b) + 0.1 * b; }
+
+/** @brief The backends under test */
+vector<std::unique_ptr<FFTBackend>> backends() {
+  vector<std::unique_ptr<FFTBackend>> all;
+  all.push_back(make_fft_backend(FFTLibrary::FFTW, FFTPlanning::Estimate, 1));
+  all.push_back(
+          make_fft_backend(FFTLibrary::Builtin, FFTPlanning::Estimate, 1));
+  return all;
+}
+
+/** @brief The builtin backend, counting the batched transforms it plans */
+class CountingFFTBackend : public BuiltinFFTBackend {
+public:
+  mutable int n_plans = 0;
+
+  std::shared_ptr<const BatchedRealFFT>
+  plan_batched_real(int N, int batch_size) const override {
+    n_plans++;
+    return BuiltinFFTBackend::plan_batched_real(N, batch_size);
+  }
+};
+
+/** @brief The plans of some wisdom, which may be exported in any order */
+vector<std::string> plans_in(const std::string &wisdom) {
+  vector<std::string> plans;
+  std::istringstream lines(wisdom);
+  for (std::string line; std::getline(lines, line);) { plans.push_back(line); }
+  std::sort(plans.begin(), plans.end());
+  return plans;
+}
+
+}// namespace
+
+TEST_CASE("FFTBackend: batched real transforms") {
+  const int BATCH_SIZE = 4;
+  for (const auto &backend : backends()) {
+    // powers of two, and lengths transformed by Bluestein's algorithm
+    for (int N : {1, 8, 16, 7, 12, 25}) {
+      SPDLOG_INFO("{} transforms of {} samples", backend->name(), N);
+      auto transform = backend->plan_batched_real(N, BATCH_SIZE);
+      REQUIRE(transform->N == N);
+      REQUIRE(transform->batch_size == BATCH_SIZE);
+
+      int n_modes = N / 2 + 1;
+      vector<double> lines(N * BATCH_SIZE, 0.);
+      vector<fftw_complex> modes(n_modes * BATCH_SIZE);
+      // a whole batch, and a partial one
+      for (int n_lines : {BATCH_SIZE, BATCH_SIZE - 1}) {
+        for (int x = 0; x < N; x++) {
+          for (int b = 0; b < n_lines; b++) {
+            lines[x * BATCH_SIZE + b] = sample(x, b);
+          }
+        }
+        transform->forward(lines.data(), modes.data(), n_lines);
+        for (int b = 0; b < n_lines; b++) {
+          vector<complex<double>> line(N);
+          for (int x = 0; x < N; x++) { line[x] = sample(x, b); }
+          vector<complex<double>> expected = dft(line);
+          for (int m = 0; m < n_modes; m++) {
+            REQUIRE(modes[m * BATCH_SIZE + b][0] ==
+                    Approx(expected[m].real()).margin(TOL));
+            REQUIRE(modes[m * BATCH_SIZE + b][1] ==
+                    Approx(expected[m].imag()).margin(TOL));
+          }
+        }
+
+        // the backward transform is unnormalised
+        transform->backward(modes.data(), lines.data(), n_lines);
+        for (int x = 0; x < N; x++) {
+          for (int b = 0; b < n_lines; b++) {
+            REQUIRE(lines[x * BATCH_SIZE + b] ==
+                    Approx(N * sample(x, b)).margin(TOL));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("FFTBackend: 2D complex transforms") {
+  for (const auto &backend : backends()) {
+    for (auto shape : {std::make_pair(8, 4), std::make_pair(6, 5)}) {
+      int n_0 = shape.first, n_1 = shape.second;
+      SPDLOG_INFO("{} transform of {}x{}", backend->name(), n_0, n_1);
+      auto *data = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * n_0 *
+                                                n_1);
+      auto transform = backend->plan_complex_2d(n_0, n_1, data);
+
+      auto element = [](int a, int b) {
+        return complex<double>(sample(a, b), sample(b, a));
+      };
+      for (int a = 0; a < n_0; a++) {
+        for (int b = 0; b < n_1; b++) {
+          data[a * n_1 + b][0] = element(a, b).real();
+          data[a * n_1 + b][1] = element(a, b).imag();
+        }
+      }
+      transform->forward();
+
+      for (int k_0 = 0; k_0 < n_0; k_0++) {
+        for (int k_1 = 0; k_1 < n_1; k_1++) {
+          complex<double> expected = 0.;
+          for (int a = 0; a < n_0; a++) {
+            for (int b = 0; b < n_1; b++) {
+              double phase = (double) k_0 * a / n_0 + (double) k_1 * b / n_1;
+              expected += element(a, b) * std::polar(1., -2. * DCPI * phase);
+            }
+          }
+          REQUIRE(data[k_0 * n_1 + k_1][0] ==
+                  Approx(expected.real()).margin(TOL));
+          REQUIRE(data[k_0 * n_1 + k_1][1] ==
+                  Approx(expected.imag()).margin(TOL));
+        }
+      }
+      fftw_free(data);
+    }
+  }
+}
+
+TEST_CASE("PSTDVariables: one plan for each length of line") {
+  CountingFFTBackend fft;
+  PSTDVariables PSTD;
+
+  // the E-field lines have I_tot samples along x (and so on), the H-field
+  // lines one more, so a cubic grid has lines of two lengths
+  PSTD.set_using_dimensions({8, 8, 8}, fft);
+  REQUIRE(fft.n_plans == 2);
+  REQUIRE(PSTD.d_ex.length() == 8);
+  REQUIRE(PSTD.d_hz.length() == 9);
+
+  // 8, 6 and 7 samples for E, and 9, 7 and 8 for H
+  fft.n_plans = 0;
+  PSTD.set_using_dimensions({8, 6, 7}, fft);
+  REQUIRE(fft.n_plans == 4);
+}
+
+TEST_CASE("FFTBackend: wisdom export and import") {
+  auto tmp = tdms_tests::create_tmp_dir();
+  std::string file = (tmp / "wisdom.dat").string();
+
+  SECTION("FFTW") {
+    FFTWBackend fft(FFTPlanning::Measure, 1);
+    fft.plan_batched_real(12, 4);
+    std::string wisdom = fft.export_wisdom_to_string();
+    REQUIRE(!wisdom.empty());
+    REQUIRE(fft.export_wisdom(file));
+
+    // the plans read back from the file, or the string, are those exported
+    fftw_forget_wisdom();
+    REQUIRE(plans_in(fft.export_wisdom_to_string()) != plans_in(wisdom));
+    REQUIRE(fft.import_wisdom(file));
+    REQUIRE(plans_in(fft.export_wisdom_to_string()) == plans_in(wisdom));
+    fftw_forget_wisdom();
+    REQUIRE(fft.import_wisdom_from_string(wisdom));
+    REQUIRE(plans_in(fft.export_wisdom_to_string()) == plans_in(wisdom));
+  }
+
+  SECTION("Builtin") {
+    // which has no plans to save
+    BuiltinFFTBackend fft;
+    fft.plan_batched_real(12, 4);
+    REQUIRE(fft.export_wisdom_to_string().empty());
+    REQUIRE(!fft.export_wisdom(file));
+    REQUIRE(!fft.import_wisdom(file));
+  }
+
+  std::filesystem::remove_all(tmp);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file test_PhasorAccumulator.cpp
+ * @brief Tests of the accumulation of the volume phasors by the update
+ * kernels.
+ */
+#include "simulation_manager/phasor_accumulator.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <omp.h>
+
+#include "field_patterns.h"
+#include "unit_test_utils.h"
+
+using tdms_tests::is_close, tdms_tests::set_pattern;
+
+namespace {
+
+// a split field larger than the phasors, and with more k-layers than a tile
+const int I_tot = 6, J_tot = 4, K_tot = 37;
+const double OMEGA = 0.7, DT = 0.1;
+const int N_T = 5;
+
+/** @brief A field whose phasors are over part of the split field */
+void set_range(ElectricField &E) {
+  E.il = 1, E.iu = I_tot - 1;
+  E.jl = 1, E.ju = J_tot - 1;
+  E.kl = 2, E.ku = K_tot - 2;
+  E.allocate_and_zero();
+}
+
+/** @brief Add F to the accumulator as the fused kernels do, over every cell */
+void add_as_kernels_do(PhasorAccumulator &phasors,
+                       const ElectricSplitField &F) {
+#pragma omp parallel for collapse(2)
+  for (int i = 0; i <= I_tot; i++) {
+    for (int j = 0; j <= J_tot; j++) {
+      if (!phasors.accumulates(i, j)) { continue; }
+      for (int k = 0; k <= K_tot; k++) {
+        phasors.add(i, j, k, F.x(i, j, k), F.y(i, j, k), F.z(i, j, k));
+      }
+    }
+  }
+}
+
+/** @brief Whether the phasors of E and expected are close at every cell */
+bool phasors_are_close(ElectricField &E, ElectricField &expected) {
+  bool all_close = true;
+  for (int k = 0; k <= E.ku - E.kl; k++) {
+    for (int j = 0; j <= E.ju - E.jl; j++) {
+      for (int i = 0; i <= E.iu - E.il; i++) {
+        for (char c : {'x', 'y', 'z'}) {
+          all_close = all_close &&
+                      is_close(E.real[c][k][j][i], expected.real[c][k][j][i]) &&
+                      is_close(E.imag[c][k][j][i], expected.imag[c][k][j][i]);
+        }
+      }
+    }
+  }
+  return all_close;
+}
+
+}// namespace
+
+TEST_CASE("PhasorAccumulator: matches Field::set_phasors") {
+  ElectricSplitField F(I_tot, J_tot, K_tot);
+  F.allocate_and_zero();
+  ElectricField E(I_tot - 1, J_tot - 1, K_tot - 3),
+          expected(I_tot - 1, J_tot - 1, K_tot - 3);
+  set_range(E);
+  set_range(expected);
+
+  PhasorAccumulator phasors;
+  REQUIRE(!phasors.is_enabled());
+  REQUIRE(!phasors.accumulates(2, 2));
+  phasors.allocate(E);
+  REQUIRE(phasors.is_enabled());
+  REQUIRE(phasors.accumulates(E.il, E.jl));
+  REQUIRE(phasors.accumulates(E.iu, E.ju));
+  REQUIRE(!phasors.accumulates(E.il - 1, E.jl));
+  REQUIRE(!phasors.accumulates(E.iu, E.ju + 1));
+
+  // three timesteps of a period, with fields that differ between them
+  for (int n = 0; n < 3; n++) {
+    set_pattern(F, 1. + n);
+    phasors.set_phase_term(E, n, OMEGA, DT, N_T);
+    add_as_kernels_do(phasors, F);
+    expected.set_phasors(F, n, OMEGA, DT, N_T);
+  }
+  phasors.flush(E);
+  REQUIRE(phasors_are_close(E, expected));
+
+  // the accumulated phasors are zeroed by the flush, so a second flush adds
+  // nothing, and the phasors of the next timesteps are added to the first
+  phasors.flush(E);
+  REQUIRE(phasors_are_close(E, expected));
+
+  set_pattern(F, -2.);
+  phasors.set_phase_term(E, 3, OMEGA, DT, N_T);
+  add_as_kernels_do(phasors, F);
+  expected.set_phasors(F, 3, OMEGA, DT, N_T);
+#pragma omp parallel
+  phasors.flush(E);
+  REQUIRE(phasors_are_close(E, expected));
+}
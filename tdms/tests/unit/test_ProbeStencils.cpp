@@ -0,0 +1,139 @@
+/**
+ * @file test_ProbeStencils.cpp
+ * @brief Tests of the evaluation of the split fields at probes with compiled
+ * interpolation stencils.
+ */
+#include "probe_stencils.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+#include "field_patterns.h"
+#include "unit_test_utils.h"
+
+using namespace std;
+using tdms_flags::InterpolationMethod;
+using tdms_tests::is_close, tdms_tests::set_pattern;
+
+namespace {
+
+const AxialDirection DIRECTIONS[3] = {AxialDirection::X, AxialDirection::Y,
+                                      AxialDirection::Z};
+
+/**
+ * @brief Whether the probes of F, interpolated to the centre of each cell of
+ * cells in each direction, agree with SplitField::interpolate_to_centre_of
+ */
+bool probes_interpolate(SplitField &F, const vector<CellCoordinate> &cells) {
+  vector<double> expected;
+  ProbeStencils probes;
+  for (const CellCoordinate &cell : cells) {
+    for (AxialDirection d : DIRECTIONS) {
+      expected.push_back(F.interpolate_to_centre_of(d, cell));
+      probes.add_interpolated(F, d, cell);
+    }
+  }
+#pragma omp parallel
+  probes.evaluate(F);
+
+  bool all_close = probes.n_probes() == (int) expected.size();
+  for (int p = 0; all_close && p < probes.n_probes(); p++) {
+    all_close = is_close(probes.value(p), expected[p]);
+  }
+  return all_close;
+}
+
+/** @brief The cells from 1 to tot - 1 in each direction of F */
+vector<CellCoordinate> inner_cells(const SplitField &F) {
+  vector<CellCoordinate> cells;
+  for (int i = 1; i < F.tot.i; i++) {
+    for (int j = 1; j < F.tot.j; j++) {
+      for (int k = 1; k < F.tot.k; k++) { cells.push_back({i, j, k}); }
+    }
+  }
+  return cells;
+}
+
+}// namespace
+
+TEST_CASE("ProbeStencils: interpolation in 3D") {
+  ElectricSplitField E(12, 9, 5);
+  MagneticSplitField H(12, 9, 5);
+  E.allocate();
+  H.allocate();
+  set_pattern(E);
+  set_pattern(H);
+
+  for (InterpolationMethod method :
+       {InterpolationMethod::Cubic, InterpolationMethod::BandLimited}) {
+    E.set_preferred_interpolation_methods(method);
+    H.set_preferred_interpolation_methods(method);
+    REQUIRE(probes_interpolate(E, inner_cells(E)));
+    REQUIRE(probes_interpolate(H, inner_cells(H)));
+  }
+}
+
+TEST_CASE("ProbeStencils: interpolation in 2D") {
+  // there is no y-direction to interpolate in
+  ElectricSplitField E(10, 1, 8);
+  MagneticSplitField H(10, 1, 8);
+  E.allocate();
+  H.allocate();
+  set_pattern(E);
+  set_pattern(H);
+
+  vector<CellCoordinate> cells;
+  for (int i = 1; i < 10; i++) {
+    for (int k = 1; k < 8; k++) { cells.push_back({i, 0, k}); }
+  }
+  REQUIRE(probes_interpolate(E, cells));
+  REQUIRE(probes_interpolate(H, cells));
+}
+
+TEST_CASE("ProbeStencils: unsplit interior") {
+  ElectricSplitField E(10, 8, 9);
+  E.allocate();
+  set_pattern(E);
+  vector<CellCoordinate> cells = inner_cells(E);
+  vector<double> expected;
+  for (const CellCoordinate &cell : cells) {
+    for (AxialDirection d : DIRECTIONS) {
+      expected.push_back(E.interpolate_to_centre_of(d, cell));
+    }
+  }
+
+  // the stencils of the probes straddle the edges of the unsplit interior
+  E.unsplit_interior({{3, 2, 3}, {7, 6, 6}});
+  ProbeStencils probes;
+  for (const CellCoordinate &cell : cells) {
+    for (AxialDirection d : DIRECTIONS) { probes.add_interpolated(E, d, cell); }
+  }
+  probes.evaluate(E);
+  bool all_close = true;
+  for (int p = 0; p < probes.n_probes(); p++) {
+    all_close = all_close && is_close(probes.value(p), expected[p]);
+  }
+  REQUIRE(all_close);
+}
+
+TEST_CASE("ProbeStencils: values and zeros") {
+  MagneticSplitField H(6, 6, 6);
+  H.allocate();
+  set_pattern(H);
+
+  ProbeStencils probes;
+  REQUIRE(probes.empty());
+  REQUIRE(probes.add_value(H, AxialDirection::X, {1, 2, 3}) == 0);
+  REQUIRE(probes.add_zero(H) == 1);
+  REQUIRE(probes.add_value(H, AxialDirection::Y, {4, 0, 5}) == 2);
+  REQUIRE(probes.add_value(H, AxialDirection::Z, {6, 6, 6}) == 3);
+  probes.evaluate(H);
+  REQUIRE(is_close(probes.value(0), H.x(1, 2, 3)));
+  REQUIRE(probes.value(1) == 0.);
+  REQUIRE(is_close(probes.value(2), H.y(4, 0, 5)));
+  REQUIRE(is_close(probes.value(3), H.z(6, 6, 6)));
+
+  probes.clear();
+  REQUIRE(probes.empty());
+  REQUIRE(probes.add_zero(H) == 0);
+}
@@ -0,0 +1,275 @@
+/**
+ * @file test_SimulationManager.cpp
+ * @brief Tests that the alternative ways of advancing the fields of a
+ * SimulationManager agree.
+ */
+#include "simulation_manager/simulation_manager.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <catch2/catch_test_macros.hpp>
+#include <omp.h>
+#include <spdlog/spdlog.h>
+
+#include "small_simulation.h"
+
+using tdms_tests::SmallSimulation;
+using tdms_tests::SmallSimulationSetup;
+
+namespace {
+
+/**
+ * @brief The number of cells at which the split components of two fields
+ * differ
+ */
+template<typename SplitFieldType>
+int n_different(const SplitFieldType &a, const SplitFieldType &b,
+                const IJKDimensions &IJK_tot) {
+  const SplitFieldComponent *components_a[6] = {&a.xy, &a.xz, &a.yx,
+                                                &a.yz, &a.zx, &a.zy};
+  const SplitFieldComponent *components_b[6] = {&b.xy, &b.xz, &b.yx,
+                                                &b.yz, &b.zx, &b.zy};
+  int n = 0;
+  for (int c = 0; c < 6; c++) {
+    for (int k = 0; k <= IJK_tot.k; k++) {
+      for (int j = 0; j <= IJK_tot.j; j++) {
+        for (int i = 0; i <= IJK_tot.i; i++) {
+          if (components_a[c]->value(i, j, k) !=
+              components_b[c]->value(i, j, k)) {
+            n++;
+          }
+        }
+      }
+    }
+  }
+  return n;
+}
+
+/** @brief The number of elements at which the phasors of two fields differ */
+int n_different(const Field &a, const Field &b) {
+  double ***parts_a[6] = {a.real.x, a.real.y, a.real.z,
+                          a.imag.x, a.imag.y, a.imag.z};
+  double ***parts_b[6] = {b.real.x, b.real.y, b.real.z,
+                          b.imag.x, b.imag.y, b.imag.z};
+  int n = 0;
+  for (int p = 0; p < 6; p++) {
+    for (int k = 0; k < a.tot.k; k++) {
+      for (int j = 0; j < a.tot.j; j++) {
+        for (int i = 0; i < a.tot.i; i++) {
+          if (parts_a[p][k][j][i] != parts_b[p][k][j][i]) { n++; }
+        }
+      }
+    }
+  }
+  return n;
+}
+
+/**
+ * @brief Require that two simulations, which have been executed, have
+ * identical fields and phasors
+ */
+void require_identical(const SimulationManager &a, const SimulationManager &b,
+                       const IJKDimensions &IJK_tot) {
+  REQUIRE(n_different(a.E_field(), b.E_field(), IJK_tot) == 0);
+  REQUIRE(n_different(a.H_field(), b.H_field(), IJK_tot) == 0);
+  REQUIRE(n_different(a.get_outputs().E, b.get_outputs().E) == 0);
+  REQUIRE(n_different(a.get_outputs().H, b.get_outputs().H) == 0);
+}
+
+/** @brief The largest absolute value of the x-directed field */
+template<typename SplitFieldType>
+double largest_x(const SplitFieldType &E, const IJKDimensions &IJK_tot) {
+  double largest = 0.;
+  for (int k = 0; k <= IJK_tot.k; k++) {
+    for (int j = 0; j <= IJK_tot.j; j++) {
+      for (int i = 0; i <= IJK_tot.i; i++) {
+        largest = std::max(largest, (double) std::abs(E.x(i, j, k)));
+      }
+    }
+  }
+  return largest;
+}
+
+/**
+ * @brief The largest difference between the x, y, and z-directed fields, the
+ * sums of their split components, of two fields
+ */
+template<typename SplitFieldType>
+double largest_difference(const SplitFieldType &a, const SplitFieldType &b,
+                          const IJKDimensions &IJK_tot) {
+  double largest = 0.;
+  for (int k = 0; k <= IJK_tot.k; k++) {
+    for (int j = 0; j <= IJK_tot.j; j++) {
+      for (int i = 0; i <= IJK_tot.i; i++) {
+        largest = std::max({largest,
+                            (double) std::abs(a.x(i, j, k) - b.x(i, j, k)),
+                            (double) std::abs(a.y(i, j, k) - b.y(i, j, k)),
+                            (double) std::abs(a.z(i, j, k) - b.z(i, j, k))});
+      }
+    }
+  }
+  return largest;
+}
+
+}// namespace
+
+/**
+ * @brief Test that the cache-blocked updates, which advance each slab of the
+ * grid by several timesteps in turn, give the same fields and phasors as
+ * advancing the whole grid a timestep at a time.
+ *
+ * The slabs are narrower than the grid, and each tile of 4 timesteps applies
+ * the source and extracts the phasors at each of its steps.
+ */
+TEST_CASE("SimulationManager: cache blocking matches the unblocked updates") {
+  spdlog::set_level(spdlog::level::off);
+  SmallSimulation simulation;
+
+  SolverOptions blocked_options;
+  blocked_options.cache_blocking = true;
+  blocked_options.tile_steps = 4;
+  blocked_options.slab_width = 3;
+
+  SimulationManager unblocked(simulation.matrices(), InputFlags());
+  SimulationManager blocked(simulation.matrices(), InputFlags(),
+                            blocked_options);
+  unblocked.execute();
+  blocked.execute();
+
+  IJKDimensions IJK_tot = unblocked.n_Yee_cells();
+  // the source has reached the fields, so that the comparison means something
+  REQUIRE(largest_x(unblocked.E_field(), IJK_tot) > 0.);
+  require_identical(unblocked, blocked, IJK_tot);
+}
+
+/**
+ * @brief Test that the fused update engine, which updates all the split
+ * components of a cell together, gives the same fields and phasors as
+ * updating each split component in a sweep of its own.
+ *
+ * The fields are advanced through the PML and a dispersive scatterer, whose
+ * auxiliary fields are stored sparsely, and through a conductive background,
+ * which makes the auxiliary fields dense.
+ */
+TEST_CASE("SimulationManager: fused updates match the component updates") {
+  spdlog::set_level(spdlog::level::off);
+  SmallSimulationSetup setup;
+  setup.dispersive = true;
+  SECTION("Dispersive scatterer") {}
+  SECTION("Conductive background and dispersive scatterer") {
+    setup.conductive = true;
+  }
+  SmallSimulation simulation(setup);
+
+  SolverOptions fused_options;
+  fused_options.fused_updates = true;
+
+  SimulationManager component(simulation.matrices(), InputFlags());
+  SimulationManager fused(simulation.matrices(), InputFlags(), fused_options);
+  component.execute();
+  fused.execute();
+
+  IJKDimensions IJK_tot = component.n_Yee_cells();
+  REQUIRE(largest_x(component.E_field(), IJK_tot) > 0.);
+  require_identical(component, fused, IJK_tot);
+}
+
+/**
+ * @brief Test that the main loop, whose single team of threads persists over
+ * all the timesteps, gives the same fields and phasors with several threads
+ * as with one thread, which runs every stage of every timestep in turn.
+ */
+TEST_CASE("SimulationManager: a persistent team of threads matches one "
+          "thread") {
+  spdlog::set_level(spdlog::level::off);
+  SmallSimulationSetup setup;
+  SolverOptions options;
+  SECTION("Dispersive scatterer") { setup.dispersive = true; }
+  SECTION("Fused updates of a conductive background") {
+    setup.conductive = true;
+    options.fused_updates = true;
+  }
+  SECTION("Cache blocking") {
+    options.cache_blocking = true;
+    options.slab_width = 3;
+  }
+  SmallSimulation simulation(setup);
+
+  int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  SimulationManager one_thread(simulation.matrices(), InputFlags(), options);
+  one_thread.execute();
+  omp_set_num_threads(4);
+  SimulationManager four_threads(simulation.matrices(), InputFlags(), options);
+  four_threads.execute();
+  omp_set_num_threads(max_threads);
+
+  IJKDimensions IJK_tot = one_thread.n_Yee_cells();
+  REQUIRE(largest_x(one_thread.E_field(), IJK_tot) > 0.);
+  require_identical(one_thread, four_threads, IJK_tot);
+}
+
+/**
+ * @brief Test that fields stored unsplit outside the PML, whose xz, yz, and zy
+ * components are only ever allocated in the PML, advance as the split fields
+ * do.
+ *
+ * The sum of the two split components of a field direction is rounded
+ * differently from the unsplit field, so the fields agree to a tolerance of
+ * the precision of field_t, relative to the largest field.
+ */
+TEST_CASE("SimulationManager: unsplit interiors match the split fields") {
+  spdlog::set_level(spdlog::level::off);
+  SmallSimulationSetup setup;
+  SECTION("Non-dispersive") {}
+  SECTION("Conductive background and dispersive scatterer") {
+    setup.dispersive = setup.conductive = true;
+  }
+  SmallSimulation simulation(setup);
+
+  SolverOptions unsplit_options;
+  unsplit_options.unsplit_interior = true;
+
+  SimulationManager split(simulation.matrices(), InputFlags());
+  SimulationManager unsplit(simulation.matrices(), InputFlags(),
+                            unsplit_options);
+  split.execute();
+  unsplit.execute();
+
+  REQUIRE(unsplit.E_field().has_unsplit_interior());
+  REQUIRE(unsplit.E_field().xz.is_pml_only());
+  REQUIRE(unsplit.H_field().zy.is_pml_only());
+  IJKDimensions IJK_tot = split.n_Yee_cells();
+  double tolerance = 10 * std::numeric_limits<field_t>::epsilon();
+  REQUIRE(largest_difference(split.E_field(), unsplit.E_field(), IJK_tot) <
+          tolerance * largest_x(split.E_field(), IJK_tot));
+  REQUIRE(largest_difference(split.H_field(), unsplit.H_field(), IJK_tot) <
+          tolerance * largest_x(split.H_field(), IJK_tot));
+}
+
+/**
+ * @brief Test that a simulation whose materials are read from the grid file,
+ * as each process of a distributed grid reads those of its block, matches one
+ * whose materials are loaded with the other inputs.
+ */
+TEST_CASE("SimulationManager: materials read from the grid file match the "
+          "loaded grid") {
+  spdlog::set_level(spdlog::level::off);
+  SmallSimulationSetup setup;
+  setup.dispersive = true;
+  SmallSimulation loaded_simulation(setup);
+  setup.grid_in_file = true;
+  SmallSimulation read_simulation(setup);
+
+  SimulationManager loaded(loaded_simulation.matrices(), InputFlags());
+  SimulationManager read(read_simulation.matrices(), InputFlags());
+  loaded.execute();
+  read.execute();
+
+  IJKDimensions IJK_tot = loaded.n_Yee_cells();
+  REQUIRE(read.n_Yee_cells().i == IJK_tot.i);
+  REQUIRE(read.n_Yee_cells().k == IJK_tot.k);
+  REQUIRE(largest_x(loaded.E_field(), IJK_tot) > 0.);
+  require_identical(loaded, read, IJK_tot);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file test_SparseCurrents.cpp
+ * @brief Tests of the storage of the dispersive and conductive auxiliary
+ * fields at only the cells that need them.
+ */
+#include "simulation_manager/sparse_currents.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/spdlog.h>
+
+#include "unit_test_utils.h"
+
+using tdms_tests::is_close;
+
+namespace {
+
+const int N_CELLS = 6;//< Number of Yee cells in each direction
+const double DT = 0.5;
+/*! Tolerance of comparisons of the fields, which may be single precision */
+const double FIELD_TOL = 1e-6;
+
+/**
+ * @brief A dispersive block of cells 2 <= i, j, k <= 3, and a single
+ * conductive cell (1, 1, 1) for the x-directed components only.
+ */
+CellCoefficients medium(int i, int j, int k, bool x_directed) {
+  CellCoefficients cell;
+  for (ECoefficients &c : cell.E) {
+    c.Ca = 1.;
+    c.Cb = 0.5;
+    if (i >= 2 && i <= 3 && j >= 2 && j <= 3 && k >= 2 && k <= 3) {
+      c.Cc = 0.25;
+      c.alpha = 0.5;
+      c.beta = 0.25;
+      c.gamma = 1.;
+    }
+    if (x_directed && i == 1 && j == 1 && k == 1) { c.rho = 0.1; }
+  }
+  return cell;
+}
+
+UpdateCoefficientPlan medium_plan() {
+  UpdateCoefficientPlan plan;
+  auto directed = [](bool x_directed) {
+    return [x_directed](int i, int j, int k) {
+      return medium(i, j, k, x_directed);
+    };
+  };
+  plan.build(N_CELLS, N_CELLS, N_CELLS, directed(true), directed(false),
+             directed(false));
+  return plan;
+}
+
+}// namespace
+
+TEST_CASE("SparseCurrents: cells and storage") {
+  SPDLOG_INFO("===== Testing SparseCurrents =====");
+  UpdateCoefficientPlan plan = medium_plan();
+  ElectricSplitField E_s(N_CELLS, N_CELLS, N_CELLS);
+  E_s.allocate_and_zero();
+  YeeCellDimensions delta = {1., 1., 1.};
+  SparseCurrents currents;
+  REQUIRE(!currents.is_active());
+
+  SECTION("Dispersive and conductive") {
+    currents.build(plan, E_s, E_s.stored_cells(), N_CELLS, N_CELLS + 1, delta,
+                   DT, true, true);
+    REQUIRE(currents.is_active());
+    // 8 dispersive cells of each component, and the conductive cell of xy, xz
+    REQUIRE(currents.n_cells() == 6 * 8 + 2);
+
+    CellCoordinate dispersive = {2, 3, 2}, conductive = {1, 1, 1},
+                   neither = {4, 4, 4};
+    REQUIRE(currents.J_s(&SplitField::zy, dispersive) != nullptr);
+    REQUIRE(currents.J_c(&SplitField::xz, conductive) != nullptr);
+    REQUIRE(currents.J_c(&SplitField::yx, conductive) == nullptr);
+    REQUIRE(currents.J_s(&SplitField::xy, neither) == nullptr);
+  }
+  SECTION("Conductive only") {
+    currents.build(plan, E_s, E_s.stored_cells(), N_CELLS, N_CELLS + 1, delta,
+                   DT, false, true);
+    REQUIRE(currents.n_cells() == 2);
+    // the dispersive fields are not stored at all
+    REQUIRE(currents.J_s(&SplitField::xy, {1, 1, 1}) == nullptr);
+    REQUIRE(currents.n_bytes() < 6 * sizeof(field_t) * (N_CELLS + 1) *
+                                         (N_CELLS + 1) * (N_CELLS + 1));
+  }
+
+  currents.clear();
+  REQUIRE(!currents.is_active());
+  REQUIRE(currents.n_cells() == 0);
+}
+
+TEST_CASE("SparseCurrents: dispersive and conductive terms") {
+  UpdateCoefficientPlan plan = medium_plan();
+  ElectricSplitField E_s(N_CELLS, N_CELLS, N_CELLS);
+  E_s.allocate_and_zero();
+  YeeCellDimensions delta = {1., 2., 3.};
+  SparseCurrents currents;
+  currents.build(plan, E_s, E_s.stored_cells(), N_CELLS, N_CELLS + 1, delta,
+                 DT, true, true);
+
+  // advance the fields at the listed cells, as if by the update of the grid
+  auto advance = [&](double E_n, double E_np1) {
+    E_s.xy(2, 2, 2) = (field_t) E_n;
+    E_s.xz(1, 1, 1) = (field_t) E_n;
+#pragma omp parallel
+    {
+      currents.save_fields(E_s);
+#pragma omp single
+      {
+        E_s.xy(2, 2, 2) = (field_t) E_np1;
+        E_s.xz(1, 1, 1) = (field_t) E_np1;
+      }
+      currents.apply(E_s);
+    }
+  };
+  const ECoefficients &c = plan.Exy(2, 2, 2);
+
+  // with the auxiliary fields zero, only the current density is advanced
+  advance(2., 3.);
+  REQUIRE(is_close((double) E_s.xy(2, 2, 2), 3., FIELD_TOL));
+  double J_s = c.kappa * c.gamma / (2. * DT) * 3.;
+  REQUIRE(is_close(*currents.J_s(&SplitField::xy, {2, 2, 2}), J_s));
+
+  // the terms of the previous step now enter the update of the field
+  advance(3., 4.);
+  double E_np1 = 4. + c.Cc * 2. -
+                 1. / 2. * c.Cb * delta.dy * (1 + c.alpha) * J_s;
+  REQUIRE(is_close((double) E_s.xy(2, 2, 2), E_np1, FIELD_TOL));
+
+  // the conductive current density enters the update of the xz component
+  const ECoefficients &c_xz = plan.Exz(1, 1, 1);
+  double J_c = *currents.J_c(&SplitField::xz, {1, 1, 1});
+  advance(1., 1.);
+  REQUIRE(is_close((double) E_s.xz(1, 1, 1), 1. + c_xz.Cb * delta.dz * J_c,
+                   FIELD_TOL));
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_SpectralLines.cpp
+ * @brief Tests of the segments of the lines that the hybrid PSTD/FDTD solver
+ * differentiates by finite differences around the interfaces between
+ * materials, and of the accuracy of its derivatives against those of PSTD.
+ */
+#include "simulation_manager/pstd_variables.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/spdlog.h>
+
+using Catch::Approx;
+using std::vector;
+
+TEST_CASE("SpectralLines: segments around an interface") {
+  SPDLOG_INFO("===== Testing SpectralLines =====");
+  const IJKDimensions IJK_tot = {19, 6, 5};
+  int n_i = IJK_tot.i + 1, n_j = IJK_tot.j + 1, n_k = IJK_tot.k + 1;
+
+  // the background, with a scatterer of the cells i = 8, ..., 11 at (j, k) =
+  // (3, 2): the line along x through it has interfaces after samples 7 and 11
+  Tensor3D<uint8_t> materials(n_k, n_j, n_i);
+  materials.zero();
+  for (int i = 8; i < 12; i++) { materials(i, 3, 2) = 1; }
+
+  SpectralLines lines;
+  vector<double> weight(n_i, -1.);
+  REQUIRE(!lines.x(3, 2, n_i, weight.data()));
+  REQUIRE(lines.spectral_fraction() == 1.);
+
+  SECTION("No overlap") {
+    lines.classify(materials, IJK_tot, 0);
+    // only the samples on either side of each interface are finite differences
+    REQUIRE(lines.x(3, 2, n_i, weight.data()));
+    for (int x = 0; x < n_i; x++) {
+      bool at_interface = x == 7 || x == 8 || x == 11 || x == 12;
+      REQUIRE(weight[x] == (at_interface ? 0. : 1.));
+    }
+    REQUIRE(lines.y(9, 2, n_j, weight.data()));
+    REQUIRE(weight[1] == 1.);
+    REQUIRE(weight[2] == 0.);
+    REQUIRE(weight[4] == 0.);
+    REQUIRE(weight[5] == 1.);
+    REQUIRE(lines.z(9, 3, n_k, weight.data()));
+    REQUIRE(weight[0] == 1.);
+    REQUIRE(weight[3] == 0.);
+    // the lines without an interface are spectral throughout
+    REQUIRE(!lines.x(4, 2, n_i, weight.data()));
+    REQUIRE(!lines.y(7, 2, n_j, weight.data()));
+    REQUIRE(!lines.z(9, 4, n_k, weight.data()));
+    // 4 samples of the line along x, and 3 of each of the 4 lines along y and
+    // along z through the scatterer
+    double n_samples = 3. * n_i * n_j * n_k;
+    REQUIRE(lines.spectral_fraction() ==
+            Approx((n_samples - 28.) / n_samples));
+  }
+  SECTION("Overlap") {
+    lines.classify(materials, IJK_tot, 2);
+    // finite differences within 2 cells of an interface, which blend into the
+    // spectral derivative over the next 2
+    REQUIRE(lines.x(3, 2, n_i, weight.data()));
+    const double expected[20] = {1.,   1.,   1., 0.75, 0.25, 0., 0.,
+                                 0.,   0.,   0., 0.,   0.,   0., 0.,
+                                 0.,   0.25, 0.75, 1., 1.,   1.};
+    for (int x = 0; x < n_i; x++) {
+      REQUIRE(weight[x] == Approx(expected[x]).margin(1e-12));
+    }
+    // only along the lines that cross an interface
+    REQUIRE(!lines.x(2, 2, n_i, weight.data()));
+    REQUIRE(!lines.x(3, 1, n_i, weight.data()));
+  }
+  SECTION("Materials of a block of the grid") {
+    // as a process of a distributed grid stores them
+    Tensor3D<uint8_t> block;
+    block.allocate({{6, 1, 0}, {14, 5, 4}});
+    block.zero();
+    for (int i = 8; i < 12; i++) { block(i, 3, 2) = 1; }
+    lines.classify(block, IJK_tot, 0);
+    REQUIRE(lines.x(3, 2, n_i, weight.data()));
+    for (int x = 0; x < n_i; x++) {
+      bool at_interface = x == 7 || x == 8 || x == 11 || x == 12;
+      REQUIRE(weight[x] == (at_interface ? 0. : 1.));
+    }
+    REQUIRE(lines.z(9, 3, n_k, weight.data()));
+    REQUIRE(!lines.x(4, 2, n_i, weight.data()));
+  }
+}
+
+/**
+ * @brief Test the accuracy of the hybrid derivative of a smooth field against
+ * that of pure PSTD.
+ *
+ * The field is band-limited, so the spectral derivative is exact. The hybrid
+ * derivative is identical to it away from the interfaces, and within the
+ * finite-difference segments and the overlaps is no further from the exact
+ * derivative than the second-order error of the central difference.
+ */
+TEST_CASE("SpectralLines: the hybrid derivative against pure PSTD") {
+  const IJKDimensions IJK_tot = {32, 3, 3};
+  int n_j = IJK_tot.j + 1, n_k = IJK_tot.k + 1;
+  // the lines along x of the E-field updates
+  const int N = IJK_tot.i;
+  const double DELTA = -0.5, TWO_PI = 2. * M_PI;
+
+  // a slab of the cells i = 10, ..., 19 across the lines with j = 1
+  Tensor3D<uint8_t> materials(n_k, n_j, N + 1);
+  materials.zero();
+  for (int k = 0; k < n_k; k++) {
+    for (int i = 10; i < 20; i++) { materials(i, 1, k) = 1; }
+  }
+  SpectralLines lines;
+  lines.classify(materials, IJK_tot, 2);
+
+  const double k_1 = TWO_PI * 2. / N, k_2 = TWO_PI * 3. / N;
+  auto sample = [&](int j, int k, int x) {
+    return std::sin(k_1 * x + j) + 0.5 * std::cos(k_2 * x + k);
+  };
+  // the derivative with respect to the sample index, half a cell back
+  auto exact = [&](int j, int k, int x) {
+    double at = x + DELTA;
+    return k_1 * std::cos(k_1 * at + j) - 0.5 * k_2 * std::sin(k_2 * at + k);
+  };
+  // the bound |f'''| / 24 on the error of the central difference
+  const double fd_error = (std::pow(k_1, 3) + 0.5 * std::pow(k_2, 3)) / 24.;
+
+  BatchedDerivative derivative;
+  derivative.initialise(N, DELTA, omp_get_max_threads(), 4);
+  vector<double> pstd(n_j * n_k * N), hybrid(n_j * n_k * N);
+  auto into = [&](vector<double> &result) {
+    return [&result, N, n_k](int j, int k, int x, double value) {
+      result[(j * n_k + k) * N + x] = value;
+    };
+  };
+#pragma omp parallel
+  {
+    derivative.differentiate_lines(n_j, n_k, 1, N, sample, into(pstd));
+    derivative.differentiate_lines(
+            n_j, n_k, 1, N, sample, into(hybrid),
+            [&](int j, int k, int n, double *weight) {
+              return lines.x(j, k, n, weight);
+            });
+  }
+
+  vector<double> weight(N);
+  double largest_error = 0.;
+  for (int j = 0; j < n_j; j++) {
+    for (int k = 0; k < n_k; k++) {
+      if (!lines.x(j, k, N, weight.data())) {
+        std::fill(weight.begin(), weight.end(), 1.);
+      }
+      for (int x = 1; x < N; x++) {
+        int n = (j * n_k + k) * N + x;
+        REQUIRE(pstd[n] == Approx(exact(j, k, x)).margin(1e-10));
+        if (weight[x] == 1.) {
+          REQUIRE(hybrid[n] == pstd[n]);
+        } else {
+          double error = std::abs(hybrid[n] - exact(j, k, x));
+          REQUIRE(error <= (1. - weight[x]) * fd_error + 1e-10);
+          largest_error = std::max(largest_error, error);
+        }
+      }
+    }
+  }
+  // the segments around the interfaces are differentiated by finite
+  // differences, so that the comparison means something
+  REQUIRE(largest_error > 0.1 * fd_error);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file test_SurfacePhasors.cpp
+ * @brief Tests of the extraction of the phasors on the surface.
+ */
+#include "surface_phasors.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+#include "field_patterns.h"
+#include "globals.h"
+#include "simulation_parameters.h"
+#include "unit_test_utils.h"
+
+using namespace std;
+using tdms_math_constants::DCPI;
+using tdms_tests::is_close, tdms_tests::set_pattern;
+
+namespace {
+
+const int I_tot = 8, J_tot = 7, K_tot = 9;
+const int N_T = 4;
+const vector<double> FREQUENCIES = {0.1, 0.35, 0.6};
+
+/** @brief Create the (MATLAB) list of vertices of a surface */
+mxArray *create_vertices(const vector<CellCoordinate> &vertices) {
+  int n_vertices = vertices.size();
+  mxArray *array =
+          mxCreateNumericMatrix(n_vertices, 3, mxINT32_CLASS, mxREAL);
+  int *data = (int *) mxGetPr(array);
+  for (int v = 0; v < n_vertices; v++) {
+    data[v] = vertices[v].i;
+    data[n_vertices + v] = vertices[v].j;
+    data[2 * n_vertices + v] = vertices[v].k;
+  }
+  return array;
+}
+
+}// namespace
+
+TEST_CASE("SurfacePhasors: extraction at every frequency") {
+  ElectricSplitField E(I_tot, J_tot, K_tot);
+  MagneticSplitField H(I_tot, J_tot, K_tot);
+  E.allocate_and_zero();
+  H.allocate_and_zero();
+  SimulationParameters params;
+  params.dt = 0.2;
+
+  mxArray *vertices = create_vertices(
+          {{2, 2, 2}, {3, 4, 5}, {6, 5, 7}, {4, 2, 3}, {5, 5, 2}});
+  int n_frequencies = FREQUENCIES.size();
+  SurfacePhasors batched(vertices, n_frequencies),
+          per_frequency(vertices, n_frequencies),
+          compiled(vertices, n_frequencies);
+  batched.zero_surface_EH();
+  per_frequency.zero_surface_EH();
+  compiled.zero_surface_EH();
+
+  for (bool interpolate : {true, false}) {
+    for (Dimension dimension :
+         {Dimension::THREE, Dimension::TRANSVERSE_ELECTRIC,
+          Dimension::TRANSVERSE_MAGNETIC}) {
+      params.dimension = dimension;
+      compiled.compile_probes(E, H, dimension, interpolate);
+      for (int n = 0; n < N_T; n++) {
+        set_pattern(E, H, 1. + 0.5 * n);
+        batched.extractPhasorsSurface(E, H, n, FREQUENCIES, N_T, params,
+                                      interpolate);
+        compiled.extractPhasorsSurface(E, H, n, FREQUENCIES, N_T, params,
+                                       interpolate);
+        for (int ifx = 0; ifx < n_frequencies; ifx++) {
+          per_frequency.extractPhasorsSurface(
+                  ifx, E, H, n, FREQUENCIES[ifx] * 2 * DCPI, N_T, params,
+                  interpolate);
+        }
+      }
+    }
+  }
+
+  // the fields at the vertices are the same, whether interpolated for each
+  // frequency, once for every frequency, or with compiled stencils
+  vector<complex<double>> batched_amplitudes = batched.amplitudes(),
+                          compiled_amplitudes = compiled.amplitudes(),
+                          expected = per_frequency.amplitudes();
+  REQUIRE(batched_amplitudes.size() == expected.size());
+  REQUIRE(compiled_amplitudes.size() == expected.size());
+  bool all_close = true;
+  for (size_t i = 0; i < expected.size(); i++) {
+    all_close = all_close && is_close(batched_amplitudes[i], expected[i]) &&
+                is_close(compiled_amplitudes[i], expected[i]);
+  }
+  REQUIRE(all_close);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file test_UpdateCoefficients.cpp
+ * @brief Tests of the per-cell lookup of update coefficients.
+ */
+#include "simulation_manager/update_coefficients.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief The coefficients of a layered medium: every cell in layer k shares
+ * its coefficients, except for a single inclusion at the centre of the grid.
+ */
+static CellCoefficients layered_medium(int i, int j, int k, int centre) {
+  CellCoefficients cell;
+  cell.E[0].Ca = 1. + k;
+  cell.E[1].Cb = 2. * k;
+  cell.H[0].Da = -1. * k;
+  if (i == centre && j == centre && k == centre) { cell.E[0].rho = 0.5; }
+  return cell;
+}
+
+TEST_CASE("CoefficientTable: lookup and deduplication") {
+  SPDLOG_INFO("===== Testing CoefficientTable =====");
+  const int I_tot = 8, J_tot = 6, K_tot = 10, centre = 3;
+  auto medium = [&](int i, int j, int k) {
+    return layered_medium(i, j, k, centre);
+  };
+
+  CoefficientTable table;
+  table.build(I_tot, J_tot, K_tot, medium);
+
+  // every cell must recover exactly the coefficients it was built with
+  bool all_match = true;
+  for (int i = 0; i <= I_tot; i++) {
+    for (int j = 0; j <= J_tot; j++) {
+      for (int k = 0; k <= K_tot; k++) {
+        const CellCoefficients &stored = table(i, j, k),
+                               expected = medium(i, j, k);
+        all_match = all_match &&
+                    std::memcmp(&stored, &expected, sizeof(expected)) == 0;
+      }
+    }
+  }
+  REQUIRE(all_match);
+
+  // one record per layer plus the inclusion, possibly repeated across threads
+  size_t n_distinct = K_tot + 2;
+  REQUIRE(table.n_records() >= n_distinct);
+  REQUIRE(table.n_records() <= n_distinct * omp_get_max_threads());
+}
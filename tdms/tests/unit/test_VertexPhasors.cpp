@@ -8,9 +8,13 @@
 
 #include "array_test_class.h"
 #include "globals.h"
+#include "simulation_parameters.h"
+#include "unit_test_utils.h"
 #include "vertex_phasors.h"
 
 using namespace std;
+using tdms_math_constants::DCPI;
+using tdms_tests::is_close;
 
 void VertexPhasorsTest::test_empty_construction() {
   create_empty_struct();
@@ -50,3 +54,80 @@ void VertexPhasorsTest::test_correct_construction() {
 }
 
 TEST_CASE("VertexPhasors") { VertexPhasorsTest().run_all_class_tests(); }
+
+TEST_CASE("VertexPhasors: extraction at every frequency") {
+  const int I_tot = 7, J_tot = 6, K_tot = 8, N_T = 3;
+  const vector<double> frequencies = {0.15, 0.4};
+  const vector<CellCoordinate> cells = {{2, 3, 2}, {5, 4, 6}, {3, 2, 5}};
+  const vector<int> requested = {1, 4, 6};//< Ex, Hx and Hz
+
+  ElectricSplitField E(I_tot, J_tot, K_tot);
+  MagneticSplitField H(I_tot, J_tot, K_tot);
+  E.allocate_and_zero();
+  H.allocate_and_zero();
+  SimulationParameters params;
+  params.dt = 0.3;
+  params.Npe = N_T;
+
+  // the vertices are given with MATLAB (1-based) indices
+  const char *fieldnames[2] = {"vertices", "components"};
+  mwSize dims[2] = {1, 1};
+  mxArray *matlab_input = mxCreateStructArray(2, dims, 2, fieldnames);
+  int n_vertices = cells.size(), n_requested = requested.size();
+  mxArray *vertices =
+          mxCreateNumericMatrix(n_vertices, 3, mxINT32_CLASS, mxREAL);
+  int *vertex_data = (int *) mxGetPr(vertices);
+  for (int v = 0; v < n_vertices; v++) {
+    vertex_data[v] = cells[v].i + 1;
+    vertex_data[n_vertices + v] = cells[v].j + 1;
+    vertex_data[2 * n_vertices + v] = cells[v].k + 1;
+  }
+  mxArray *components =
+          mxCreateNumericMatrix(1, n_requested, mxINT32_CLASS, mxREAL);
+  int *component_data = (int *) mxGetPr(components);
+  for (int c = 0; c < n_requested; c++) { component_data[c] = requested[c]; }
+  mxSetField(matlab_input, 0, fieldnames[0], vertices);
+  mxSetField(matlab_input, 0, fieldnames[1], components);
+
+  int n_frequencies = frequencies.size();
+  VertexPhasors batched(matlab_input), per_frequency(matlab_input),
+          compiled(matlab_input);
+  batched.setup_complex_amplitude_arrays(n_frequencies);
+  per_frequency.setup_complex_amplitude_arrays(n_frequencies);
+  compiled.setup_complex_amplitude_arrays(n_frequencies);
+  compiled.compile_probes(E, H, params.dimension);
+
+  for (int n = 0; n < N_T; n++) {
+    for (int i = 0; i <= I_tot; i++) {
+      for (int j = 0; j <= J_tot; j++) {
+        for (int k = 0; k <= K_tot; k++) {
+          E.xy(i, j, k) = (i + 1.) * (n - 1);
+          E.zx(i, j, k) = 0.5 * j * k;
+          H.xz(i, j, k) = i - 2. * k + n;
+          H.yx(i, j, k) = 0.1 * j;
+          H.zy(i, j, k) = (k + 0.5) * n;
+        }
+      }
+    }
+    batched.extractPhasorsVertices(E, H, n, frequencies, params);
+    compiled.extractPhasorsVertices(E, H, n, frequencies, params);
+    for (int ifx = 0; ifx < n_frequencies; ifx++) {
+      per_frequency.extractPhasorsVertices(
+              ifx, E, H, n, frequencies[ifx] * 2 * DCPI, params);
+    }
+  }
+
+  int n_values = n_vertices * n_requested * n_frequencies;
+  double *expected_real = mxGetPr(per_frequency.get_mx_camplitudes()),
+         *expected_imag = mxGetPi(per_frequency.get_mx_camplitudes());
+  bool all_close = true;
+  for (VertexPhasors *phasors : {&batched, &compiled}) {
+    double *real = mxGetPr(phasors->get_mx_camplitudes()),
+           *imag = mxGetPi(phasors->get_mx_camplitudes());
+    for (int i = 0; i < n_values; i++) {
+      all_close = all_close && is_close(real[i], expected_real[i]) &&
+                  is_close(imag[i], expected_imag[i]);
+    }
+  }
+  REQUIRE(all_close);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_VolumeSpectrum.cpp
+ * @brief Tests of the extraction of the volume phasors at several frequencies.
+ */
+#include "volume_spectrum.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "field_patterns.h"
+#include "globals.h"
+#include "unit_test_utils.h"
+
+using namespace std;
+using tdms_math_constants::DCPI, tdms_math_constants::IMAGINARY_UNIT;
+using tdms_tests::is_close, tdms_tests::set_pattern;
+
+namespace {
+
+const int I_tot = 5, J_tot = 4, K_tot = 6;
+const double DT = 0.1;
+const int INTERVAL = 3;
+const vector<double> FREQUENCIES = {0.05, 0.2, 0.45};
+
+/** @brief The field of a component at a cell, Ex to Hz for 0 to 5 */
+double component_of(const ElectricSplitField &E, const MagneticSplitField &H,
+                    int c, int i, int j, int k) {
+  switch (c) {
+    case 0:
+      return E.x(i, j, k);
+    case 1:
+      return E.y(i, j, k);
+    case 2:
+      return E.z(i, j, k);
+    case 3:
+      return H.x(i, j, k);
+    case 4:
+      return H.y(i, j, k);
+    default:
+      return H.z(i, j, k);
+  }
+}
+
+}// namespace
+
+TEST_CASE("VolumeSpectrum: phasors at every frequency") {
+  ElectricSplitField E_s(I_tot, J_tot, K_tot);
+  MagneticSplitField H_s(I_tot, J_tot, K_tot);
+  E_s.allocate_and_zero();
+  H_s.allocate_and_zero();
+
+  // the phasors cover part of the grid
+  ElectricField E;
+  E.il = 1, E.iu = I_tot - 1;
+  E.jl = 0, E.ju = J_tot - 2;
+  E.kl = 2, E.ku = K_tot;
+
+  // more extractions than the phases are rotated for, before they are
+  // recomputed
+  const int n_extractions = 2 * VolumeSpectrum::RESEED_INTERVAL + 10,
+            start_tind = 7;
+  VolumeSpectrum spectrum;
+  REQUIRE(!spectrum.is_enabled());
+  spectrum.allocate(E, FREQUENCIES, DT, INTERVAL, n_extractions);
+  REQUIRE(spectrum.is_enabled());
+  REQUIRE(spectrum.n_frequencies() == 3);
+  long long n_cells =
+          (long long) (E.iu - E.il + 1) * (E.ju - E.jl + 1) * (E.ku - E.kl + 1);
+  REQUIRE(spectrum.cells().n_cells() == n_cells);
+
+  // the phasors computed directly: the fields at timestep n times
+  // exp(i omega n dt) / Npe for E, and half a timestep later for H
+  const CellBox &cells = spectrum.cells();
+  int n_f = FREQUENCIES.size();
+  vector<complex<double>> expected(cells.n_cells() * 6 * n_f, 0.);
+  auto expected_at = [&](int c, int i, int j, int k, int f) -> auto & {
+    int n_j = cells.upper.j - cells.lower.j,
+        n_k = cells.upper.k - cells.lower.k;
+    int cell = ((i - cells.lower.i) * n_j + (j - cells.lower.j)) * n_k +
+               (k - cells.lower.k);
+    return expected[(cell * 6 + c) * n_f + f];
+  };
+
+  for (int m = 0; m < n_extractions; m++) {
+    int tind = start_tind + m * INTERVAL;
+    set_pattern(E_s, H_s, cos(0.1 * m));
+    spectrum.extract(E_s, H_s, tind);
+
+    for (int f = 0; f < n_f; f++) {
+      double omega = 2. * DCPI * FREQUENCIES[f];
+      complex<double> E_phase = exp(omega * tind * DT * IMAGINARY_UNIT) /
+                                (double) n_extractions,
+                      H_phase = exp(omega * (tind + 0.5) * DT *
+                                    IMAGINARY_UNIT) /
+                                (double) n_extractions;
+      for (int i = cells.lower.i; i < cells.upper.i; i++) {
+        for (int j = cells.lower.j; j < cells.upper.j; j++) {
+          for (int k = cells.lower.k; k < cells.upper.k; k++) {
+            for (int c = 0; c < 6; c++) {
+              expected_at(c, i, j, k, f) +=
+                      component_of(E_s, H_s, c, i, j, k) *
+                      (c < 3 ? E_phase : H_phase);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  auto all_close = [&](const vector<complex<double>> &norms) {
+    bool close = true;
+    for (int i = cells.lower.i; i < cells.upper.i; i++) {
+      for (int j = cells.lower.j; j < cells.upper.j; j++) {
+        for (int k = cells.lower.k; k < cells.upper.k; k++) {
+          for (int c = 0; c < 6; c++) {
+            for (int f = 0; f < n_f; f++) {
+              close = close && is_close(spectrum.phasor(c, i, j, k, f),
+                                        expected_at(c, i, j, k, f) /
+                                                norms[c / 3 * n_f + f]);
+            }
+          }
+        }
+      }
+    }
+    return close;
+  };
+  REQUIRE(all_close(vector<complex<double>>(2 * n_f, 1.)));
+
+  SECTION("Normalisation") {
+    vector<complex<double>> E_norm = {{1., 2.}, {0.5, 0.}, {0., -3.}},
+                            H_norm = {{2., 0.}, {-1., 1.}, {0.25, 0.25}};
+    spectrum.normalise(E_norm, H_norm);
+    vector<complex<double>> norms = E_norm;
+    norms.insert(norms.end(), H_norm.begin(), H_norm.end());
+    REQUIRE(all_close(norms));
+  }
+
+  SECTION("Copy in MATLAB order") {
+    int n_i = cells.upper.i - cells.lower.i,
+        n_j = cells.upper.j - cells.lower.j,
+        n_k = cells.upper.k - cells.lower.k;
+    vector<double> real(cells.n_cells() * n_f), imag(real.size());
+    spectrum.copy_to(4, real.data(), imag.data());
+    bool copied = true;
+    for (int f = 0; f < n_f; f++) {
+      for (int k = 0; k < n_k; k++) {
+        for (int j = 0; j < n_j; j++) {
+          for (int i = 0; i < n_i; i++) {
+            int out = ((f * n_k + k) * n_j + j) * n_i + i;
+            complex<double> phasor =
+                    spectrum.phasor(4, cells.lower.i + i, cells.lower.j + j,
+                                    cells.lower.k + k, f);
+            copied = copied && real[out] == phasor.real() &&
+                     imag[out] == phasor.imag();
+          }
+        }
+      }
+    }
+    REQUIRE(copied);
+  }
+}
@@ -140,5 +140,190 @@ TEST_CASE("CL options") {
                               const_cast<char **>(vector_to_array(input_args)));
     // ArgumentNamespace should ignore executable name when counting input args
     REQUIRE(args.num_non_flag == 2);
+    REQUIRE(!args.solver_options().cache_blocking);
+    REQUIRE(!args.solver_options().fused_updates);
+    REQUIRE(!args.solver_options().fused_phasors);
+    REQUIRE(!args.solver_options().huge_pages);
+    REQUIRE(!args.solver_options().pad_rows);
+    REQUIRE(!args.solver_options().unsplit_interior);
+    REQUIRE(!args.solver_options().volume_spectrum);
+  }
+  SECTION("Cache blocking") {
+    for (const char *flag : {"-b", "--cache-blocking"}) {
+      vector<string> args_with_flag = input_args;
+      args_with_flag.insert(args_with_flag.begin() + 1, flag);
+      auto args = ArgumentNamespace(
+              args_with_flag.size(),
+              const_cast<char **>(vector_to_array(args_with_flag)));
+      REQUIRE(args.num_non_flag == 2);
+      REQUIRE(args.solver_options().cache_blocking);
+    }
+  }
+  SECTION("Fused updates") {
+    for (const char *flag : {"-f", "--fused-updates"}) {
+      vector<string> args_with_flag = input_args;
+      args_with_flag.insert(args_with_flag.begin() + 1, flag);
+      auto args = ArgumentNamespace(
+              args_with_flag.size(),
+              const_cast<char **>(vector_to_array(args_with_flag)));
+      REQUIRE(args.num_non_flag == 2);
+      REQUIRE(args.solver_options().fused_updates);
+      REQUIRE(!args.solver_options().fused_phasors);
+      REQUIRE(!args.solver_options().cache_blocking);
+    }
+  }
+  SECTION("Fused phasors") {
+    vector<string> args_with_flag = input_args;
+    args_with_flag.insert(args_with_flag.begin() + 1, "--fused-phasors");
+    auto args = ArgumentNamespace(
+            args_with_flag.size(),
+            const_cast<char **>(vector_to_array(args_with_flag)));
+    REQUIRE(args.num_non_flag == 2);
+    // the phasors are accumulated by the kernels of the fused engine
+    REQUIRE(args.solver_options().fused_phasors);
+    REQUIRE(args.solver_options().fused_updates);
+  }
+  SECTION("Field storage") {
+    vector<string> args_with_flags = input_args;
+    args_with_flags.insert(args_with_flags.begin() + 1, "--huge-pages");
+    args_with_flags.insert(args_with_flags.begin() + 1, "--pad-rows");
+    args_with_flags.insert(args_with_flags.begin() + 1, "--unsplit-interior");
+    auto args = ArgumentNamespace(
+            args_with_flags.size(),
+            const_cast<char **>(vector_to_array(args_with_flags)));
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().huge_pages);
+    REQUIRE(args.solver_options().pad_rows);
+    REQUIRE(args.solver_options().unsplit_interior);
+  }
+  // the arguments with the given flags before the input file
+  auto args_with = [&](vector<string> flags) {
+    vector<string> args_with_flags = input_args;
+    args_with_flags.insert(args_with_flags.begin() + 1, flags.begin(),
+                           flags.end());
+    return ArgumentNamespace(
+            args_with_flags.size(),
+            const_cast<char **>(vector_to_array(args_with_flags)));
+  };
+  SECTION("Tile steps") {
+    REQUIRE(args_with({}).solver_options().tile_steps == 4);
+    REQUIRE(args_with({"-b"}).solver_options().tile_steps == 4);
+
+    auto args = args_with({"--tile-steps=8"});
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().cache_blocking);
+    REQUIRE(args.solver_options().tile_steps == 8);
+    for (string steps : {"0", "four", "2x"}) {
+      REQUIRE_THROWS_AS(args_with({"--tile-steps=" + steps}).solver_options(),
+                        std::runtime_error);
+    }
+  }
+  SECTION("Slab width") {
+    REQUIRE(args_with({}).solver_options().slab_width == 0);
+    REQUIRE(args_with({"-b"}).solver_options().slab_width == 0);
+
+    auto args = args_with({"--slab-width=3"});
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().cache_blocking);
+    REQUIRE(args.solver_options().slab_width == 3);
+    for (string width : {"0", "-2", "three"}) {
+      REQUIRE_THROWS_AS(args_with({"--slab-width=" + width}).solver_options(),
+                        std::runtime_error);
+    }
+  }
+  SECTION("FFT backend") {
+    REQUIRE(args_with({}).solver_options().fft_library == FFTLibrary::FFTW);
+    REQUIRE(args_with({"--fft-backend=builtin"}).solver_options().fft_library ==
+            FFTLibrary::Builtin);
+    REQUIRE_THROWS_AS(args_with({"--fft-backend=mkl"}).solver_options(),
+                      std::runtime_error);
+  }
+  SECTION("FFTW planning") {
+    REQUIRE(args_with({}).solver_options().fftw_planning ==
+            FFTPlanning::Measure);
+    REQUIRE(args_with({}).solver_options().fftw_wisdom.empty());
+
+    auto args = args_with({"--fftw-planning=patient",
+                           "--fftw-wisdom=wisdom.dat"});
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().fftw_planning == FFTPlanning::Patient);
+    REQUIRE(args.solver_options().fftw_wisdom == "wisdom.dat");
+    REQUIRE_THROWS_AS(
+            args_with({"--fftw-planning=thorough"}).solver_options(),
+            std::runtime_error);
+  }
+  SECTION("Active region") {
+    REQUIRE(!args_with({}).solver_options().active_region);
+    REQUIRE(args_with({"--active-region"}).solver_options().active_region);
+
+    auto args = args_with({"--active-region-threshold=1e-4"});
+    REQUIRE(args.solver_options().active_region);
+    REQUIRE(args.solver_options().active_region_threshold == 1e-4);
+    for (string threshold : {"-0.1", "1", "small"}) {
+      REQUIRE_THROWS_AS(args_with({"--active-region-threshold=" + threshold})
+                                .solver_options(),
+                        std::runtime_error);
+    }
+  }
+  SECTION("Energy decay") {
+    REQUIRE(args_with({}).solver_options().energy_decay == 0.);
+    REQUIRE(args_with({"--energy-decay=1e-6"}).solver_options().energy_decay ==
+            1e-6);
+    for (string fraction : {"0", "1.5", "1e-6s"}) {
+      REQUIRE_THROWS_AS(
+              args_with({"--energy-decay=" + fraction}).solver_options(),
+              std::runtime_error);
+    }
+  }
+  SECTION("Convergence check") {
+    REQUIRE(args_with({}).solver_options().convergence_set ==
+            ConvergenceSet::Volume);
+    REQUIRE(args_with({}).solver_options().convergence_stride == 1);
+
+    auto args = args_with({"--convergence-on=surface",
+                           "--convergence-stride=4"});
+    REQUIRE(args.solver_options().convergence_set == ConvergenceSet::Surface);
+    REQUIRE(args.solver_options().convergence_stride == 4);
+    REQUIRE_THROWS_AS(args_with({"--convergence-on=vertices"}).solver_options(),
+                      std::runtime_error);
+    for (string stride : {"0", "-2", "two"}) {
+      REQUIRE_THROWS_AS(
+              args_with({"--convergence-stride=" + stride}).solver_options(),
+              std::runtime_error);
+    }
+  }
+  SECTION("Hybrid PSTD") {
+    REQUIRE(!args_with({}).solver_options().hybrid_pstd);
+    REQUIRE(args_with({}).solver_options().hybrid_overlap == 2);
+
+    auto args = args_with({"--hybrid-pstd", "--hybrid-overlap=4"});
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().hybrid_pstd);
+    REQUIRE(args.solver_options().hybrid_overlap == 4);
+    for (string overlap : {"-1", "two", "3x"}) {
+      REQUIRE_THROWS_AS(args_with({"--hybrid-overlap=" + overlap})
+                                .solver_options(),
+                        std::runtime_error);
+    }
+  }
+  SECTION("Volume spectrum") {
+    REQUIRE(!args_with({}).solver_options().volume_spectrum);
+    auto args = args_with({"--volume-spectrum"});
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().volume_spectrum);
+  }
+
+  SECTION("Compiled probes") {
+    REQUIRE(!args_with({}).solver_options().compiled_probes);
+    auto args = args_with({"--compiled-probes"});
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().compiled_probes);
+  }
+
+  SECTION("Distributed") {
+    REQUIRE(!args_with({}).solver_options().distributed);
+    auto args = args_with({"--distributed"});
+    REQUIRE(args.num_non_flag == 2);
+    REQUIRE(args.solver_options().distributed);
   }
 }
@@ -4,6 +4,10 @@
  */
 #include "numerical_derivative.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <fftw3.h>
@@ -105,3 +109,133 @@ TEST_CASE("Numerical derivative") {
   for (int i = 0; i < NSAMPLES; i++)
     if (not std::isnan(ratio[i])) REQUIRE(ratio[i] == Approx(mean));
 }
+
+/**
+ * @brief Test that the batched real-to-complex derivative matches the real
+ * part of first_derivative, normalised to the derivative with respect to the
+ * sample index.
+ *
+ * The number of lines is not a multiple of the batch size, so that some lines
+ * are differentiated in a partial batch.
+ */
+TEST_CASE("BatchedDerivative") {
+  const int N_OUTER = 3, N_INNER = 7, N_MAX = 16;
+  const double DELTA = -0.5;
+  // the line (outer, inner) is a sum of sinusoids, of a sample i
+  auto sample = [](int outer, int inner, int i, int N) {
+    double theta = 2. * M_PI * i / (double) N;
+    return std::cos((outer + 1) * theta) + 0.5 * std::sin(inner * theta) +
+           0.1 * inner;
+  };
+
+  // the lines of both an even and an odd number of samples
+  for (int N : {16, 15}) {
+    SPDLOG_INFO("Lines of {} samples", N);
+    fftw_complex line[N_MAX], output[N_MAX], dk[N_MAX];
+    fftw_plan pf =
+            fftw_plan_dft_1d(N, line, output, FFTW_FORWARD, FFTW_ESTIMATE);
+    fftw_plan pb =
+            fftw_plan_dft_1d(N, line, output, FFTW_BACKWARD, FFTW_ESTIMATE);
+    init_diff_shift_op(DELTA, dk, N);
+
+    BatchedDerivative derivative;
+    derivative.initialise(N, DELTA, omp_get_max_threads(), 4);
+    REQUIRE(derivative.length() == N);
+
+    std::vector<double> batched(N_OUTER * N_INNER * N);
+#pragma omp parallel
+    derivative.differentiate_lines(
+            N_OUTER, N_INNER, 0, N,
+            [&](int outer, int inner, int i) {
+              return sample(outer, inner, i, N);
+            },
+            [&](int outer, int inner, int i, double result) {
+              batched[(outer * N_INNER + inner) * N + i] = result;
+            });
+
+    for (int outer = 0; outer < N_OUTER; outer++) {
+      for (int inner = 0; inner < N_INNER; inner++) {
+        for (int i = 0; i < N; i++) {
+          line[i][REAL] = sample(outer, inner, i, N);
+          line[i][IMAG] = 0.;
+        }
+        first_derivative(line, output, dk, N, pf, pb);
+        for (int i = 0; i < N; i++) {
+          REQUIRE(batched[(outer * N_INNER + inner) * N + i] ==
+                  Approx(output[i][REAL] / N).margin(1e-9));
+        }
+      }
+    }
+    fftw_destroy_plan(pf);
+    fftw_destroy_plan(pb);
+  }
+}
+
+/**
+ * @brief Test that the blended lines of a BatchedDerivative are differentiated
+ * by the weighted sum of the spectral derivative and the finite difference,
+ * and the other lines spectrally.
+ */
+TEST_CASE("BatchedDerivative: blended lines") {
+  const int N = 12, N_OUTER = 2, N_INNER = 9;
+  auto sample = [](int outer, int inner, int i) {
+    return std::sin(0.4 * i * (inner + 1) + outer) + 0.1 * i * i;
+  };
+  // the first batch of lines, and every third line after it, is blended: by
+  // finite differences only at the middle samples of the line, and the weight
+  // of the spectral derivative rising either side of them
+  auto weight_at = [](int x) {
+    return std::min(1., std::max(0., (std::abs(2 * x - N) - 2) / 6.));
+  };
+  auto is_blended = [](int outer, int inner) {
+    return inner < 4 || inner % 3 == 0;
+  };
+  auto blend = [&](int outer, int inner, int n, double *weight) {
+    if (!is_blended(outer, inner)) { return false; }
+    for (int x = 0; x < n; x++) { weight[x] = weight_at(x); }
+    return true;
+  };
+
+  for (double delta : {-0.5, 0.5}) {
+    BatchedDerivative derivative;
+    derivative.initialise(N, delta, omp_get_max_threads(), 4);
+    // the differences reach one sample beyond the updated range
+    int begin = delta < 0. ? 1 : 0, end = delta < 0. ? N : N - 1;
+
+    std::vector<double> spectral(N_OUTER * N_INNER * N),
+            hybrid(N_OUTER * N_INNER * N);
+    auto into = [&](std::vector<double> &result) {
+      return [&result](int outer, int inner, int i, double value) {
+        result[(outer * N_INNER + inner) * N + i] = value;
+      };
+    };
+#pragma omp parallel
+    {
+      derivative.differentiate_lines(N_OUTER, N_INNER, begin, end, sample,
+                                     into(spectral));
+      derivative.differentiate_lines(N_OUTER, N_INNER, begin, end, sample,
+                                     into(hybrid), blend);
+    }
+
+    for (int outer = 0; outer < N_OUTER; outer++) {
+      for (int inner = 0; inner < N_INNER; inner++) {
+        for (int i = begin; i < end; i++) {
+          int n = (outer * N_INNER + inner) * N + i;
+          double difference =
+                  delta < 0. ? sample(outer, inner, i) -
+                                       sample(outer, inner, i - 1)
+                             : sample(outer, inner, i + 1) -
+                                       sample(outer, inner, i);
+          double weight = is_blended(outer, inner) ? weight_at(i) : 1.;
+          if (weight == 1.) {
+            REQUIRE(hybrid[n] == spectral[n]);
+          } else {
+            REQUIRE(hybrid[n] ==
+                    Approx(weight * spectral[n] + (1. - weight) * difference)
+                            .margin(1e-12));
+          }
+        }
+      }
+    }
+  }
+}
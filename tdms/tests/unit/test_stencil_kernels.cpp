@@ -0,0 +1,140 @@
+/**
+ * @file test_stencil_kernels.cpp
+ * @brief Tests that the vectorised finite-difference kernels agree with the
+ * scalar update equations.
+ */
+#include "stencil_kernels.h"
+
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/spdlog.h>
+
+using namespace std;
+
+// the vectorised kernels are built under the same conditions as in
+// stencil_kernels.cpp
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TDMS_X86_SIMD 1
+#endif
+
+namespace {
+
+/**
+ * @brief Every implementation of the row update that the CPU supports.
+ */
+vector<SimdLevel> supported_levels() {
+  vector<SimdLevel> levels = {SimdLevel::SCALAR};
+  if (detected_simd_level() != SimdLevel::SCALAR) {
+    levels.push_back(SimdLevel::AVX2);
+  }
+  if (detected_simd_level() == SimdLevel::AVX512) {
+    levels.push_back(SimdLevel::AVX512);
+  }
+  return levels;
+}
+
+/**
+ * @brief Whether the implementation for the given instruction set reproduces
+ * the scalar update, for rows of every length up to 37.
+ *
+ * @tparam T Scalar type of the field
+ */
+template<typename T>
+bool agrees_with_scalar_update(SimdLevel level) {
+  mt19937 generator(2023);
+  uniform_real_distribution<double> distribution(-1., 1.);
+  // row lengths that exercise the remainder handling of each implementation
+  const int max_length = 37;
+  vector<double> a(max_length), b(max_length);
+  vector<T> plus_1(max_length), plus_2(max_length), minus_1(max_length),
+          minus_2(max_length), field(max_length);
+  for (auto *v : {&a, &b}) {
+    for (double &value : *v) { value = distribution(generator); }
+  }
+  for (auto *v : {&plus_1, &plus_2, &minus_1, &minus_2, &field}) {
+    for (T &value : *v) { value = (T) distribution(generator); }
+  }
+
+  CurlUpdateRow<T> kernel = curl_update_row_kernel<T>(level);
+  bool all_equal = true;
+  for (int n = 0; n <= max_length; n++) {
+    vector<T> updated = field, expected = field;
+    kernel(n, updated.data(), a.data(), b.data(), plus_1.data(), plus_2.data(),
+           minus_1.data(), minus_2.data());
+    // this file is built with -ffp-contract=off, as the kernels are, so the
+    // reference is not contracted into fused multiply-adds
+    for (int k = 0; k < n; k++) {
+      expected[k] = a[k] * field[k] +
+                    b[k] * (plus_1[k] + plus_2[k] - minus_1[k] - minus_2[k]);
+    }
+    // elements beyond the row must not be touched
+    all_equal = all_equal && (updated == expected);
+  }
+  return all_equal;
+}
+
+}// namespace
+
+TEST_CASE("Vectorised row updates agree bit-for-bit with the scalar update") {
+  SPDLOG_INFO("Detected SIMD level: {}", to_string(detected_simd_level()));
+
+  for (SimdLevel level : supported_levels()) {
+    SPDLOG_INFO("Checking the {} kernels", to_string(level));
+    REQUIRE(agrees_with_scalar_update<double>(level));
+    REQUIRE(agrees_with_scalar_update<float>(level));
+  }
+}
+
+TEST_CASE("Row updates are dispatched to the widest kernels that the CPU "
+          "supports") {
+  SECTION("A CPU without AVX2 or AVX-512 falls back on the scalar kernels") {
+    REQUIRE(select_simd_level(false, false) == SimdLevel::SCALAR);
+  }
+
+  SECTION("The widest instruction set of the CPU is selected") {
+#ifdef TDMS_X86_SIMD
+    REQUIRE(select_simd_level(true, false) == SimdLevel::AVX2);
+    REQUIRE(select_simd_level(true, true) == SimdLevel::AVX512);
+    REQUIRE(select_simd_level(false, true) == SimdLevel::AVX512);
+#else
+    // a build without the vectorised kernels always uses the scalar ones
+    REQUIRE(select_simd_level(true, false) == SimdLevel::SCALAR);
+    REQUIRE(select_simd_level(true, true) == SimdLevel::SCALAR);
+#endif
+  }
+
+  SECTION("The detected instruction set is that reported by the CPU") {
+    SimdLevel reported = SimdLevel::SCALAR;
+#ifdef TDMS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      reported = SimdLevel::AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+      reported = SimdLevel::AVX2;
+    }
+#endif
+    REQUIRE(detected_simd_level() == reported);
+  }
+
+  SECTION("Each instruction set has its own kernels") {
+    CurlUpdateRow<double> scalar =
+            curl_update_row_kernel<double>(SimdLevel::SCALAR);
+    CurlUpdateRow<float> scalar_float =
+            curl_update_row_kernel<float>(SimdLevel::SCALAR);
+#ifdef TDMS_X86_SIMD
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+      REQUIRE(curl_update_row_kernel<double>(level) != scalar);
+      REQUIRE(curl_update_row_kernel<float>(level) != scalar_float);
+    }
+    REQUIRE(curl_update_row_kernel<double>(SimdLevel::AVX2) !=
+            curl_update_row_kernel<double>(SimdLevel::AVX512));
+#else
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+      REQUIRE(curl_update_row_kernel<double>(level) == scalar);
+      REQUIRE(curl_update_row_kernel<float>(level) == scalar_float);
+    }
+#endif
+  }
+}